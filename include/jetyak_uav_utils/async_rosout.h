@@ -0,0 +1,66 @@
+
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This header forwards the asynchronous log of bsc_common to rosconsole.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef JETYAK_UAV_UTILS_ASYNC_ROSOUT_H_
+#define JETYAK_UAV_UTILS_ASYNC_ROSOUT_H_
+
+#include <ros/ros.h>
+
+#include "../lib/bsc_common/include/async_log.h"
+
+namespace JETYAK_UAV_UTILS
+{
+/** startAsyncLog
+ * Starts the ASYNC_* macros' formatting thread with rosconsole as the sink.
+ * Call after ros::init.
+ */
+inline void startAsyncLog()
+{
+	bsc_common::AsyncLog::instance().start([](bsc_common::AsyncLog::level_t level, const char *text) {
+		switch (level)
+		{
+		case bsc_common::AsyncLog::LEVEL_DEBUG:
+			ROS_DEBUG("%s", text);
+			break;
+		case bsc_common::AsyncLog::LEVEL_INFO:
+			ROS_INFO("%s", text);
+			break;
+		case bsc_common::AsyncLog::LEVEL_WARN:
+			ROS_WARN("%s", text);
+			break;
+		default:
+			ROS_ERROR("%s", text);
+			break;
+		}
+	});
+}
+}; // namespace JETYAK_UAV_UTILS
+
+#endif // JETYAK_UAV_UTILS_ASYNC_ROSOUT_H_
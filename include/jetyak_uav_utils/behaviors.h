@@ -61,14 +61,27 @@ SOFTWARE.
 // Jetyak UAV Includes
 #include "jetyak_uav_utils/ObservedState.h"
 #include "jetyak_uav_utils/FourAxes.h"
+#include "jetyak_uav_utils/LandingDiagnostics.h"
 #include "jetyak_uav_utils/GetString.h"
+#include "jetyak_uav_utils/SetCoverage.h"
 #include "jetyak_uav_utils/SetString.h"
+#include "jetyak_uav_utils/SetWaypoints.h"
+#include "jetyak_uav_utils/async_rosout.h"
 #include "jetyak_uav_utils/jetyak_uav_utils.h"
 
 // Lib includes
+#include "../lib/bsc_common/include/angles.h"
+#include "../lib/bsc_common/include/boat_predictor.h"
+#include "../lib/bsc_common/include/coverage_path.h"
+#include "../lib/bsc_common/include/flight_recorder.h"
+#include "../lib/bsc_common/include/gps_enu.h"
+#include "../lib/bsc_common/include/landing_behaviors.h"
 #include "../lib/bsc_common/include/lqr.h"
+#include "../lib/bsc_common/include/min_snap.h"
+#include "../lib/bsc_common/include/trajectory_planner.h"
 #include "../lib/bsc_common/include/types.h"
 #include "../lib/bsc_common/include/util.h"
+#include "../lib/bsc_common/include/waypoint_path.h"
 
 class Behaviors
 {
@@ -77,20 +90,18 @@ private:
 	 * ROS PUBLISHERS, SUBSCRIBERS, AND SERVICES
 	 *********************************************/
 	ros::Subscriber stateSub_, tagSub_, extCmdSub_;
-	ros::Publisher cmdPub_, modePub_, gimbalCmdPub_;
+	ros::Publisher cmdPub_, modePub_, gimbalCmdPub_, landDiagnosticsPub_;
 	ros::ServiceClient propSrv_, takeoffSrv_, landSrv_, lookdownSrv_, resetKalmanSrv_, enableGimbalSrv_;
-	ros::ServiceServer setModeService_, getModeService_, setFollowPosition_, setLandPosition_;
+	ros::ServiceServer setModeService_, getModeService_, setFollowPosition_, setLandPosition_, setWaypoints_, setCoverage_;
 	ros::NodeHandle nh;
 
 	/**********************
 	 * INSTANCE VARIABLES
 	 **********************/
 	int integral_size = 0;
-	bsc_common::LQR *lqr_; // pid controllers
 	std::string generalK, landK;
 	bool behaviorChanged_ = false;
 	JETYAK_UAV_UTILS::Mode currentMode_;
-	bool propellorsRunning = false;
 	bool trackEnabled = false;
 	double resetFilterTimeThresh;
 
@@ -98,8 +109,22 @@ private:
 	 * STATE VARIABLES
 	 ************************************/
 	double uavHeight_ = 0;
-	double lastSpotted = 0;
 	jetyak_uav_utils::ObservedState state;
+	bsc_common::BoatPredictor boatPredictor_; // boat motion fit from the state updates
+
+	// Takeoff, follow, land, ride and hover, shared with the simulated missions. It also
+	// owns the derived state and the LQRs the other behaviors use.
+	bsc_common::LandingBehaviors::params_t landingParams_;
+	bsc_common::LandingBehaviors *landing_;
+
+	// Binary flight log, written off the control thread
+	bsc_common::FlightRecorder recorder_;
+	struct
+	{
+		std::string path; // empty disables the recorder
+		int maxRecords = 2000000;
+		int state, setpoint, command, mode, landThreshold; // record type ids
+	} log_;
 
 	/*********************************************
 	 * BEHAVIOR SPECIFIC VARIABLES AND CONSTANTS
@@ -111,23 +136,19 @@ private:
 		double threshold;
 	} takeoff_;
 
-	// Land specific constantsRC_Interpreter.joyCallback
+	// Land specific constants
 	struct
 	{
-		bsc_common::pose4d_t goal_pose; // landing goal
-		double xTopThresh, yTopThresh, xBottomThresh, yBottomThresh,bottom, top;
-		double velThreshSqr;
-		double angleThresh;
-		bsc_common::LQR *lqr;
-		double tagLossThresh;
+		// Envelope check, published at diagnosticsRate
+		jetyak_uav_utils::LandingDiagnostics diagnostics;
+		double diagnosticsRate = 5; // Hz, 0 disables
+		double lastDiagnostics = 0;
 	} land_;
 
 	// follow specific constants
 	struct
 	{
-		bsc_common::pose4d_t goal_pose; // follow goal
 		double deadzone_radius;
-		double tagLossThresh;
 	} follow_;
 
 	// follow specific constants
@@ -141,7 +162,8 @@ private:
 		double settleRadiusSquared = .1;
 		double tagTime;
 		double tagLossThresh;
-		double maxVel;
+		double maxVel;				// speed the drone closes on the intercept point at
+		double predictHorizon; // longest intercept looked for
 		bsc_common::pose4d_t goal; // settle goal
 		enum Stage
 		{
@@ -156,6 +178,41 @@ private:
 	{
 		sensor_msgs::Joy input;
 	} leave_;
+
+	// waypoint specific variables
+	struct
+	{
+		bsc_common::WaypointPath path;
+		std::vector<double> radius, loiterTime, heading; // per waypoint, index 0 is the start point
+		int leg = 0;																		 // leg being flown, the target is waypoint leg+1
+		int lookaheadLeg = 0;														 // leg hint for the lookahead point
+		double enteredTime = -1;												 // time the target radius was entered, -1 if outside
+		double lookahead;																 // distance along the path to the carrot
+		double speed;																		 // velocity setpoint along the path
+		double maxCmd;																	 // horizontal command limit
+		sensor_msgs::Joy cmd;														 // reused each tick
+
+		// Coverage surveys are pulled one point at a time into a two leg window of path
+		bsc_common::CoveragePath coverage;
+		bool streaming = false;
+		double surveyZ;
+		std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d>> window;
+
+		// Uploaded waypoints are flown along a minimum snap trajectory, solved on the planner's
+		// thread while the legs are flown
+		bsc_common::TrajectoryPlanner planner;
+		bool planning = false; // a request is outstanding
+		int planTag = 0;			 // tag of the newest request, older solves are dropped
+		int planFrom = 0;			 // first waypoint of the newest request
+		bsc_common::MinSnapTrajectory trajectory;
+		bsc_common::MinSnapTrajectory::sample_t ref;
+		bsc_common::MinSnapTrajectory::points_t points; // waypoints in ENU, index 0 is the start point
+		bool planned = false;
+		int trajOffset = 0;		 // waypoint index of the trajectory's start point
+		double trajTime = 0;	 // reference time along the trajectory
+		double lastTick = -1;	// time of the previous tick, -1 if there was none
+		double maxVel, maxAcc; // trajectory limits
+	} waypoint_;
 	/*********************
 	 * SERVICE CALLBACKS
 	 *********************/
@@ -191,6 +248,24 @@ private:
 	 */
 	bool setLandPositionCallback(jetyak_uav_utils::FourAxes::Request &req, jetyak_uav_utils::FourAxes::Response &res);
 
+	/** setWaypointsCallback
+	 * Replace the waypoint path. The path starts at the drone's current position.
+	 *
+	 * @param req waypoints in latitude, longitude, altitude
+	 * @param res false if there is no ENU origin yet
+	 */
+	bool setWaypointsCallback(jetyak_uav_utils::SetWaypoints::Request &req,
+														jetyak_uav_utils::SetWaypoints::Response &res);
+
+	/** setCoverageCallback
+	 * Start a coverage survey of a polygon. Its points are generated as they are flown.
+	 *
+	 * @param req polygon corners in latitude, longitude and the pattern to fly
+	 * @param res false if there is no ENU origin yet or the polygon is invalid
+	 */
+	bool setCoverageCallback(jetyak_uav_utils::SetCoverage::Request &req,
+													 jetyak_uav_utils::SetCoverage::Response &res);
+
 	/****************************
 	 * SUBSCRIPTION CALLBACKS
 	 *****************************/
@@ -249,6 +324,34 @@ private:
 	 */
 	void hoverBehavior();
 
+	/** waypointBehavior
+	 * Follow the uploaded waypoints, loitering at each, then hover
+	 */
+	void waypointBehavior();
+
+	/** planTrajectory
+	 * Start planning the trajectory from the drone's position and velocity through the waypoints
+	 * from index from onwards. The legs are flown until adoptTrajectory picks it up.
+	 *
+	 * @return false if there are no waypoints left
+	 */
+	bool planTrajectory(int from);
+
+	/** adoptTrajectory
+	 * Switch to the newest planned trajectory once its solve finishes
+	 */
+	void adoptTrajectory();
+
+	/** followTrajectory
+	 * Track the trajectory with the LQR, advancing the reference only while the drone keeps up
+	 */
+	void followTrajectory();
+
+	/** pullCoverageLeg
+	 * Drop the flown legs from the coverage window and pull as many new points of the survey
+	 */
+	void pullCoverageLeg();
+
 	/*****************
 	 * Common Methods
 	 *****************/
@@ -260,19 +363,27 @@ private:
 	 */
 	void downloadParams(std::string ns = "");
 
-	/** boat_to_drone
-	 * Converts a 4d pose in the boat FLU frame to the UAV FLU frame. Useful in translating boat relative setpoints to the drone's frame.
-	 * @param pos position in the boat frame
-	 * @param yaw offset relative to boat frame
-	 * */
-	Eigen::Vector4d boat_to_drone(Eigen::Vector4d pos);
-
 	/** gimbal_angle_cmd
 	 * Uses the observed state of the UAV and Jetyak to find the gimbal angle in order to point the camera to the boat.
 	 * */
 	Eigen::Vector2d gimbal_angle_cmd();
 
-	bool inLandThreshold();
+	/** publishCommand
+	 * Publishes a command of the landing behaviors on behavior_cmd
+	 */
+	void publishCommand(const bsc_common::LandingBehaviors::command_t &cmd);
+
+	/** landCheck
+	 * Logs an envelope check of land and publishes it at land_.diagnosticsRate
+	 */
+	void landCheck(const bsc_common::LandingBehaviors::check_t &c);
+
+	/** recordControl
+	 * Logs the state, setpoint and output of the controller that just produced a command
+	 *
+	 * @param lqr controller used this tick
+	 */
+	void recordControl(const bsc_common::LQR &lqr);
 
 	/***********************
 	 * Constructor Methods
@@ -299,6 +410,8 @@ private:
 	void assignSubscribers();
 
 public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
 	/** Constructor
 	 * Start up the Controller Node
 	 * Create publishers, subscribers, services
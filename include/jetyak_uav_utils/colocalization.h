@@ -0,0 +1,183 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This node runs the drone/boat colocalization filter (C++ version of filter_node.py)
+ * 
+ * Between filter predictions the drone state is propagated with the IMU so the state
+ * is published at IMU rate. Each IMU sample costs a constant amount of work.
+ *
+ * ~use_srf runs the float32 square root filter instead of the EKF. It applies late
+ * measurements on arrival rather than replaying them.
+ *
+ * The filter only moves forward to measurement stamps, so measurements with the usual
+ * latency do not arrive in its past. Recent IMU samples are kept and replayed on top of
+ * the filter each tick, and every published state carries the stamp it was propagated to.
+ */
+
+#ifndef COLOCALIZATION_H
+#define COLOCALIZATION_H
+
+// System includes
+#include <deque>
+
+// ROS includes
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/QuaternionStamped.h>
+#include <geometry_msgs/Vector3Stamped.h>
+#include <sensor_msgs/Imu.h>
+#include <sensor_msgs/NavSatFix.h>
+#include <std_msgs/Float64.h>
+#include <std_srvs/Trigger.h>
+#include "ros/ros.h"
+
+// Jetyak UAV Includes
+#include "jetyak_uav_utils/ObservedState.h"
+
+// Lib includes
+#include "../lib/bsc_common/include/angles.h"
+#include "../lib/bsc_common/include/attitude.h"
+#include "../lib/bsc_common/include/colocalization_ekf.h"
+#include "../lib/bsc_common/include/colocalization_srf.h"
+#include "../lib/bsc_common/include/gps_enu.h"
+
+class colocalization
+{
+public:
+	/** colocalization
+	 * Constructs the node using a node handle
+	 */
+	colocalization(ros::NodeHandle &nh);
+	~colocalization(){};
+
+	/** predictAndPublish
+	 * Restarts the IMU propagation from the filter and replays the IMU samples since.
+	 * Publishes the state when the IMU is not driving the output.
+	 */
+	void predictAndPublish();
+
+	double getRate();
+
+private:
+	// Subscribers
+	ros::Subscriber dGPSSub, dAttiSub, dImuSub, dVelSub, jGPSSub, jCompassSub, tagSub;
+
+	// Publishers
+	ros::Publisher statePub;
+
+	// Services
+	ros::ServiceServer resetFilterService;
+
+	// Functions
+	/** publishState
+	 * Publishes the filter state with the drone position and velocity and the boat position replaced
+	 *
+	 * @param stamp time of the state
+	 * @param droneP drone position in local ENU
+	 * @param droneV drone velocity in local ENU
+	 * @param boatP boat GPS position in local ENU
+	 */
+	void publishState(const ros::Time &stamp, const Eigen::Vector3d &droneP, const Eigen::Vector3d &droneV,
+										const Eigen::Vector3d &boatP);
+
+	// Callbacks
+	void dGPSCallback(const sensor_msgs::NavSatFix::ConstPtr &msg);
+	void dAttiCallback(const geometry_msgs::QuaternionStamped::ConstPtr &msg);
+	void dVelCallback(const geometry_msgs::Vector3Stamped::ConstPtr &msg);
+	void jGPSCallback(const sensor_msgs::NavSatFix::ConstPtr &msg);
+	void jCompassCallback(const std_msgs::Float64::ConstPtr &msg);
+
+	/** tagCallback
+	 * Rotates the tag position into ENU and measures the compass offset from the tag yaw
+	 */
+	void tagCallback(const geometry_msgs::PoseStamped::ConstPtr &msg);
+
+	/** dImuCallback
+	 * Keeps the sample for replay, integrates it and publishes every imuDecimation samples.
+	 * Samples stamped at or before the propagation are not integrated or published.
+	 */
+	void dImuCallback(const sensor_msgs::Imu::ConstPtr &msg);
+
+	/** filter*
+	 * The filter selected by ~use_srf, the SRF state is widened to double
+	 */
+	bool filterInitialized() const;
+	double filterTime() const;
+	bsc_common::ColocalizationEKF::state_t filterState() const;
+
+	/** propagate
+	 * Integrates an ENU acceleration from the propagation stamp to t
+	 */
+	void propagate(double t, const Eigen::Vector3d &a);
+
+	bool resetFilterCallback(std_srvs::Trigger::Request &req, std_srvs::Trigger::Response &res);
+
+	// Data
+	bsc_common::ColocalizationEKF ekf;
+	bsc_common::ColocalizationSRF srf;
+	bool useSrf;
+	bsc_common::GPS_ENU enu;
+	Eigen::Vector3d origin;
+	bool originSet;
+
+	Eigen::Quaterniond droneAtti;
+	Eigen::Vector3d droneRates;
+	double boatHeading;
+	bool attiSet, ratesSet, headingSet;
+
+	// IMU propagation from the filter
+	struct
+	{
+		double t;
+		Eigen::Vector3d droneP, droneV, boatP;
+		Eigen::Vector2d boatV;
+		bool valid;
+	} propagated;
+
+	// IMU samples newer than the filter, ENU acceleration at its stamp
+	struct imu_t
+	{
+		double t;
+		Eigen::Vector3d a;
+	};
+	std::deque<imu_t, Eigen::aligned_allocator<imu_t>> imuSamples;
+	int imuBuffer;
+
+	double rate;
+	int imuDecimation, imuCount;
+	double lastImuTime;
+
+	// Latency from IMU stamp to publish and cost of each IMU sample, reported every 10s
+	struct
+	{
+		double latencySum, latencyMax, costMax;
+		int samples;
+		ros::WallTime lastReport;
+	} imuStats;
+
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+#endif
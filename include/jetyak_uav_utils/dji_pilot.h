@@ -49,8 +49,10 @@ SOFTWARE.
 #include <dji_sdk/SDKControlAuthority.h>
 #include <dji_sdk/dji_sdk.h>
 
+#include "jetyak_uav_utils/async_rosout.h"
 #include "jetyak_uav_utils/jetyak_uav_utils.h"
 #include "../lib/bsc_common/include/flasher.h"
+#include "../lib/bsc_common/include/flight_recorder.h"
 
 class dji_pilot
 {
@@ -163,6 +165,12 @@ protected:
 	ros::Time lastRCmsg;
 	bsc_common::Flasher *alarm;
 
+	// Binary log of the command arbitration, closed if recorderPath is empty
+	bsc_common::FlightRecorder recorder;
+	std::string recorderPath;
+	int recorderMaxRecords;
+	int commandRecord, panicRecord;
+
 private:
 	/** buildFlag
 	 * Builds a DJI_SDK flag using the simpler JETYAK_UAV_UTILS flag
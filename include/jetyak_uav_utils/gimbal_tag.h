@@ -41,6 +41,10 @@ SOFTWARE.
 #include <dji_sdk/QueryDroneVersion.h>
 #include "dji_sdk/dji_sdk.h"
 
+// Lib includes
+#include "../lib/bsc_common/include/angles.h"
+#include "../lib/bsc_common/include/attitude.h"
+
 #define C_PI (double)3.141592653589793
 #define DEG2RAD(DEG) ((DEG) * ((C_PI) / (180.0)))
 #define RAD2DEG(RAD) ((RAD) * (180.0) / (C_PI))
@@ -106,6 +110,7 @@ private:
 	tf::Quaternion qVehicle;
 	tf::Quaternion qTag;
 	tf::Quaternion posTag;
+	ros::Time tagStamp;
 
 	bool tagFound;
 	bool isM100;
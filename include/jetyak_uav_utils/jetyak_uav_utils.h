@@ -52,11 +52,12 @@ enum Mode : char
 	RETURN,
 	LAND,
 	RIDE,
-	HOVER
+	HOVER,
+	WAYPOINT
 };
 
 // Save the names for human readable display
-static std::string nameFromMode[] = {"TAKEOFF", "FOLLOW", "LEAVE", "RETURN", "LAND", "RIDE", "HOVER"};
+static std::string nameFromMode[] = {"TAKEOFF", "FOLLOW", "LEAVE", "RETURN", "LAND", "RIDE", "HOVER", "WAYPOINT"};
 }; // namespace JETYAK_UAV_UTILS
 
 #endif // JETYAK_FLAG_H_
\ No newline at end of file
@@ -0,0 +1,181 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This node bridges the UAV and the boat over a UDP link instead of a shared ROS master.
+ * One runs on each side, selected by ~side.
+ *
+ * uav:  sends the observed state in Gorilla compressed batches every state_period and the
+ *       behavior mode when it changes, and calls the behaviors services the boat forwards.
+ *       The calls run in order on their own thread, so a slow service does not hold up the link.
+ * boat: republishes the state and mode under their usual names and advertises the behaviors
+ *       services, so rc_interpreter.py and HLC.py run unchanged. Each call is forwarded as
+ *       a link command, which goes ahead of telemetry, and waits for the UAV's response.
+ *
+ * Both sides publish link_stats. The state header frame_id is not sent.
+ */
+
+#ifndef LINK_BRIDGE_H
+#define LINK_BRIDGE_H
+
+// System includes
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// ROS includes
+#include <ros/callback_queue.h>
+#include <ros/serialization.h>
+#include <std_msgs/UInt8.h>
+#include "ros/ros.h"
+
+// Jetyak UAV Includes
+#include "jetyak_uav_utils/FourAxes.h"
+#include "jetyak_uav_utils/GetString.h"
+#include "jetyak_uav_utils/LinkStats.h"
+#include "jetyak_uav_utils/ObservedState.h"
+#include "jetyak_uav_utils/SetCoverage.h"
+#include "jetyak_uav_utils/SetString.h"
+#include "jetyak_uav_utils/SetWaypoints.h"
+
+// Lib includes
+#include "../lib/bsc_common/include/gorilla.h"
+#include "../lib/bsc_common/include/udp_link.h"
+
+class link_bridge
+{
+public:
+	/** link_bridge
+	 * Opens the link and sets up the side given by ~side
+	 */
+	link_bridge(ros::NodeHandle &nh);
+	~link_bridge();
+
+	/** poll
+	 * Runs the link, then sends the state batch and publishes the stats when due
+	 *
+	 * @param timeout seconds to wait for the link
+	 */
+	void poll(double timeout);
+
+	bool isOpen() const;
+
+private:
+	enum channel_t
+	{
+		STATE = 0,
+		MODE = 1,
+		REQUEST = 2, // [uint32 id][uint8 service][request]
+		RESPONSE = 3 // [uint32 id][uint8 success][response]
+	};
+
+	// drone_p, drone_pdot, drone_q, drone_qdot, boat_p, boat_pdot, heading, gps_offset, heading_offset, origin
+	static const int STATE_COLUMNS = 26;
+
+	bool isUav;
+	bsc_common::UdpLink link;
+
+	// Subscribers
+	ros::Subscriber stateSub, modeSub;
+
+	// Publishers
+	ros::Publisher statePub, modePub, statsPub;
+
+	// Services
+	std::vector<ros::ServiceServer> servers;
+
+	// UAV side service calls by index, from the serialized request to the serialized response
+	std::vector<std::function<bool(const uint8_t *, size_t, std::vector<uint8_t> &)>> callers;
+
+	// UAV side calls waiting to run, one at a time and in the order they arrived
+	ros::CallbackQueue callQueue;
+	ros::AsyncSpinner callSpinner;
+
+	// Functions
+	/** addService
+	 * Forwards /jetyak_uav_utils/<name> from the boat to the UAV. Services must be added in
+	 * the same order on both sides.
+	 */
+	template <class S>
+	void addService(ros::NodeHandle &nh, const std::string &name);
+
+	/** forwardCall
+	 * Sends a service request to the UAV and waits for the response
+	 *
+	 * @return false if the UAV service failed or did not answer within serviceTimeout
+	 */
+	template <class S>
+	bool forwardCall(uint8_t index, typename S::Request &req, typename S::Response &res);
+
+	/** received
+	 * Handles a message from the link. Requests are queued for callSpinner.
+	 */
+	void received(uint8_t channel, bsc_common::UdpLink::priority_t priority, const uint8_t *data, size_t size);
+
+	/** flushState
+	 * Sends the states since the last flush as one telemetry message
+	 */
+	void flushState();
+
+	/** call
+	 * Runs a forwarded request on the UAV and sends the response
+	 *
+	 * @param request [id][service][request]
+	 */
+	void call(const std::vector<uint8_t> &request);
+
+	void publishStats();
+
+	// Callbacks
+	void stateCallback(const jetyak_uav_utils::ObservedState::ConstPtr &msg);
+	void modeCallback(const std_msgs::UInt8::ConstPtr &msg);
+
+	// State batches, the encoder is shared with the state callback
+	std::mutex stateMutex;
+	bsc_common::GorillaEncoder stateEncoder;
+	bsc_common::GorillaDecoder stateDecoder;
+	double statePeriod;
+	int stateMaxRows;
+	ros::WallTime lastFlush;
+
+	// Mode, sent on change and every modePeriod
+	uint8_t mode;
+	bool modeSet, modeChanged;
+	double modePeriod;
+	ros::WallTime lastMode;
+
+	// Forwarded calls waiting for the UAV
+	std::mutex callMutex;
+	std::condition_variable callDone;
+	uint32_t nextCall;
+	std::map<uint32_t, std::pair<bool, std::vector<uint8_t>>> replies; // answered, response
+	double serviceTimeout;
+
+	double statsPeriod;
+	ros::WallTime lastStats;
+};
+
+#endif
@@ -0,0 +1,114 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This node runs the UAV and the boat in simulation so behaviors and dji_pilot can fly
+ * without the DJI SDK, the cameras or colocalization. It stands in for all of them:
+ *
+ * subscribes /dji_sdk/flight_control_setpoint_generic
+ * publishes  /jetyak_uav_vision/state, /jetyak_uav_vision/tag_pose, /dji_sdk/rc (autopilot
+ *            switch on, sticks centered) and /clock
+ * services   /dji_sdk/sdk_control_authority, /dji_sdk/drone_task_control, /dji_sdk/drone_arm_control,
+ *            the vision services behaviors calls, and ~reset
+ *
+ * Simulated time runs at real_time_factor times the wall clock, or as fast as it can at 0.
+ * The other nodes need use_sim_time so their clocks follow /clock.
+ */
+
+#ifndef SIL_SIM_H
+#define SIL_SIM_H
+
+// ROS includes
+#include <dji_sdk/DroneArmControl.h>
+#include <dji_sdk/DroneTaskControl.h>
+#include <dji_sdk/SDKControlAuthority.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <rosgraph_msgs/Clock.h>
+#include <sensor_msgs/Joy.h>
+#include <std_srvs/SetBool.h>
+#include <std_srvs/Trigger.h>
+#include "ros/ros.h"
+
+// Jetyak UAV Includes
+#include "jetyak_uav_utils/ObservedState.h"
+
+// Lib includes
+#include "../lib/bsc_common/include/uav_sim.h"
+
+class sil_sim
+{
+public:
+	/** sil_sim
+	 * Sets up the simulation from the node's parameters
+	 */
+	sil_sim(ros::NodeHandle &nh);
+
+	/** spin
+	 * Steps the simulation, handling callbacks between steps, until ROS shuts down
+	 */
+	void spin();
+
+private:
+	bsc_common::UavSim sim;
+	Eigen::Vector3d origin; // [lat, lon, alt] of the ENU origin
+	double clockOffset;			// simulated seconds before the last reset
+
+	// Subscribers
+	ros::Subscriber setpointSub;
+
+	// Publishers
+	ros::Publisher statePub, tagPub, rcPub, clockPub;
+
+	// Services
+	ros::ServiceServer authorityServ, taskServ, armServ, resetServ;
+	ros::ServiceServer gimbalServ, facedownServ, resetFilterServ;
+
+	// Periods in simulated seconds
+	double statePeriod, tagPeriod, rcPeriod;
+	double lastState, lastTag, lastRc;
+
+	double realTimeFactor;
+	double reportPeriod; // wall seconds between speed reports
+	bool authority, crashReported;
+
+	/** now
+	 * @return simulated seconds since the node started, published on /clock
+	 */
+	double now() const;
+
+	void publishState(const ros::Time &stamp);
+	void publishTag(const ros::Time &stamp);
+	void publishRc(const ros::Time &stamp);
+
+	// Callbacks
+	void setpointCallback(const sensor_msgs::Joy::ConstPtr &msg);
+	bool authorityCallback(dji_sdk::SDKControlAuthority::Request &req, dji_sdk::SDKControlAuthority::Response &res);
+	bool taskCallback(dji_sdk::DroneTaskControl::Request &req, dji_sdk::DroneTaskControl::Response &res);
+	bool armCallback(dji_sdk::DroneArmControl::Request &req, dji_sdk::DroneArmControl::Response &res);
+	bool resetCallback(std_srvs::Trigger::Request &req, std_srvs::Trigger::Response &res);
+	bool visionTriggerCallback(std_srvs::Trigger::Request &req, std_srvs::Trigger::Response &res);
+	bool visionBoolCallback(std_srvs::SetBool::Request &req, std_srvs::SetBool::Response &res);
+};
+
+#endif
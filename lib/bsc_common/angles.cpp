@@ -0,0 +1,98 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the batch angle kernels
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/angles.h"
+#include <algorithm>
+#include <eigen3/Eigen/Dense>
+
+namespace bsc_common
+{
+namespace angles
+{
+typedef Eigen::Map<const Eigen::ArrayXd> const_map_t;
+typedef Eigen::Map<Eigen::ArrayXd> map_t;
+
+// Vectorized counterpart of wrapPeriod, done in blocks that stay in L1
+template <typename Derived>
+static void wrapInto(const Eigen::ArrayBase<Derived> &x, double half, double inv, map_t out)
+{
+	const int block = 256;
+	Eigen::Array<double, block, 1> r;
+	for (int i = 0; i < out.size(); i += block)
+	{
+		int m = std::min<int>(block, out.size() - i);
+		auto ri = r.head(m);
+		ri = x.segment(i, m) - 2 * half * ((x.segment(i, m) + half) * inv).floor();
+		ri = (ri >= half).select(ri - 2 * half, ri);
+		out.segment(i, m) = (ri < -half).select(ri + 2 * half, ri);
+	}
+}
+
+void wrap(const double *in, double *out, int n)
+{
+	wrapInto(const_map_t(in, n), PI, 1 / TWO_PI, map_t(out, n));
+}
+
+void wrapDeg(const double *in, double *out, int n)
+{
+	wrapInto(const_map_t(in, n), 180.0, 1 / 360.0, map_t(out, n));
+}
+
+void diff(const double *start, const double *stop, double *out, int n)
+{
+	wrapInto(const_map_t(stop, n) - const_map_t(start, n), PI, 1 / TWO_PI, map_t(out, n));
+}
+
+void diffDeg(const double *start, const double *stop, double *out, int n)
+{
+	wrapInto(const_map_t(stop, n) - const_map_t(start, n), 180.0, 1 / 360.0, map_t(out, n));
+}
+
+double circularMean(const double *in, int n)
+{
+	const_map_t a(in, n);
+	double s = a.sin().sum();
+	double c = a.cos().sum();
+	if (s == 0 and c == 0)
+		return 0;
+	return wrap(std::atan2(s, c));
+}
+
+double circularMeanDeg(const double *in, int n)
+{
+	const_map_t a(in, n);
+	double s = (a * (PI / 180.0)).sin().sum();
+	double c = (a * (PI / 180.0)).cos().sum();
+	if (s == 0 and c == 0)
+		return 0;
+	return wrapDeg(std::atan2(s, c) * 180.0 / PI);
+}
+} // namespace angles
+} // namespace bsc_common
@@ -0,0 +1,109 @@
+#include "include/angles.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace bsc_common;
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, double in, double out)
+{
+	if (!ok)
+	{
+		++failures;
+		std::cout.precision(17);
+		std::cout << "FAIL " << what << ": " << in << " -> " << out << std::endl;
+	}
+}
+
+// Loop based wrap as it was done before the kernels
+static double loopWrap(double a)
+{
+	while (a < -M_PI)
+		a += 2 * M_PI;
+	while (a >= M_PI)
+		a -= 2 * M_PI;
+	return a;
+}
+
+int main()
+{
+	const double pi = angles::PI;
+
+	// Boundaries and multiples of the period
+	double edges[] = {0.0, -0.0, pi, -pi, 2 * pi, -2 * pi, 3 * pi, -3 * pi, pi - 1e-15, -pi + 1e-15, pi + 1e-15,
+										-pi - 1e-15, std::nextafter(pi, 0.0), std::nextafter(-pi, -4.0), 1e6 * pi, -1e6 * pi, 1e12, -1e12,
+										std::numeric_limits<double>::denorm_min(), -std::numeric_limits<double>::denorm_min()};
+	for (double a : edges)
+	{
+		double w = angles::wrap(a);
+		check(w >= -pi and w < pi, "wrap range", a, w);
+		check(std::fabs(std::remainder(w - a, 2 * pi)) <= 1e-15 * std::max(1.0, std::fabs(a)), "wrap congruent", a, w);
+	}
+	check(angles::wrap(pi) == -pi, "wrap(pi) == -pi", pi, angles::wrap(pi));
+	check(angles::wrap(-pi) == -pi, "wrap(-pi) == -pi", -pi, angles::wrap(-pi));
+	check(angles::wrapDeg(180) == -180, "wrapDeg(180) == -180", 180, angles::wrapDeg(180));
+	check(angles::wrapDeg(-180) == -180, "wrapDeg(-180) == -180", -180, angles::wrapDeg(-180));
+	check(angles::wrapDeg(540) == -180, "wrapDeg(540) == -180", 540, angles::wrapDeg(540));
+	check(angles::wrapDeg(359.5) == -0.5, "wrapDeg(359.5)", 359.5, angles::wrapDeg(359.5));
+	check(std::isnan(angles::wrap(std::nan(""))), "wrap(nan) is nan", 0, angles::wrap(std::nan("")));
+
+	// Differences, CCW positive, including the old truncation case of ang_dist
+	check(std::fabs(angles::diffDeg(170, -170) - 20) < 1e-12, "diffDeg(170,-170) == 20", 170, angles::diffDeg(170, -170));
+	check(std::fabs(angles::diffDeg(-170, 170) + 20) < 1e-12, "diffDeg(-170,170) == -20", -170, angles::diffDeg(-170, 170));
+	check(std::fabs(angles::diff(0.1, 0.6) - 0.5) < 1e-15, "diff(0.1,0.6) == 0.5", 0.1, angles::diff(0.1, 0.6));
+	check(std::fabs(angles::diff(3.0, -3.0) - (2 * pi - 6.0)) < 1e-15, "diff across pi", 3.0, angles::diff(3.0, -3.0));
+
+	// Means across the wrap point
+	check(std::fabs(angles::meanDeg(170, -170) + 180) < 1e-12, "meanDeg(170,-170) == -180", 170, angles::meanDeg(170, -170));
+	check(std::fabs(angles::mean(-0.1, 0.3) - 0.1) < 1e-15, "mean(-0.1,0.3)", -0.1, angles::mean(-0.1, 0.3));
+	double ring[] = {pi - .1, -pi + .1, pi - .05, -pi + .05};
+	double cm = angles::circularMean(ring, 4);
+	check(std::fabs(std::fabs(cm) - pi) < 1e-12, "circularMean across pi", 0, cm);
+	double degs[] = {350, 10, 20, 340};
+	double cmd = angles::circularMeanDeg(degs, 4);
+	check(std::fabs(cmd) < 1e-12, "circularMeanDeg(350,10,20,340) == 0", 0, cmd);
+
+	// Random sweep against the loop implementation, scalar against batch
+	const int n = 1 << 20;
+	std::vector<double> in(n), out(n), start(n), dout(n);
+	std::srand(1);
+	for (int i = 0; i < n; ++i)
+	{
+		in[i] = (std::rand() / (double)RAND_MAX - .5) * 200;
+		start[i] = (std::rand() / (double)RAND_MAX - .5) * 20;
+	}
+	angles::wrap(in.data(), out.data(), n);
+	angles::diff(start.data(), in.data(), dout.data(), n);
+	for (int i = 0; i < n; ++i)
+	{
+		double s = angles::wrap(in[i]);
+		check(s == out[i], "batch wrap == scalar wrap", in[i], out[i]);
+		check(std::fabs(s - loopWrap(in[i])) < 1e-12, "wrap == loop wrap", in[i], s);
+		check(angles::diff(start[i], in[i]) == dout[i], "batch diff == scalar diff", in[i], dout[i]);
+	}
+	std::cout << (failures == 0 ? "PASS" : "FAIL") << ": " << failures << " failures" << std::endl;
+
+	// Benchmark
+	double sink = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; ++i)
+		sink += loopWrap(in[i]);
+	auto t1 = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; ++i)
+		sink += angles::wrap(in[i]);
+	auto t2 = std::chrono::steady_clock::now();
+	angles::wrap(in.data(), out.data(), n);
+	auto t3 = std::chrono::steady_clock::now();
+	sink += out[n / 2];
+
+	std::cout << "loop wrap:   " << std::chrono::duration<double, std::nano>(t1 - t0).count() / n << " ns/angle\n";
+	std::cout << "scalar wrap: " << std::chrono::duration<double, std::nano>(t2 - t1).count() / n << " ns/angle\n";
+	std::cout << "batch wrap:  " << std::chrono::duration<double, std::nano>(t3 - t2).count() / n << " ns/angle\n";
+	std::cout << sink << std::endl;
+	return failures == 0 ? 0 : 1;
+}
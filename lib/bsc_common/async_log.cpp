@@ -0,0 +1,284 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements asynchronous logging for the control loops
+ * 
+ * Author: Brennan Cain
+ */
+#include "include/async_log.h"
+#include <algorithm>
+
+namespace bsc_common
+{
+namespace
+{
+std::atomic<uint64_t> nextId(1);
+
+// Ring the calling thread last used, tagged with the log it belongs to
+struct cache_t
+{
+	uint64_t id;
+	void *ring;
+};
+thread_local cache_t threadCache = {0, nullptr};
+} // namespace
+
+AsyncLog::AsyncLog(int ringSize) : id_(nextId++), running_(false), flushPeriod_(0.005)
+{
+	ringSize_ = 1;
+	while (ringSize_ < (uint64_t)std::max(ringSize, 2))
+		ringSize_ <<= 1;
+}
+
+AsyncLog::~AsyncLog()
+{
+	stop();
+}
+
+AsyncLog &AsyncLog::instance()
+{
+	static AsyncLog log;
+	return log;
+}
+
+void AsyncLog::start(sink_t sink, double flushPeriod)
+{
+	if (running_)
+		return;
+	sink_ = sink;
+	flushPeriod_ = flushPeriod;
+	running_ = true;
+	worker_ = std::thread(&AsyncLog::workerLoop, this);
+}
+
+void AsyncLog::stop()
+{
+	if (not running_)
+		return;
+	running_ = false;
+	worker_.join();
+	drain();
+}
+
+uint64_t AsyncLog::dropped() const
+{
+	uint64_t sum = 0;
+	std::lock_guard<std::mutex> lock(const_cast<std::mutex &>(ringsMutex_));
+	for (const std::unique_ptr<ring_t> &r : rings_)
+		sum += r->dropped.load(std::memory_order_relaxed);
+	return sum;
+}
+
+AsyncLog::ring_t *AsyncLog::threadRing()
+{
+	if (threadCache.id == id_)
+		return (ring_t *)threadCache.ring;
+	return registerThread();
+}
+
+AsyncLog::ring_t *AsyncLog::registerThread()
+{
+	std::lock_guard<std::mutex> lock(ringsMutex_);
+	std::thread::id self = std::this_thread::get_id();
+	ring_t *ring = nullptr;
+	for (const std::unique_ptr<ring_t> &r : rings_)
+		if (r->owner == self)
+			ring = r.get();
+
+	if (not ring)
+	{
+		rings_.emplace_back(new ring_t);
+		ring = rings_.back().get();
+		ring->owner = self;
+		ring->entries.resize(ringSize_);
+		ring->head = 0;
+		ring->tail = 0;
+		ring->dropped = 0;
+	}
+	threadCache.id = id_;
+	threadCache.ring = ring;
+	return ring;
+}
+
+void AsyncLog::set(entry_t &e, const char *s)
+{
+	e.kinds[e.count] = STRING;
+	e.values[e.count].u = e.textUsed;
+	if (not s)
+		s = "(null)";
+	size_t room = TEXT_SIZE - e.textUsed;
+	size_t n = std::min(strlen(s), room ? room - 1 : 0);
+	if (room)
+	{
+		memcpy(e.text + e.textUsed, s, n);
+		e.text[e.textUsed + n] = 0;
+		e.textUsed += n + 1;
+	}
+	else
+		e.values[e.count].u = TEXT_SIZE - 1; // the last byte is always a terminator once full
+}
+
+void AsyncLog::workerLoop()
+{
+	while (running_)
+	{
+		drain();
+		std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(flushPeriod_ * 1e6)));
+	}
+}
+
+void AsyncLog::drain()
+{
+	std::vector<ring_t *> rings;
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex_);
+		for (const std::unique_ptr<ring_t> &r : rings_)
+			rings.push_back(r.get());
+	}
+
+	char text[1024];
+	uint64_t drops = 0;
+	for (ring_t *ring : rings)
+	{
+		uint64_t t = ring->tail.load(std::memory_order_relaxed);
+		uint64_t h = ring->head.load(std::memory_order_acquire);
+		for (; t < h; ++t)
+		{
+			const entry_t &e = ring->entries[t & (ringSize_ - 1)];
+			if (not throttled(e))
+			{
+				format(e, text, sizeof(text));
+				if (sink_)
+					sink_((level_t)e.level, text);
+			}
+		}
+		ring->tail.store(t, std::memory_order_release);
+		drops += ring->dropped.load(std::memory_order_relaxed);
+	}
+
+	if (drops != reportedDrops_ and sink_)
+	{
+		snprintf(text, sizeof(text), "Async log dropped %lu messages", (unsigned long)(drops - reportedDrops_));
+		sink_(LEVEL_WARN, text);
+		reportedDrops_ = drops;
+	}
+}
+
+bool AsyncLog::throttled(const entry_t &e)
+{
+	if (e.throttle <= 0)
+		return false;
+	for (std::pair<const char *, int64_t> &seen : lastSeen_)
+	{
+		if (seen.first == e.format)
+		{
+			if (e.stamp - seen.second < (int64_t)(e.throttle * 1e9))
+				return true;
+			seen.second = e.stamp;
+			return false;
+		}
+	}
+	lastSeen_.push_back(std::make_pair(e.format, e.stamp));
+	return false;
+}
+
+void AsyncLog::format(const entry_t &e, char *out, size_t size) const
+{
+	size_t used = 0;
+	int arg = 0;
+	auto append = [&](int n) { used = std::min(used + std::max(n, 0), size - 1); };
+
+	for (const char *c = e.format; *c and used < size - 1; ++c)
+	{
+		if (*c != '%')
+		{
+			out[used++] = *c;
+			continue;
+		}
+		if (c[1] == '%')
+		{
+			out[used++] = '%';
+			++c;
+			continue;
+		}
+
+		// Rebuild the conversion with the length the stored value needs
+		char spec[32] = "%";
+		size_t s = 1;
+		const char *p = c + 1;
+		while (*p and strchr("-+ #0123456789.", *p) and s < sizeof(spec) - 4)
+			spec[s++] = *p++;
+		while (*p and strchr("hlLqjzt", *p))
+			++p;
+		char conv = *p;
+		if (not conv)
+			break;
+		c = p;
+
+		if (arg >= e.count)
+		{
+			append(snprintf(out + used, size - used, "%%%c", conv));
+			continue;
+		}
+		uint8_t kind = e.kinds[arg];
+		const auto &v = e.values[arg++];
+
+		if (strchr("di", conv))
+		{
+			spec[s++] = 'l', spec[s++] = 'l', spec[s++] = conv, spec[s] = 0;
+			long long x = kind == DOUBLE ? (long long)v.d : kind == UINT ? (long long)v.u : (long long)v.i;
+			append(snprintf(out + used, size - used, spec, x));
+		}
+		else if (strchr("ouxX", conv))
+		{
+			spec[s++] = 'l', spec[s++] = 'l', spec[s++] = conv, spec[s] = 0;
+			unsigned long long x = kind == DOUBLE ? (unsigned long long)v.d : (unsigned long long)v.u;
+			append(snprintf(out + used, size - used, spec, x));
+		}
+		else if (strchr("eEfFgGaA", conv))
+		{
+			spec[s++] = conv, spec[s] = 0;
+			double x = kind == DOUBLE ? v.d : kind == UINT ? (double)v.u : (double)v.i;
+			append(snprintf(out + used, size - used, spec, x));
+		}
+		else if (conv == 'c')
+		{
+			spec[s++] = conv, spec[s] = 0;
+			append(snprintf(out + used, size - used, spec, (int)v.i));
+		}
+		else if (conv == 's')
+		{
+			spec[s++] = conv, spec[s] = 0;
+			append(snprintf(out + used, size - used, spec, kind == STRING ? e.text + v.u : "(?)"));
+		}
+		else if (conv == 'p')
+		{
+			spec[s++] = conv, spec[s] = 0;
+			append(snprintf(out + used, size - used, spec, v.p));
+		}
+	}
+	out[used] = 0;
+}
+} // namespace bsc_common
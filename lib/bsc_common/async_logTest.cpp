@@ -0,0 +1,210 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/async_log.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace bsc_common;
+
+struct Collected
+{
+	std::mutex mutex;
+	std::vector<std::string> lines;
+	void add(AsyncLog::level_t, const char *text)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		lines.push_back(text);
+	}
+};
+
+int main()
+{
+	int failures = 0;
+
+	// Formatting matches printf
+	{
+		Collected c;
+		AsyncLog log(64);
+		log.start([&](AsyncLog::level_t l, const char *t) { c.add(l, t); });
+		std::vector<std::string> expected;
+		char buf[256];
+		const char *name = "return";
+		std::string mode = "LAND";
+		unsigned long big = 4000000000ul;
+		int neg = -42;
+		char letter = 'x';
+
+#define CHECK(...)                          \
+	snprintf(buf, sizeof(buf), __VA_ARGS__); \
+	expected.push_back(buf);                 \
+	log.log(AsyncLog::LEVEL_INFO, 0, __VA_ARGS__);
+
+		CHECK("Settling: %1.2fm over", 0.4567);
+		CHECK("Goal: %1.2f, Current %1.2f", 3.0, -1.25);
+		CHECK("Mode out of bounds: %i. Now hovering.", (char)7);
+		CHECK("Behavior is now %s, mode %s", name, mode.c_str());
+		CHECK("%5d|%-5d|%+d|%05d|%x|%X|%o|%lu", neg, 3, 3, 17, 255, 255u, 8, big);
+		CHECK("%e %g %10.3f %-8.1f| 100%%", 12345.678, 0.0001, 3.14159, 2.5f);
+		CHECK("%c%c %s", letter, 'y', "literal");
+		CHECK("Received %i waypoints, %1.1fm path, %1.1fs trajectory", (int)5, 123.45, 67.8);
+		CHECK("no arguments");
+#undef CHECK
+		log.stop();
+		if (c.lines != expected)
+		{
+			printf("  FAIL: formatting\n");
+			for (size_t i = 0; i < expected.size(); ++i)
+				printf("    \"%s\" vs \"%s\"\n", i < c.lines.size() ? c.lines[i].c_str() : "", expected[i].c_str());
+			++failures;
+		}
+	}
+
+	// Long string arguments are cut, not overrun
+	{
+		Collected c;
+		AsyncLog log(8);
+		std::string longName(300, 'a');
+		log.log(AsyncLog::LEVEL_WARN, 0, "%s|%s|%d", longName.c_str(), "b", 1);
+		log.start([&](AsyncLog::level_t l, const char *t) { c.add(l, t); });
+		log.stop();
+		std::string want = std::string(AsyncLog::TEXT_SIZE - 1, 'a') + "||1";
+		if (c.lines.size() != 1 or c.lines[0] != want)
+		{
+			printf("  FAIL: long string \"%s\"\n", c.lines.empty() ? "" : c.lines[0].c_str());
+			++failures;
+		}
+	}
+
+	// Throttling by call site
+	{
+		Collected c;
+		AsyncLog log(4096);
+		log.start([&](AsyncLog::level_t l, const char *t) { c.add(l, t); });
+		const char *format = "Throttled %d";
+		for (int k = 0; k < 1000; ++k)
+		{
+			log.log(AsyncLog::LEVEL_WARN, 0.05, format, k);
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+		log.stop();
+		// about 0.25s of logging at one message per 0.05s
+		if (c.lines.size() < 3 or c.lines.size() > 8 or c.lines[0] != "Throttled 0")
+		{
+			printf("  FAIL: throttle let %i through\n", (int)c.lines.size());
+			++failures;
+		}
+	}
+
+	// Several threads, each thread's messages arrive in order and a full ring drops instead of blocking
+	{
+		Collected c;
+		AsyncLog log(256);
+		log.start([&](AsyncLog::level_t l, const char *t) { c.add(l, t); }, 0.001);
+		const int threads = 4, n = 20000;
+		std::vector<int> refused(threads, 0);
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threads; ++i)
+			workers.push_back(std::thread([&, i]() {
+				for (int k = 0; k < n; ++k)
+				{
+					refused[i] += not log.log(AsyncLog::LEVEL_INFO, 0, "thread %d message %d", i, k);
+					if (k % 100 == 99)
+						std::this_thread::sleep_for(std::chrono::microseconds(500));
+				}
+			}));
+		for (std::thread &w : workers)
+			w.join();
+		log.stop();
+
+		int total = 0;
+		std::vector<int> last(threads, -1);
+		bool ordered = true;
+		for (const std::string &line : c.lines)
+		{
+			int i, k;
+			if (sscanf(line.c_str(), "thread %d message %d", &i, &k) == 2)
+			{
+				ordered &= k > last[i];
+				last[i] = k;
+				++total;
+			}
+		}
+		int dropped = 0;
+		for (int r : refused)
+			dropped += r;
+		printf("%i threads x %i: %i delivered, %i dropped\n", threads, n, total, dropped);
+		if (not ordered or total + dropped != threads * n or (uint64_t)dropped != log.dropped())
+		{
+			printf("  FAIL: thread messages lost or out of order\n");
+			++failures;
+		}
+	}
+
+	// Cost on the calling thread, in bursts the size of a few control ticks so the ring keeps up
+	{
+		const int bursts = 200, burst = 1000, n = bursts * burst;
+		AsyncLog log(4096);
+		log.start([](AsyncLog::level_t, const char *) {}, 0.001);
+		std::chrono::duration<double, std::nano> doubles(0), strings(0);
+		for (int b = 0; b < bursts; ++b)
+		{
+			auto t0 = std::chrono::steady_clock::now();
+			for (int k = 0; k < burst / 2; ++k)
+				log.log(AsyncLog::LEVEL_WARN, 0, "X %1.2f<%1.2f<%1.2f", -.1, k * 1e-3, .1);
+			auto t1 = std::chrono::steady_clock::now();
+			for (int k = 0; k < burst / 2; ++k)
+				log.log(AsyncLog::LEVEL_WARN, 0, "Mode changed to %s", "FOLLOW");
+			auto t2 = std::chrono::steady_clock::now();
+			doubles += t1 - t0;
+			strings += t2 - t1;
+			std::this_thread::sleep_for(std::chrono::milliseconds(3));
+		}
+		log.stop();
+
+		FILE *null = fopen("/dev/null", "w");
+		char buf[512];
+		auto t3 = std::chrono::steady_clock::now();
+		for (int k = 0; k < n / 2; ++k)
+		{
+			snprintf(buf, sizeof(buf), "X %1.2f<%1.2f<%1.2f", -.1, k * 1e-3, .1);
+			fprintf(null, "[ WARN] %s\n", buf);
+			fflush(null);
+		}
+		auto t4 = std::chrono::steady_clock::now();
+		fclose(null);
+		printf("async 3 doubles %1.0fns, async string %1.0fns, format and write %1.0fns\n", doubles.count() / (n / 2),
+					 strings.count() / (n / 2), std::chrono::duration<double, std::nano>(t4 - t3).count() / (n / 2));
+		if (log.dropped())
+		{
+			printf("  FAIL: dropped %lu in timing\n", (unsigned long)log.dropped());
+			++failures;
+		}
+	}
+
+	printf(failures ? "%i FAILURES\n" : "PASSED\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the batch attitude conversions
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/attitude.h"
+
+namespace bsc_common
+{
+namespace attitude
+{
+void rpyFromQuat(const double *xyzw, double *rpy, int n)
+{
+	for (int i = 0; i < n; ++i, xyzw += 4, rpy += 3)
+	{
+		Eigen::Map<Eigen::Vector3d> out(rpy);
+		out = rpyFromQuat(xyzw[0], xyzw[1], xyzw[2], xyzw[3]);
+	}
+}
+
+void yawFromQuat(const double *xyzw, double *yaw, int n)
+{
+	for (int i = 0; i < n; ++i, xyzw += 4)
+	{
+		yaw[i] = yawFromQuat(xyzw[0], xyzw[1], xyzw[2], xyzw[3]);
+	}
+}
+
+void quatFromRPY(const double *rpy, double *xyzw, int n)
+{
+	for (int i = 0; i < n; ++i, rpy += 3, xyzw += 4)
+	{
+		// coeffs() is stored as x,y,z,w
+		Eigen::Map<Eigen::Vector4d> out(xyzw);
+		out = quatFromRPY(rpy[0], rpy[1], rpy[2]).coeffs();
+	}
+}
+} // namespace attitude
+} // namespace bsc_common
@@ -0,0 +1,105 @@
+#include "include/attitude.h"
+#include <tf/LinearMath/Matrix3x3.h>
+#include <tf/LinearMath/Quaternion.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static double urand(double low, double high)
+{
+	return low + (high - low) * std::rand() / (double)RAND_MAX;
+}
+
+int main()
+{
+	const int n = 200000;
+	std::srand(2);
+	std::vector<double> xyzw(4 * n), rpy(3 * n), back(4 * n);
+	for (int i = 0; i < n; ++i)
+	{
+		Eigen::Vector4d q(urand(-1, 1), urand(-1, 1), urand(-1, 1), urand(-1, 1));
+		q *= urand(.5, 2) / q.norm(); // not normalized on purpose
+		Eigen::Map<Eigen::Vector4d> out(&xyzw[4 * i]);
+		out = q;
+	}
+
+	// Equivalence with tf
+	double worstRPY = 0, worstQuat = 0, worstYaw = 0;
+	for (int i = 0; i < n; ++i)
+	{
+		const double *q = &xyzw[4 * i];
+		double r, p, y;
+		tf::Matrix3x3(tf::Quaternion(q[0], q[1], q[2], q[3])).getRPY(r, p, y);
+		Eigen::Vector3d k = bsc_common::attitude::rpyFromQuat(q[0], q[1], q[2], q[3]);
+		worstRPY = std::max(worstRPY, (k - Eigen::Vector3d(r, p, y)).cwiseAbs().maxCoeff());
+		worstYaw = std::max(worstYaw, std::fabs(bsc_common::attitude::yawFromQuat(q[0], q[1], q[2], q[3]) - y));
+
+		tf::Quaternion tq;
+		tq.setRPY(r, p, y);
+		Eigen::Quaterniond kq = bsc_common::attitude::quatFromRPY(r, p, y);
+		worstQuat = std::max(worstQuat, (kq.coeffs() - Eigen::Vector4d(tq.x(), tq.y(), tq.z(), tq.w())).cwiseAbs().maxCoeff());
+	}
+
+	// Gimbal lock round trips to the same rotation. (a,b,a,-b) and (a,b,-a,b) put m20 at +1 and -1
+	double worstLock = 0;
+	for (int i = 0; i < 1000; ++i)
+	{
+		double a = urand(.1, 1), b = urand(-1, 1);
+		Eigen::Quaterniond q = i % 2 ? Eigen::Quaterniond(-b, a, b, a) : Eigen::Quaterniond(b, a, b, -a);
+		Eigen::Vector3d k = bsc_common::attitude::rpyFromQuat(q);
+		Eigen::Quaterniond qb = bsc_common::attitude::quatFromRPY(k(0), k(1), k(2));
+		worstLock = std::max(worstLock, 1 - std::fabs(q.normalized().dot(qb)));
+	}
+
+	// Batch matches scalar
+	bsc_common::attitude::rpyFromQuat(xyzw.data(), rpy.data(), n);
+	bsc_common::attitude::quatFromRPY(rpy.data(), back.data(), n);
+	bool batchOk = true;
+	for (int i = 0; i < n; ++i)
+	{
+		const double *q = &xyzw[4 * i];
+		batchOk = batchOk and bsc_common::attitude::rpyFromQuat(q[0], q[1], q[2], q[3]) == Eigen::Map<Eigen::Vector3d>(&rpy[3 * i]);
+		Eigen::Quaterniond qs(q[3], q[0], q[1], q[2]);
+		Eigen::Quaterniond qb(back[4 * i + 3], back[4 * i], back[4 * i + 1], back[4 * i + 2]);
+		batchOk = batchOk and 1 - std::fabs(qs.normalized().dot(qb)) < 1e-12;
+	}
+
+	bool ok = worstRPY < 1e-12 and worstYaw < 1e-12 and worstQuat < 1e-15 and worstLock < 1e-12 and batchOk;
+	std::cout << (ok ? "PASS" : "FAIL") << ": rpy " << worstRPY << " yaw " << worstYaw << " quat " << worstQuat
+						<< " lock " << worstLock << " batch " << (batchOk ? "ok" : "mismatch") << std::endl;
+
+	// Benchmark
+	double sink = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; ++i)
+	{
+		const double *q = &xyzw[4 * i];
+		double r, p, y;
+		tf::Matrix3x3(tf::Quaternion(q[0], q[1], q[2], q[3])).getRPY(r, p, y);
+		sink += r + p + y;
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; ++i)
+	{
+		const double *q = &xyzw[4 * i];
+		sink += bsc_common::attitude::rpyFromQuat(q[0], q[1], q[2], q[3]).sum();
+	}
+	auto t2 = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; ++i)
+	{
+		const double *q = &xyzw[4 * i];
+		sink += bsc_common::attitude::yawFromQuat(q[0], q[1], q[2], q[3]);
+	}
+	auto t3 = std::chrono::steady_clock::now();
+	bsc_common::attitude::rpyFromQuat(xyzw.data(), rpy.data(), n);
+	auto t4 = std::chrono::steady_clock::now();
+	sink += rpy[n];
+
+	std::cout << "tf getRPY:     " << std::chrono::duration<double, std::nano>(t1 - t0).count() / n << " ns\n";
+	std::cout << "rpyFromQuat:   " << std::chrono::duration<double, std::nano>(t2 - t1).count() / n << " ns\n";
+	std::cout << "yawFromQuat:   " << std::chrono::duration<double, std::nano>(t3 - t2).count() / n << " ns\n";
+	std::cout << "batch rpy:     " << std::chrono::duration<double, std::nano>(t4 - t3).count() / n << " ns\n";
+	std::cout << sink << std::endl;
+	return ok ? 0 : 1;
+}
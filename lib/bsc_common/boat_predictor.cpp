@@ -0,0 +1,231 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the boat motion predictor
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/boat_predictor.h"
+#include "include/angles.h"
+#include <cmath>
+#include <complex>
+
+namespace bsc_common
+{
+BoatPredictor::BoatPredictor(int window, double maxGap)
+{
+	maxGap_ = maxGap;
+	p_.setZero();
+	v_.setZero();
+	setWindow(window);
+}
+
+void BoatPredictor::setWindow(int window)
+{
+	window_ = window < 3 ? 3 : window;
+	samples_.resize(window_);
+	reset();
+}
+
+void BoatPredictor::reset()
+{
+	head_ = count_ = sinceRebuild_ = 0;
+	St_ = Stt_ = Sh_ = Sth_ = Ss_ = Sts_ = 0;
+	turnRate_ = acceleration_ = 0;
+}
+
+bool BoatPredictor::ready() const
+{
+	return count_ >= 3;
+}
+
+double BoatPredictor::turnRate() const
+{
+	return turnRate_;
+}
+
+double BoatPredictor::acceleration() const
+{
+	return acceleration_;
+}
+
+void BoatPredictor::add(const sample_t &s, double sign)
+{
+	St_ += sign * s.t;
+	Stt_ += sign * s.t * s.t;
+	Sh_ += sign * s.heading;
+	Sth_ += sign * s.t * s.heading;
+	Ss_ += sign * s.speed;
+	Sts_ += sign * s.t * s.speed;
+}
+
+void BoatPredictor::rebuild()
+{
+	// Move the base to the oldest update so the sums stay small
+	int oldest = (head_ - count_ + window_) % window_;
+	double dt = samples_[oldest].t, dh = samples_[oldest].heading;
+	tBase_ += dt;
+	hBase_ += dh;
+
+	St_ = Stt_ = Sh_ = Sth_ = Ss_ = Sts_ = 0;
+	for (int i = 0; i < count_; ++i)
+	{
+		sample_t &s = samples_[(oldest + i) % window_];
+		s.t -= dt;
+		s.heading -= dh;
+		add(s, 1);
+	}
+	sinceRebuild_ = 0;
+}
+
+void BoatPredictor::fit()
+{
+	double det = count_ * Stt_ - St_ * St_;
+	if (count_ < 3 or det <= 1e-12 * count_ * Stt_)
+		return;
+	turnRate_ = (count_ * Sth_ - St_ * Sh_) / det;
+	acceleration_ = (count_ * Sts_ - St_ * Ss_) / det;
+}
+
+void BoatPredictor::update(double t, const Eigen::Vector2d &p, const Eigen::Vector2d &v, double heading)
+{
+	if (count_ > 0 and t <= lastT_)
+		return;
+	if (count_ > 0 and t - lastT_ > maxGap_)
+		reset();
+
+	sample_t s;
+	if (count_ == 0)
+	{
+		tBase_ = t;
+		hBase_ = heading;
+		s.t = s.heading = 0;
+	}
+	else
+	{
+		// Unwrap the heading against the last update
+		const sample_t &last = samples_[(head_ - 1 + window_) % window_];
+		s.t = t - tBase_;
+		s.heading = last.heading + angles::wrap(heading - lastRawHeading_);
+	}
+	s.speed = v.norm();
+
+	if (count_ == window_)
+		add(samples_[head_], -1);
+	else
+		++count_;
+	samples_[head_] = s;
+	head_ = (head_ + 1) % window_;
+	add(s, 1);
+
+	lastT_ = t;
+	lastRawHeading_ = heading;
+	p_ = p;
+	v_ = v;
+
+	if (++sinceRebuild_ >= window_)
+		rebuild();
+	fit();
+}
+
+double BoatPredictor::heading(double dt) const
+{
+	return lastRawHeading_ + turnRate_ * dt;
+}
+
+void BoatPredictor::predict(double dt, Eigen::Vector2d &p, Eigen::Vector2d &v) const
+{
+	typedef std::complex<double> c_t;
+
+	double v0 = v_.norm();
+	c_t dir = v0 > 1e-3 ? c_t(v_(0), v_(1)) / v0 : std::polar(1.0, lastRawHeading_);
+
+	// Slowing down stops the boat instead of reversing it
+	double a = acceleration_;
+	double moving = dt;
+	if (a < 0 and v0 + a * dt < 0)
+		moving = -v0 / a;
+
+	// Integral of (v0 + a s) e^(i w s) over [0, moving]
+	double w = turnRate_;
+	double wt = w * moving;
+	c_t travel;
+	if (std::abs(wt) < 1e-3)
+	{
+		double t2 = moving * moving;
+		travel = c_t(v0 * moving + a * t2 / 2, w * (v0 * t2 / 2 + a * t2 * moving / 3));
+	}
+	else
+	{
+		c_t e = std::polar(1.0, wt), iw(0, w);
+		travel = v0 * (e - 1.0) / iw + a * (moving * e / iw + (e - 1.0) / (w * w));
+	}
+	travel *= dir;
+	p << p_(0) + travel.real(), p_(1) + travel.imag();
+
+	c_t vel = dir * std::polar(v0 + a * moving, w * moving);
+	v << vel.real(), vel.imag();
+}
+
+Eigen::Vector2d BoatPredictor::target(double dt, const Eigen::Vector2d &offset) const
+{
+	Eigen::Vector2d p, v;
+	predict(dt, p, v);
+	double h = heading(dt), c = cos(h), s = sin(h);
+	return p + Eigen::Vector2d(c * offset(0) - s * offset(1), s * offset(0) + c * offset(1));
+}
+
+bool BoatPredictor::intercept(const Eigen::Vector2d &from, const Eigen::Vector2d &offset, double speed,
+															double horizon, Eigen::Vector2d &point, double &dt) const
+{
+	// Remaining distance once the vehicle has flown for t, reachable where it is <= 0
+	auto gap = [&](double t, Eigen::Vector2d &p) {
+		p = target(t, offset);
+		return (p - from).norm() - speed * t;
+	};
+
+	dt = 0;
+	if (gap(0, point) <= 0)
+		return true;
+	if (speed <= 0 or gap(horizon, point) > 0)
+		return false;
+
+	// Bisect to 1e-4 of the horizon, at most 30 predictions
+	double lo = 0, hi = horizon;
+	for (int i = 0; i < 30 and hi - lo > 1e-4 * horizon; ++i)
+	{
+		double mid = (lo + hi) / 2;
+		Eigen::Vector2d p;
+		if (gap(mid, p) > 0)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	dt = hi;
+	point = target(hi, offset);
+	return true;
+}
+} // namespace bsc_common
@@ -0,0 +1,193 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/boat_predictor.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace bsc_common;
+
+static double noise(double sigma)
+{
+	// Sum of uniforms, close enough to gaussian for a test
+	double s = 0;
+	for (int i = 0; i < 12; ++i)
+		s += (double)rand() / RAND_MAX;
+	return sigma * (s - 6);
+}
+
+// Boat turning at w and accelerating at a, integrated finely
+struct Boat
+{
+	double x = 0, y = 0, h = 0, s = 2, w, a;
+	void step(double dt)
+	{
+		int n = (int)ceil(dt / 0.005);
+		for (int i = 0; i < n; ++i)
+		{
+			x += s * cos(h) * dt / n;
+			y += s * sin(h) * dt / n;
+			h += w * dt / n;
+			s = std::max(0.0, s + a * dt / n);
+		}
+	}
+};
+
+int main()
+{
+	srand(3);
+	int failures = 0;
+	const double rate = 20, horizon = 5;
+
+	double w[] = {0, 0.05, -0.1, 0.2};
+	double a[] = {0, 0.05, -0.05, 0.1};
+	for (int c = 0; c < 4; ++c)
+	{
+		Boat boat;
+		boat.w = w[c];
+		boat.a = a[c];
+		BoatPredictor predictor(50);
+
+		double errPred = 0, errConst = 0;
+		int n = 0;
+		for (int k = 0; k < 600; ++k)
+		{
+			double t = k / rate;
+			Eigen::Vector2d p(boat.x + noise(0.05), boat.y + noise(0.05));
+			Eigen::Vector2d v(boat.s * cos(boat.h) + noise(0.05), boat.s * sin(boat.h) + noise(0.05));
+			predictor.update(t, p, v, boat.h + noise(0.02));
+
+			if (k >= 100 and k % 20 == 0 and predictor.ready())
+			{
+				Eigen::Vector2d pp, vp;
+				predictor.predict(horizon, pp, vp);
+				Boat future = boat;
+				future.step(horizon);
+				Eigen::Vector2d truth(future.x, future.y);
+				errPred += (pp - truth).norm();
+				errConst += (p + horizon * v - truth).norm();
+				++n;
+			}
+			boat.step(1 / rate);
+		}
+		errPred /= n;
+		errConst /= n;
+		printf("w %5.2f a %5.2f: fit w %6.3f a %6.3f, %1.0fs error %5.2fm (constant velocity %5.2fm)\n", w[c], a[c],
+					 predictor.turnRate(), predictor.acceleration(), horizon, errPred, errConst);
+		if (std::abs(predictor.turnRate() - w[c]) > 0.02 or std::abs(predictor.acceleration() - a[c]) > 0.05)
+		{
+			printf("  FAIL: fit\n");
+			++failures;
+		}
+		if (errPred > std::max(0.5, 0.25 * errConst))
+		{
+			printf("  FAIL: prediction\n");
+			++failures;
+		}
+	}
+
+	// Heading wrapping through +-pi must not look like a turn
+	{
+		BoatPredictor predictor(20);
+		for (int k = 0; k < 40; ++k)
+		{
+			double h = M_PI - 0.5 + 0.02 * k;
+			predictor.update(k * 0.1, Eigen::Vector2d::Zero(), Eigen::Vector2d(cos(h), sin(h)), h > M_PI ? h - 2 * M_PI : h);
+		}
+		printf("wrap: fit w %6.3f\n", predictor.turnRate());
+		if (std::abs(predictor.turnRate() - 0.2) > 1e-6)
+		{
+			printf("  FAIL: wrap\n");
+			++failures;
+		}
+	}
+
+	// Intercept of a point behind a turning boat
+	{
+		Boat boat;
+		boat.w = 0.05;
+		boat.a = 0;
+		BoatPredictor predictor(50);
+		for (int k = 0; k < 100; ++k)
+		{
+			predictor.update(k / rate, Eigen::Vector2d(boat.x, boat.y),
+											 Eigen::Vector2d(boat.s * cos(boat.h), boat.s * sin(boat.h)), boat.h);
+			if (k < 99)
+				boat.step(1 / rate);
+		}
+		Eigen::Vector2d from(-40, 60), offset(-2, 0), point;
+		double dt;
+		bool ok = predictor.intercept(from, offset, 3, 60, point, dt);
+		Boat future = boat;
+		future.step(dt);
+		Eigen::Vector2d truth(future.x + cos(future.h) * offset(0), future.y + sin(future.h) * offset(0));
+		printf("intercept: %1.2fs, flown %1.2fm, reached %1.2fm, point error %1.3fm\n", dt, 3 * dt,
+					 (point - from).norm(), (point - truth).norm());
+		if (not ok or std::abs((point - from).norm() - 3 * dt) > 0.05 or (point - truth).norm() > 0.1)
+		{
+			printf("  FAIL: intercept\n");
+			++failures;
+		}
+		if (predictor.intercept(from, offset, 1, 10, point, dt))
+		{
+			printf("  FAIL: intercept by a slower vehicle\n");
+			++failures;
+		}
+
+		const int n = 100000;
+		auto t0 = std::chrono::steady_clock::now();
+		double sum = 0;
+		for (int k = 0; k < n; ++k)
+		{
+			predictor.intercept(from + Eigen::Vector2d(k % 100, 0), offset, 3, 60, point, dt);
+			sum += dt;
+		}
+		auto t1 = std::chrono::steady_clock::now();
+		printf("intercept %1.3fus (%g)\n", std::chrono::duration<double, std::micro>(t1 - t0).count() / n, sum);
+	}
+
+	// Timing
+	{
+		BoatPredictor predictor(50);
+		const int n = 1000000;
+		auto t0 = std::chrono::steady_clock::now();
+		for (int k = 0; k < n; ++k)
+			predictor.update(k * 0.05, Eigen::Vector2d(k * 0.1, 0), Eigen::Vector2d(2, 0.01 * (k % 7)), 0.001 * (k % 13));
+		auto t1 = std::chrono::steady_clock::now();
+		Eigen::Vector2d p, v, sum(0, 0);
+		for (int k = 0; k < n; ++k)
+		{
+			predictor.predict(0.01 * (k % 1000), p, v);
+			sum += p;
+		}
+		auto t2 = std::chrono::steady_clock::now();
+		printf("update %1.3fus, predict %1.3fus (%g)\n", std::chrono::duration<double, std::micro>(t1 - t0).count() / n,
+					 std::chrono::duration<double, std::micro>(t2 - t1).count() / n, sum(0));
+	}
+
+	printf(failures ? "%i FAILURES\n" : "PASSED\n", failures);
+	return failures ? 1 : 0;
+}
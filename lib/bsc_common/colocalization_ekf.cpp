@@ -0,0 +1,439 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/colocalization_ekf.h"
+#include <chrono>
+
+namespace bsc_common
+{
+ColocalizationEKF::ColocalizationEKF(double P0, double noise)
+{
+	this->P0 = P0;
+	this->noise = noise;
+
+	this->Cf = continuousNoise().asDiagonal();
+	setupSensors(this->tag, this->dvel, this->dgps, this->jgps);
+
+	this->setHistorySize(128);
+	this->reset();
+}
+
+ColocalizationEKF::state_t ColocalizationEKF::continuousNoise()
+{
+	// Same as kalman_filter.py
+	state_t diagCf;
+	diagCf << 1e-1, 1e-1, 1e-1,
+		1e0, 1e0, 1e0,
+		1e-1, 1e-1, 1e-3,
+		1e0, 1e0,
+		1e0, 1e0, 1e0,
+		1e-1;
+	return diagCf;
+}
+
+void ColocalizationEKF::setupSensors(Sensor<4> &tag, Sensor<3> &dvel, Sensor<3> &dgps, Sensor<3> &jgps)
+{
+	// Critical chi-squared values for P = 0.001 and different degrees of freedom
+	const double chiSquared_1 = 10.828;
+	const double chiSquared_3 = 16.266;
+
+	// Tag measures pJ - pD - GPSoffsetJ and the compass offset
+	setupSensor(tag, 1.0e-3, chiSquared_3, 39);
+	setupSensor(dvel, 1.0e-3, chiSquared_1, 150);
+	setupSensor(dgps, 1.0e-1, chiSquared_1, 150);
+	setupSensor(jgps, 5.0e0, chiSquared_1, 10);
+	for (int i = 0; i < 3; ++i)
+	{
+		addH(tag, i, DRONE_P + i, -1);
+		addH(tag, i, BOAT_P + i, 1);
+		addH(tag, i, GPS_OFFSET + i, -1);
+		addH(dvel, i, DRONE_V + i, 1);
+		addH(dgps, i, DRONE_P + i, 1);
+		addH(jgps, i, BOAT_P + i, 1);
+	}
+	addH(tag, 3, HEADING_OFFSET, 1);
+}
+
+template <int M>
+void ColocalizationEKF::setupSensor(Sensor<M> &s, double rNom, double chi, int N)
+{
+	s.H.setZero();
+	for (int i = 0; i < M; ++i)
+		s.hCount[i] = 0;
+	s.Rnom = rNom * Eigen::Matrix<double, M, M>::Identity();
+	s.R = s.Rnom;
+	s.chiCritical = chi;
+	s.setWindow(N);
+}
+
+template <int M>
+void ColocalizationEKF::addH(Sensor<M> &s, int row, int col, double sign)
+{
+	s.H(row, col) = sign;
+	s.hIndex[row][s.hCount[row]] = col;
+	s.hSign[row][s.hCount[row]] = sign;
+	++s.hCount[row];
+}
+
+void ColocalizationEKF::reset()
+{
+	this->X.setZero();
+	this->P = this->P0 * cov_t::Identity();
+	this->F.setIdentity();
+	this->lastDt = -1;
+	this->isInit = false;
+	this->dronePosSet = false;
+	this->boatPosSet = false;
+	this->t = 0;
+	this->historyHead = 0;
+	this->historyCount = 0;
+}
+
+void ColocalizationEKF::setHistorySize(int size)
+{
+	this->history.resize(size);
+	this->historyHead = 0;
+	this->historyCount = 0;
+}
+
+void ColocalizationEKF::updateFQ(double dt)
+{
+	if (dt == this->lastDt)
+		return;
+
+	this->F.block<3, 3>(DRONE_P, DRONE_V) = dt * Eigen::Matrix3d::Identity();
+	this->F.block<2, 2>(BOAT_P, BOAT_V) = dt * Eigen::Matrix2d::Identity();
+	// Q is tuned per 50Hz step, scale it so stamped predictions of any length add the same noise per second
+	this->Q = this->noise * (dt * 50.0) * this->F * this->Cf * this->F.transpose();
+	this->lastDt = dt;
+}
+
+void ColocalizationEKF::predict(double dt)
+{
+	if (!this->isInit)
+		return;
+
+	this->t += dt;
+	this->updateFQ(dt);
+	this->X = this->F * this->X;
+	this->P = this->F * this->P * this->F.transpose() + this->Q;
+	this->P = (this->P + this->P.transpose()) / 2;
+}
+
+template <int M>
+bool ColocalizationEKF::correct(Sensor<M> &s, const Eigen::Matrix<double, M, 1> &z)
+{
+	typedef Eigen::Matrix<double, M, 1> meas_t;
+	typedef Eigen::Matrix<double, M, M> meas_cov_t;
+
+	Eigen::Matrix<double, n, M> hatP;
+	meas_cov_t S;
+	meas_t r;
+	if (this->useSelectionH)
+	{
+		// P*H' and H*X are signed sums of the selected columns and entries
+		hatP.setZero();
+		r = z;
+		for (int i = 0; i < M; ++i)
+			for (int k = 0; k < s.hCount[i]; ++k)
+			{
+				hatP.col(i) += s.hSign[i][k] * this->P.col(s.hIndex[i][k]);
+				r(i) -= s.hSign[i][k] * this->X(s.hIndex[i][k]);
+			}
+		S = s.R;
+		for (int i = 0; i < M; ++i)
+			for (int k = 0; k < s.hCount[i]; ++k)
+				S.row(i) += s.hSign[i][k] * hatP.row(s.hIndex[i][k]);
+	}
+	else
+	{
+		hatP = this->P * s.H.transpose();
+		S = s.H * hatP + s.R;
+		r = z - s.H * this->X;
+	}
+	Eigen::LLT<meas_cov_t> llt(S);
+
+	// Check residual and apply chi-squared outlier rejection
+	double chi2 = r.dot(llt.solve(r));
+	if (!(chi2 < s.chiCritical))
+		return false;
+
+	// K = hatP * S^-1, S is symmetric
+	Eigen::Matrix<double, n, M> K = llt.solve(hatP.transpose()).transpose();
+	this->X += K * r;
+
+	// Joseph form keeps P symmetric positive definite
+	if (this->useSelectionH)
+	{
+		// K*H*P = K*hatP' = hatP*K', so the three rank M terms collapse into one product
+		Eigen::Matrix<double, n, M> KS = K * S - 2 * hatP;
+		this->P.noalias() += KS * K.transpose();
+	}
+	else
+	{
+		cov_t IKH = cov_t::Identity() - K * s.H;
+		this->P = IKH * this->P * IKH.transpose() + K * s.R * K.transpose();
+	}
+	this->P = (this->P + this->P.transpose()) / 2;
+
+	if (this->updateSensorR)
+	{
+		meas_cov_t Pz;
+		if (this->useSelectionH)
+		{
+			Eigen::Matrix<double, M, n> HP = Eigen::Matrix<double, M, n>::Zero();
+			for (int i = 0; i < M; ++i)
+				for (int k = 0; k < s.hCount[i]; ++k)
+					HP.row(i) += s.hSign[i][k] * this->P.row(s.hIndex[i][k]);
+			Pz.setZero();
+			for (int j = 0; j < M; ++j)
+				for (int k = 0; k < s.hCount[j]; ++k)
+					Pz.col(j) += s.hSign[j][k] * HP.col(s.hIndex[j][k]);
+		}
+		else
+			Pz = s.H * this->P * s.H.transpose();
+		s.updateR(r, Pz);
+	}
+
+	return true;
+}
+
+bool ColocalizationEKF::processTag(const Eigen::Vector4d &z)
+{
+	if (this->isInit)
+		return this->correct(this->tag, z);
+
+	// The offsets need both positions
+	if (this->dronePosSet && this->boatPosSet)
+	{
+		this->X.segment<3>(GPS_OFFSET) = this->X.segment<3>(BOAT_P) - this->X.segment<3>(DRONE_P) - z.head<3>();
+		this->X(HEADING_OFFSET) = z(3);
+		this->isInit = true;
+	}
+	return false;
+}
+
+bool ColocalizationEKF::processDroneVel(const Eigen::Vector3d &z)
+{
+	if (this->isInit)
+		return this->correct(this->dvel, z);
+	return false;
+}
+
+bool ColocalizationEKF::processDroneGPS(const Eigen::Vector3d &z)
+{
+	if (this->isInit)
+		return this->correct(this->dgps, z);
+
+	this->X.segment<3>(DRONE_P) = z;
+	this->dronePosSet = true;
+	return false;
+}
+
+bool ColocalizationEKF::processBoatGPS(const Eigen::Vector3d &z)
+{
+	if (this->isInit)
+		return this->correct(this->jgps, z);
+
+	this->X.segment<3>(BOAT_P) = z;
+	this->boatPosSet = true;
+	return false;
+}
+
+void ColocalizationEKF::predictTo(double t)
+{
+	if (t > this->t)
+	{
+		this->predict(t - this->t);
+		this->t = t;
+	}
+}
+
+bool ColocalizationEKF::processTag(const Eigen::Vector4d &z, double stamp)
+{
+	return this->processAt(TAG, z, stamp);
+}
+
+bool ColocalizationEKF::processDroneVel(const Eigen::Vector3d &z, double stamp)
+{
+	return this->processAt(DVEL, (Eigen::Vector4d() << z, 0).finished(), stamp);
+}
+
+bool ColocalizationEKF::processDroneGPS(const Eigen::Vector3d &z, double stamp)
+{
+	return this->processAt(DGPS, (Eigen::Vector4d() << z, 0).finished(), stamp);
+}
+
+bool ColocalizationEKF::processBoatGPS(const Eigen::Vector3d &z, double stamp)
+{
+	return this->processAt(JGPS, (Eigen::Vector4d() << z, 0).finished(), stamp);
+}
+
+bool ColocalizationEKF::apply(SensorID sensor, const Eigen::Vector4d &z)
+{
+	switch (sensor)
+	{
+	case TAG:
+		return this->processTag(z);
+	case DVEL:
+		return this->processDroneVel(z.head<3>());
+	case DGPS:
+		return this->processDroneGPS(z.head<3>());
+	case JGPS:
+		return this->processBoatGPS(z.head<3>());
+	default:
+		return false;
+	}
+}
+
+ColocalizationEKF::history_t &ColocalizationEKF::historyAt(int i)
+{
+	return this->history[(this->historyHead + i) % this->history.size()];
+}
+
+void ColocalizationEKF::pushHistory(SensorID sensor, const Eigen::Vector4d &z)
+{
+	if (this->historyCount == (int)this->history.size())
+	{
+		this->historyHead = (this->historyHead + 1) % this->history.size();
+		--this->historyCount;
+	}
+	history_t &h = this->historyAt(this->historyCount++);
+	h.t = this->t;
+	h.sensor = sensor;
+	h.z = z;
+	h.X = this->X;
+	h.P = this->P;
+}
+
+bool ColocalizationEKF::processAt(SensorID sensor, const Eigen::Vector4d &z, double stamp)
+{
+	if (!this->isInit)
+	{
+		this->apply(sensor, z);
+
+		// The initial state is the base of the history
+		if (this->isInit)
+		{
+			this->t = stamp;
+			this->historyHead = 0;
+			this->historyCount = 0;
+			this->pushHistory(NONE, z);
+		}
+		return false;
+	}
+
+	if (stamp >= this->t)
+	{
+		this->predictTo(stamp);
+		bool applied = this->apply(sensor, z);
+		this->pushHistory(sensor, z);
+		return applied;
+	}
+
+	// Newest stored state at or before the stamp
+	int k = this->historyCount - 1;
+	while (k >= 0 && this->historyAt(k).t > stamp)
+		--k;
+	if (k < 0)
+	{
+		++this->replayStats.tooOld;
+		return false;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	double now = this->t;
+
+	// Apply the measurement on top of the stored state
+	this->X = this->historyAt(k).X;
+	this->P = this->historyAt(k).P;
+	this->t = this->historyAt(k).t;
+	this->predictTo(stamp);
+	bool applied = this->apply(sensor, z);
+
+	// Insert it after k, shifting the newer entries up
+	if (this->historyCount == (int)this->history.size())
+	{
+		this->historyHead = (this->historyHead + 1) % this->history.size();
+		--this->historyCount;
+		--k;
+	}
+	for (int i = this->historyCount; i > k + 1; --i)
+		this->historyAt(i) = this->historyAt(i - 1);
+	++this->historyCount;
+	history_t &h = this->historyAt(k + 1);
+	h.t = this->t;
+	h.sensor = sensor;
+	h.z = z;
+	h.X = this->X;
+	h.P = this->P;
+
+	// Replay the newer measurements, their residuals were already used for R
+	bool updateR = this->updateSensorR;
+	this->updateSensorR = false;
+	int replayed = 0;
+	for (int i = k + 2; i < this->historyCount; ++i, ++replayed)
+	{
+		history_t &e = this->historyAt(i);
+		this->predictTo(e.t);
+		this->apply(e.sensor, e.z);
+		e.X = this->X;
+		e.P = this->P;
+	}
+	this->updateSensorR = updateR;
+	this->predictTo(now);
+
+	this->replayStats.replays++;
+	this->replayStats.replayedMeasurements += replayed;
+	if (replayed > this->replayStats.maxReplayed)
+		this->replayStats.maxReplayed = replayed;
+	this->replayStats.replaySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return applied;
+}
+
+bool ColocalizationEKF::isInitialized() const
+{
+	return this->isInit;
+}
+
+const ColocalizationEKF::state_t &ColocalizationEKF::getState() const
+{
+	return this->X;
+}
+
+const ColocalizationEKF::cov_t &ColocalizationEKF::getCovariance() const
+{
+	return this->P;
+}
+
+double ColocalizationEKF::getTime() const
+{
+	return this->t;
+}
+
+const ColocalizationEKF::replay_stats_t &ColocalizationEKF::getReplayStats() const
+{
+	return this->replayStats;
+}
+} // namespace bsc_common
@@ -0,0 +1,45 @@
+"""
+Times the numpy colocalization filter (scripts/nodes/filter) on the same corrections as
+timeCorrections in colocalization_ekfTest.cpp: a drone GPS, a drone velocity and a tag
+measurement per cycle, each followed by the adaptive R update as in filter_node.py.
+
+	python colocalization_ekfBench.py [cycles]
+"""
+import os
+import sys
+import time
+
+import numpy as np
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'scripts', 'nodes', 'filter'))
+from kalman_filter import KalmanFilter
+from setupSensors import setupSensors
+
+n = 15
+cycles = int(sys.argv[1]) if len(sys.argv) > 1 else 20000
+
+# Initialized the way FusionEKF does, with the drone 5m from the boat
+X = np.matrix(np.zeros((n, 1)))
+X[0:3] = np.matrix([[5.0], [0.0], [10.0]])
+X[6:9] = np.matrix([[0.0], [0.0], [0.0]])
+X[11:14] = np.matrix([[0.5], [-0.3], [1.2]])
+X[14] = 0.1
+kf = KalmanFilter()
+kf.initialize(X, np.asmatrix(np.eye(n)), np.asmatrix(1.0e3 * np.eye(n)), 1e-3)
+kf.updateF(1 / 50.0)
+kf.updateQ()
+kf.predict()
+
+tagS, velDS, gpsDS, gpsJS = setupSensors(n)
+gpsDS.setZ(X[0:3])
+velDS.setZ(np.matrix(np.zeros((3, 1))))
+tagS.setZ(np.concatenate((X[6:9] - X[0:3] - X[11:14], X[14:15])))
+
+start = time.time()
+for i in range(cycles):
+	for s in (gpsDS, velDS, tagS):
+		r, P = kf.correct(s.getZ(), s.getH(), s.getR(), s.getChi())
+		s.updateR(r, P)
+elapsed = time.time() - start
+
+print("numpy:     %.0f updates/s" % (3 * cycles / elapsed))
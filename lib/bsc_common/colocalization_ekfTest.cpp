@@ -0,0 +1,348 @@
+#include "include/colocalization_ekf.h"
+#include "include/colocalization_srf.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+typedef bsc_common::ColocalizationEKF EKF;
+
+struct truth_t
+{
+	Eigen::Vector3d pD, vD, pJ, vJ, offset;
+	double headingOffset;
+};
+
+// Drone circling above a boat driving a straight line
+static truth_t simulate(double t)
+{
+	truth_t s;
+	s.pJ << 2 * t, 1 * t, 0;
+	s.vJ << 2, 1, 0;
+	s.pD << s.pJ(0) + 5 * std::cos(.2 * t), s.pJ(1) + 5 * std::sin(.2 * t), 10;
+	s.vD << s.vJ(0) - std::sin(.2 * t), s.vJ(1) + std::cos(.2 * t), 0;
+	s.offset << .5, -.3, 1.2;
+	s.headingOffset = .1;
+	return s;
+}
+
+/* Flies the simulation for the given time at the aircraft's sensor rates:
+ * dgps and dvel at 50Hz, tag at 25Hz, jgps at 10Hz
+ * Returns the number of rejected measurements
+ */
+template <class Filter>
+static int fly(Filter &ekf, double duration, int &total)
+{
+	const double dt = 1 / 50.0;
+	std::mt19937 gen(0);
+	std::normal_distribution<double> gauss(0, 1);
+	auto noisy = [&](const Eigen::Vector3d &v, double sd) {
+		return Eigen::Vector3d(v(0) + sd * gauss(gen), v(1) + sd * gauss(gen), v(2) + sd * gauss(gen));
+	};
+
+	int rejected = 0;
+	total = 0;
+	for (int i = 0; i < duration / dt; ++i)
+	{
+		truth_t s = simulate(i * dt);
+		ekf.predict(dt);
+		total += 2;
+		rejected += !ekf.processDroneGPS(noisy(s.pD, .3)) and ekf.isInitialized();
+		rejected += !ekf.processDroneVel(noisy(s.vD, .03)) and ekf.isInitialized();
+		if (i % 5 == 0)
+		{
+			++total;
+			rejected += !ekf.processBoatGPS(noisy(s.pJ + s.offset, 2)) and ekf.isInitialized();
+		}
+		if (i % 2 == 0)
+		{
+			Eigen::Vector4d z;
+			z << noisy(s.pJ - s.pD, .03), s.headingOffset + .03 * gauss(gen);
+			++total;
+			rejected += !ekf.processTag(z) and ekf.isInitialized();
+		}
+	}
+	ekf.predict(dt);
+	return rejected;
+}
+
+// Boat driving at 6 m/s with the drone weaving 3 m around it
+static truth_t simulateFollow(double t)
+{
+	truth_t s;
+	const double w = .5;
+	s.pJ << 6 * t, 0, 0;
+	s.vJ << 6, 0, 0;
+	s.pD = s.pJ + Eigen::Vector3d(-3 + std::sin(w * t), 3 * std::sin(w * t), 3);
+	s.vD = s.vJ + Eigen::Vector3d(w * std::cos(w * t), 3 * w * std::cos(w * t), 0);
+	s.offset << .5, -.3, 1.2;
+	s.headingOffset = .1;
+	return s;
+}
+
+struct event_t
+{
+	double stamp, arrival;
+	EKF::SensorID sensor;
+	Eigen::Vector4d z;
+};
+
+/* Follows the boat with the tag 150ms late and the boat GPS 300ms late
+ * Measurements are stamped with their arrival time unless useStamps is set
+ * Returns the RMS error of the boat position relative to the drone
+ */
+template <class Filter>
+static double follow(Filter &ekf, bool useStamps)
+{
+	const double dt = 1 / 50.0, duration = 60;
+	std::mt19937 gen(1);
+	std::normal_distribution<double> gauss(0, 1);
+	std::vector<event_t> events;
+	for (int i = 0; i < duration / dt; ++i)
+	{
+		double t = i * dt;
+		truth_t s = simulateFollow(t);
+		Eigen::Vector4d n(gauss(gen), gauss(gen), gauss(gen), gauss(gen));
+		events.push_back({t, t, EKF::DGPS, (Eigen::Vector4d() << s.pD + .3 * n.head<3>(), 0).finished()});
+		events.push_back({t, t, EKF::DVEL, (Eigen::Vector4d() << s.vD + .03 * n.head<3>(), 0).finished()});
+		if (i % 2 == 0)
+			events.push_back({t, t + .15, EKF::TAG, (Eigen::Vector4d() << s.pJ - s.pD + .03 * n.head<3>(), s.headingOffset).finished()});
+		if (i % 5 == 0)
+			events.push_back({t, t + .3, EKF::JGPS, (Eigen::Vector4d() << s.pJ + s.offset + 2 * n.head<3>(), 0).finished()});
+	}
+	std::stable_sort(events.begin(), events.end(), [](const event_t &a, const event_t &b) { return a.arrival < b.arrival; });
+
+	double sqErr = 0;
+	int samples = 0;
+	size_t next = 0;
+	for (int i = 0; i < duration / dt; ++i)
+	{
+		double t = i * dt;
+		for (; next < events.size() && events[next].arrival <= t; ++next)
+		{
+			const event_t &e = events[next];
+			double stamp = useStamps ? e.stamp : e.arrival;
+			switch (e.sensor)
+			{
+			case EKF::TAG:
+				ekf.processTag(e.z, stamp);
+				break;
+			case EKF::DVEL:
+				ekf.processDroneVel(e.z.head<3>(), stamp);
+				break;
+			case EKF::DGPS:
+				ekf.processDroneGPS(e.z.head<3>(), stamp);
+				break;
+			default:
+				ekf.processBoatGPS(e.z.head<3>(), stamp);
+			}
+		}
+		ekf.predictTo(t);
+
+		truth_t s = simulateFollow(t);
+		Eigen::Matrix<double, EKF::n, 1> X = ekf.getState().template cast<double>();
+		if (t > 10)
+		{
+			sqErr += (X.segment<3>(6) - X.segment<3>(0) - X.segment<3>(11) - (s.pJ - s.pD)).squaredNorm();
+			++samples;
+		}
+	}
+	return std::sqrt(sqErr / samples);
+}
+
+// Windowed R estimate recomputed from all residuals, as in sensor.py
+struct NaiveR
+{
+	int N;
+	std::vector<Eigen::Vector3d> residuals;
+	Eigen::Matrix3d R, Rnom;
+
+	void updateR(const Eigen::Vector3d &r, const Eigen::Matrix3d &Pz)
+	{
+		if ((int)residuals.size() == N)
+			residuals.erase(residuals.begin());
+		residuals.push_back(r);
+		if ((int)residuals.size() == N)
+		{
+			Eigen::Matrix3d sum = Eigen::Matrix3d::Zero();
+			for (const Eigen::Vector3d &res : residuals)
+				sum += res * res.transpose();
+			Eigen::Vector3d hatRdiag = (sum / N - Pz).diagonal();
+			R = hatRdiag.cwiseMax(Rnom.diagonal()).asDiagonal();
+		}
+	}
+};
+
+// Compares the running sum window against the recomputed one, returns the worst relative difference of R
+static double compareAdaptiveR(int N, int updates, double &tRunning, double &tNaive)
+{
+	std::mt19937 gen(2);
+	std::normal_distribution<double> gauss(0, 1);
+	std::vector<Eigen::Vector3d> rs(updates);
+	for (Eigen::Vector3d &r : rs)
+		r << .5 * gauss(gen), 2 * gauss(gen), 10 * gauss(gen);
+	Eigen::Matrix3d Pz = 1e-2 * Eigen::Matrix3d::Identity();
+
+	EKF::Sensor<3> sensor;
+	sensor.Rnom = 1e-3 * Eigen::Matrix3d::Identity();
+	sensor.R = sensor.Rnom;
+	sensor.setWindow(N);
+	NaiveR naive;
+	naive.N = N;
+	naive.Rnom = sensor.Rnom;
+	naive.R = sensor.Rnom;
+
+	double worst = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	for (const Eigen::Vector3d &r : rs)
+		sensor.updateR(r, Pz);
+	auto t1 = std::chrono::steady_clock::now();
+	for (const Eigen::Vector3d &r : rs)
+		naive.updateR(r, Pz);
+	auto t2 = std::chrono::steady_clock::now();
+	tRunning = std::chrono::duration<double>(t1 - t0).count() / updates;
+	tNaive = std::chrono::duration<double>(t2 - t1).count() / updates;
+
+	// Check every step of a shorter run
+	sensor.setWindow(N);
+	naive.residuals.clear();
+	for (int i = 0; i < std::min(updates, 20 * N); ++i)
+	{
+		sensor.updateR(rs[i], Pz);
+		naive.updateR(rs[i], Pz);
+		worst = std::max(worst, ((sensor.R - naive.R).cwiseAbs().array() / naive.R.cwiseAbs().array().max(1e-12)).maxCoeff());
+	}
+	return worst;
+}
+
+// Seconds per 50Hz correction cycle (dgps, dvel and tag) around the current estimate
+// colocalization_ekfBench.py times the numpy filter on the same cycle
+template <class Filter>
+static double timeCorrections(Filter &ekf, int cycles)
+{
+	Eigen::Matrix<double, EKF::n, 1> X = ekf.getState().template cast<double>();
+	Eigen::Vector3d zD = X.segment<3>(0), zV = Eigen::Vector3d::Zero();
+	Eigen::Vector4d zT;
+	zT << X.segment<3>(6) - X.segment<3>(0) - X.segment<3>(11), X(14);
+	volatile double sink = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < cycles; ++i)
+	{
+		ekf.processDroneGPS(zD);
+		ekf.processDroneVel(zV);
+		ekf.processTag(zT);
+		sink = sink + ekf.getState()(0);
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(t1 - t0).count() / cycles;
+}
+
+int main()
+{
+	const double duration = 120;
+	int total;
+	EKF ekf;
+	int rejected = fly(ekf, duration, total);
+
+	truth_t s = simulate(duration);
+	const EKF::state_t &X = ekf.getState();
+	double posErr = (X.segment<3>(0) - s.pD).norm();
+	double relErr = (X.segment<3>(6) - X.segment<3>(0) - X.segment<3>(11) - (s.pJ - s.pD)).norm();
+	double hdgErr = std::abs(X(14) - s.headingOffset);
+	bool tracks = ekf.isInitialized() and posErr < 1 and relErr < .1 and hdgErr < .05;
+	std::cout << "drone position error " << posErr << " m, relative position error " << relErr
+						<< " m, heading offset error " << hdgErr << " rad, rejected " << rejected << "/" << total << std::endl;
+	std::cout << (tracks ? "PASS" : "FAIL") << ": filter tracks the simulated flight" << std::endl;
+
+	// The selection form of H must match the dense update
+	EKF dense;
+	dense.useSelectionH = false;
+	int denseRejected = fly(dense, duration, total);
+	double xDiff = (dense.getState() - ekf.getState()).cwiseAbs().maxCoeff();
+	double pDiff = ((dense.getCovariance() - ekf.getCovariance()).cwiseAbs().array() /
+									(1 + dense.getCovariance().cwiseAbs().array()))
+										 .maxCoeff();
+	bool same = denseRejected == rejected and xDiff < 1e-9 and pDiff < 1e-9;
+	std::cout << "dense vs selection H: max state diff " << xDiff << ", max relative covariance diff " << pDiff << std::endl;
+	std::cout << (same ? "PASS" : "FAIL") << ": selection H matches the dense update" << std::endl;
+
+	const int cycles = 200000;
+	double tDense = timeCorrections(dense, cycles);
+	double tSparse = timeCorrections(ekf, cycles);
+	std::cout << "dense:     " << 3 / tDense << " updates/s\n";
+	std::cout << "selection: " << 3 / tSparse << " updates/s (" << tDense / tSparse << "x)\n";
+
+	// Latency compensation while following
+	EKF late, stamped;
+	double lateErr = follow(late, false);
+	auto f0 = std::chrono::steady_clock::now();
+	double stampedErr = follow(stamped, true);
+	auto f1 = std::chrono::steady_clock::now();
+	const EKF::replay_stats_t &stats = stamped.getReplayStats();
+	bool compensates = stampedErr < lateErr / 2;
+	std::cout << "following, relative position RMS error: applied on arrival " << lateErr << " m, applied at stamp "
+						<< stampedErr << " m" << std::endl;
+	std::cout << "replays " << stats.replays << ", replayed " << stats.replayedMeasurements << " (max "
+						<< stats.maxReplayed << " per replay), " << stats.tooOld << " too old, " << 1e6 * stats.replaySeconds / stats.replays << " us/replay, "
+						<< 100 * stats.replaySeconds / std::chrono::duration<double>(f1 - f0).count() << "% of the run" << std::endl;
+	std::cout << (compensates ? "PASS" : "FAIL") << ": stamped measurements remove the lag error" << std::endl;
+
+	// Adaptive R over the window sizes of the sensors
+	bool sameR = true;
+	for (int N : {10, 39, 150, 1000})
+	{
+		double tRunning, tNaive;
+		double diff = compareAdaptiveR(N, 200000, tRunning, tNaive);
+		sameR = sameR and diff < 1e-9;
+		std::cout << "adaptive R, N = " << N << ": running sums " << 1e9 * tRunning << " ns/update, recomputed "
+							<< 1e9 * tNaive << " ns/update, max relative diff " << diff << std::endl;
+	}
+	std::cout << (sameR ? "PASS" : "FAIL") << ": running sums match the recomputed window" << std::endl;
+
+	// Float32 square root filter against the double precision reference
+	EKF reference;
+	int refRejected = fly(reference, duration, total);
+	bsc_common::ColocalizationSRF srf;
+	int srfRejected = fly(srf, duration, total);
+	Eigen::Matrix<double, EKF::n, 1> srfDiff = (srf.getState().cast<double>() - reference.getState()).cwiseAbs();
+	double srfPos = std::max(srfDiff.segment<3>(0).maxCoeff(), srfDiff.segment<3>(6).maxCoeff());
+	double srfOffset = srfDiff.segment<3>(11).maxCoeff();
+	double srfVel = srfDiff.segment<5>(3).maxCoeff();
+	double srfStd = (srf.getCovariance().diagonal().cast<double>().cwiseSqrt() - reference.getCovariance().diagonal().cwiseSqrt())
+											.cwiseQuotient(reference.getCovariance().diagonal().cwiseSqrt())
+											.cwiseAbs()
+											.maxCoeff();
+	bool srfClose = srfPos < 1e-3 and srfVel < 1e-3 and srfOffset < 1e-3 and srfDiff(14) < 1e-4 and srfStd < 1e-3 and
+									srfRejected == refRejected;
+	std::cout << "float32 SRF vs float64: positions " << srfPos << " m, velocities " << srfVel << " m/s, offsets " << srfOffset
+						<< " m, heading offset " << srfDiff(14) << " rad, relative std " << srfStd << ", rejected " << srfRejected
+						<< " vs " << refRejected << std::endl;
+	std::cout << (srfClose ? "PASS" : "FAIL") << ": float32 SRF within 1 mm, 1 mm/s, 1e-4 rad and 0.1% std of float64"
+						<< std::endl;
+
+	// Stamped SRF measurements are predicted to, late ones are applied on arrival
+	bsc_common::ColocalizationSRF srfFollow;
+	double srfFollowErr = follow(srfFollow, true);
+	bool srfStamped = std::abs(srfFollowErr - lateErr) < .1 * lateErr;
+	std::cout << "following, relative position RMS error: float32 SRF with stamps " << srfFollowErr << " m" << std::endl;
+	std::cout << (srfStamped ? "PASS" : "FAIL") << ": stamped SRF tracks like the EKF with late measurements applied on arrival" << std::endl;
+
+	double tSrf = timeCorrections(srf, cycles);
+	std::cout << "float32 SRF: " << 3 / tSrf << " updates/s\n";
+
+	// Full 50Hz cycle including the prediction
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < cycles; ++i)
+		ekf.predict(1 / 50.0);
+	auto t1 = std::chrono::steady_clock::now();
+	double tPredict = std::chrono::duration<double>(t1 - t0).count() / cycles;
+	std::cout << "predict:   " << 1 / tPredict << " predictions/s, " << 1 / (tPredict + tSparse) << " cycles/s\n";
+	t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < cycles; ++i)
+		srf.predict(1 / 50.0);
+	t1 = std::chrono::steady_clock::now();
+	double tSrfPredict = std::chrono::duration<double>(t1 - t0).count() / cycles;
+	std::cout << "SRF predict: " << 1 / tSrfPredict << " predictions/s, " << 1 / (tSrfPredict + tSrf) << " cycles/s\n";
+	return tracks and same and compensates and sameR and srfClose and srfStamped ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/colocalization_srf.h"
+
+namespace bsc_common
+{
+ColocalizationSRF::ColocalizationSRF(double P0, double noise)
+{
+	this->P0 = P0;
+	this->noise = noise;
+	this->sqrtCf = ColocalizationEKF::continuousNoise().cwiseSqrt().cast<float>().asDiagonal();
+	ColocalizationEKF::setupSensors(this->tag, this->dvel, this->dgps, this->jgps);
+	this->reset();
+}
+
+void ColocalizationSRF::reset()
+{
+	this->X.setZero();
+	this->S = (float)std::sqrt(this->P0) * cov_t::Identity();
+	this->F.setIdentity();
+	this->lastDt = -1;
+	this->t = 0;
+	this->isInit = false;
+	this->dronePosSet = false;
+	this->boatPosSet = false;
+}
+
+void ColocalizationSRF::predict(double dt)
+{
+	if (!this->isInit)
+		return;
+
+	if (dt != this->lastDt)
+	{
+		this->F.block<3, 3>(ColocalizationEKF::DRONE_P, ColocalizationEKF::DRONE_V) = (float)dt * Eigen::Matrix3f::Identity();
+		this->F.block<2, 2>(ColocalizationEKF::BOAT_P, ColocalizationEKF::BOAT_V) = (float)dt * Eigen::Matrix2f::Identity();
+		this->lastDt = dt;
+	}
+	this->X = this->F * this->X;
+
+	// [F*S F*sqrt(Q)]' = Q*R, so F*P*F' + Q = R'*R
+	Eigen::Matrix<float, 2 * n, n> A;
+	A.topRows<n>().noalias() = (this->F * this->S).transpose();
+	A.bottomRows<n>().noalias() = (float)std::sqrt(this->noise * dt * 50.0) * (this->F * this->sqrtCf).transpose();
+	Eigen::HouseholderQR<Eigen::Matrix<float, 2 * n, n>> qr(A);
+	this->S = qr.matrixQR().topRows<n>().triangularView<Eigen::Upper>().transpose();
+}
+
+template <int M>
+bool ColocalizationSRF::correct(ColocalizationEKF::Sensor<M> &s, const Eigen::Matrix<double, M, 1> &z)
+{
+	typedef Eigen::Matrix<float, M + n, M + n> array_t;
+
+	// Pre-array, H*S and H*X gather the selected rows
+	array_t A = array_t::Zero();
+	Eigen::Matrix<float, M, 1> r = z.template cast<float>();
+	A.template topLeftCorner<M, M>() = s.R.diagonal().cwiseSqrt().template cast<float>().asDiagonal();
+	for (int i = 0; i < M; ++i)
+		for (int k = 0; k < s.hCount[i]; ++k)
+		{
+			A.template block<1, n>(i, M) += (float)s.hSign[i][k] * this->S.row(s.hIndex[i][k]);
+			r(i) -= (float)s.hSign[i][k] * this->X(s.hIndex[i][k]);
+		}
+	A.template bottomRightCorner<n, n>() = this->S;
+
+	// A' = Q*R, so A*Q = R' is the lower triangular post-array
+	Eigen::HouseholderQR<array_t> qr(A.transpose());
+	array_t L = qr.matrixQR().template triangularView<Eigen::Upper>().transpose();
+
+	// Check residual and apply chi-squared outlier rejection
+	Eigen::Matrix<float, M, 1> e = L.template topLeftCorner<M, M>().template triangularView<Eigen::Lower>().solve(r);
+	if (!(e.squaredNorm() < s.chiCritical))
+		return false;
+
+	this->X += L.template bottomLeftCorner<n, M>() * e;
+	this->S = L.template bottomRightCorner<n, n>();
+
+	if (this->updateSensorR)
+	{
+		Eigen::Matrix<double, M, n> HS = Eigen::Matrix<double, M, n>::Zero();
+		for (int i = 0; i < M; ++i)
+			for (int k = 0; k < s.hCount[i]; ++k)
+				HS.row(i) += s.hSign[i][k] * this->S.row(s.hIndex[i][k]).template cast<double>();
+		s.updateR(r.template cast<double>(), HS * HS.transpose());
+	}
+
+	return true;
+}
+
+bool ColocalizationSRF::processTag(const Eigen::Vector4d &z)
+{
+	if (this->isInit)
+		return this->correct(this->tag, z);
+
+	// The offsets need both positions
+	if (this->dronePosSet && this->boatPosSet)
+	{
+		this->X.segment<3>(ColocalizationEKF::GPS_OFFSET) =
+				this->X.segment<3>(ColocalizationEKF::BOAT_P) - this->X.segment<3>(ColocalizationEKF::DRONE_P) - z.head<3>().cast<float>();
+		this->X(ColocalizationEKF::HEADING_OFFSET) = z(3);
+		this->isInit = true;
+	}
+	return false;
+}
+
+bool ColocalizationSRF::processDroneVel(const Eigen::Vector3d &z)
+{
+	if (this->isInit)
+		return this->correct(this->dvel, z);
+	return false;
+}
+
+bool ColocalizationSRF::processDroneGPS(const Eigen::Vector3d &z)
+{
+	if (this->isInit)
+		return this->correct(this->dgps, z);
+
+	this->X.segment<3>(ColocalizationEKF::DRONE_P) = z.cast<float>();
+	this->dronePosSet = true;
+	return false;
+}
+
+bool ColocalizationSRF::processBoatGPS(const Eigen::Vector3d &z)
+{
+	if (this->isInit)
+		return this->correct(this->jgps, z);
+
+	this->X.segment<3>(ColocalizationEKF::BOAT_P) = z.cast<float>();
+	this->boatPosSet = true;
+	return false;
+}
+
+void ColocalizationSRF::predictTo(double t)
+{
+	if (t > this->t)
+	{
+		this->predict(t - this->t);
+		this->t = t;
+	}
+}
+
+bool ColocalizationSRF::processTag(const Eigen::Vector4d &z, double stamp)
+{
+	this->predictTo(stamp);
+	return this->processTag(z);
+}
+
+bool ColocalizationSRF::processDroneVel(const Eigen::Vector3d &z, double stamp)
+{
+	this->predictTo(stamp);
+	return this->processDroneVel(z);
+}
+
+bool ColocalizationSRF::processDroneGPS(const Eigen::Vector3d &z, double stamp)
+{
+	this->predictTo(stamp);
+	return this->processDroneGPS(z);
+}
+
+bool ColocalizationSRF::processBoatGPS(const Eigen::Vector3d &z, double stamp)
+{
+	this->predictTo(stamp);
+	return this->processBoatGPS(z);
+}
+
+bool ColocalizationSRF::isInitialized() const
+{
+	return this->isInit;
+}
+
+const ColocalizationSRF::state_t &ColocalizationSRF::getState() const
+{
+	return this->X;
+}
+
+double ColocalizationSRF::getTime() const
+{
+	return this->t;
+}
+
+const ColocalizationSRF::cov_t &ColocalizationSRF::getCovarianceFactor() const
+{
+	return this->S;
+}
+
+ColocalizationSRF::cov_t ColocalizationSRF::getCovariance() const
+{
+	return this->S * this->S.transpose();
+}
+} // namespace bsc_common
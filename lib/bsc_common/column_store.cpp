@@ -0,0 +1,369 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements a columnar store for logged time series
+ * 
+ * Author: Brennan Cain
+ */
+#include "include/column_store.h"
+#include "include/gorilla.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bsc_common
+{
+namespace column_store
+{
+namespace
+{
+const char MAGIC[8] = {'J', 'Y', 'C', 'O', 'L', 'I', 'D', 'X'};
+const uint32_t VERSION = 2; // 1 used byte aligned XOR values
+
+std::string fileName(const std::string &dir, const std::string &field)
+{
+	std::string name = field;
+	std::replace(name.begin(), name.end(), '/', '_');
+	return dir + "/" + name + ".col";
+}
+} // namespace
+
+void encodeTimes(const int64_t *t, size_t rows, std::vector<uint8_t> &out)
+{
+	gorilla::BitWriter bits;
+	gorilla::TimeCodec codec;
+	for (size_t i = 0; i < rows; ++i)
+		codec.encode(bits, t[i]);
+	out.insert(out.end(), bits.data(), bits.data() + bits.size());
+}
+
+bool decodeTimes(const uint8_t *in, size_t size, size_t rows, int64_t *t)
+{
+	gorilla::BitReader bits(in, size);
+	gorilla::TimeCodec codec;
+	for (size_t i = 0; i < rows; ++i)
+		t[i] = codec.decode(bits);
+	return bits.ok();
+}
+
+void encodeValues(const double *v, size_t rows, std::vector<uint8_t> &out)
+{
+	gorilla::BitWriter bits;
+	gorilla::ValueCodec codec;
+	for (size_t i = 0; i < rows; ++i)
+		codec.encode(bits, v[i]);
+	out.insert(out.end(), bits.data(), bits.data() + bits.size());
+}
+
+bool decodeValues(const uint8_t *in, size_t size, size_t rows, double *v)
+{
+	gorilla::BitReader bits(in, size);
+	gorilla::ValueCodec codec;
+	for (size_t i = 0; i < rows; ++i)
+		v[i] = codec.decode(bits);
+	return bits.ok();
+}
+} // namespace column_store
+
+using namespace column_store;
+
+ColumnWriter::ColumnWriter(int blockRows) : blockRows_(std::max(blockRows, 1))
+{
+}
+
+ColumnWriter::~ColumnWriter()
+{
+	close();
+}
+
+bool ColumnWriter::open(const std::string &dir, const std::vector<std::string> &fields)
+{
+	close();
+	if (mkdir(dir.c_str(), 0755) != 0 and errno != EEXIST)
+		return false;
+
+	dir_ = dir;
+	fields_ = fields;
+	values_.assign(fields.size(), std::vector<double>());
+	times_.clear();
+	index_.clear();
+	rows_ = bytes_ = 0;
+	ok_ = true;
+
+	files_.push_back(fopen(fileName(dir, "_time").c_str(), "wb"));
+	for (const std::string &f : fields)
+		files_.push_back(fopen(fileName(dir, f).c_str(), "wb"));
+	for (FILE *f : files_)
+		ok_ = ok_ and f;
+	if (not ok_)
+		close();
+	return ok_;
+}
+
+void ColumnWriter::append(int64_t t, const double *values)
+{
+	if (files_.empty())
+		return;
+	times_.push_back(t);
+	for (size_t c = 0; c < fields_.size(); ++c)
+		values_[c].push_back(values[c]);
+	++rows_;
+	if ((int)times_.size() >= blockRows_)
+		flushBlock();
+}
+
+void ColumnWriter::flushBlock()
+{
+	if (times_.empty())
+		return;
+
+	block_t block;
+	block.rows = times_.size();
+	block.tMin = *std::min_element(times_.begin(), times_.end());
+	block.tMax = *std::max_element(times_.begin(), times_.end());
+	for (size_t c = 0; c < files_.size(); ++c)
+	{
+		buffer_.clear();
+		if (c == 0)
+			encodeTimes(times_.data(), times_.size(), buffer_);
+		else
+			encodeValues(values_[c - 1].data(), times_.size(), buffer_);
+
+		span_t span;
+		span.offset = ftell(files_[c]);
+		span.size = buffer_.size();
+		ok_ = ok_ and fwrite(buffer_.data(), 1, buffer_.size(), files_[c]) == buffer_.size();
+		bytes_ += buffer_.size();
+		block.spans.push_back(span);
+	}
+	index_.push_back(block);
+
+	times_.clear();
+	for (std::vector<double> &v : values_)
+		v.clear();
+}
+
+bool ColumnWriter::close()
+{
+	if (files_.empty())
+		return ok_;
+	flushBlock();
+	for (FILE *f : files_)
+		if (f)
+			ok_ = fclose(f) == 0 and ok_;
+	files_.clear();
+
+	FILE *f = fopen((dir_ + "/index").c_str(), "wb");
+	if (not f)
+		return ok_ = false;
+	uint32_t header[4] = {VERSION, (uint32_t)fields_.size(), (uint32_t)index_.size(), (uint32_t)blockRows_};
+	fwrite(MAGIC, 1, sizeof(MAGIC), f);
+	fwrite(header, sizeof(header), 1, f);
+	for (const std::string &name : fields_)
+	{
+		uint16_t n = name.size();
+		fwrite(&n, sizeof(n), 1, f);
+		fwrite(name.data(), 1, n, f);
+	}
+	for (const block_t &b : index_)
+	{
+		fwrite(&b.tMin, sizeof(b.tMin), 1, f);
+		fwrite(&b.tMax, sizeof(b.tMax), 1, f);
+		fwrite(&b.rows, sizeof(b.rows), 1, f);
+		for (const span_t &s : b.spans)
+		{
+			fwrite(&s.offset, sizeof(s.offset), 1, f);
+			fwrite(&s.size, sizeof(s.size), 1, f);
+		}
+	}
+	ok_ = not ferror(f) and ok_;
+	ok_ = fclose(f) == 0 and ok_;
+	return ok_;
+}
+
+size_t ColumnWriter::rows() const
+{
+	return rows_;
+}
+
+size_t ColumnWriter::bytes() const
+{
+	return bytes_;
+}
+
+ColumnReader::ColumnReader()
+{
+}
+
+ColumnReader::~ColumnReader()
+{
+	close();
+}
+
+bool ColumnReader::open(const std::string &dir)
+{
+	close();
+	FILE *f = fopen((dir + "/index").c_str(), "rb");
+	if (not f)
+		return false;
+
+	char magic[8];
+	uint32_t header[4];
+	bool ok = fread(magic, 1, sizeof(magic), f) == sizeof(magic) and not memcmp(magic, MAGIC, sizeof(magic)) and
+						fread(header, sizeof(header), 1, f) == 1 and header[0] == VERSION;
+	for (uint32_t i = 0; ok and i < header[1]; ++i)
+	{
+		uint16_t n;
+		ok = fread(&n, sizeof(n), 1, f) == 1;
+		std::string name(n, 0);
+		ok = ok and fread(&name[0], 1, n, f) == n;
+		fields_.push_back(name);
+	}
+	for (uint32_t i = 0; ok and i < header[2]; ++i)
+	{
+		block_t b;
+		ok = fread(&b.tMin, sizeof(b.tMin), 1, f) == 1 and fread(&b.tMax, sizeof(b.tMax), 1, f) == 1 and
+				 fread(&b.rows, sizeof(b.rows), 1, f) == 1;
+		b.spans.resize(fields_.size() + 1);
+		for (span_t &s : b.spans)
+			ok = ok and fread(&s.offset, sizeof(s.offset), 1, f) == 1 and fread(&s.size, sizeof(s.size), 1, f) == 1;
+		index_.push_back(b);
+		rows_ += b.rows;
+	}
+	fclose(f);
+
+	if (not ok)
+	{
+		close();
+		return false;
+	}
+	dir_ = dir;
+	fds_.assign(fields_.size() + 1, -1);
+	return true;
+}
+
+void ColumnReader::close()
+{
+	for (int fd : fds_)
+		if (fd >= 0)
+			::close(fd);
+	fds_.clear();
+	fields_.clear();
+	index_.clear();
+	rows_ = 0;
+}
+
+const std::vector<std::string> &ColumnReader::fields() const
+{
+	return fields_;
+}
+
+size_t ColumnReader::rows() const
+{
+	return rows_;
+}
+
+int64_t ColumnReader::start() const
+{
+	int64_t t = INT64_MAX;
+	for (const block_t &b : index_)
+		t = std::min(t, b.tMin);
+	return t;
+}
+
+int64_t ColumnReader::end() const
+{
+	int64_t t = INT64_MIN;
+	for (const block_t &b : index_)
+		t = std::max(t, b.tMax);
+	return t;
+}
+
+bool ColumnReader::readSpan(int column, const span_t &span, std::vector<uint8_t> &bytes)
+{
+	if (fds_[column] < 0)
+	{
+		std::string name = column ? fields_[column - 1] : "_time";
+		fds_[column] = ::open(fileName(dir_, name).c_str(), O_RDONLY);
+		if (fds_[column] < 0)
+			return false;
+	}
+	bytes.resize(span.size);
+	return pread(fds_[column], bytes.data(), span.size, span.offset) == (ssize_t)span.size;
+}
+
+bool ColumnReader::read(int64_t t0, int64_t t1, const std::vector<std::string> &names, std::vector<int64_t> &t,
+												std::vector<std::vector<double>> &columns)
+{
+	std::vector<int> wanted;
+	const std::vector<std::string> &list = names.empty() ? fields_ : names;
+	for (const std::string &name : list)
+	{
+		auto it = std::find(fields_.begin(), fields_.end(), name);
+		if (it == fields_.end())
+			return false;
+		wanted.push_back(it - fields_.begin() + 1);
+	}
+
+	t.clear();
+	columns.assign(wanted.size(), std::vector<double>());
+	std::vector<uint8_t> bytes;
+	std::vector<int64_t> times;
+	std::vector<double> values;
+	std::vector<uint32_t> keep;
+	for (const block_t &b : index_)
+	{
+		if (b.tMax < t0 or b.tMin > t1)
+			continue;
+
+		times.resize(b.rows);
+		if (not readSpan(0, b.spans[0], bytes) or not decodeTimes(bytes.data(), bytes.size(), b.rows, times.data()))
+			return false;
+		keep.clear();
+		for (uint32_t r = 0; r < b.rows; ++r)
+			if (t0 <= times[r] and times[r] <= t1)
+			{
+				keep.push_back(r);
+				t.push_back(times[r]);
+			}
+		if (keep.empty())
+			continue;
+
+		values.resize(b.rows);
+		for (size_t c = 0; c < wanted.size(); ++c)
+		{
+			if (not readSpan(wanted[c], b.spans[wanted[c]], bytes) or
+					not decodeValues(bytes.data(), bytes.size(), b.rows, values.data()))
+				return false;
+			for (uint32_t r : keep)
+				columns[c].push_back(values[r]);
+		}
+	}
+	return true;
+}
+} // namespace bsc_common
@@ -0,0 +1,171 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/column_store.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace bsc_common;
+
+static bool same(double a, double b)
+{
+	return not memcmp(&a, &b, sizeof(a));
+}
+
+int main()
+{
+	int failures = 0;
+	const std::string dir = "/tmp/column_storeTest";
+
+	// Codec round trip on awkward values
+	{
+		double v[] = {0, -0.0, 1, 1, NAN, INFINITY, -1e300, 5e-324, 3.14159, 3.14159f, (float)2.5, 1e15 + 1};
+		int64_t t[] = {0, 1, 2, 2, -5, INT64_MAX / 4, 40, 41, 42, 43, 44, 45};
+		const size_t n = sizeof(v) / sizeof(v[0]);
+		std::vector<uint8_t> bytes;
+		column_store::encodeValues(v, n, bytes);
+		size_t split = bytes.size();
+		column_store::encodeTimes(t, n, bytes);
+		double v2[n];
+		int64_t t2[n];
+		bool ok = column_store::decodeValues(bytes.data(), split, n, v2) and
+							column_store::decodeTimes(bytes.data() + split, bytes.size() - split, n, t2);
+		for (size_t i = 0; ok and i < n; ++i)
+			ok = same(v[i], v2[i]) and t[i] == t2[i];
+		ok = ok and not column_store::decodeValues(bytes.data(), split - 1, n, v2);
+		if (not ok)
+		{
+			printf("  FAIL: codec round trip\n");
+			++failures;
+		}
+	}
+
+	// A flight's worth of a 50Hz topic: smooth floats, a counter, a mode that rarely changes
+	const int n = 200000;
+	const int64_t t0 = 1500000000000000000ll, dt = 20000000;
+	std::vector<std::string> fields = {"x", "y", "z", "seq", "mode", "noise"};
+	std::vector<std::vector<double>> truth(fields.size(), std::vector<double>(n));
+	std::vector<int64_t> times(n);
+	srand(3);
+	for (int i = 0; i < n; ++i)
+	{
+		times[i] = t0 + i * dt + rand() % 1000; // receive jitter
+		truth[0][i] = (float)(10 * sin(i * 1e-3));
+		truth[1][i] = (float)(10 * cos(i * 1e-3));
+		truth[2][i] = (float)(2 + 0.01 * (i % 500));
+		truth[3][i] = i;
+		truth[4][i] = (i / 20000) % 4;
+		truth[5][i] = (double)rand() / RAND_MAX;
+	}
+
+	{
+		ColumnWriter writer(4096);
+		if (not writer.open(dir, fields))
+		{
+			printf("  FAIL: open %s\n", dir.c_str());
+			return 1;
+		}
+		std::vector<double> row(fields.size());
+		auto s = std::chrono::steady_clock::now();
+		for (int i = 0; i < n; ++i)
+		{
+			for (size_t c = 0; c < fields.size(); ++c)
+				row[c] = truth[c][i];
+			writer.append(times[i], row.data());
+		}
+		if (not writer.close())
+		{
+			printf("  FAIL: close\n");
+			++failures;
+		}
+		auto e = std::chrono::steady_clock::now();
+		double raw = n * (fields.size() + 1) * 8.0;
+		printf("wrote %i rows x %i in %1.1fms, %1.1f bytes/row vs %1.0f raw (%1.1fx)\n", n, (int)fields.size(),
+					 std::chrono::duration<double, std::milli>(e - s).count(), (double)writer.bytes() / n, raw / n,
+					 raw / writer.bytes());
+	}
+
+	{
+		ColumnReader reader;
+		if (not reader.open(dir) or reader.fields() != fields or reader.rows() != (size_t)n)
+		{
+			printf("  FAIL: reopen\n");
+			return 1;
+		}
+
+		// Everything
+		std::vector<int64_t> t;
+		std::vector<std::vector<double>> cols;
+		auto s = std::chrono::steady_clock::now();
+		bool ok = reader.read(INT64_MIN, INT64_MAX, {}, t, cols);
+		auto e = std::chrono::steady_clock::now();
+		ok = ok and t == times;
+		for (size_t c = 0; ok and c < fields.size(); ++c)
+			for (int i = 0; ok and i < n; ++i)
+				ok = same(cols[c][i], truth[c][i]);
+		if (not ok)
+		{
+			printf("  FAIL: full read\n");
+			++failures;
+		}
+		printf("full read %1.1fms (%1.0fM values/s)\n", std::chrono::duration<double, std::milli>(e - s).count(),
+					 n * (fields.size() + 1) / std::chrono::duration<double, std::micro>(e - s).count());
+
+		// Ten seconds of two fields from the middle
+		int64_t a = t0 + 1234 * dt * 10, b = a + 10000000000ll;
+		s = std::chrono::steady_clock::now();
+		ok = reader.read(a, b, {"mode", "z"}, t, cols);
+		e = std::chrono::steady_clock::now();
+		int expected = 0, first = -1;
+		for (int i = 0; i < n; ++i)
+			if (a <= times[i] and times[i] <= b)
+			{
+				first = first < 0 ? i : first;
+				++expected;
+			}
+		ok = ok and (int)t.size() == expected and cols.size() == 2;
+		for (int i = 0; ok and i < expected; ++i)
+			ok = t[i] == times[first + i] and same(cols[0][i], truth[4][first + i]) and same(cols[1][i], truth[2][first + i]);
+		if (not ok)
+		{
+			printf("  FAIL: range read\n");
+			++failures;
+		}
+		printf("10s range of 2 fields %1.3fms\n", std::chrono::duration<double, std::milli>(e - s).count());
+
+		if (reader.read(a, b, {"missing"}, t, cols))
+		{
+			printf("  FAIL: read an unknown field\n");
+			++failures;
+		}
+	}
+
+	if (system(("rm -rf " + dir).c_str()) != 0)
+		printf("could not remove %s\n", dir.c_str());
+	printf(failures ? "%i FAILURES\n" : "PASSED\n", failures);
+	return failures ? 1 : 0;
+}
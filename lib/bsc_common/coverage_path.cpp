@@ -0,0 +1,261 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the coverage path generator
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/coverage_path.h"
+#include <algorithm>
+#include <cmath>
+
+namespace bsc_common
+{
+bool CoveragePath::setup(const polygon_t &polygon, Pattern pattern, double spacing, double angle)
+{
+	done_ = true;
+	if (polygon.size() < 3 or not(spacing > 0) or pattern < LAWNMOWER or pattern > BOUSTROPHEDON)
+		return false;
+
+	pattern_ = pattern;
+	spacing_ = spacing;
+	toWorld_ << cos(angle), -sin(angle), sin(angle), cos(angle);
+
+	local_.resize(polygon.size());
+	for (size_t i = 0; i < polygon.size(); ++i)
+		local_[i] = toWorld_.transpose() * polygon[i];
+	crossings_.reserve(local_.size());
+
+	yMin_ = yMax_ = local_[0](1);
+	center_.setZero();
+	for (const Eigen::Vector2d &v : local_)
+	{
+		yMin_ = std::min(yMin_, v(1));
+		yMax_ = std::max(yMax_, v(1));
+		center_ += v;
+	}
+	center_ /= local_.size();
+	if (yMax_ <= yMin_)
+		return false;
+
+	// Lines are centered in the polygon so each border gets at most half a spacing
+	lineCount_ = std::max(1, (int)std::ceil((yMax_ - yMin_) / spacing_ - 1e-9));
+
+	rMax_ = 0;
+	for (const Eigen::Vector2d &v : local_)
+		rMax_ = std::max(rMax_, (v - center_).norm());
+
+	critical_.clear();
+	int n = local_.size();
+	for (int i = 0; i < n; ++i)
+	{
+		double y = local_[i](1);
+		double dPrev = local_[(i + n - 1) % n](1) - y, dNext = local_[(i + 1) % n](1) - y;
+		if (dPrev * dNext >= 0)
+			critical_.push_back(y);
+	}
+	std::sort(critical_.begin(), critical_.end());
+	critical_.erase(std::unique(critical_.begin(), critical_.end()), critical_.end());
+
+	reset();
+	return true;
+}
+
+void CoveragePath::reset()
+{
+	line_ = 0;
+	pendingCount_ = pendingIndex_ = 0;
+	forward_ = true;
+	upward_ = true;
+	slab_ = 0;
+	cell_ = 0;
+	cellLine_ = 0;
+	cellFirst_ = 0;
+	cellLast_ = -1;
+	theta_ = 0;
+	done_ = local_.size() < 3;
+}
+
+double CoveragePath::lineY(int i) const
+{
+	double margin = 0.5 * ((yMax_ - yMin_) - (lineCount_ - 1) * spacing_);
+	return yMin_ + margin + i * spacing_;
+}
+
+int CoveragePath::lineAtOrAbove(double y) const
+{
+	double margin = 0.5 * ((yMax_ - yMin_) - (lineCount_ - 1) * spacing_);
+	return std::max(0, (int)std::ceil((y - yMin_ - margin) / spacing_));
+}
+
+void CoveragePath::computeCrossings(double y)
+{
+	crossings_.clear();
+	int n = local_.size();
+	for (int i = 0, j = n - 1; i < n; j = i++)
+	{
+		const Eigen::Vector2d &a = local_[j], &b = local_[i];
+		if ((a(1) <= y) != (b(1) <= y))
+			crossings_.push_back(a(0) + (y - a(1)) * (b(0) - a(0)) / (b(1) - a(1)));
+	}
+	std::sort(crossings_.begin(), crossings_.end());
+}
+
+void CoveragePath::queue(double y, double x0, double x1)
+{
+	if (not forward_)
+		std::swap(x0, x1);
+	forward_ = not forward_;
+	pending_[0] = toWorld_ * Eigen::Vector2d(x0, y);
+	pending_[1] = toWorld_ * Eigen::Vector2d(x1, y);
+	pendingCount_ = 2;
+	pendingIndex_ = 0;
+}
+
+bool CoveragePath::nextLawnmower()
+{
+	while (line_ < lineCount_)
+	{
+		double y = lineY(line_++);
+		computeCrossings(y);
+		if (crossings_.size() >= 2)
+		{
+			queue(y, crossings_.front(), crossings_.back());
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CoveragePath::nextBoustrophedon()
+{
+	while (slab_ + 1 < (int)critical_.size())
+	{
+		// Start a cell: the lines of this slab, restricted to interval cell_
+		if (cellLine_ > cellLast_ - cellFirst_)
+		{
+			if (cellLast_ >= cellFirst_)
+			{
+				++cell_;
+				upward_ = not upward_;
+			}
+			cellFirst_ = lineAtOrAbove(critical_[slab_]);
+			cellLast_ = std::min(lineCount_, lineAtOrAbove(critical_[slab_ + 1])) - 1;
+			cellLine_ = 0;
+
+			// Slabs thinner than the spacing have no lines and are covered by their neighbors
+			bool empty = cellLast_ < cellFirst_;
+			if (not empty)
+			{
+				computeCrossings(lineY(cellFirst_));
+				empty = 2 * cell_ >= (int)crossings_.size();
+			}
+			if (empty)
+			{
+				++slab_;
+				cell_ = 0;
+				cellLast_ = -1;
+				cellLine_ = 0;
+				continue;
+			}
+		}
+
+		int i = upward_ ? cellFirst_ + cellLine_ : cellLast_ - cellLine_;
+		++cellLine_;
+		double y = lineY(i);
+		computeCrossings(y);
+		if (2 * cell_ + 1 < (int)crossings_.size())
+		{
+			queue(y, crossings_[2 * cell_], crossings_[2 * cell_ + 1]);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CoveragePath::nextSpiral(Eigen::Vector2d &point)
+{
+	// r = b * theta gives one spacing between turns
+	double b = spacing_ / (2 * M_PI);
+	while (b * theta_ <= rMax_ + spacing_)
+	{
+		double r = b * theta_;
+		Eigen::Vector2d p = center_ + r * Eigen::Vector2d(cos(theta_), sin(theta_));
+
+		// Advance about one spacing of arc length
+		theta_ += spacing_ / std::sqrt(r * r + b * b);
+
+		if (insideLocal(p))
+		{
+			point = toWorld_ * p;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CoveragePath::next(Eigen::Vector2d &point)
+{
+	if (done_)
+		return false;
+
+	if (pattern_ == SPIRAL)
+	{
+		done_ = not nextSpiral(point);
+		return not done_;
+	}
+
+	if (pendingIndex_ >= pendingCount_)
+	{
+		bool more = pattern_ == LAWNMOWER ? nextLawnmower() : nextBoustrophedon();
+		if (not more)
+		{
+			done_ = true;
+			return false;
+		}
+	}
+	point = pending_[pendingIndex_++];
+	return true;
+}
+
+bool CoveragePath::insideLocal(const Eigen::Vector2d &p) const
+{
+	bool in = false;
+	int n = local_.size();
+	for (int i = 0, j = n - 1; i < n; j = i++)
+	{
+		const Eigen::Vector2d &a = local_[j], &b = local_[i];
+		if ((a(1) <= p(1)) != (b(1) <= p(1)) and p(0) < a(0) + (p(1) - a(1)) * (b(0) - a(0)) / (b(1) - a(1)))
+			in = not in;
+	}
+	return in;
+}
+
+bool CoveragePath::inside(const Eigen::Vector2d &p) const
+{
+	return insideLocal(toWorld_.transpose() * p);
+}
+} // namespace bsc_common
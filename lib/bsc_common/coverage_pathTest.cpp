@@ -0,0 +1,116 @@
+#include "include/coverage_path.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using namespace bsc_common;
+
+// Distance from p to segment ab
+static double segDist(const Eigen::Vector2d &p, const Eigen::Vector2d &a, const Eigen::Vector2d &b)
+{
+	Eigen::Vector2d d = b - a;
+	double t = d.squaredNorm() > 0 ? std::min(1.0, std::max(0.0, (p - a).dot(d) / d.squaredNorm())) : 0;
+	return (p - a - t * d).norm();
+}
+
+/* Checks that every point of a grid inside the polygon is within maxDist of a leg,
+ * and that swept legs stay inside the polygon
+ */
+static int checkCoverage(const char *name, CoveragePath &cov, const CoveragePath::polygon_t &poly, double maxDist,
+												 bool legsInside)
+{
+	CoveragePath::polygon_t pts;
+	Eigen::Vector2d p;
+	cov.reset();
+	while (cov.next(p))
+		pts.push_back(p);
+
+	int failures = 0, outside = 0;
+	for (size_t i = 0; legsInside and i + 1 < pts.size(); i += 2)
+		if (not cov.inside(0.5 * (pts[i] + pts[i + 1])))
+			++outside;
+
+	Eigen::Vector2d lo = poly[0], hi = poly[0];
+	for (const Eigen::Vector2d &v : poly)
+	{
+		lo = lo.cwiseMin(v);
+		hi = hi.cwiseMax(v);
+	}
+	int uncovered = 0, samples = 0;
+	for (double x = lo(0); x <= hi(0); x += 0.37)
+		for (double y = lo(1); y <= hi(1); y += 0.37)
+		{
+			Eigen::Vector2d s(x, y);
+			if (not cov.inside(s))
+				continue;
+			++samples;
+			double best = 1e9;
+			for (size_t i = 0; i + 1 < pts.size(); ++i)
+				best = std::min(best, segDist(s, pts[i], pts[i + 1]));
+			if (best > maxDist)
+				++uncovered;
+		}
+	failures = uncovered + outside;
+	printf("%-14s %5d points, %d/%d samples uncovered, %d legs outside: %s\n", name, (int)pts.size(), uncovered, samples,
+				 outside, failures ? "FAIL" : "PASS");
+	return failures;
+}
+
+int main()
+{
+	int failures = 0;
+	CoveragePath cov;
+
+	// Rectangle lawnmower has the expected corners
+	CoveragePath::polygon_t rect = {{0, 0}, {10, 0}, {10, 4}, {0, 4}};
+	cov.setup(rect, CoveragePath::LAWNMOWER, 1);
+	double expected[][2] = {{0, .5}, {10, .5}, {10, 1.5}, {0, 1.5}, {0, 2.5}, {10, 2.5}, {10, 3.5}, {0, 3.5}};
+	Eigen::Vector2d p;
+	int n = 0;
+	while (cov.next(p))
+	{
+		if (n >= 8 or (p - Eigen::Vector2d(expected[n][0], expected[n][1])).norm() > 1e-9)
+			++failures;
+		++n;
+	}
+	printf("rectangle lawnmower: %d points %s\n", n, (failures or n != 8) ? "FAIL" : "PASS");
+	failures += n != 8;
+
+	// A U shaped field flown at an angle. Sweep lines leave the corner triangles of slanted
+	// edges up to a spacing away, and corners fall between the last spiral turns.
+	CoveragePath::polygon_t u = {{0, 0}, {30, 0}, {30, 20}, {20, 20}, {20, 8}, {10, 8}, {10, 20}, {0, 20}};
+	double spacing = 2;
+	cov.setup(u, CoveragePath::LAWNMOWER, spacing, 0.3);
+	failures += checkCoverage("lawnmower", cov, u, spacing, false);
+	cov.setup(u, CoveragePath::BOUSTROPHEDON, spacing, 0.3);
+	failures += checkCoverage("boustrophedon", cov, u, spacing, true);
+	cov.setup(u, CoveragePath::SPIRAL, spacing);
+	failures += checkCoverage("spiral", cov, u, 1.25 * spacing, false);
+
+	// A 5km square at 1m spacing streams without building the path
+	CoveragePath::polygon_t big = {{0, 0}, {5000, 0}, {5000, 5000}, {0, 5000}};
+	CoveragePath::Pattern patterns[] = {CoveragePath::LAWNMOWER, CoveragePath::BOUSTROPHEDON, CoveragePath::SPIRAL};
+	const char *names[] = {"lawnmower", "boustrophedon", "spiral"};
+	for (int k = 0; k < 3; ++k)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		cov.setup(big, patterns[k], 1);
+		auto t1 = std::chrono::steady_clock::now();
+		long count = 0;
+		double length = 0;
+		Eigen::Vector2d last(0, 0);
+		while (cov.next(p))
+		{
+			length += (p - last).norm();
+			last = p;
+			++count;
+		}
+		auto t2 = std::chrono::steady_clock::now();
+		printf("5km %-14s setup %.1f us, %ld points, %.0f km, %.3f us per point\n", names[k],
+					 std::chrono::duration<double, std::micro>(t1 - t0).count(), count, length / 1000,
+					 std::chrono::duration<double, std::micro>(t2 - t1).count() / count);
+	}
+
+	printf(failures ? "FAILED (%d)\n" : "PASSED\n", failures);
+	return failures != 0;
+}
@@ -0,0 +1,205 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the flight recorder
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/flight_recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace bsc_common
+{
+FlightRecorder::FlightRecorder(int ringSize)
+		: head_(0), tail_(0), ringDropped_(0), fileDropped_(0), open_(false), running_(false), written_(0)
+{
+	uint64_t size = 1;
+	while (size < (uint64_t)ringSize)
+		size <<= 1;
+	ring_.resize(size);
+	mask_ = size - 1;
+}
+
+FlightRecorder::~FlightRecorder()
+{
+	close();
+}
+
+int FlightRecorder::addType(const std::string &name, const std::string &fields)
+{
+	int count = fields.empty() ? 0 : (int)std::count(fields.begin(), fields.end(), ',') + 1;
+	std::string line = std::to_string(fieldCount_.size()) + " " + name + " " + fields + "\n";
+	if (open_ or count > MAX_FIELDS or (int)fieldCount_.size() >= MAX_TYPES or
+			schema_.size() + line.size() >= sizeof(header_t::schema))
+		return -1;
+	schema_ += line;
+	fieldCount_.push_back(count);
+	return (int)fieldCount_.size() - 1;
+}
+
+bool FlightRecorder::open(const std::string &path, size_t maxRecords, double flushPeriod)
+{
+	if (open_)
+		return false;
+
+	fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd_ < 0)
+		return false;
+
+	// Reserve the blocks now so a full disk fails here rather than in flight
+	mapSize_ = sizeof(header_t) + maxRecords * sizeof(record_t);
+	void *map = MAP_FAILED;
+	if (posix_fallocate(fd_, 0, mapSize_) == 0)
+		map = mmap(nullptr, mapSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+	if (map == MAP_FAILED)
+	{
+		::close(fd_);
+		fd_ = -1;
+		return false;
+	}
+
+	header_ = (header_t *)map;
+	records_ = (record_t *)((char *)map + sizeof(header_t));
+	memset(header_, 0, sizeof(header_t));
+	memcpy(header_->magic, "JYFLTREC", 8);
+	header_->version = 1;
+	header_->recordSize = sizeof(record_t);
+	header_->capacity = maxRecords;
+	memcpy(header_->schema, schema_.c_str(), schema_.size());
+
+	capacity_ = maxRecords;
+	flushPeriod_ = flushPeriod;
+	written_ = 0;
+	ringDropped_ = 0;
+	fileDropped_ = 0;
+	tail_ = head_.load();
+	running_ = true;
+	writer_ = std::thread(&FlightRecorder::writerLoop, this);
+	open_ = true;
+	return true;
+}
+
+void FlightRecorder::close()
+{
+	if (not open_)
+		return;
+	open_ = false;
+	running_ = false;
+	writer_.join();
+	flush();
+
+	header_->records = written_;
+	header_->dropped = dropped();
+	msync(header_, mapSize_, MS_SYNC);
+	munmap(header_, mapSize_);
+
+	// Trim the unused preallocation, records in the header marks the end if this fails
+	int trimmed = ftruncate(fd_, sizeof(header_t) + written_ * sizeof(record_t));
+	(void)trimmed;
+	::close(fd_);
+	fd_ = -1;
+	header_ = nullptr;
+	records_ = nullptr;
+}
+
+bool FlightRecorder::isOpen() const
+{
+	return open_.load(std::memory_order_relaxed);
+}
+
+uint64_t FlightRecorder::written() const
+{
+	return written_.load(std::memory_order_relaxed);
+}
+
+uint64_t FlightRecorder::dropped() const
+{
+	return ringDropped_.load(std::memory_order_relaxed) + fileDropped_.load(std::memory_order_relaxed);
+}
+
+bool FlightRecorder::record(int type, const double *values, int count)
+{
+	if (not open_.load(std::memory_order_relaxed))
+		return false;
+
+	uint64_t h = head_.load(std::memory_order_relaxed);
+	if (h - tail_.load(std::memory_order_acquire) > mask_)
+	{
+		ringDropped_.store(ringDropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	record_t &r = ring_[h & mask_];
+	r.stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+								std::chrono::system_clock::now().time_since_epoch())
+								.count();
+	r.type = (uint16_t)type;
+	r.count = (uint16_t)std::min(count, (int)MAX_FIELDS);
+	r.seq = (uint32_t)(h + ringDropped_.load(std::memory_order_relaxed));
+	memcpy(r.values, values, r.count * sizeof(double));
+	head_.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+bool FlightRecorder::record(int type, std::initializer_list<double> values)
+{
+	return record(type, values.begin(), (int)values.size());
+}
+
+void FlightRecorder::writerLoop()
+{
+	std::chrono::duration<double> period(flushPeriod_);
+	while (running_)
+	{
+		flush();
+		std::this_thread::sleep_for(period);
+	}
+}
+
+void FlightRecorder::flush()
+{
+	uint64_t t = tail_.load(std::memory_order_relaxed);
+	uint64_t h = head_.load(std::memory_order_acquire);
+	while (t < h)
+	{
+		// Contiguous run of the ring, up to its end
+		uint64_t n = std::min(h - t, mask_ + 1 - (t & mask_));
+		uint64_t fit = std::min<uint64_t>(n, capacity_ - written_);
+		memcpy(records_ + written_, &ring_[t & mask_], fit * sizeof(record_t));
+		written_ += fit;
+		if (fit < n)
+			fileDropped_.store(fileDropped_.load(std::memory_order_relaxed) + n - fit, std::memory_order_relaxed);
+		t += n;
+		tail_.store(t, std::memory_order_release);
+	}
+	header_->records = written_;
+}
+} // namespace bsc_common
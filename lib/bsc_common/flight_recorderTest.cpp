@@ -0,0 +1,185 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/flight_recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace bsc_common;
+
+static bool readFile(const char *path, FlightRecorder::header_t &header, std::vector<FlightRecorder::record_t> &records)
+{
+	FILE *f = fopen(path, "rb");
+	if (not f)
+		return false;
+	bool ok = fread(&header, sizeof(header), 1, f) == 1;
+	records.resize(ok ? header.records : 0);
+	if (ok and header.records)
+		ok = fread(records.data(), sizeof(FlightRecorder::record_t), header.records, f) == header.records;
+	fclose(f);
+	return ok;
+}
+
+int main()
+{
+	int failures = 0;
+	const char *path = "/tmp/flight_recorderTest.bin";
+
+	// Full rate, every record should make it to the file in order
+	{
+		FlightRecorder recorder(1 << 16);
+		int state = recorder.addType("state", "x,y,z,w");
+		int mode = recorder.addType("mode", "mode");
+		if (recorder.addType("wide", "a,b,c,d,e,f,g,h,i,j,k,l,m,n,o") != -1)
+		{
+			printf("  FAIL: accepted too many fields\n");
+			++failures;
+		}
+		if (not recorder.open(path, 2000000, 0.002))
+		{
+			printf("  FAIL: open %s\n", path);
+			return 1;
+		}
+		if (recorder.addType("late", "a") != -1)
+		{
+			printf("  FAIL: accepted a type after open\n");
+			++failures;
+		}
+
+		const int n = 1000000;
+		double worst = 0, busy = 0;
+		int refused = 0, slow = 0;
+		for (int k = 0; k < n; ++k)
+		{
+			auto s = std::chrono::steady_clock::now();
+			bool ok = k % 10 ? recorder.record(state, {(double)k, 1, 2, 3}) : recorder.record(mode, {(double)k});
+			auto e = std::chrono::steady_clock::now();
+			double us = std::chrono::duration<double, std::micro>(e - s).count();
+			worst = std::max(worst, us);
+			busy += us;
+			slow += us > 5;
+			refused += not ok;
+			// Roughly a fast control loop, lets the writer keep up
+			if (k % 64 == 63)
+				std::this_thread::sleep_for(std::chrono::microseconds(20));
+		}
+		recorder.close();
+		printf("recorded %i, mean %1.0fns, worst %1.2fus, %i over 5us, dropped %lu\n", n, 1000 * busy / n, worst, slow,
+					 (unsigned long)recorder.dropped());
+
+		FlightRecorder::header_t header;
+		std::vector<FlightRecorder::record_t> records;
+		if (not readFile(path, header, records))
+		{
+			printf("  FAIL: read back\n");
+			return 1;
+		}
+		if (strncmp(header.magic, "JYFLTREC", 8) or header.recordSize != sizeof(FlightRecorder::record_t))
+		{
+			printf("  FAIL: header\n");
+			++failures;
+		}
+		if (std::string(header.schema) != "0 state x,y,z,w\n1 mode mode\n")
+		{
+			printf("  FAIL: schema \"%s\"\n", header.schema);
+			++failures;
+		}
+		if (header.records + header.dropped != (uint64_t)n or (uint64_t)refused != header.dropped)
+		{
+			printf("  FAIL: %lu written + %lu dropped != %i\n", (unsigned long)header.records, (unsigned long)header.dropped, n);
+			++failures;
+		}
+
+		// Values and sequence numbers line up, gaps only where drops were counted
+		uint64_t gaps = 0;
+		bool ordered = true;
+		for (size_t i = 0; i < records.size(); ++i)
+		{
+			const FlightRecorder::record_t &r = records[i];
+			uint32_t expected = i ? records[i - 1].seq + 1 : 0;
+			gaps += r.seq - expected;
+			ordered &= r.values[0] == r.seq and r.type == (r.seq % 10 ? state : mode) and r.count == (r.seq % 10 ? 4 : 1);
+			ordered &= not i or r.stamp >= records[i - 1].stamp;
+		}
+		if (not ordered or gaps + (n - 1 - (records.empty() ? 0 : records.back().seq)) != header.dropped)
+		{
+			printf("  FAIL: records out of order or gaps do not match drops\n");
+			++failures;
+		}
+	}
+
+	// Tiny ring with nobody draining it fast enough, record must refuse instead of waiting
+	{
+		FlightRecorder recorder(16);
+		int type = recorder.addType("burst", "k");
+		recorder.open(path, 1000, 1);
+		const int n = 1000;
+		int refused = 0;
+		double worst = 0;
+		for (int k = 0; k < n; ++k)
+		{
+			auto s = std::chrono::steady_clock::now();
+			refused += not recorder.record(type, {(double)k});
+			auto e = std::chrono::steady_clock::now();
+			worst = std::max(worst, std::chrono::duration<double, std::micro>(e - s).count());
+		}
+		uint64_t dropped = recorder.dropped();
+		recorder.close();
+		printf("burst of %i into 16: refused %i, worst record %1.2fus\n", n, refused, worst);
+		if (refused < n - 32 or dropped != (uint64_t)refused or recorder.written() + dropped != (uint64_t)n)
+		{
+			printf("  FAIL: drops not counted\n");
+			++failures;
+		}
+	}
+
+	// File smaller than the run, extra records are dropped and counted
+	{
+		FlightRecorder recorder(1024);
+		int type = recorder.addType("fill", "k");
+		recorder.open(path, 100, 0.001);
+		for (int k = 0; k < 500; ++k)
+			recorder.record(type, {(double)k});
+		recorder.close();
+		if (recorder.written() != 100 or recorder.dropped() != 400)
+		{
+			printf("  FAIL: full file wrote %lu dropped %lu\n", (unsigned long)recorder.written(),
+						 (unsigned long)recorder.dropped());
+			++failures;
+		}
+		if (recorder.record(type, {1}))
+		{
+			printf("  FAIL: recorded while closed\n");
+			++failures;
+		}
+	}
+
+	remove(path);
+	printf(failures ? "%i FAILURES\n" : "PASSED\n", failures);
+	return failures ? 1 : 0;
+}
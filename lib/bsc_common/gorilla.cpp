@@ -0,0 +1,317 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the Gorilla time series codec
+ * 
+ * Author: Brennan Cain
+ */
+#include "include/gorilla.h"
+#include <algorithm>
+#include <cstring>
+
+namespace bsc_common
+{
+namespace gorilla
+{
+namespace
+{
+// Time buckets: prefix, prefix length, bits of the delta of delta
+struct bucket_t
+{
+	uint64_t prefix;
+	int prefixBits, bits;
+};
+const bucket_t BUCKETS[] = {{0b10, 2, 7}, {0b110, 3, 12}, {0b1110, 4, 20}, {0b11110, 5, 32}, {0b11111, 5, 64}};
+const int N_BUCKETS = sizeof(BUCKETS) / sizeof(BUCKETS[0]);
+
+const int WINDOW_BITS = 11; // lead and length of a new value window
+
+inline bool fits(int64_t v, int bits)
+{
+	return bits == 64 or (v >= -(int64_t(1) << (bits - 1)) and v < (int64_t(1) << (bits - 1)));
+}
+
+inline int64_t signExtend(uint64_t v, int bits)
+{
+	return bits == 64 ? (int64_t)v : (int64_t)(v << (64 - bits)) >> (64 - bits);
+}
+
+inline uint64_t mask(int bits)
+{
+	return bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+}
+} // namespace
+
+void BitWriter::write(uint64_t bits, int count)
+{
+	if (count > 56)
+	{
+		write(bits >> 32, count - 32);
+		count = 32;
+	}
+
+	// OR into the 8 bytes holding the next bit, the bytes past it are zero
+	size_t byte = bits_ >> 3;
+	if (byte + 8 > bytes_.size())
+		bytes_.resize(std::max<size_t>(64, 2 * bytes_.size()), 0);
+	uint64_t word;
+	memcpy(&word, &bytes_[byte], 8);
+	word = __builtin_bswap64(word) | (bits & mask(count)) << (64 - (bits_ & 7) - count);
+	word = __builtin_bswap64(word);
+	memcpy(&bytes_[byte], &word, 8);
+	bits_ += count;
+}
+
+void BitWriter::clear()
+{
+	memset(bytes_.data(), 0, std::min(bytes_.size(), size() + 1));
+	bits_ = 0;
+}
+
+const uint8_t *BitWriter::data() const
+{
+	return bytes_.data();
+}
+
+size_t BitWriter::size() const
+{
+	return (bits_ + 7) >> 3;
+}
+
+size_t BitWriter::bits() const
+{
+	return bits_;
+}
+
+BitReader::BitReader(const uint8_t *data, size_t size) : data_(data), size_(size)
+{
+}
+
+uint64_t BitReader::read(int count)
+{
+	if (count > 56)
+	{
+		uint64_t high = read(count - 32);
+		return high << 32 | read(32);
+	}
+	if (not count)
+		return 0;
+
+	size_t byte = pos_ >> 3;
+	if (pos_ + count > size_ * 8)
+	{
+		ok_ = false;
+		return 0;
+	}
+	uint64_t word = 0;
+	if (byte + 8 <= size_)
+	{
+		memcpy(&word, data_ + byte, 8);
+		word = __builtin_bswap64(word);
+	}
+	else
+		for (size_t i = byte; i < size_; ++i)
+			word |= (uint64_t)data_[i] << (56 - 8 * (i - byte));
+	uint64_t v = (word << (pos_ & 7)) >> (64 - count);
+	pos_ += count;
+	return v;
+}
+
+bool BitReader::ok() const
+{
+	return ok_;
+}
+
+void TimeCodec::reset()
+{
+	prev_ = delta_ = 0;
+}
+
+void TimeCodec::encode(BitWriter &out, int64_t t)
+{
+	int64_t delta = t - prev_, dod = delta - delta_;
+	prev_ = t;
+	delta_ = delta;
+	if (dod == 0)
+	{
+		out.write(0, 1);
+		return;
+	}
+	for (const bucket_t &b : BUCKETS)
+		if (fits(dod, b.bits))
+		{
+			if (b.prefixBits + b.bits <= 56)
+				out.write(b.prefix << b.bits | ((uint64_t)dod & mask(b.bits)), b.prefixBits + b.bits);
+			else
+			{
+				out.write(b.prefix, b.prefixBits);
+				out.write((uint64_t)dod & mask(b.bits), b.bits);
+			}
+			return;
+		}
+}
+
+int64_t TimeCodec::decode(BitReader &in)
+{
+	int64_t dod = 0;
+	if (in.read(1))
+	{
+		// Count further ones to find the bucket
+		int ones = 1;
+		while (ones < N_BUCKETS and in.read(1))
+			++ones;
+		int bits = BUCKETS[ones - 1].bits;
+		dod = signExtend(in.read(bits), bits);
+	}
+	delta_ += dod;
+	prev_ += delta_;
+	return prev_;
+}
+
+void ValueCodec::reset()
+{
+	prev_ = 0;
+	lead_ = -1;
+	trail_ = 0;
+}
+
+void ValueCodec::encode(BitWriter &out, double v)
+{
+	uint64_t cur;
+	memcpy(&cur, &v, sizeof(cur));
+	uint64_t x = cur ^ prev_;
+	prev_ = cur;
+	if (not x)
+	{
+		out.write(0, 1);
+		return;
+	}
+
+	int lead = std::min(__builtin_clzll(x), 31), trail = __builtin_ctzll(x);
+	int bits = 64 - lead - trail;
+	if (lead_ >= 0 and lead >= lead_ and trail >= trail_ and 64 - lead_ - trail_ - bits <= WINDOW_BITS)
+	{
+		// Fits the previous window, without wasting more than a new window costs
+		bits = 64 - lead_ - trail_;
+		if (bits <= 54)
+			out.write(uint64_t(0b10) << bits | x >> trail_, bits + 2);
+		else
+		{
+			out.write(0b10, 2);
+			out.write(x >> trail_, bits);
+		}
+		return;
+	}
+	out.write(0b11 << 11 | lead << 6 | (bits & 63), 13); // 64 wraps to 0
+	out.write(x >> trail, bits);
+	lead_ = lead;
+	trail_ = trail;
+}
+
+double ValueCodec::decode(BitReader &in)
+{
+	if (in.read(1))
+	{
+		if (in.read(1))
+		{
+			int window = in.read(11);
+			lead_ = window >> 6;
+			int bits = window & 63 ? window & 63 : 64;
+			trail_ = std::max(64 - lead_ - bits, 0);
+		}
+		int bits = 64 - lead_ - trail_;
+		prev_ ^= bits > 0 ? in.read(bits) << trail_ : 0;
+	}
+	double v;
+	memcpy(&v, &prev_, sizeof(v));
+	return v;
+}
+} // namespace gorilla
+
+GorillaEncoder::GorillaEncoder(int columns) : values_(columns)
+{
+}
+
+void GorillaEncoder::append(int64_t t, const double *values)
+{
+	time_.encode(out_, t);
+	for (size_t c = 0; c < values_.size(); ++c)
+		values_[c].encode(out_, values[c]);
+	++rows_;
+}
+
+void GorillaEncoder::reset()
+{
+	out_.clear();
+	time_.reset();
+	for (gorilla::ValueCodec &v : values_)
+		v.reset();
+	rows_ = 0;
+}
+
+const uint8_t *GorillaEncoder::data() const
+{
+	return out_.data();
+}
+
+size_t GorillaEncoder::size() const
+{
+	return out_.size();
+}
+
+size_t GorillaEncoder::rows() const
+{
+	return rows_;
+}
+
+int GorillaEncoder::columns() const
+{
+	return values_.size();
+}
+
+GorillaDecoder::GorillaDecoder(int columns) : values_(columns)
+{
+}
+
+void GorillaDecoder::reset(const uint8_t *data, size_t size, size_t rows)
+{
+	in_ = gorilla::BitReader(data, size);
+	time_.reset();
+	for (gorilla::ValueCodec &v : values_)
+		v.reset();
+	rows_ = rows;
+}
+
+bool GorillaDecoder::next(int64_t &t, double *values)
+{
+	if (not rows_)
+		return false;
+	t = time_.decode(in_);
+	for (size_t c = 0; c < values_.size(); ++c)
+		values[c] = values_[c].decode(in_);
+	--rows_;
+	return in_.ok();
+}
+} // namespace bsc_common
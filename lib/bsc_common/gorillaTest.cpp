@@ -0,0 +1,253 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/gorilla.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace bsc_common;
+
+static bool same(double a, double b)
+{
+	return not memcmp(&a, &b, sizeof(a));
+}
+
+// The byte aligned XOR codec column_store used before, for comparison
+static size_t byteXorSize(const std::vector<int64_t> &t, const std::vector<double> &v, int columns)
+{
+	size_t size = 0;
+	int64_t prevT = 0, delta = 0;
+	std::vector<uint64_t> prev(columns, 0);
+	for (size_t r = 0; r < t.size(); ++r)
+	{
+		int64_t d = t[r] - prevT, dod = d - delta;
+		uint64_t z = ((uint64_t)dod << 1) ^ (uint64_t)(dod >> 63);
+		do
+			++size;
+		while (z >>= 7);
+		prevT = t[r];
+		delta = d;
+		for (int c = 0; c < columns; ++c)
+		{
+			uint64_t cur;
+			memcpy(&cur, &v[r * columns + c], 8);
+			uint64_t x = cur ^ prev[c];
+			prev[c] = cur;
+			size += x ? 9 - __builtin_clzll(x) / 8 - __builtin_ctzll(x) / 8 : 1;
+		}
+	}
+	return size;
+}
+
+/**
+ * Synthetic flight at 50Hz: float32 sensor fields like the DJI topics, smooth doubles
+ * like the filtered state, sticks held between moves, and a mode that rarely changes
+ */
+static void flight(size_t rows, bool jitter, std::vector<int64_t> &t, std::vector<double> &v, int &columns)
+{
+	std::mt19937 rng(7);
+	std::normal_distribution<double> noise(0, 1);
+	columns = 14;
+	t.resize(rows);
+	v.resize(rows * columns);
+	int64_t stamp = 1500000000LL * 1000000000LL;
+	float stick = 0;
+	for (size_t r = 0; r < rows; ++r)
+	{
+		double s = r * .02;
+		stamp += 20000000 + (jitter ? (int64_t)(noise(rng) * 200000) : 0);
+		t[r] = stamp;
+		double *row = &v[r * columns];
+		// Position and velocity from a float32 topic
+		row[0] = (float)(10 * sin(s * .1) + .01 * noise(rng));
+		row[1] = (float)(10 * cos(s * .1) + .01 * noise(rng));
+		row[2] = (float)(5 + .02 * noise(rng));
+		row[3] = (float)(cos(s * .1) + .05 * noise(rng));
+		row[4] = (float)(-sin(s * .1) + .05 * noise(rng));
+		row[5] = (float)(.05 * noise(rng));
+		// Attitude quaternion
+		row[6] = (float)cos(s * .05);
+		row[7] = (float)(.01 * noise(rng));
+		row[8] = (float)(.01 * noise(rng));
+		row[9] = (float)sin(s * .05);
+		// Filtered double state
+		row[10] = 10 * sin(s * .1);
+		row[11] = 0.3 * s;
+		// Stick held for about a second at a time
+		if (r % 50 == 0)
+			stick = std::round((float)noise(rng) * 100) / 100;
+		row[12] = stick;
+		row[13] = r < rows / 2 ? 2 : 3;
+	}
+}
+
+int main()
+{
+	int failures = 0;
+
+	// Round trip on awkward values and time steps
+	{
+		double v[] = {0, -0.0, 1, 1, NAN, -NAN, INFINITY, -INFINITY, -1e300, 5e-324, 3.14159, 3.14159f, 1e15 + 1, 0};
+		int64_t t[] = {0, 1, 2, 2, -5, INT64_MAX / 2, INT64_MIN / 2, 40, 41, 42, 43, 44, 45, INT64_MAX};
+		const size_t n = sizeof(v) / sizeof(v[0]);
+		GorillaEncoder enc(2);
+		for (size_t i = 0; i < n; ++i)
+		{
+			double row[2] = {v[i], v[n - 1 - i]};
+			enc.append(t[i], row);
+		}
+		GorillaDecoder dec(2);
+		dec.reset(enc.data(), enc.size(), enc.rows());
+		bool ok = true;
+		int64_t t2;
+		double row[2];
+		for (size_t i = 0; ok and i < n; ++i)
+			ok = dec.next(t2, row) and t2 == t[i] and same(row[0], v[i]) and same(row[1], v[n - 1 - i]);
+		ok = ok and not dec.next(t2, row);
+		if (not ok)
+		{
+			++failures;
+			printf("  FAIL: round trip\n");
+		}
+
+		// A short block must not decode
+		size_t left = 0;
+		for (dec.reset(enc.data(), enc.size() - 1, enc.rows()); dec.next(t2, row);)
+			++left;
+		if (left == n)
+		{
+			++failures;
+			printf("  FAIL: truncated block decoded\n");
+		}
+	}
+
+	// Random bit patterns, every width of XOR and every time bucket
+	{
+		std::mt19937_64 rng(3);
+		const size_t n = 20000;
+		std::vector<int64_t> t(n);
+		std::vector<double> v(n * 3);
+		int64_t stamp = 0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			int shift = rng() % 64;
+			stamp += (int64_t)(rng() >> shift) * (rng() & 1 ? 1 : -1);
+			t[i] = stamp;
+			uint64_t bits = i ? 0 : rng();
+			memcpy(&bits, &v[(i ? i - 1 : 0) * 3], 8);
+			bits ^= rng() >> (rng() % 64) << (rng() % 64);
+			memcpy(&v[i * 3], &bits, 8);
+			v[i * 3 + 1] = (double)(rng() % 5);
+			v[i * 3 + 2] = (float)(rng() >> 11) * 1e-10;
+		}
+		GorillaEncoder enc(3);
+		for (size_t i = 0; i < n; ++i)
+			enc.append(t[i], &v[i * 3]);
+		GorillaDecoder dec(3);
+		dec.reset(enc.data(), enc.size(), enc.rows());
+		bool ok = true;
+		for (size_t i = 0; ok and i < n; ++i)
+		{
+			int64_t t2;
+			double row[3];
+			ok = dec.next(t2, row) and t2 == t[i] and same(row[0], v[i * 3]) and same(row[1], v[i * 3 + 1]) and
+					 same(row[2], v[i * 3 + 2]);
+			if (not ok)
+				printf("  FAIL: random round trip at row %zu\n", i);
+		}
+		failures += not ok;
+	}
+
+	// Reset starts an independent block
+	{
+		GorillaEncoder enc(1);
+		double a = 1, b = 2;
+		enc.append(10, &a);
+		enc.reset();
+		enc.append(20, &b);
+		GorillaDecoder dec(1);
+		dec.reset(enc.data(), enc.size(), enc.rows());
+		int64_t t;
+		double v;
+		if (not dec.next(t, &v) or t != 20 or v != 2 or enc.rows() != 1)
+		{
+			++failures;
+			printf("  FAIL: reset\n");
+		}
+	}
+
+	// Compression and throughput on flight like data
+	for (int jitter = 0; jitter < 2; ++jitter)
+	{
+		const size_t n = 500000;
+		std::vector<int64_t> t;
+		std::vector<double> v;
+		int columns;
+		flight(n, jitter, t, v, columns);
+
+		GorillaEncoder enc(columns);
+		for (size_t r = 0; r < n; ++r)
+			enc.append(t[r], &v[r * columns]); // warm up the buffer
+		enc.reset();
+		auto s = std::chrono::steady_clock::now();
+		for (size_t r = 0; r < n; ++r)
+			enc.append(t[r], &v[r * columns]);
+		auto e = std::chrono::steady_clock::now();
+		double encodeMs = std::chrono::duration<double, std::milli>(e - s).count();
+
+		GorillaDecoder dec(columns);
+		std::vector<double> row(columns);
+		bool ok = true;
+		s = std::chrono::steady_clock::now();
+		dec.reset(enc.data(), enc.size(), enc.rows());
+		for (size_t r = 0; r < n; ++r)
+		{
+			int64_t t2;
+			ok = dec.next(t2, row.data()) and ok and t2 == t[r] and not memcmp(row.data(), &v[r * columns], 8 * columns);
+		}
+		e = std::chrono::steady_clock::now();
+		double decodeMs = std::chrono::duration<double, std::milli>(e - s).count();
+		if (not ok)
+		{
+			++failures;
+			printf("  FAIL: flight round trip\n");
+		}
+
+		double raw = 8.0 * (columns + 1), packed = (double)enc.size() / n, byteXor = (double)byteXorSize(t, v, columns) / n;
+		printf("%s times: %.1f bytes/row vs %.0f raw (%.1fx), byte XOR %.1f (%.1fx)\n", jitter ? "jittered" : "steady",
+					 packed, raw, raw / packed, byteXor, raw / byteXor);
+		printf("  encode %.0fns/row (%.0fM values/s), decode %.0fns/row (%.0fM values/s)\n", 1e6 * encodeMs / n,
+					 n * (columns + 1) / encodeMs / 1e3, 1e6 * decodeMs / n, n * (columns + 1) / decodeMs / 1e3);
+	}
+
+	if (failures)
+		printf("%i FAILURES\n", failures);
+	else
+		printf("PASSED\n");
+	return failures;
+}
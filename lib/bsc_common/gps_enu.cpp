@@ -56,11 +56,22 @@ void GPS_ENU::setENUOrigin(double lat, double lon, double alt)
 	this->R(2, 0) = cPhi * cLmd;
 	this->R(2, 1) = cPhi * sLmd;
 	this->R(2, 2) = sPhi;
+
+	// Build the local expansion
+	double W = 1 - this->e2 * sPhi * sPhi;
+	double N = this->a / std::sqrt(W);
+	double M = this->a * (1 - this->e2) / (W * std::sqrt(W));
+
+	this->mh0 = M + this->altZero;
+	this->halfdM0 = 1.5 * M * this->e2 * sPhi * cPhi / W;
+	this->r0 = (N + this->altZero) * cPhi;
+	this->sPhi0 = sPhi;
+	this->cPhi0 = cPhi;
 }
 Eigen::Matrix<double, 3, 1> GPS_ENU::geo2ecef(double lat, double lon, double alt)
 {
-	double phi = this->latZero * M_PI / 180.0;
-	double lmd = this->lonZero * M_PI / 180.0;
+	double phi = lat * M_PI / 180.0;
+	double lmd = lon * M_PI / 180.0;
 
 	double cPhi = std::cos(phi);
 	double cLmd = std::cos(lmd);
@@ -90,4 +101,44 @@ Eigen::Matrix<double, 3, 1> GPS_ENU::geo2enu(double lat, double lon, double alt)
 
 	return ecef2enu(ecef(0, 0), ecef(1, 0), ecef(2, 0));
 }
+enu_result_t GPS_ENU::geo2enuFast(double lat, double lon, double alt)
+{
+	enu_result_t res;
+
+	double u = (lat - this->latZero) * M_PI / 180.0;
+	double v = (lon - this->lonZero) * M_PI / 180.0;
+	double dh = alt - this->altZero;
+
+	// Shortest way across the antimeridian
+	if (v >= M_PI)
+		v -= 2 * M_PI;
+	else if (v < -M_PI)
+		v += 2 * M_PI;
+
+	double theta = std::fabs(u) + std::fabs(v);
+	res.errorBound = (this->a + std::fabs(this->altZero)) * theta * theta * theta + std::fabs(dh) * theta * theta;
+
+	if (res.errorBound < this->fastTolerance)
+	{
+		res.path = enu_result_t::LOCAL;
+		res.enu(0) = v * (this->r0 - this->mh0 * this->sPhi0 * u + this->cPhi0 * dh);
+		res.enu(1) = u * (this->mh0 + this->halfdM0 * u + dh) + 0.5 * this->sPhi0 * this->r0 * v * v;
+		res.enu(2) = dh - 0.5 * (this->mh0 * u * u + this->cPhi0 * this->r0 * v * v);
+	}
+	else
+	{
+		res.path = enu_result_t::EXACT;
+		res.errorBound = 0;
+		res.enu = geo2enu(lat, lon, alt);
+	}
+	return res;
+}
+void GPS_ENU::setFastTolerance(double meters)
+{
+	this->fastTolerance = meters;
+}
+double GPS_ENU::getFastTolerance()
+{
+	return this->fastTolerance;
+}
 } // namespace bsc_common
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "include/gps_enu.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+int main()
+{
+	bsc_common::GPS_ENU enu;
+	double origins[][3] = {{34.0, -81.0, 100}, {0.0, 179.99, 0}, {-60.0, 20.0, 2000}, {85.0, 10.0, 50}};
+	std::srand(0);
+
+	// Check the bound of the local expansion against the exact path
+	bool ok = true;
+	for (auto &o : origins)
+	{
+		enu.setENUOrigin(o[0], o[1], o[2]);
+		enu.setFastTolerance(1e9);
+		double worstRatio = 0, worstErr = 0;
+		for (int i = 0; i < 100000; ++i)
+		{
+			double lat = o[0] + (std::rand() / (double)RAND_MAX - .5) * .2;
+			double lon = o[1] + (std::rand() / (double)RAND_MAX - .5) * .2;
+			double alt = o[2] + (std::rand() / (double)RAND_MAX - .5) * 400;
+			bsc_common::enu_result_t fast = enu.geo2enuFast(lat, lon, alt);
+			double err = (fast.enu - enu.geo2enu(lat, lon, alt)).norm();
+			if (err > fast.errorBound + 1e-6)
+				ok = false;
+			if (fast.errorBound > 1e-6 and err / fast.errorBound > worstRatio)
+				worstRatio = err / fast.errorBound;
+			if (fast.errorBound < 0.01 and err > worstErr)
+				worstErr = err;
+		}
+		std::cout << "origin " << o[0] << "," << o[1] << " worst err/bound " << worstRatio
+							<< " worst err within 1cm bound " << worstErr << std::endl;
+	}
+	std::cout << (ok ? "PASS" : "FAIL") << ": expansion error within bound" << std::endl;
+
+	// Compare throughput of both paths near the origin
+	enu.setENUOrigin(34.0, -81.0, 100);
+	enu.setFastTolerance(0.01);
+	const int n = 1000000;
+	double sink = 0;
+	int local = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; ++i)
+		sink += enu.geo2enu(34.0 + i * 1e-8, -81.0 + i * 1e-8, 100)(0);
+	auto t1 = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; ++i)
+	{
+		bsc_common::enu_result_t r = enu.geo2enuFast(34.0 + i * 1e-8, -81.0 + i * 1e-8, 100);
+		sink += r.enu(0);
+		local += r.path == bsc_common::enu_result_t::LOCAL;
+	}
+	auto t2 = std::chrono::steady_clock::now();
+
+	std::cout << "exact: " << std::chrono::duration<double, std::nano>(t1 - t0).count() / n << " ns/call\n";
+	std::cout << "fast:  " << std::chrono::duration<double, std::nano>(t2 - t1).count() / n << " ns/call ("
+						<< local << "/" << n << " local)\n";
+	std::cout << sink << std::endl;
+	return ok ? 0 : 1;
+}
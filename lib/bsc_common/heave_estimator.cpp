@@ -0,0 +1,337 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the heave estimator
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/heave_estimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace bsc_common
+{
+// Sum of e^(i d (j - c)) over a window of n ones centred on c
+static double dirichlet(double d, int n)
+{
+	double s = sin(d / 2);
+	return std::abs(s) < 1e-12 ? n : sin(d * n / 2) / s;
+}
+
+HeaveEstimator::HeaveEstimator(double rate, int window, double fMin, double fMax, int components)
+{
+	rate_ = rate;
+	window_ = window;
+	components_ = components;
+	samples_.resize(window_);
+
+	// Half bin spacing, with two extra frequencies at each end for the Hann window
+	double spacing = M_PI / window_;
+	double wMin = 2 * M_PI * fMin / rate_ - 2 * spacing;
+	bank_ = (int)ceil(2 * M_PI * (fMax - fMin) / rate_ / spacing) + 5;
+
+	w_.resize(bank_);
+	stepRe_.resize(bank_);
+	stepIm_.resize(bank_);
+	dropRe_.resize(bank_);
+	dropIm_.resize(bank_);
+	gRe_.resize(bank_);
+	gIm_.resize(bank_);
+	for (int k = 0; k < bank_; ++k)
+	{
+		w_[k] = wMin + k * spacing;
+		stepRe_[k] = cos(w_[k]);
+		stepIm_[k] = -sin(w_[k]);
+		dropRe_[k] = cos(w_[k] * window_);
+		dropIm_[k] = sin(w_[k] * window_);
+
+		// Geometric sum of e^(i w j) for j in [0, N)
+		double re = 0, im = 0;
+		for (int j = 0; j < window_; ++j)
+		{
+			re += cos(w_[k] * j);
+			im += sin(w_[k] * j);
+		}
+		gRe_[k] = re;
+		gIm_[k] = im;
+	}
+	binStepRe_ = cos(2 * M_PI / window_);
+	binStepIm_ = -sin(2 * M_PI / window_);
+
+	yRe_.resize(bank_);
+	yIm_.resize(bank_);
+	phRe_.resize(bank_);
+	phIm_.resize(bank_);
+	mRe_.resize(bank_);
+	mIm_.resize(bank_);
+	hRe_.resize(bank_);
+	hIm_.resize(bank_);
+	amp_.resize(bank_);
+
+	cRe_.resize(components_);
+	cIm_.resize(components_);
+	W_.resize(components_);
+	peakAmp_.resize(components_);
+	reset();
+}
+
+void HeaveEstimator::reset()
+{
+	std::fill(samples_.begin(), samples_.end(), 0);
+	std::fill(yRe_.begin(), yRe_.end(), 0);
+	std::fill(yIm_.begin(), yIm_.end(), 0);
+	std::fill(phRe_.begin(), phRe_.end(), 1);
+	std::fill(phIm_.begin(), phIm_.end(), 0);
+	std::fill(amp_.begin(), amp_.end(), 0);
+	binRe_ = 1;
+	binIm_ = 0;
+	head_ = count_ = sinceRebuild_ = peaks_ = 0;
+	sum_ = 0;
+	started_ = false;
+}
+
+bool HeaveEstimator::ready() const
+{
+	return count_ == window_;
+}
+
+int HeaveEstimator::components() const
+{
+	return peaks_;
+}
+
+double HeaveEstimator::frequency(int i) const
+{
+	return W_[i] / (2 * M_PI);
+}
+
+double HeaveEstimator::amplitude(int i) const
+{
+	return peakAmp_[i];
+}
+
+void HeaveEstimator::update(double t, double z)
+{
+	if (started_ and t - tLast_ > 1.0)
+		reset();
+	if (not started_)
+	{
+		started_ = true;
+		zRef_ = zLast_ = z;
+		tNext_ = t;
+	}
+	else if (t <= tLast_)
+		return;
+
+	// Hold the previous height until this update, then start holding this one
+	double dt = 1 / rate_;
+	bool pushed = false;
+	while (tNext_ < t - 1e-9)
+	{
+		push(zLast_ - zRef_);
+		tNext_ += dt;
+		pushed = true;
+	}
+	if (tNext_ - t < 1e-9)
+	{
+		push(z - zRef_);
+		tNext_ += dt;
+		pushed = true;
+	}
+	tLast_ = t;
+	zLast_ = z;
+
+	if (pushed and ready())
+		findPeaks();
+}
+
+void HeaveEstimator::push(double x)
+{
+	double old = samples_[head_];
+	samples_[head_] = x;
+	head_ = (head_ + 1) % window_;
+	count_ = std::min(count_ + 1, window_);
+	sum_ += x - old;
+
+	double bin = binRe_ * binStepRe_ - binIm_ * binStepIm_;
+	binIm_ = binRe_ * binStepIm_ + binIm_ * binStepRe_;
+	binRe_ = bin;
+
+	// Slide every correlation, separate arrays so this vectorizes
+	double *yRe = yRe_.data(), *yIm = yIm_.data(), *phRe = phRe_.data(), *phIm = phIm_.data();
+	const double *sRe = stepRe_.data(), *sIm = stepIm_.data(), *dRe = dropRe_.data(), *dIm = dropIm_.data();
+	for (int k = 0; k < bank_; ++k)
+	{
+		double re = phRe[k] * sRe[k] - phIm[k] * sIm[k];
+		double im = phRe[k] * sIm[k] + phIm[k] * sRe[k];
+		phRe[k] = re;
+		phIm[k] = im;
+		double oRe = re * dRe[k] - im * dIm[k];
+		double oIm = re * dIm[k] + im * dRe[k];
+		yRe[k] += x * re - old * oRe;
+		yIm[k] += x * im - old * oIm;
+	}
+
+	if (++sinceRebuild_ >= window_)
+		rebuild();
+}
+
+void HeaveEstimator::rebuild()
+{
+	// Renormalize the phasors and recompute the sums to clear rounding error
+	sum_ = 0;
+	for (int i = 0; i < count_; ++i)
+		sum_ += samples_[i];
+	double n = sqrt(binRe_ * binRe_ + binIm_ * binIm_);
+	binRe_ /= n;
+	binIm_ /= n;
+	for (int k = 0; k < bank_; ++k)
+	{
+		n = sqrt(phRe_[k] * phRe_[k] + phIm_[k] * phIm_[k]);
+		phRe_[k] /= n;
+		phIm_[k] /= n;
+
+		// Walk back from the newest sample, whose phasor is ph
+		double re = phRe_[k], im = phIm_[k], yRe = 0, yIm = 0;
+		for (int j = 0; j < window_; ++j)
+		{
+			double x = samples_[(head_ - 1 - j + window_) % window_];
+			yRe += x * re;
+			yIm += x * im;
+			double r = re * stepRe_[k] + im * stepIm_[k]; // times e^(i w)
+			im = im * stepRe_[k] - re * stepIm_[k];
+			re = r;
+		}
+		yRe_[k] = yRe;
+		yIm_[k] = yIm;
+	}
+	sinceRebuild_ = 0;
+}
+
+void HeaveEstimator::findPeaks()
+{
+	// Remove the window mean, the sum of e^(-i w m) over the window is ph G
+	double mean = sum_ / window_;
+	for (int k = 0; k < bank_; ++k)
+	{
+		mRe_[k] = yRe_[k] - mean * (phRe_[k] * gRe_[k] - phIm_[k] * gIm_[k]);
+		mIm_[k] = yIm_[k] - mean * (phRe_[k] * gIm_[k] + phIm_[k] * gRe_[k]);
+	}
+
+	// Hann window centred on the window, from the neighbours a bin away:
+	// H(w) = Y(w) / 2 + q Y(w - bin) / 4 + conj(q) Y(w + bin) / 4, q = e^(-i bin (n - (N-1)/2))
+	double a = M_PI * (window_ - 1) / window_;
+	double qRe = binRe_ * cos(a) - binIm_ * sin(a);
+	double qIm = binRe_ * sin(a) + binIm_ * cos(a);
+	for (int k = 2; k < bank_ - 2; ++k)
+	{
+		double lRe = mRe_[k - 2], lIm = mIm_[k - 2], rRe = mRe_[k + 2], rIm = mIm_[k + 2];
+		hRe_[k] = 0.5 * mRe_[k] + 0.25 * (qRe * lRe - qIm * lIm + qRe * rRe + qIm * rIm);
+		hIm_[k] = 0.5 * mIm_[k] + 0.25 * (qRe * lIm + qIm * lRe + qRe * rIm - qIm * rRe);
+		amp_[k] = 4 * sqrt(hRe_[k] * hRe_[k] + hIm_[k] * hIm_[k]) / window_;
+	}
+
+	// Keep the strongest local maxima
+	peaks_ = 0;
+	double bin = 2 * M_PI / window_;
+	for (int k = 3; k < bank_ - 3; ++k)
+	{
+		if (amp_[k] < amp_[k - 1] or amp_[k] <= amp_[k + 1])
+			continue;
+		int i = peaks_ < components_ ? peaks_++ : components_;
+		for (; i > 0 and peakAmp_[i - 1] < amp_[k]; --i)
+		{
+			if (i < components_)
+			{
+				peakAmp_[i] = peakAmp_[i - 1];
+				W_[i] = W_[i - 1];
+				cRe_[i] = cRe_[i - 1];
+				cIm_[i] = cIm_[i - 1];
+			}
+		}
+		if (i == components_)
+			continue;
+
+		// Refine the frequency between the neighbours of the peak with a parabola
+		double d = 0, den = amp_[k - 1] - 2 * amp_[k] + amp_[k + 1];
+		if (den < 0)
+			d = 0.5 * (amp_[k - 1] - amp_[k + 1]) / den * (w_[k + 1] - w_[k]);
+
+		// A sinusoid d off w shows up in H with the real gain of the window and a phase of d at its centre
+		double gain = 0.5 * dirichlet(d, window_) + 0.25 * (dirichlet(d + bin, window_) + dirichlet(d - bin, window_));
+		double scale = 2 / std::max(gain, 0.25 * window_);
+		double cd = cos(d * (window_ - 1) / 2), sd = sin(d * (window_ - 1) / 2);
+
+		// c = 2/gain H conj(ph) e^(i d (N-1)/2), so the component at the newest sample is Re(c)
+		double re = hRe_[k], im = hIm_[k];
+		double cr = scale * (re * phRe_[k] + im * phIm_[k]);
+		double ci = scale * (im * phRe_[k] - re * phIm_[k]);
+		peakAmp_[i] = scale * sqrt(re * re + im * im);
+		W_[i] = (w_[k] + d) * rate_;
+		cRe_[i] = cr * cd - ci * sd;
+		cIm_[i] = cr * sd + ci * cd;
+	}
+}
+
+void HeaveEstimator::predict(double dt, double &z, double &zdot) const
+{
+	// Time since the newest resampled sample
+	dt += tLast_ - (tNext_ - 1 / rate_);
+
+	z = zdot = 0;
+	for (int i = 0; i < peaks_; ++i)
+	{
+		double c = cos(W_[i] * dt), s = sin(W_[i] * dt);
+		z += cRe_[i] * c - cIm_[i] * s;
+		zdot -= W_[i] * (cRe_[i] * s + cIm_[i] * c);
+	}
+}
+
+double HeaveEstimator::quietIn(double duration, double maxSpeed, double horizon) const
+{
+	if (not ready())
+		return 0;
+
+	// Step at the resampling rate, looking for a run of quiet steps covering the duration
+	double dt = 1 / rate_;
+	int steps = (int)ceil(duration / dt - 1e-9), last = (int)floor(horizon / dt + 1e-9);
+	int start = 0;
+	for (int j = 0; j <= last + steps; ++j)
+	{
+		double z, zdot;
+		predict(j * dt, z, zdot);
+		if (std::abs(zdot) > maxSpeed)
+		{
+			start = j + 1;
+			if (start > last)
+				return -1;
+		}
+		else if (j - start >= steps)
+			return start * dt;
+	}
+	return -1;
+}
+} // namespace bsc_common
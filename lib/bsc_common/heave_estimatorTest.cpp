@@ -0,0 +1,159 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/heave_estimator.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace bsc_common;
+
+static double noise(double sigma)
+{
+	double s = 0;
+	for (int i = 0; i < 12; ++i)
+		s += (double)rand() / RAND_MAX;
+	return sigma * (s - 6);
+}
+
+// Two swells beating into wave groups, and a slow drift in height
+static double wave(double t, double &zdot)
+{
+	const double a1 = 0.3, f1 = 0.10, a2 = 0.25, f2 = 0.13;
+	zdot = a1 * 2 * M_PI * f1 * cos(2 * M_PI * f1 * t) + a2 * 2 * M_PI * f2 * cos(2 * M_PI * f2 * t + 1) + 0.002;
+	return a1 * sin(2 * M_PI * f1 * t) + a2 * sin(2 * M_PI * f2 * t + 1) + 0.002 * t + 12;
+}
+
+int main()
+{
+	srand(5);
+	int failures = 0;
+
+	HeaveEstimator heave;
+	const double rate = 17; // state updates do not line up with the resampling
+	const double quietTime = 1.5, quietSpeed = 0.1;
+
+	double errZ = 0, errV = 0, amp = 0;
+	int n = 0, predictedQuiet = 0, actuallyQuiet = 0, momentary = 0, momentaryQuiet = 0;
+	for (int k = 0; k < 600 * rate; ++k)
+	{
+		double t = k / rate + noise(0.002), zdot;
+		heave.update(t, wave(t, zdot) + noise(0.02));
+		if (not heave.ready() or k % 5 != 0)
+			continue;
+
+		// Heave over the next 3s, compared about the current height
+		double z0, v0;
+		heave.predict(0, z0, v0);
+		double tz;
+		double truth0 = wave(t, tz);
+		for (double dt = 0.5; dt <= 3; dt += 0.5)
+		{
+			double z, v, vt;
+			heave.predict(dt, z, v);
+			double truth = wave(t + dt, vt);
+			errZ += std::pow((z - z0) - (truth - truth0), 2);
+			errV += std::pow(v - vt, 2);
+			amp += std::pow(truth - truth0, 2);
+			++n;
+		}
+
+		// Quiet now according to the prediction and to the current speed
+		double maxSpeed = 0;
+		for (double dt = 0; dt <= quietTime; dt += 0.05)
+		{
+			double v;
+			wave(t + dt, v);
+			maxSpeed = std::max(maxSpeed, std::abs(v));
+		}
+		bool quiet = maxSpeed <= 1.5 * quietSpeed;
+		if (heave.quietIn(quietTime, quietSpeed, 0) == 0)
+		{
+			++predictedQuiet;
+			actuallyQuiet += quiet;
+		}
+		if (std::abs(tz + noise(0.05)) <= quietSpeed)
+		{
+			++momentary;
+			momentaryQuiet += quiet;
+		}
+	}
+	errZ = sqrt(errZ / n);
+	errV = sqrt(errV / n);
+	amp = sqrt(amp / n);
+	printf("components:");
+	for (int i = 0; i < heave.components(); ++i)
+		printf(" %1.3fHz %1.2fm", heave.frequency(i), heave.amplitude(i));
+	printf("\n3s prediction rms %1.3fm of %1.3fm motion, speed rms %1.3fm/s\n", errZ, amp, errV);
+	printf("quiet windows: predicted %i, %1.0f%% held; momentary %i, %1.0f%% held\n", predictedQuiet,
+				 100.0 * actuallyQuiet / predictedQuiet, momentary, 100.0 * momentaryQuiet / momentary);
+
+	if (std::abs(heave.frequency(0) - 0.10) > 0.01 or std::abs(heave.amplitude(0) - 0.3) > 0.05)
+	{
+		printf("  FAIL: dominant swell\n");
+		++failures;
+	}
+	if (errZ > 0.3 * amp)
+	{
+		printf("  FAIL: prediction\n");
+		++failures;
+	}
+	if (predictedQuiet == 0 or actuallyQuiet < 0.9 * predictedQuiet or
+			(double)actuallyQuiet / predictedQuiet <= (double)momentaryQuiet / momentary)
+	{
+		printf("  FAIL: quiet windows\n");
+		++failures;
+	}
+
+	// Flat water is always quiet
+	{
+		HeaveEstimator flat;
+		for (int k = 0; k < 1200; ++k)
+			flat.update(k * 0.1, 3 + noise(0.01));
+		if (flat.quietIn(quietTime, quietSpeed, 0) != 0)
+		{
+			printf("  FAIL: flat water\n");
+			++failures;
+		}
+	}
+
+	// Timing
+	{
+		const int m = 1000000;
+		auto t0 = std::chrono::steady_clock::now();
+		for (int k = 0; k < m; ++k)
+			heave.update(400 + k * 0.1, 0.01 * (k % 17));
+		auto t1 = std::chrono::steady_clock::now();
+		double sum = 0;
+		for (int k = 0; k < m / 100; ++k)
+			sum += heave.quietIn(quietTime, quietSpeed, 10);
+		auto t2 = std::chrono::steady_clock::now();
+		printf("update %1.3fus, quietIn %1.3fus (%g)\n", std::chrono::duration<double, std::micro>(t1 - t0).count() / m,
+					 std::chrono::duration<double, std::micro>(t2 - t1).count() / (m / 100), sum);
+	}
+
+	printf(failures ? "%i FAILURES\n" : "PASSED\n", failures);
+	return failures ? 1 : 0;
+}
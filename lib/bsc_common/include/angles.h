@@ -0,0 +1,132 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file provides branchless angle wrapping, difference, and mean kernels
+ * in radians and degrees. Batch versions work on contiguous arrays and are
+ * vectorized through Eigen.
+ *
+ * Wrapped angles are in [-pi, pi) or [-180, 180).
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_ANGLES_
+#define BSC_COMMON_ANGLES_
+#include <cmath>
+
+namespace bsc_common
+{
+namespace angles
+{
+static constexpr double PI = 3.14159265358979323846;
+static constexpr double TWO_PI = 2 * PI;
+
+/** wrapPeriod
+ * Wraps x into [-half, half). The selects compile to conditional moves and only
+ * correct the last ulp when the floor rounds across the boundary.
+ *
+ * @param x value to wrap
+ * @param half half of the period
+ * @param inv 1/(2*half)
+ */
+inline double wrapPeriod(double x, double half, double inv)
+{
+	double r = x - 2 * half * std::floor((x + half) * inv);
+	r = r >= half ? r - 2 * half : r;
+	return r < -half ? r + 2 * half : r;
+}
+
+/** wrap
+ * @param a angle in radians
+ * @return a in [-pi, pi)
+ */
+inline double wrap(double a)
+{
+	return wrapPeriod(a, PI, 1 / TWO_PI);
+}
+
+/** wrapDeg
+ * @param a angle in degrees
+ * @return a in [-180, 180)
+ */
+inline double wrapDeg(double a)
+{
+	return wrapPeriod(a, 180.0, 1 / 360.0);
+}
+
+/** diff
+ * Shortest angular distance from start to stop, CCW positive.
+ * ex. start=170deg, stop=-170deg => +20deg
+ *
+ * @return stop-start in [-pi, pi)
+ */
+inline double diff(double start, double stop)
+{
+	return wrap(stop - start);
+}
+
+inline double diffDeg(double start, double stop)
+{
+	return wrapDeg(stop - start);
+}
+
+/** mean
+ * Midpoint of the shortest arc between two angles
+ *
+ * @return mean angle in [-pi, pi)
+ */
+inline double mean(double a, double b)
+{
+	return wrap(a + 0.5 * diff(a, b));
+}
+
+inline double meanDeg(double a, double b)
+{
+	return wrapDeg(a + 0.5 * diffDeg(a, b));
+}
+
+/** wrap (batch)
+ * @param in n angles in radians
+ * @param out n wrapped angles, may alias in
+ */
+void wrap(const double *in, double *out, int n);
+void wrapDeg(const double *in, double *out, int n);
+
+/** diff (batch)
+ * out[i] = diff(start[i], stop[i])
+ */
+void diff(const double *start, const double *stop, double *out, int n);
+void diffDeg(const double *start, const double *stop, double *out, int n);
+
+/** circularMean
+ * Mean direction of n angles, atan2 of the summed unit vectors
+ *
+ * @return mean angle in [-pi, pi), 0 if the angles cancel out
+ */
+double circularMean(const double *in, int n);
+double circularMeanDeg(const double *in, int n);
+} // namespace angles
+} // namespace bsc_common
+
+#endif
@@ -0,0 +1,252 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides asynchronous logging for the control loops.
+ * A log call copies the format string pointer and the raw arguments into a lock free ring
+ * owned by the calling thread, then returns. A background thread formats the entries,
+ * applies per call site throttling and hands the text to a sink, which forwards it to
+ * rosout in the nodes. When a ring is full the message is dropped and counted.
+ *
+ * Formats must be string literals, they are used as the call site id and read later.
+ * String arguments are copied, up to TEXT_SIZE bytes per message.
+ *
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_ASYNC_LOG_
+#define BSC_COMMON_ASYNC_LOG_
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace bsc_common
+{
+class AsyncLog
+{
+public:
+	enum level_t
+	{
+		LEVEL_DEBUG,
+		LEVEL_INFO,
+		LEVEL_WARN,
+		LEVEL_ERROR
+	};
+
+	static const int MAX_ARGS = 8;
+	static const int TEXT_SIZE = 96;
+
+	typedef std::function<void(level_t, const char *)> sink_t;
+
+	/** Constructor
+	 * @param ringSize entries in each thread's ring, rounded up to a power of two
+	 */
+	AsyncLog(int ringSize = 1024);
+	~AsyncLog();
+
+	/** instance
+	 * @return log shared by the macros below
+	 */
+	static AsyncLog &instance();
+
+	/** start
+	 * Starts the formatting thread. Messages logged before start are kept until their ring fills.
+	 *
+	 * @param sink receives each formatted message on the formatting thread
+	 * @param flushPeriod seconds between passes over the rings
+	 */
+	void start(sink_t sink, double flushPeriod = 0.005);
+
+	/** stop
+	 * Stops the formatting thread after handing every queued message to the sink
+	 */
+	void stop();
+
+	/** log
+	 * Queues a message on the calling thread's ring without formatting it
+	 *
+	 * @param level severity
+	 * @param throttle shortest time between messages from this format, 0 for none (s)
+	 * @param format printf format, must outlive the log
+	 * @param args integers, floating point values, strings or pointers
+	 *
+	 * @return false if the message was dropped
+	 */
+	template <typename... Args>
+	bool log(level_t level, double throttle, const char *format, const Args &... args);
+
+	uint64_t dropped() const;
+
+private:
+	enum kind_t : uint8_t
+	{
+		INT,
+		UINT,
+		DOUBLE,
+		STRING,
+		POINTER
+	};
+
+	struct entry_t
+	{
+		const char *format;
+		int64_t stamp; // steady clock ns
+		float throttle;
+		uint8_t level, count, textUsed;
+		uint8_t kinds[MAX_ARGS];
+		union {
+			int64_t i;
+			uint64_t u;
+			double d;
+			const void *p;
+		} values[MAX_ARGS];
+		char text[TEXT_SIZE]; // copied string arguments, values hold offsets
+	};
+
+	// Single producer, single consumer ring owned by one thread
+	struct ring_t
+	{
+		std::thread::id owner;
+		std::vector<entry_t> entries;
+		std::atomic<uint64_t> head;
+		char padHead[56];
+		std::atomic<uint64_t> tail;
+		char padTail[56];
+		std::atomic<uint64_t> dropped; // written by the owner only
+	};
+
+	uint64_t ringSize_;
+	uint64_t id_; // tells instances apart in the thread local ring cache
+	std::mutex ringsMutex_;
+	std::vector<std::unique_ptr<ring_t>> rings_;
+
+	sink_t sink_;
+	std::thread worker_;
+	std::atomic<bool> running_;
+	double flushPeriod_;
+	uint64_t reportedDrops_ = 0;
+	std::vector<std::pair<const char *, int64_t>> lastSeen_; // last output time per throttled format
+
+	/** threadRing
+	 * @return ring of the calling thread, created on its first message
+	 */
+	ring_t *threadRing();
+	ring_t *registerThread();
+
+	void workerLoop();
+	void drain();
+	void format(const entry_t &e, char *out, size_t size) const;
+	bool throttled(const entry_t &e);
+
+	static void put(entry_t &) {}
+	template <typename T, typename... Rest>
+	static void put(entry_t &e, const T &v, const Rest &... rest)
+	{
+		if (e.count < MAX_ARGS)
+		{
+			set(e, v);
+			++e.count;
+		}
+		put(e, rest...);
+	}
+
+	template <typename T>
+	static typename std::enable_if<(std::is_integral<T>::value and std::is_signed<T>::value) or std::is_enum<T>::value>::type
+	set(entry_t &e, T v)
+	{
+		e.kinds[e.count] = INT;
+		e.values[e.count].i = (int64_t)v;
+	}
+	template <typename T>
+	static typename std::enable_if<std::is_integral<T>::value and not std::is_signed<T>::value>::type set(entry_t &e, T v)
+	{
+		e.kinds[e.count] = UINT;
+		e.values[e.count].u = (uint64_t)v;
+	}
+	template <typename T>
+	static typename std::enable_if<std::is_floating_point<T>::value>::type set(entry_t &e, T v)
+	{
+		e.kinds[e.count] = DOUBLE;
+		e.values[e.count].d = v;
+	}
+	template <typename T>
+	static void set(entry_t &e, const T *v)
+	{
+		e.kinds[e.count] = POINTER;
+		e.values[e.count].p = v;
+	}
+	static void set(entry_t &e, const char *s);
+	static void set(entry_t &e, char *s) { set(e, (const char *)s); }
+};
+
+template <typename... Args>
+bool AsyncLog::log(level_t level, double throttle, const char *format, const Args &... args)
+{
+	ring_t *ring = threadRing();
+	uint64_t h = ring->head.load(std::memory_order_relaxed);
+	if (h - ring->tail.load(std::memory_order_acquire) >= ringSize_)
+	{
+		ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	entry_t &e = ring->entries[h & (ringSize_ - 1)];
+	e.format = format;
+	e.stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+								.count();
+	e.throttle = (float)throttle;
+	e.level = (uint8_t)level;
+	e.count = 0;
+	e.textUsed = 0;
+	put(e, args...);
+	ring->head.store(h + 1, std::memory_order_release);
+	return true;
+}
+} // namespace bsc_common
+
+// The dead printf keeps the compiler's format checking at each call site
+#define BSC_LOG(level, throttle, ...)                                                         \
+	do                                                                                          \
+	{                                                                                           \
+		if (false)                                                                                \
+			printf(__VA_ARGS__);                                                                    \
+		bsc_common::AsyncLog::instance().log(bsc_common::AsyncLog::level, throttle, __VA_ARGS__); \
+	} while (0)
+
+#define ASYNC_DEBUG(...) BSC_LOG(LEVEL_DEBUG, 0, __VA_ARGS__)
+#define ASYNC_INFO(...) BSC_LOG(LEVEL_INFO, 0, __VA_ARGS__)
+#define ASYNC_WARN(...) BSC_LOG(LEVEL_WARN, 0, __VA_ARGS__)
+#define ASYNC_ERROR(...) BSC_LOG(LEVEL_ERROR, 0, __VA_ARGS__)
+#define ASYNC_INFO_THROTTLE(period, ...) BSC_LOG(LEVEL_INFO, period, __VA_ARGS__)
+#define ASYNC_WARN_THROTTLE(period, ...) BSC_LOG(LEVEL_WARN, period, __VA_ARGS__)
+
+#endif
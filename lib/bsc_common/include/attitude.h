@@ -0,0 +1,127 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file provides closed form conversions between quaternions and
+ * roll, pitch, yaw (fixed axis XYZ, the tf convention). They give the same
+ * results as tf::Matrix3x3::getRPY and tf::createQuaternionFromRPY without
+ * building tf objects or a rotation matrix. At the gimbal lock (|pitch|=pi/2)
+ * yaw is 0 and roll holds the observable roll-yaw combination, where tf
+ * returns whatever the rounding noise gives.
+ *
+ * Quaternions are (x, y, z, w) and need not be normalized.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_ATTITUDE_
+#define BSC_COMMON_ATTITUDE_
+#include <cmath>
+#include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/Geometry>
+
+namespace bsc_common
+{
+namespace attitude
+{
+/** rpyFromQuat
+ * @return roll, pitch, yaw in radians. Roll and yaw in [-pi, pi], pitch in [-pi/2, pi/2]
+ */
+inline Eigen::Vector3d rpyFromQuat(double x, double y, double z, double w)
+{
+	double s = 2 / (x * x + y * y + z * z + w * w);
+	double m20 = s * (x * z - w * y);
+
+	Eigen::Vector3d rpy;
+	if (std::fabs(m20) >= 1 - 1e-12)
+	{
+		// Gimbal lock, only roll-yaw is observable so yaw is set to 0. The band below 1
+		// keeps roll and yaw from being read off rounding noise, at a pitch error under 2e-6
+		double m01 = s * (x * y - w * z);
+		double m11 = 1 - s * (x * x + z * z);
+		rpy(0) = m20 < 0 ? std::atan2(m01, m11) : std::atan2(-m01, m11);
+		rpy(1) = m20 < 0 ? M_PI / 2 : -M_PI / 2;
+		rpy(2) = 0;
+	}
+	else
+	{
+		rpy(0) = std::atan2(s * (y * z + w * x), 1 - s * (x * x + y * y));
+		rpy(1) = -std::asin(m20);
+		rpy(2) = std::atan2(s * (x * y + w * z), 1 - s * (y * y + z * z));
+	}
+	return rpy;
+}
+
+inline Eigen::Vector3d rpyFromQuat(const Eigen::Quaterniond &q)
+{
+	return rpyFromQuat(q.x(), q.y(), q.z(), q.w());
+}
+
+/** yawFromQuat
+ * @return yaw in radians [-pi, pi]
+ */
+inline double yawFromQuat(double x, double y, double z, double w)
+{
+	double s = 2 / (x * x + y * y + z * z + w * w);
+	if (std::fabs(s * (x * z - w * y)) >= 1 - 1e-12)
+		return 0;
+	return std::atan2(s * (x * y + w * z), 1 - s * (y * y + z * z));
+}
+
+/** quatFromRPY
+ * @return unit quaternion of the rotation yaw*pitch*roll
+ */
+inline Eigen::Quaterniond quatFromRPY(double roll, double pitch, double yaw)
+{
+	double sr = std::sin(roll * 0.5), cr = std::cos(roll * 0.5);
+	double sp = std::sin(pitch * 0.5), cp = std::cos(pitch * 0.5);
+	double sy = std::sin(yaw * 0.5), cy = std::cos(yaw * 0.5);
+
+	// Eigen's constructor order is (w, x, y, z)
+	return Eigen::Quaterniond(cr * cp * cy + sr * sp * sy,
+														sr * cp * cy - cr * sp * sy,
+														cr * sp * cy + sr * cp * sy,
+														cr * cp * sy - sr * sp * cy);
+}
+
+/** rpyFromQuat (batch)
+ * @param xyzw n quaternions packed as x,y,z,w
+ * @param rpy n outputs packed as roll,pitch,yaw
+ */
+void rpyFromQuat(const double *xyzw, double *rpy, int n);
+
+/** yawFromQuat (batch)
+ * @param xyzw n quaternions packed as x,y,z,w
+ * @param yaw n outputs
+ */
+void yawFromQuat(const double *xyzw, double *yaw, int n);
+
+/** quatFromRPY (batch)
+ * @param rpy n angles packed as roll,pitch,yaw
+ * @param xyzw n quaternions packed as x,y,z,w
+ */
+void quatFromRPY(const double *rpy, double *xyzw, int n);
+} // namespace attitude
+} // namespace bsc_common
+
+#endif
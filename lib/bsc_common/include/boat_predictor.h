@@ -0,0 +1,128 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a short term predictor of the boat's motion.
+ * Turn rate and acceleration along the track are fit by least squares over a sliding
+ * window of state updates. The fit keeps running sums, so an update is constant time,
+ * and the sums are rebuilt once per window to bound their rounding error. Predictions
+ * assume the turn rate and acceleration stay constant and are closed form, so a query
+ * for the boat's position at t+dt is also constant time.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_BOAT_PREDICTOR_
+#define BSC_COMMON_BOAT_PREDICTOR_
+#include <eigen3/Eigen/Dense>
+#include <vector>
+
+namespace bsc_common
+{
+class BoatPredictor
+{
+public:
+	/** Constructor
+	 * @param window number of updates in the fit
+	 * @param maxGap seconds without an update after which the fit starts over
+	 */
+	BoatPredictor(int window = 50, double maxGap = 1.0);
+
+	void setWindow(int window);
+	void reset();
+
+	/** update
+	 * Adds a state of the boat to the fit. Updates older than the last one are ignored.
+	 *
+	 * @param t time of the state
+	 * @param p horizontal position
+	 * @param v horizontal velocity
+	 * @param heading heading of the boat
+	 */
+	void update(double t, const Eigen::Vector2d &p, const Eigen::Vector2d &v, double heading);
+
+	/** ready
+	 * @return true once the fit has enough updates to predict with
+	 */
+	bool ready() const;
+
+	double turnRate() const;
+	double acceleration() const;
+
+	/** predict
+	 * Position and velocity of the boat dt seconds after the last update.
+	 * The boat stops rather than reversing if it is slowing down.
+	 */
+	void predict(double dt, Eigen::Vector2d &p, Eigen::Vector2d &v) const;
+
+	/** heading
+	 * @return heading of the boat dt seconds after the last update, not wrapped
+	 */
+	double heading(double dt) const;
+
+	/** intercept
+	 * Finds when a vehicle at from flying at speed can reach a point fixed to the boat
+	 *
+	 * @param from position of the vehicle
+	 * @param offset point in the boat frame
+	 * @param speed speed of the vehicle
+	 * @param horizon longest time looked ahead
+	 * @param point where the point will be at the intercept
+	 * @param dt time to the intercept after the last update
+	 *
+	 * @return false if the point can not be reached within the horizon
+	 */
+	bool intercept(const Eigen::Vector2d &from, const Eigen::Vector2d &offset, double speed, double horizon,
+								 Eigen::Vector2d &point, double &dt) const;
+
+private:
+	// One update, time and heading relative to the base of the sums
+	struct sample_t
+	{
+		double t, heading, speed;
+	};
+
+	std::vector<sample_t> samples_; // ring buffer
+	int window_, head_ = 0, count_ = 0, sinceRebuild_ = 0;
+	double maxGap_;
+
+	// Running sums for the fits of heading and speed against time
+	double St_ = 0, Stt_ = 0, Sh_ = 0, Sth_ = 0, Ss_ = 0, Sts_ = 0;
+	double tBase_ = 0, hBase_ = 0;
+
+	// Last update
+	double lastT_ = 0, lastRawHeading_ = 0;
+	Eigen::Vector2d p_, v_;
+
+	double turnRate_ = 0, acceleration_ = 0;
+
+	void add(const sample_t &s, double sign);
+	void rebuild();
+	void fit();
+
+	// Point fixed to the boat at offset, dt seconds after the last update
+	Eigen::Vector2d target(double dt, const Eigen::Vector2d &offset) const;
+};
+} // namespace bsc_common
+
+#endif
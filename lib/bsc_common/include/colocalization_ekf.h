@@ -0,0 +1,277 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides the drone/boat colocalization filter.
+ * C++ port of scripts/nodes/filter (fusion_ekf.py, kalman_filter.py, sensor.py, setupSensors.py)
+ * with the same state layout, sensors and chi-squared gating.
+ *
+ * The state is
+ *	X = {pD(3), dotpD(3), pJ(3), dotpJ(2), GPSoffsetJ(3), compassOffsetJ(1)}
+ *
+ * The sensors are
+ *	tag  -> pJ - pD - GPSoffsetJ and the compass offset, from the tag seen by the drone
+ *	dvel -> drone velocity in local ENU
+ *	dgps -> drone position in local ENU
+ *	jgps -> boat GPS position in local ENU
+ *
+ * All matrices are fixed size and the covariance is corrected in Joseph form.
+ * Every H is a selection matrix, so corrections only gather the touched states
+ * unless useSelectionH is turned off.
+ *
+ * The stamped process* overloads apply each measurement at its stamp. Late
+ * measurements rewind to the newest stored state before their stamp, and the
+ * stored measurements after it are replayed up to the present. The replay is
+ * bounded by the history size and measurements older than the history are dropped.
+ * 
+ * Author: Michail Kalaitzakis
+ */
+#ifndef BSC_COMMON_COLOCALIZATION_EKF_
+#define BSC_COMMON_COLOCALIZATION_EKF_
+#include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/StdVector>
+#include <vector>
+
+namespace bsc_common
+{
+class ColocalizationEKF
+{
+public:
+	static const int n = 15;
+	typedef Eigen::Matrix<double, n, 1> state_t;
+	typedef Eigen::Matrix<double, n, n> cov_t;
+
+	// First index of each part of the state
+	enum StateIndex
+	{
+		DRONE_P = 0,
+		DRONE_V = 3,
+		BOAT_P = 6,
+		BOAT_V = 9,
+		GPS_OFFSET = 11,
+		HEADING_OFFSET = 14
+	};
+
+	enum SensorID
+	{
+		NONE,
+		TAG,
+		DVEL,
+		DGPS,
+		JGPS
+	};
+
+	// Cost of the out of sequence measurement replays
+	struct replay_stats_t
+	{
+		long replays = 0;							// late measurements applied in the past
+		long replayedMeasurements = 0; // stored measurements re-applied
+		int maxReplayed = 0;					 // most measurements re-applied by a single replay
+		long tooOld = 0;							 // measurements older than the history
+		double replaySeconds = 0;			 // CPU time spent in replays
+	};
+
+	/* Sensor model with an adaptive measurement covariance
+	 * R is re-estimated from the last N residuals, and never drops below Rnom.
+	 * Only the diagonal of R is adapted, so the window keeps running sums of the
+	 * squared residuals and each update costs O(M) whatever N is.
+	 */
+	template <int M>
+	struct Sensor
+	{
+		Eigen::Matrix<double, M, n> H;
+
+		// H as signed state indices, row i is sum(hSign[i][k] * X[hIndex[i][k]])
+		static const int maxPerRow = 3;
+		int hIndex[M][maxPerRow];
+		double hSign[M][maxPerRow];
+		int hCount[M];
+
+		Eigen::Matrix<double, M, M> R, Rnom;
+		double chiCritical;
+		int N; // residual window
+
+		// Ring of the last N residuals, one per column, and the sum of their squares
+		Eigen::Matrix<double, M, Eigen::Dynamic> residuals;
+		Eigen::Matrix<double, M, 1> sumSq;
+		int count = 0, next = 0;
+
+		// Sets the window size and clears it
+		void setWindow(int N)
+		{
+			this->N = N;
+			this->residuals.setZero(M, N);
+			this->sumSq.setZero();
+			this->count = 0;
+			this->next = 0;
+		}
+
+		/** updateR
+		 * Re-estimates R from the residual window
+		 *
+		 * @param r residual before the correction
+		 * @param Pz covariance of the measured states after the correction
+		 */
+		void updateR(const Eigen::Matrix<double, M, 1> &r, const Eigen::Matrix<double, M, M> &Pz)
+		{
+			// The evicted column is zero until the window fills
+			this->sumSq += r.cwiseAbs2() - this->residuals.col(this->next).cwiseAbs2();
+			this->sumSq = this->sumSq.cwiseMax(0);
+			this->residuals.col(this->next) = r;
+			this->next = this->next + 1 == this->N ? 0 : this->next + 1;
+			if (this->count < this->N)
+				++this->count;
+
+			if (this->count == this->N)
+			{
+				Eigen::Matrix<double, M, 1> hatRdiag = this->sumSq / this->N - Pz.diagonal();
+				this->R = hatRdiag.cwiseMax(this->Rnom.diagonal()).asDiagonal();
+			}
+		}
+
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	};
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	// Diagonal of the continuous white noise matrix Cf
+	static state_t continuousNoise();
+
+	/** setupSensors
+	 * Builds the sensor models (same as setupSensors.py)
+	 */
+	static void setupSensors(Sensor<4> &tag, Sensor<3> &dvel, Sensor<3> &dgps, Sensor<3> &jgps);
+
+	/** Constructor
+	 * @param P0 initial covariance diagonal
+	 * @param noise process noise level
+	 */
+	ColocalizationEKF(double P0 = 1.0e3, double noise = 1.0e-3);
+
+	/** predict
+	 * Propagates the state and covariance dt seconds forward. Does nothing before initialization.
+	 */
+	void predict(double dt);
+
+	/** process*
+	 * Corrects the filter with a measurement or uses it to initialize the filter.
+	 *
+	 * @return true if the measurement was applied, false if it initialized the filter or was rejected
+	 */
+	bool processTag(const Eigen::Vector4d &z);
+	bool processDroneVel(const Eigen::Vector3d &z);
+	bool processDroneGPS(const Eigen::Vector3d &z);
+	bool processBoatGPS(const Eigen::Vector3d &z);
+
+	/** process* with stamps
+	 * Applies a measurement at its stamp in seconds, then propagates back to the present
+	 * if it was late.
+	 *
+	 * @return true if the measurement was applied
+	 */
+	bool processTag(const Eigen::Vector4d &z, double stamp);
+	bool processDroneVel(const Eigen::Vector3d &z, double stamp);
+	bool processDroneGPS(const Eigen::Vector3d &z, double stamp);
+	bool processBoatGPS(const Eigen::Vector3d &z, double stamp);
+
+	/** predictTo
+	 * Propagates the filter to time t in seconds. Earlier times are ignored.
+	 */
+	void predictTo(double t);
+
+	/** setHistorySize
+	 * Sets how many stamped measurements are kept for replays and clears the history
+	 */
+	void setHistorySize(int size);
+
+	void reset();
+
+	bool isInitialized() const;
+	const state_t &getState() const;
+	const cov_t &getCovariance() const;
+	double getTime() const;
+	const replay_stats_t &getReplayStats() const;
+
+	// Enable or disable the adaptive measurement covariance
+	bool updateSensorR = true;
+
+	// Use the sparse selection form of H, false runs the dense reference update
+	bool useSelectionH = true;
+
+	Sensor<4> tag;
+	Sensor<3> dvel, dgps, jgps;
+
+private:
+	state_t X;
+	cov_t P, F, Q, Cf;
+	double P0, noise, lastDt;
+	bool isInit, dronePosSet, boatPosSet;
+
+	// Filter time, advanced by every prediction
+	double t;
+
+	// Posterior after each stamped measurement, oldest at historyHead
+	struct history_t
+	{
+		double t;
+		SensorID sensor;
+		Eigen::Vector4d z;
+		state_t X;
+		cov_t P;
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	};
+	std::vector<history_t, Eigen::aligned_allocator<history_t>> history;
+	int historyHead, historyCount;
+	replay_stats_t replayStats;
+
+	history_t &historyAt(int i);
+	void pushHistory(SensorID sensor, const Eigen::Vector4d &z);
+
+	// Corrects with the sensor, z is truncated to the sensor size
+	bool apply(SensorID sensor, const Eigen::Vector4d &z);
+
+	bool processAt(SensorID sensor, const Eigen::Vector4d &z, double stamp);
+
+	template <int M>
+	static void setupSensor(Sensor<M> &s, double rNom, double chi, int N);
+
+	// Sets H(row, col) = sign in both forms of H
+	template <int M>
+	static void addH(Sensor<M> &s, int row, int col, double sign);
+
+	void updateFQ(double dt);
+
+	/** correct
+	 * Kalman correction with chi-squared outlier rejection
+	 * S is factored once for the gate and the gain. With useSelectionH the Joseph form
+	 * is expanded as P + (K*S - 2*P*H')*K' so H never multiplies a full matrix.
+	 *
+	 * @return true if the measurement passed the gate
+	 */
+	template <int M>
+	bool correct(Sensor<M> &s, const Eigen::Matrix<double, M, 1> &z);
+};
+} // namespace bsc_common
+
+#endif
@@ -0,0 +1,123 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a float32 square root version of ColocalizationEKF for the Manifold.
+ * The covariance is kept as a lower triangular factor S with P = S*S', and both the
+ * prediction and the correction re-triangularize an array with a QR decomposition.
+ * The factor only needs the square root of the dynamic range of P, so float is enough.
+ *
+ * Same state, sensors, gating and adaptive R as ColocalizationEKF. The stamped process*
+ * overloads predict to the stamp, but late measurements are applied at the filter time
+ * instead of being replayed, which keeps the Manifold's cost per measurement fixed.
+ */
+#ifndef BSC_COMMON_COLOCALIZATION_SRF_
+#define BSC_COMMON_COLOCALIZATION_SRF_
+#include "colocalization_ekf.h"
+
+namespace bsc_common
+{
+class ColocalizationSRF
+{
+public:
+	static const int n = ColocalizationEKF::n;
+	typedef Eigen::Matrix<float, n, 1> state_t;
+	typedef Eigen::Matrix<float, n, n> cov_t;
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	/** Constructor
+	 * @param P0 initial covariance diagonal
+	 * @param noise process noise level
+	 */
+	ColocalizationSRF(double P0 = 1.0e3, double noise = 1.0e-3);
+
+	/** predict
+	 * Propagates the state and covariance factor dt seconds forward. Does nothing before initialization.
+	 */
+	void predict(double dt);
+
+	/** process*
+	 * Corrects the filter with a measurement or uses it to initialize the filter.
+	 *
+	 * @return true if the measurement was applied, false if it initialized the filter or was rejected
+	 */
+	bool processTag(const Eigen::Vector4d &z);
+	bool processDroneVel(const Eigen::Vector3d &z);
+	bool processDroneGPS(const Eigen::Vector3d &z);
+	bool processBoatGPS(const Eigen::Vector3d &z);
+
+	/** process* with stamps
+	 * Predicts to the stamp in seconds and applies the measurement. A late measurement is
+	 * applied at the filter time.
+	 *
+	 * @return true if the measurement was applied
+	 */
+	bool processTag(const Eigen::Vector4d &z, double stamp);
+	bool processDroneVel(const Eigen::Vector3d &z, double stamp);
+	bool processDroneGPS(const Eigen::Vector3d &z, double stamp);
+	bool processBoatGPS(const Eigen::Vector3d &z, double stamp);
+
+	/** predictTo
+	 * Propagates the filter to time t in seconds. Earlier times are ignored.
+	 */
+	void predictTo(double t);
+
+	void reset();
+
+	bool isInitialized() const;
+	const state_t &getState() const;
+	double getTime() const;
+
+	// Lower triangular factor of the covariance
+	const cov_t &getCovarianceFactor() const;
+	cov_t getCovariance() const;
+
+	// Enable or disable the adaptive measurement covariance
+	bool updateSensorR = true;
+
+	ColocalizationEKF::Sensor<4> tag;
+	ColocalizationEKF::Sensor<3> dvel, dgps, jgps;
+
+private:
+	state_t X;
+	cov_t S, F, sqrtCf;
+	double P0, noise, lastDt;
+	bool isInit, dronePosSet, boatPosSet;
+
+	// Filter time, follows the stamps before initialization
+	double t;
+
+	/** correct
+	 * Square root correction with chi-squared outlier rejection
+	 * The array [sqrt(R) H*S; 0 S] is triangularized into [sqrt(Pzz) 0; K*sqrt(Pzz) S+]
+	 *
+	 * @return true if the measurement passed the gate
+	 */
+	template <int M>
+	bool correct(ColocalizationEKF::Sensor<M> &s, const Eigen::Matrix<double, M, 1> &z);
+};
+} // namespace bsc_common
+
+#endif
@@ -0,0 +1,173 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a columnar store for logged time series.
+ * A table is a directory holding one file per field plus a time index. Rows are cut into
+ * blocks, and each block of each column is compressed on its own so a read only decodes
+ * the blocks that overlap the requested time range, and only the requested columns.
+ *
+ * Each block of a column is a Gorilla stream (see gorilla.h): delta of delta times and
+ * doubles XORed with the previous value of the column.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_COLUMN_STORE_
+#define BSC_COMMON_COLUMN_STORE_
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace bsc_common
+{
+namespace column_store
+{
+// One block of one column in the index
+struct span_t
+{
+	uint64_t offset;
+	uint32_t size;
+};
+
+// One block of rows in the index
+struct block_t
+{
+	int64_t tMin, tMax; // ns
+	uint32_t rows;
+	std::vector<span_t> spans; // time first, then the fields in order
+};
+
+/** encodeTimes
+ * Appends rows of times to out as delta of delta bits
+ */
+void encodeTimes(const int64_t *t, size_t rows, std::vector<uint8_t> &out);
+
+/** encodeValues
+ * Appends rows of values to out, XORed against the previous value
+ */
+void encodeValues(const double *v, size_t rows, std::vector<uint8_t> &out);
+
+/** decodeTimes, decodeValues
+ * @return false if the bytes end early
+ */
+bool decodeTimes(const uint8_t *in, size_t size, size_t rows, int64_t *t);
+bool decodeValues(const uint8_t *in, size_t size, size_t rows, double *v);
+} // namespace column_store
+
+class ColumnWriter
+{
+public:
+	/** Constructor
+	 * @param blockRows rows per block
+	 */
+	ColumnWriter(int blockRows = 4096);
+	~ColumnWriter();
+
+	/** open
+	 * Creates the table directory and a file for each field
+	 *
+	 * @param dir table directory, created if missing
+	 * @param fields field names, each becomes <dir>/<field>.col
+	 *
+	 * @return false if a file could not be created
+	 */
+	bool open(const std::string &dir, const std::vector<std::string> &fields);
+
+	/** append
+	 * @param t time of the row (ns)
+	 * @param values one value per field
+	 */
+	void append(int64_t t, const double *values);
+
+	/** close
+	 * Writes the last block and the index
+	 *
+	 * @return false if a write failed
+	 */
+	bool close();
+
+	size_t rows() const;
+	size_t bytes() const; // compressed bytes written
+
+private:
+	int blockRows_;
+	std::string dir_;
+	std::vector<std::string> fields_;
+	std::vector<FILE *> files_; // time first
+	std::vector<int64_t> times_;
+	std::vector<std::vector<double>> values_; // pending block, by column
+	std::vector<column_store::block_t> index_;
+	std::vector<uint8_t> buffer_;
+	size_t rows_ = 0, bytes_ = 0;
+	bool ok_ = true;
+
+	void flushBlock();
+};
+
+class ColumnReader
+{
+public:
+	ColumnReader();
+	~ColumnReader();
+
+	/** open
+	 * Reads the index of a table written by ColumnWriter
+	 *
+	 * @return false if the index is missing or damaged
+	 */
+	bool open(const std::string &dir);
+	void close();
+
+	const std::vector<std::string> &fields() const;
+	size_t rows() const;
+	int64_t start() const; // first time in the table (ns)
+	int64_t end() const;	 // last time in the table (ns)
+
+	/** read
+	 * Reads the rows with t0 <= t <= t1
+	 *
+	 * @param t0 start of the range (ns)
+	 * @param t1 end of the range (ns)
+	 * @param names fields to read, empty for all
+	 * @param t times of the rows read
+	 * @param columns values of the rows read, one vector per name
+	 *
+	 * @return false if a name is unknown or a block could not be read
+	 */
+	bool read(int64_t t0, int64_t t1, const std::vector<std::string> &names, std::vector<int64_t> &t,
+						std::vector<std::vector<double>> &columns);
+
+private:
+	std::string dir_;
+	std::vector<std::string> fields_;
+	std::vector<column_store::block_t> index_;
+	std::vector<int> fds_; // opened on first use, time first
+	size_t rows_ = 0;
+
+	bool readSpan(int column, const column_store::span_t &span, std::vector<uint8_t> &bytes);
+};
+} // namespace bsc_common
+
+#endif
@@ -0,0 +1,116 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides lawnmower, spiral, and boustrophedon coverage paths over a polygon.
+ * Points are generated one at a time by next(), so memory depends only on the
+ * number of polygon vertices and not on the area or line spacing.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_COVERAGE_PATH_
+#define BSC_COMMON_COVERAGE_PATH_
+#include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/StdVector>
+#include <vector>
+
+namespace bsc_common
+{
+class CoveragePath
+{
+public:
+	typedef std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d>> polygon_t;
+
+	enum Pattern
+	{
+		LAWNMOWER,		// one pass per sweep line from its first to its last crossing
+		SPIRAL,				// archimedean spiral from the vertex centroid, outside points skipped
+		BOUSTROPHEDON // sweep lines restricted to one cell of the decomposition at a time
+	};
+
+	/** setup
+	 * Sets the area to cover and restarts the path
+	 *
+	 * @param polygon vertices in order, not closed
+	 * @param pattern pattern to fly
+	 * @param spacing distance between sweep lines or spiral turns
+	 * @param angle direction of the sweep lines from the x axis (rad)
+	 * @return false if the polygon or spacing is invalid
+	 */
+	bool setup(const polygon_t &polygon, Pattern pattern, double spacing, double angle = 0);
+
+	/** reset
+	 * Restarts the path from its first point
+	 */
+	void reset();
+
+	/** next
+	 * @param point set to the next point of the path
+	 * @return false once the path is complete
+	 */
+	bool next(Eigen::Vector2d &point);
+
+	/** inside
+	 * @return true if p is inside the polygon (even-odd rule)
+	 */
+	bool inside(const Eigen::Vector2d &p) const;
+
+private:
+	Pattern pattern_ = LAWNMOWER;
+	double spacing_ = 1;
+	Eigen::Matrix2d toWorld_ = Eigen::Matrix2d::Identity(); // sweep frame to world, sweep lines are along x
+	polygon_t local_;																				// polygon in the sweep frame
+	double yMin_ = 0, yMax_ = 0;
+	std::vector<double> crossings_; // scratch for the crossings of one sweep line
+
+	// Points left from the current sweep line
+	Eigen::Vector2d pending_[2];
+	int pendingCount_ = 0, pendingIndex_ = 0;
+	bool forward_ = true; // direction of the next sweep line along x
+	bool done_ = true;
+
+	// Sweep lines, line i is at lineY(i)
+	int line_ = 0, lineCount_ = 0;
+
+	// Boustrophedon cells are the intervals between the y of vertices that are local extrema in y
+	std::vector<double> critical_;
+	int slab_ = 0, cell_ = 0, cellLine_ = 0, cellFirst_ = 0, cellLast_ = -1;
+	bool upward_ = true;
+
+	// Spiral
+	Eigen::Vector2d center_;
+	double theta_ = 0, rMax_ = 0;
+
+	double lineY(int i) const;
+	int lineAtOrAbove(double y) const;
+	void computeCrossings(double y);
+	bool nextLawnmower();
+	bool nextBoustrophedon();
+	bool nextSpiral(Eigen::Vector2d &point);
+	bool insideLocal(const Eigen::Vector2d &p) const;
+	void queue(double y, double x0, double x1);
+};
+} // namespace bsc_common
+
+#endif
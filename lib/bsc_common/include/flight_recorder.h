@@ -0,0 +1,153 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides an in process binary flight recorder.
+ * The control thread writes fixed size records into a single producer, single consumer
+ * ring without locks. When the ring is full the record is dropped and counted, so the
+ * control thread never waits on the disk. A background thread copies records from the
+ * ring into a preallocated memory mapped file, which starts with a schema header naming
+ * each record type and its fields.
+ *
+ * File layout: header_t, then records in the order they were written.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_FLIGHT_RECORDER_
+#define BSC_COMMON_FLIGHT_RECORDER_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bsc_common
+{
+class FlightRecorder
+{
+public:
+	static const int MAX_FIELDS = 14;
+	static const int MAX_TYPES = 64;
+
+	// One record, 128 bytes
+	struct record_t
+	{
+		uint64_t stamp; // ns since the epoch
+		uint16_t type;
+		uint16_t count; // fields used
+		uint32_t seq;		// low bits of the record number, gaps are drops
+		double values[MAX_FIELDS];
+	};
+
+	/* File header, 4096 bytes
+	 * schema has one line per type: "<id> <name> <field>,<field>,...\n"
+	 */
+	struct header_t
+	{
+		char magic[8]; // "JYFLTREC"
+		uint32_t version;
+		uint32_t recordSize;
+		uint64_t capacity; // records the file can hold
+		uint64_t records;	// records written
+		uint64_t dropped;	// records lost to a full ring or file
+		char schema[4096 - 40];
+	};
+
+	/** Constructor
+	 * @param ringSize records in the ring, rounded up to a power of two
+	 */
+	FlightRecorder(int ringSize = 4096);
+	~FlightRecorder();
+
+	/** addType
+	 * Declares a record type. Types must be added before open.
+	 *
+	 * @param name type name
+	 * @param fields comma separated field names
+	 *
+	 * @return id of the type, -1 if the recorder is open, the schema is full or there are too many fields
+	 */
+	int addType(const std::string &name, const std::string &fields);
+
+	/** open
+	 * Preallocates and maps the file and starts the writer thread
+	 *
+	 * @param path file to write
+	 * @param maxRecords records the file can hold
+	 * @param flushPeriod seconds between copies out of the ring
+	 *
+	 * @return false if the file could not be allocated or mapped
+	 */
+	bool open(const std::string &path, size_t maxRecords, double flushPeriod = 0.01);
+
+	/** close
+	 * Flushes the ring, stops the writer thread and trims the file to the records written
+	 */
+	void close();
+
+	bool isOpen() const;
+
+	/** record
+	 * Adds a record from the control thread. Only one thread may record.
+	 *
+	 * @return false if the recorder is closed or the record was dropped
+	 */
+	bool record(int type, const double *values, int count);
+	bool record(int type, std::initializer_list<double> values);
+
+	uint64_t written() const;
+	uint64_t dropped() const;
+
+private:
+	std::vector<record_t> ring_;
+	uint64_t mask_;
+
+	// Producer and consumer positions on separate cache lines
+	std::atomic<uint64_t> head_;
+	char padHead_[56];
+	std::atomic<uint64_t> tail_;
+	char padTail_[56];
+	std::atomic<uint64_t> ringDropped_, fileDropped_; // each has a single writer
+	std::atomic<bool> open_, running_;
+
+	std::vector<int> fieldCount_;
+	std::string schema_;
+
+	// File
+	int fd_ = -1;
+	header_t *header_ = nullptr;
+	record_t *records_ = nullptr;
+	size_t capacity_ = 0, mapSize_ = 0;
+	std::atomic<uint64_t> written_;
+	std::thread writer_;
+	double flushPeriod_;
+
+	void writerLoop();
+	void flush();
+};
+} // namespace bsc_common
+
+#endif
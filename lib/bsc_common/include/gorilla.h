@@ -0,0 +1,159 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides the Gorilla time series codec for telemetry and logs.
+ * Times are stored as the change in their spacing, which is zero for a steady rate, using
+ * the fewest bits that fit. Values are XORed with the previous value of their column; an
+ * unchanged value costs one bit, and a changed one stores only the bits between the
+ * leading and trailing zeros, reusing the previous window when it still covers them.
+ *
+ * Pelkonen et al., "Gorilla: A Fast, Scalable, In-Memory Time Series Database", VLDB 2015.
+ * The time buckets are widened for nanosecond stamps.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_GORILLA_
+#define BSC_COMMON_GORILLA_
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bsc_common
+{
+namespace gorilla
+{
+// Appends bits most significant first
+class BitWriter
+{
+public:
+	void write(uint64_t bits, int count);
+	void clear();
+	const uint8_t *data() const;
+	size_t size() const; // bytes, the last one padded with zeros
+	size_t bits() const;
+
+private:
+	std::vector<uint8_t> bytes_; // zero past the written bits
+	size_t bits_ = 0;
+};
+
+class BitReader
+{
+public:
+	BitReader(const uint8_t *data = nullptr, size_t size = 0);
+	uint64_t read(int count);
+	bool ok() const; // false once a read ran past the end
+
+private:
+	const uint8_t *data_;
+	size_t size_, pos_ = 0; // bytes, bits
+	bool ok_ = true;
+};
+
+// Delta of delta times
+class TimeCodec
+{
+public:
+	void reset();
+	void encode(BitWriter &out, int64_t t);
+	int64_t decode(BitReader &in);
+
+private:
+	int64_t prev_ = 0, delta_ = 0;
+};
+
+// XOR values
+class ValueCodec
+{
+public:
+	void reset();
+	void encode(BitWriter &out, double v);
+	double decode(BitReader &in);
+
+private:
+	uint64_t prev_ = 0;
+	int lead_ = -1, trail_ = 0; // window of the last stored XOR, lead_ < 0 before the first
+};
+} // namespace gorilla
+
+/**
+ * Rows of a time and a fixed number of values in one bit stream, for blocks of telemetry
+ */
+class GorillaEncoder
+{
+public:
+	GorillaEncoder(int columns);
+
+	/** append
+	 * @param t time of the row
+	 * @param values one per column
+	 */
+	void append(int64_t t, const double *values);
+
+	/** reset
+	 * Starts a new block, which decodes without the rows before it
+	 */
+	void reset();
+
+	const uint8_t *data() const;
+	size_t size() const; // bytes
+	size_t rows() const;
+	int columns() const;
+
+private:
+	gorilla::BitWriter out_;
+	gorilla::TimeCodec time_;
+	std::vector<gorilla::ValueCodec> values_;
+	size_t rows_ = 0;
+};
+
+class GorillaDecoder
+{
+public:
+	GorillaDecoder(int columns);
+
+	/** reset
+	 * Starts decoding a block from GorillaEncoder
+	 *
+	 * @param data bytes of the block
+	 * @param size bytes in data
+	 * @param rows rows in the block, the padding after the last row is not a row
+	 */
+	void reset(const uint8_t *data, size_t size, size_t rows);
+
+	/** next
+	 * @return false after the last row, or if the block ends early
+	 */
+	bool next(int64_t &t, double *values);
+
+private:
+	gorilla::BitReader in_;
+	gorilla::TimeCodec time_;
+	std::vector<gorilla::ValueCodec> values_;
+	size_t rows_ = 0;
+};
+} // namespace bsc_common
+
+#endif
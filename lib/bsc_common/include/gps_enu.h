@@ -28,6 +28,7 @@ SOFTWARE.
  *	
  * Use setENUorigin(lat, lon, height) to set the local ENU coordinate system
  * Use geo2enu(lat, lon, height) to get position in the local ENU system
+ * Use geo2enuFast(lat, lon, height) to use a local expansion near the origin
  * 
  * Author: Michail Kalaitzakis
  * Ported by Brennan Cain from python to C++ 
@@ -40,6 +41,23 @@ SOFTWARE.
 
 namespace bsc_common
 {
+/* Result of a geo2enuFast conversion
+ * enu is the position in the local ENU system
+ * path is LOCAL when the local expansion was used, EXACT for the ECEF round trip
+ * errorBound is the bound on the expansion error in meters (0 for EXACT)
+ */
+struct enu_result_t
+{
+	enum Path
+	{
+		EXACT,
+		LOCAL
+	};
+	Eigen::Matrix<double, 3, 1> enu;
+	Path path;
+	double errorBound;
+};
+
 class GPS_ENU
 {
 private:
@@ -60,12 +78,49 @@ private:
 	Eigen::Matrix<double, 3, 1> oZero = Eigen::Matrix<double, 3, 1>::Identity();
 	Eigen::Matrix<double, 3, 3> R = Eigen::Matrix<double, 3, 3>::Identity();
 
+	/* Second order expansion of geo2enu around the origin
+	 * With u=dlat, v=dlon (rad) and dh=alt-altZero:
+	 *	E = r0*v - (M0+h0)*sPhi0*u*v + cPhi0*dh*v
+	 *	N = (M0+h0)*u + dM0/2*u^2 + u*dh + sPhi0*r0/2*v^2
+	 *	U = dh - (M0+h0)/2*u^2 - cPhi0*r0/2*v^2
+	 * M0 is the meridian radius of curvature and r0 the distance to the polar axis.
+	 * The dropped third order terms are bounded by
+	 *	(a+|h0|)*(|u|+|v|)^3 + |dh|*(|u|+|v|)^2
+	 */
+	double mh0 = 0;			// M0+h0
+	double halfdM0 = 0; // dM/dphi / 2 at the origin
+	double r0 = 0;
+	double sPhi0 = 0;
+	double cPhi0 = 1;
+	double fastTolerance = 0.01; // meters
+
 public:
 	GPS_ENU();
 	void setENUOrigin(double lat, double lon, double alt);
 	Eigen::Matrix<double, 3, 1> geo2ecef(double lat, double lon, double alt);
 	Eigen::Matrix<double, 3, 1> ecef2enu(double x, double y, double z);
 	Eigen::Matrix<double, 3, 1> geo2enu(double lat, double lon, double alt);
+
+	/** geo2enuFast
+	 * Converts to the local ENU system using the expansion around the origin
+	 * when its error bound is within the tolerance. Falls back to geo2enu otherwise.
+	 * With the default tolerance of 1cm the expansion covers roughly 7km around the origin.
+	 *
+	 * @param lat latitude in degrees
+	 * @param lon longitude in degrees
+	 * @param alt height in meters
+	 *
+	 * @return position with the path used and its error bound
+	 */
+	enu_result_t geo2enuFast(double lat, double lon, double alt);
+
+	/** setFastTolerance
+	 * Sets the largest error bound accepted by geo2enuFast before using the exact path
+	 *
+	 * @param meters tolerance in meters, 0 disables the local expansion
+	 */
+	void setFastTolerance(double meters);
+	double getFastTolerance();
 };
 } // namespace bsc_common
 
@@ -0,0 +1,121 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides an online estimate of the boat's heave spectrum.
+ * Heave is resampled to a fixed rate and correlated against a bank of frequencies, half
+ * a DFT bin apart, over a sliding window. Each correlation slides in constant time by
+ * adding the new sample and dropping the oldest one, and the bank is stored as separate
+ * real and imaginary arrays so the per sample loop vectorizes. A Hann window is applied
+ * by combining neighbours a bin apart. The strongest peaks, refined between bank
+ * frequencies, are kept as sinusoids to predict the heave a few seconds ahead and to
+ * find the next quiet window.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_HEAVE_ESTIMATOR_
+#define BSC_COMMON_HEAVE_ESTIMATOR_
+#include <vector>
+
+namespace bsc_common
+{
+class HeaveEstimator
+{
+public:
+	/** Constructor
+	 * @param rate resampling rate (Hz)
+	 * @param window samples in the sliding window
+	 * @param fMin lowest frequency of the bank (Hz)
+	 * @param fMax highest frequency of the bank (Hz)
+	 * @param components number of peaks used for prediction
+	 */
+	HeaveEstimator(double rate = 5, int window = 512, double fMin = 0.05, double fMax = 1.0, int components = 3);
+
+	void reset();
+
+	/** update
+	 * Adds a height of the boat. Heights are held until the next update when resampling.
+	 * Gaps of more than a second restart the window.
+	 */
+	void update(double t, double z);
+
+	/** ready
+	 * @return true once the window is full
+	 */
+	bool ready() const;
+
+	/** predict
+	 * Heave dt seconds after the last sample, about the mean of the window
+	 */
+	void predict(double dt, double &z, double &zdot) const;
+
+	/** quietIn
+	 * Finds the next window where the predicted heave speed stays under maxSpeed
+	 *
+	 * @param duration length of the quiet window (s)
+	 * @param maxSpeed heave speed limit (m/s)
+	 * @param horizon latest start looked for (s)
+	 *
+	 * @return seconds until the window starts, 0 if it is now or the estimator is not ready,
+	 * -1 if there is none within the horizon
+	 */
+	double quietIn(double duration, double maxSpeed, double horizon) const;
+
+	int components() const;
+	double frequency(int i) const; // Hz
+	double amplitude(int i) const; // m
+
+private:
+	double rate_;
+	int window_, bank_, components_;
+
+	// Samples, relative to the first one after a reset
+	std::vector<double> samples_;
+	int head_ = 0, count_ = 0, sinceRebuild_ = 0;
+	double zRef_ = 0, sum_ = 0;
+	double tNext_ = 0, tLast_ = 0, zLast_ = 0;
+	bool started_ = false;
+
+	// Bank, one entry per frequency, with two extra at each end for the Hann window
+	std::vector<double> w_;						// rad/sample
+	std::vector<double> yRe_, yIm_;		// sum of x[m] e^(-i w m) over the window
+	std::vector<double> phRe_, phIm_; // e^(-i w n) of the newest sample
+	std::vector<double> stepRe_, stepIm_, dropRe_, dropIm_, gRe_, gIm_; // e^(-i w), e^(i w N), sum of e^(i w j)
+	std::vector<double> mRe_, mIm_;		// sums with the window mean removed
+	std::vector<double> hRe_, hIm_, amp_; // Hann windowed sums and their amplitudes
+
+	// e^(-i 2pi/N n) of the newest sample, shifts the Hann window along with the samples
+	double binRe_ = 1, binIm_ = 0, binStepRe_, binStepIm_;
+
+	// Peaks used for prediction, value at dt is the sum of Re(c e^(i W dt))
+	std::vector<double> cRe_, cIm_, W_, peakAmp_;
+	int peaks_ = 0;
+
+	void push(double x);
+	void rebuild();
+	void findPeaks();
+};
+} // namespace bsc_common
+
+#endif
@@ -0,0 +1,242 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides the takeoff, follow, land, ride and hover behaviors without ROS.
+ * The behaviors node runs them with ROS time, its command publisher and the DJI task
+ * services, and LandingMission runs the same code against the simulator. Each behavior
+ * takes the caller's changed flag and returns the mode to run next, so the caller keeps
+ * its own mode. Commands, services and the envelope checks go through hooks.
+ *
+ * Commands carry the behaviors flag; dji_pilot::buildFlag turns it into DJI bits.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_LANDING_BEHAVIORS_
+#define BSC_COMMON_LANDING_BEHAVIORS_
+#include "heave_estimator.h"
+#include "landing_predictor.h"
+#include "lqr.h"
+#include <eigen3/Eigen/Dense>
+#include <functional>
+
+namespace bsc_common
+{
+class LandingBehaviors
+{
+public:
+	// Same values as JETYAK_UAV_UTILS::Mode and JETYAK_UAV_UTILS::Flag
+	enum mode_t : char
+	{
+		TAKEOFF,
+		FOLLOW,
+		LEAVE,
+		RETURN,
+		LAND,
+		RIDE,
+		HOVER
+	};
+
+	enum flag_t : uint8_t
+	{
+		WORLD_POS = 0b10,
+		WORLD_RATE = 0b01,
+		LQR_FLAG = 0b00
+	};
+
+	// Defaults from cfg/behaviors_M.yaml, names follow its keys
+	struct params_t
+	{
+		Eigen::Vector4d followGoal = Eigen::Vector4d(-2, -0.05, 1.5, 0); // x, y, z, yaw in the boat FLU frame
+		double followTagLossThresh = 10;
+
+		Eigen::Vector4d landGoal = Eigen::Vector4d(-0.92, -0.05, 0.1, 0);
+		double landVelMag = 0.15;
+		double landXTopThresh = 0.09, landYTopThresh = 0.09;
+		double landXBottomThresh = 0.15, landYBottomThresh = 0.15;
+		double landBottom = -0.15, landTop = 0.1;
+		double landAngleThresh = 0.25;
+		double landTagLossThresh = 3;
+		double landQuietSpeed = 0.1, landQuietTime = 1.5, landQuietWait = 20;
+		double landPredictHorizon = 3;
+		double landSigmaPos = 0.05, landSigmaVel = 0.05;
+		double landMinConfidence = 0.8;
+		double landPaceSlack = 0.2;
+		LandingPredictor::plant_t landPlant;
+	};
+
+	// ObservedState
+	struct state_t
+	{
+		Eigen::Vector3d droneP, droneV, droneRpy, droneRates; // ENU, rates in the body frame
+		Eigen::Vector3d boatP, boatV;
+		double heading; // boat yaw, ENU
+	};
+
+	// Quantities derived from the state, rebuilt once per updateState
+	struct derived_t
+	{
+		Eigen::Matrix2d droneToWorld, worldToDrone; // rotations by drone yaw
+		Eigen::Matrix2d boatToWorld, worldToBoat;		// rotations by boat heading
+		Eigen::Vector2d boatOffsetWorld;						// drone - boat position, world frame
+		Eigen::Vector2d boatOffsetBoat;							// drone - boat position, boat frame
+		double boatOffsetZ;													// drone - boat height
+		Eigen::Vector2d droneVelDrone;							// drone horizontal velocity, drone frame
+		Eigen::Vector2d boatVelDrone;								// boat horizontal velocity, drone frame
+		double relVelSqr;														// squared horizontal speed of the drone relative to the boat
+	};
+
+	struct command_t
+	{
+		Eigen::Vector4d u; // behavior_cmd axes 0 to 3
+		flag_t flag;
+	};
+
+	// One check of the landing envelope and the quiet heave window
+	struct check_t
+	{
+		double x, y, z, w, vel;					 // offset from the land goal in the boat frame and relative speed
+		double xLow, xHigh, yLow, yHigh; // envelope at this height
+		bool inX, inY, inZ, inW, inVel, in;
+		double quietIn;		 // s until the heave is quiet, 0 if now, -1 if none within landQuietWait
+		double waitElapsed; // s inside the envelope without a break, -1 while outside it
+	};
+
+	struct hooks_t
+	{
+		std::function<bool()> takeoff, land;						 // DJI task services, true on success
+		std::function<void(const command_t &)> command;	// sends a command
+		std::function<void(const LQR &)> control;				 // after each LQR command
+		std::function<void(const check_t &)> landCheck; // after each envelope check
+	};
+
+	/** Constructor
+	 * @param generalK LQR gains of follow and the other behaviors
+	 * @param landK LQR gains of land
+	 */
+	LandingBehaviors(const params_t &params, const Eigen::Matrix<double, 4, 12> &generalK,
+									 const Eigen::Matrix<double, 4, 12> &landK);
+
+	void setHooks(const hooks_t &hooks);
+
+	/** params
+	 * The goals may be moved in flight, the envelope is fixed at construction
+	 */
+	params_t &params();
+
+	/** updateState
+	 * Rebuilds the derived state and the LQR states
+	 *
+	 * @param t stamp of the state (s)
+	 */
+	void updateState(double t, const state_t &state);
+
+	/** tagSeen
+	 * @param t stamp of the tag detection (s)
+	 */
+	void tagSeen(double t);
+
+	double lastSpotted() const;
+	const state_t &state() const;
+	const derived_t &derived() const;
+	bool propellorsRunning() const;
+
+	/** aborts
+	 * @return landings abandoned because the tag was lost
+	 */
+	int aborts() const;
+
+	LQR &generalLqr();
+	LQR &landLqr();
+
+	/** boatToDrone
+	 * Converts a 4d pose in the boat FLU frame to the UAV FLU frame
+	 *
+	 * @param goal x, y, z, yaw relative to the boat
+	 * @return offset from the drone to the goal and the yaw to turn
+	 */
+	Eigen::Vector4d boatToDrone(const Eigen::Vector4d &goal) const;
+
+	/* Behaviors, each runs one tick
+	 * @param t now (s)
+	 * @param changed set when the mode was just switched to, cleared or set by the behavior
+	 * @return mode to run next
+	 */
+	mode_t takeoff(bool &changed);
+	mode_t follow(double t, bool &changed);
+	mode_t land(double t, bool &changed);
+	mode_t ride();
+	void hover();
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+	params_t p_;
+	hooks_t hooks_;
+	LQR generalLqr_, landLqr_;
+	LandingPredictor predictor_;
+	HeaveEstimator heave_;
+
+	state_t state_;
+	derived_t derived_;
+	double lastSpotted_ = 0;
+	bool propellorsRunning_ = false;
+	int aborts_ = 0;
+
+	double waitStart_ = -1; // time the land threshold was last entered, -1 while outside it
+	int lastChecks_ = -1;		// bits of the last logged check, -1 to log the next one
+
+	void send(const Eigen::Vector4d &u, flag_t flag);
+
+	/** inLandThreshold
+	 * Checks the landing envelope
+	 *
+	 * @param c filled with the check
+	 * @return true if the drone is inside it
+	 */
+	bool inLandThreshold(check_t &c);
+
+	/** landWindowOpen
+	 * Checks the heave prediction for a quiet window starting now. Gives up waiting for one
+	 * after landQuietWait in the envelope without a break.
+	 *
+	 * @param c check of this tick, with quietIn set, waitElapsed is filled in
+	 * @return true if landing can start
+	 */
+	bool landWindowOpen(double t, check_t &c);
+
+	/** predictLanding
+	 * Rolls the landing approach forward from the current state
+	 *
+	 * @param goal_d landing goal in the drone frame
+	 * @param vMult scale of the boat's forward speed in the velocity setpoint
+	 * @param p prediction
+	 *
+	 * @return false if the envelope is not met within the horizon
+	 */
+	bool predictLanding(const Eigen::Vector4d &goal_d, double vMult, LandingPredictor::prediction_t &p) const;
+};
+} // namespace bsc_common
+
+#endif
@@ -0,0 +1,147 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a Monte Carlo campaign of simulated landings. Each run flies
+ * takeoff, follow and land with a LandingMission against a UavSim, through the same
+ * rates and command clipping as behaviors and dji_pilot, under conditions drawn at
+ * random: wind, boat speed, heading and weave, heave, tag dropouts and sensor noise.
+ * Runs are seeded from the campaign seed and their index, so results do not depend on
+ * the number of threads, and runs share nothing so they scale across cores.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_LANDING_CAMPAIGN_
+#define BSC_COMMON_LANDING_CAMPAIGN_
+#include "landing_mission.h"
+#include "uav_sim.h"
+#include <eigen3/Eigen/Dense>
+#include <vector>
+
+namespace bsc_common
+{
+class LandingCampaign
+{
+public:
+	// Uniform draw between min and max
+	struct range_t
+	{
+		double min, max;
+	};
+
+	struct config_t
+	{
+		LandingMission::params_t mission;
+		Eigen::Matrix<double, 4, 12> generalK, landK;
+		UavSim::params_t sim; // randomized fields are drawn per run
+
+		// behaviors and dji_pilot
+		double behaviorRate = 25; // Hz
+		double stateRate = 50;		// Hz, colocalization
+		double tagRate = 15;			// Hz, camera
+		double hAngleCmdMax = 0.1, hVelocityMax = 1.0, vVelocityMaxBody = 0.5, vVelocityMaxGround = 0.4;
+		double yAngleRateMax = 1.0;
+
+		// Mission
+		double followTime = 10; // s following before land is set, again after an abort
+		double timeout = 120;		// s
+
+		// Conditions
+		range_t windSpeed = {0, 2};				// m/s, from any direction
+		range_t boatSpeed = {0, 2};				// m/s, on any heading
+		range_t weaveAmplitude = {0, 0.3}; // rad
+		range_t weavePeriod = {10, 40};		 // s
+		range_t heaveAmplitude = {0, 0.15}; // m
+		range_t heavePeriod = {3, 8};				// s
+		range_t dropoutRate = {0, 0.2};			// tag dropouts per s
+		range_t dropoutLength = {0.2, 2};		// s, mean length
+		range_t positionNoise = {0, 0.05};	// m, state position
+		range_t velocityNoise = {0, 0.05};	// m/s, state velocity
+		range_t rangeNoise = {0.005, 0.02}; // tag position per m of range
+		unsigned seed = 1;
+
+		config_t();
+
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	};
+
+	enum outcome_t
+	{
+		LANDED,	// on the pad after the land service
+		CRASHED, // hard touchdown or into the water
+		LOST,		 // follow lost the tag and hovered
+		TIMEOUT,
+		OUTCOMES
+	};
+
+	struct result_t
+	{
+		int run;
+		outcome_t outcome;
+		double time;					 // s from land set to touchdown
+		double error;					 // m from the pad center at touchdown
+		double touchdownSpeed; // m/s
+		int aborts;						 // landings abandoned for the tag
+
+		// Conditions drawn
+		double wind, boatSpeed, weave, heave, dropoutRate, positionNoise;
+	};
+
+	struct stats_t
+	{
+		double mean = 0, p5 = 0, p50 = 0, p95 = 0, max = 0;
+	};
+
+	struct summary_t
+	{
+		int runs = 0;
+		int outcomes[OUTCOMES] = {0};
+		double successRate = 0, successLow = 0, successHigh = 0; // with the 95% Wilson interval
+		stats_t time, error, touchdownSpeed;										 // of the landings
+	};
+
+	LandingCampaign(const config_t &config);
+
+	/** runOne
+	 * Flies run index of the campaign
+	 */
+	result_t runOne(int index) const;
+
+	/** run
+	 * Flies runs 0 to runs-1 on threads threads
+	 */
+	std::vector<result_t> run(int runs, int threads) const;
+
+	static summary_t summarize(const std::vector<result_t> &results);
+
+	static const char *outcomeName(outcome_t outcome);
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+	config_t c_;
+};
+} // namespace bsc_common
+
+#endif
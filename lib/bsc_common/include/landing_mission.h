@@ -0,0 +1,80 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a mission of the landing behaviors without ROS, so landings can
+ * be flown in simulation by the thousand. It keeps the mode like Behaviors does and runs
+ * the same LandingBehaviors, with time passed in rather than read from a clock and the
+ * DJI task services as callbacks, so a mission is deterministic.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_LANDING_MISSION_
+#define BSC_COMMON_LANDING_MISSION_
+#include "landing_behaviors.h"
+
+namespace bsc_common
+{
+class LandingMission : public LandingBehaviors
+{
+public:
+	/** Constructor
+	 * @param generalK LQR gains of follow
+	 * @param landK LQR gains of land
+	 */
+	LandingMission(const params_t &params, const Eigen::Matrix<double, 4, 12> &generalK,
+								 const Eigen::Matrix<double, 4, 12> &landK);
+
+	/** setServices
+	 * The takeoff and land services of dji_pilot
+	 */
+	void setServices(std::function<bool()> takeoff, std::function<bool()> land);
+
+	void setMode(mode_t mode);
+	mode_t mode() const;
+
+	/** step
+	 * Runs the current mode once, like Behaviors::doBehaviorAction
+	 *
+	 * @param t now (s)
+	 * @param cmd command, only set if one is sent
+	 *
+	 * @return true if a command is sent
+	 */
+	bool step(double t, command_t &cmd);
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+	hooks_t callbacks_;
+	mode_t mode_ = RIDE;
+	bool changed_ = false;
+
+	// Command of the current step
+	command_t *cmd_ = nullptr;
+	bool sent_ = false;
+};
+} // namespace bsc_common
+
+#endif
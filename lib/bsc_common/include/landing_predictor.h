@@ -0,0 +1,138 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a forward simulation of the closed loop landing approach.
+ * The LQR gains close the loop around a linear model of the drone relative to the
+ * landing goal: second order attitude tracking of the angle commands and first order
+ * tracking of the vertical speed and yaw rate commands. The closed loop is discretized
+ * once, so a rollout is one 12x12 product per step. Uncertainty in the initial position
+ * and velocity is carried by sigma points, whose offsets Phi^k delta are precomputed
+ * since the loop is linear. The confidence is the fraction of them that enter the
+ * envelope soon after the nominal state does.
+ *
+ * State, in the drone frame relative to the goal and the boat:
+ * [position error, velocity relative to the boat, roll, pitch, yaw error, roll rate, pitch rate, yaw rate]
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_LANDING_PREDICTOR_
+#define BSC_COMMON_LANDING_PREDICTOR_
+#include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/StdVector>
+#include <vector>
+
+namespace bsc_common
+{
+class LandingPredictor
+{
+public:
+	typedef Eigen::Matrix<double, 12, 1> state_t;
+
+	/* Closed loop model of the drone
+	 * attFreq, attDamp: natural frequency (rad/s) and damping of roll and pitch tracking
+	 * zTau, yawTau: time constants of vertical speed and yaw rate tracking (s)
+	 */
+	struct plant_t
+	{
+		double attFreq = 6, attDamp = 0.7, zTau = 0.3, yawTau = 0.3;
+	};
+
+	/* Landing envelope, the trapezoid of inLandThreshold
+	 * x and y limits widen linearly from top to bottom, angle is the yaw limit, vel the relative speed limit
+	 */
+	struct envelope_t
+	{
+		double xTop, yTop, xBottom, yBottom, bottom, top, angle, vel;
+	};
+
+	/** Constructor
+	 * @param K LQR gains
+	 * @param plant closed loop model
+	 * @param dt rollout step (s)
+	 * @param horizon rollout length (s)
+	 */
+	LandingPredictor(const Eigen::Matrix<double, 4, 12> &K, const plant_t &plant, double dt = 0.02, double horizon = 3);
+
+	void setEnvelope(const envelope_t &envelope);
+
+	/** setUncertainty
+	 * Standard deviations of the initial position and velocity used for the confidence
+	 *
+	 * @param tolerance time after the predicted entry a sigma point may take to enter (s)
+	 */
+	void setUncertainty(double pos, double vel, double tolerance = 0.5);
+
+	/** inside
+	 * @param x state
+	 * @param goalYaw yaw of the goal in the boat frame, rotates the drone frame into the boat frame
+	 *
+	 * @return true if x is in the envelope
+	 */
+	bool inside(const state_t &x, double goalYaw) const;
+
+	/* Result of a rollout
+	 * t: time until the envelope is met
+	 * heightTime: time until the height alone is in the envelope
+	 * confidence: fraction of sigma points in the envelope within the tolerance after t
+	 */
+	struct prediction_t
+	{
+		double t, heightTime, confidence;
+	};
+
+	/** predict
+	 * Rolls the approach forward and finds the first step in the envelope
+	 *
+	 * @param x0 current state
+	 * @param velOffset velocity setpoint minus the boat's velocity, drone frame, held over the rollout
+	 * @param goalYaw yaw of the goal in the boat frame
+	 * @param p prediction, only set if the envelope is met
+	 *
+	 * @return false if the envelope is not met within the horizon
+	 */
+	bool predict(const state_t &x0, const Eigen::Vector3d &velOffset, double goalYaw, prediction_t &p) const;
+
+	double dt() const;
+	int steps() const;
+
+private:
+	typedef Eigen::Matrix<double, 12, 12> matrix_t;
+	typedef Eigen::Matrix<double, 12, 6> sigma_t;
+
+	Eigen::Matrix<double, 4, 12> K_;
+	matrix_t phi_;												// one step of the closed loop
+	Eigen::Matrix<double, 12, 3> gamma_; // one step response to the velocity offset
+	std::vector<sigma_t, Eigen::aligned_allocator<sigma_t>> spread_; // Phi^k diag(sigma) for the position and velocity columns
+	double dt_;
+	int steps_;
+	double sigmaPos_ = 0.05, sigmaVel_ = 0.05;
+	int toleranceSteps_;
+	envelope_t envelope_;
+
+	void buildSpread();
+};
+} // namespace bsc_common
+
+#endif
@@ -78,6 +78,13 @@ public:
 
 	// [p_goal_dronebody,pdot_goal_dronebody,[0,0,yaw_goal_world],0_3]^T
 	Eigen::Matrix<double, 4, 1> getCommand(Eigen::Matrix<double, 12, 1> set);
+
+	const Eigen::Matrix<double, 4, 12> &getK() const;
+
+	// Last state, setpoint and command
+	const Eigen::Matrix<double, 12, 1> &getState() const;
+	const Eigen::Matrix<double, 12, 1> &getSetpoint() const;
+	const Eigen::Matrix<double, 4, 1> &getOutput() const;
 };
 } // namespace bsc_common
 #endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides minimum snap trajectories through a sequence of waypoints.
+ * Legs are split into 7th order polynomial pieces defined by the position, velocity,
+ * acceleration, and jerk at their ends. Minimizing snap over those knot values is a block
+ * tridiagonal system, so a solve is linear in the number of pieces. Piece times come from a
+ * trapezoidal profile that slows for turns and are then scaled together so the velocity and
+ * acceleration limits hold.
+ * Waypoints with a radius may be cut inside that radius, waypoints with a hold time
+ * are stopped at.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_MIN_SNAP_
+#define BSC_COMMON_MIN_SNAP_
+#include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/StdVector>
+#include <vector>
+
+namespace bsc_common
+{
+class MinSnapTrajectory
+{
+public:
+	typedef std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d>> points_t;
+
+	/* A point of the trajectory
+	 * knot is the index of the waypoint being flown to
+	 */
+	struct sample_t
+	{
+		Eigen::Vector3d p, v, a;
+		int knot;
+	};
+
+	/** solve
+	 * Builds the trajectory
+	 *
+	 * @param points waypoints, the first one is the start
+	 * @param radius allowed distance from each waypoint, <= 0 to pass through it exactly
+	 * @param hold time to stop at each waypoint, > 0 stops there
+	 * @param maxVel speed limit
+	 * @param maxAcc acceleration limit
+	 * @param startVel velocity at the start
+	 * @return false if there are fewer than two points or the limits are invalid
+	 */
+	bool solve(const points_t &points, const std::vector<double> &radius, const std::vector<double> &hold, double maxVel,
+						 double maxAcc, const Eigen::Vector3d &startVel = Eigen::Vector3d::Zero());
+
+	/** sample
+	 * Samples the trajectory, constant time when t only moves forward between calls
+	 *
+	 * @param t time since the start, clamped to the trajectory
+	 * @param s sampled state
+	 */
+	void sample(double t, sample_t &s) const;
+
+	double duration() const;
+
+	/** knot
+	 * @return where the trajectory passes waypoint i
+	 */
+	const Eigen::Vector3d &knot(int i) const;
+
+	int knots() const;
+
+	/** peaks
+	 * Largest speed and acceleration along the trajectory, measured by sampling
+	 */
+	void peaks(double &vel, double &acc) const;
+
+	/** setMaxIterations
+	 * Limits the passes of pinning knots to their radius per solve
+	 */
+	void setMaxIterations(int n);
+
+private:
+	typedef Eigen::Matrix<double, 8, 3> coeffs_t;
+	typedef Eigen::Matrix<double, 4, 3> knot_t; // position, velocity, acceleration, jerk of one knot
+	typedef Eigen::Matrix4d block_t;
+
+	// Polynomial in normalized time tau = (t - t0) / T
+	struct segment_t
+	{
+		coeffs_t c;
+		double t0, T;
+		int knot;
+		bool hold;
+	};
+
+	std::vector<segment_t, Eigen::aligned_allocator<segment_t>> segments_;
+	mutable int hint_ = 0;
+	int maxIterations_ = 20;
+
+	// Problem, one entry per knot
+	points_t points_, knots_;
+	std::vector<int> knotOf_, lastInput_; // knot of each input waypoint, last input waypoint of each knot
+	std::vector<double> radius_, hold_, T_;
+	std::vector<bool> fixedPos_, stop_;
+	Eigen::Vector3d startVel_;
+
+	// Block tridiagonal system, D on the diagonal and U above it
+	std::vector<block_t, Eigen::aligned_allocator<block_t>> D_, U_;
+	std::vector<knot_t, Eigen::aligned_allocator<knot_t>> rhs_, x_;
+
+	/** segmentHessian
+	 * Snap cost of a leg of duration T as a quadratic in its end knot values
+	 */
+	static Eigen::Matrix<double, 8, 8> segmentHessian(double T);
+
+	/** endpointsToCoeffs
+	 * Maps the end knot values of a leg to its normalized polynomial
+	 */
+	static const Eigen::Matrix<double, 8, 8> &endpointsToCoeffs();
+
+	/** trapezoidTime
+	 * Time to cover s of a leg of length d starting at v0 and ending at v1
+	 */
+	static double trapezoidTime(double s, double d, double v0, double v1, double maxVel, double maxAcc);
+
+	void solveKnots();
+	bool fixRadius();
+
+	/** worstRatio
+	 * @return largest ratio of the peaks to the limits, scaling all leg times by it makes the trajectory feasible
+	 */
+	double worstRatio(double maxVel, double maxAcc) const;
+	void buildSegments();
+	void segmentPeaks(const segment_t &seg, double &vel, double &acc) const;
+	void evaluate(const segment_t &seg, double tau, sample_t &s) const;
+};
+} // namespace bsc_common
+
+#endif
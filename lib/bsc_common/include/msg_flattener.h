@@ -0,0 +1,126 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides flattening of serialized ROS messages into numeric columns.
+ * It parses the message definition stored with each bag connection, so no generated
+ * message code is needed. Every numeric leaf becomes one column named by its path,
+ * e.g. "pose.position.x". Times and durations become seconds. Strings are skipped.
+ *
+ * Fixed arrays of numbers get a column per element, up to MAX_FIXED. Variable arrays of
+ * numbers get a "<name>.size" column and the first maxArray elements, NaN when missing.
+ * Arrays of messages keep the first element and the size.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_MSG_FLATTENER_
+#define BSC_COMMON_MSG_FLATTENER_
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bsc_common
+{
+class MessageFlattener
+{
+public:
+	static const int MAX_FIXED = 64;
+
+	/** Constructor
+	 * @param maxArray elements kept from variable length arrays of numbers
+	 */
+	MessageFlattener(int maxArray = 8);
+
+	/** parse
+	 * Builds the columns of a message type from its full definition, as stored in a bag
+	 *
+	 * @param type message type, e.g. "sensor_msgs/Joy"
+	 * @param definition definition text including the MSG: sections of nested types
+	 *
+	 * @return false if a field type is not defined
+	 */
+	bool parse(const std::string &type, const std::string &definition);
+
+	const std::vector<std::string> &fields() const;
+
+	/** flatten
+	 * @param data serialized message
+	 * @param size bytes in data
+	 * @param out one value per field
+	 *
+	 * @return false if the message ends before its definition does
+	 */
+	bool flatten(const uint8_t *data, size_t size, double *out) const;
+
+private:
+	enum kind_t : uint8_t
+	{
+		BOOL,
+		INT8,
+		UINT8,
+		INT16,
+		UINT16,
+		INT32,
+		UINT32,
+		INT64,
+		UINT64,
+		FLOAT32,
+		FLOAT64,
+		TIME,
+		DURATION,
+		STRING,
+		MESSAGE
+	};
+
+	struct node_t
+	{
+		kind_t kind;
+		int array;						 // -1 scalar, 0 variable, otherwise fixed length
+		int column;						 // first column, -1 if not kept
+		int sizeColumn;				 // column of a variable array's size
+		std::vector<node_t> children; // fields of a message
+	};
+
+	// Field of a parsed definition
+	struct field_t
+	{
+		std::string type, name;
+		int array;
+	};
+
+	int maxArray_;
+	std::map<std::string, std::vector<field_t>> types_;
+	std::vector<node_t> root_;
+	std::vector<std::string> fields_;
+
+	bool build(const std::string &type, const std::string &prefix, std::vector<node_t> &nodes, int depth);
+	bool run(const std::vector<node_t> &nodes, const uint8_t *&p, const uint8_t *end, double *out, bool keep) const;
+	static bool primitive(const std::string &type, kind_t &kind);
+	static size_t width(kind_t kind);
+};
+} // namespace bsc_common
+
+#endif
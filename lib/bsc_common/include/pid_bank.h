@@ -0,0 +1,161 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a bank of PID controllers updated together.
+ * Each axis behaves like bsc_common::PID. The windowed integral is kept in a
+ * fixed capacity ring so an update never allocates.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_PID_BANK_
+#define BSC_COMMON_PID_BANK_
+#include <eigen3/Eigen/Dense>
+
+namespace bsc_common
+{
+template <int N, int Capacity = 50>
+class PIDBank
+{
+public:
+	typedef Eigen::Array<double, N, 1> axes_t;
+
+private:
+	axes_t kp_, ki_, kd_, last_error_, integral_, signal_, last_d_;
+	double last_time_;
+
+	// Integral contributions of the last integral_frame_ updates, one column per update
+	Eigen::Array<double, N, Capacity> past_integral_contributions;
+	int oldest_, count_;
+	int integral_frame_;
+	bool use_int_frame_;
+
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	PIDBank() : PIDBank(axes_t::Zero(), axes_t::Zero(), axes_t::Zero()){};
+
+	/** Constructor
+	 * @param kp proportional gain of each axis
+	 * @param ki integral gain of each axis
+	 * @param kd derivative gain of each axis
+	 * @param integral_frame number of updates in the integral window (at most Capacity). Negative for an unbounded integral.
+	 */
+	PIDBank(const axes_t &kp, const axes_t &ki, const axes_t &kd, int integral_frame = Capacity)
+	{
+		updateParams(kp, ki, kd);
+		integral_frame_ = integral_frame > Capacity ? Capacity : integral_frame;
+		use_int_frame_ = integral_frame >= 0;
+		reset();
+	}
+
+	/** update
+	 * Updates every axis with a new error. Same semantics as PID::update.
+	 *
+	 * @param error error of each axis
+	 * @param utime timestamp of the error
+	 */
+	void update(const axes_t &error, double utime)
+	{
+		// Proportional
+		signal_ = error * kp_;
+		if (utime != 0 and last_time_ != 0) // timestamped and not first time
+		{
+			if (last_time_ == utime)
+			{
+				signal_ += integral_ * ki_ + last_d_;
+			}
+			else
+			{
+				// get change in time
+				double dt = utime - last_time_;
+
+				// integral
+				integral_ += error * dt;
+
+				// differential
+				last_d_ = kd_ * (error - last_error_) / dt;
+
+				signal_ += integral_ * ki_ + last_d_;
+
+				if (use_int_frame_)
+				{
+					if (count_ < integral_frame_)
+					{
+						past_integral_contributions.col((oldest_ + count_) % Capacity) = error * dt;
+						++count_;
+					}
+					else if (integral_frame_ > 0)
+					{
+						// Window is full, the newest contribution replaces the oldest one in the rolling sum
+						integral_ -= past_integral_contributions.col(oldest_);
+						past_integral_contributions.col(oldest_) = error * dt;
+						oldest_ = (oldest_ + 1) % Capacity;
+					}
+					else
+					{
+						integral_ -= error * dt;
+					}
+				}
+			}
+		}
+		last_error_ = error;
+		last_time_ = utime;
+	}
+
+	/** update
+	 * @param error pointer to N errors
+	 * @param utime timestamp of the errors
+	 */
+	void update(const double *error, double utime)
+	{
+		update(Eigen::Map<const axes_t>(error), utime);
+	}
+
+	void updateParams(const axes_t &kp, const axes_t &ki, const axes_t &kd)
+	{
+		kp_ = kp;
+		ki_ = ki;
+		kd_ = kd;
+	}
+
+	void reset()
+	{
+		last_error_.setZero();
+		integral_.setZero();
+		signal_.setZero();
+		last_d_.setZero();
+		last_time_ = 0;
+		oldest_ = 0;
+		count_ = 0;
+	}
+
+	const axes_t &get_signal() const
+	{
+		return signal_;
+	}
+};
+} // namespace bsc_common
+
+#endif
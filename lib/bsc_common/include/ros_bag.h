@@ -0,0 +1,96 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a reader for ROS bag files, format 2.0, without ROS.
+ * The file is memory mapped and its records are walked in order, handing each message's
+ * connection, receive time and serialized bytes to a callback. Connections are read from
+ * the bag as they appear, so each is known before its first message.
+ *
+ * Only uncompressed chunks are read. Compressed chunks are skipped and counted.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_ROS_BAG_
+#define BSC_COMMON_ROS_BAG_
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace bsc_common
+{
+class RosBagReader
+{
+public:
+	struct connection_t
+	{
+		std::string topic, type, md5sum, definition;
+	};
+
+	struct message_t
+	{
+		uint32_t conn;
+		int64_t stamp; // receive time (ns)
+		const uint8_t *data;
+		uint32_t size;
+	};
+
+	RosBagReader();
+	~RosBagReader();
+
+	/** open
+	 * Maps the file and checks its version line
+	 *
+	 * @return false if the file is missing or not a version 2.0 bag
+	 */
+	bool open(const std::string &path);
+	void close();
+
+	/** read
+	 * Walks the bag, calling back once per message in file order
+	 *
+	 * @param callback gets each message, its data is valid during the call
+	 *
+	 * @return false if a record runs past the end of the file
+	 */
+	bool read(const std::function<void(const message_t &)> &callback);
+
+	const std::map<uint32_t, connection_t> &connections() const;
+	int skippedChunks() const;
+	size_t size() const; // bytes in the file
+
+private:
+	int fd_ = -1;
+	const uint8_t *data_ = nullptr;
+	size_t size_ = 0;
+	std::map<uint32_t, connection_t> connections_;
+	int skipped_ = 0;
+
+	bool readRecords(const uint8_t *p, const uint8_t *end, const std::function<void(const message_t &)> &callback);
+};
+} // namespace bsc_common
+
+#endif
@@ -0,0 +1,97 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides minimum snap trajectories solved off the control thread.
+ * A request is copied to a worker thread, which solves it while the caller keeps
+ * flying. Requests replace any that has not started, and the caller collects the
+ * finished trajectory with poll. Neither call waits for a solve.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_TRAJECTORY_PLANNER_
+#define BSC_COMMON_TRAJECTORY_PLANNER_
+#include "min_snap.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace bsc_common
+{
+class TrajectoryPlanner
+{
+public:
+	// Arguments of MinSnapTrajectory::solve, tag identifies the request to the caller
+	struct request_t
+	{
+		MinSnapTrajectory::points_t points;
+		std::vector<double> radius, hold;
+		double maxVel, maxAcc;
+		Eigen::Vector3d startVel = Eigen::Vector3d::Zero();
+		int tag = 0;
+	};
+
+	TrajectoryPlanner();
+	~TrajectoryPlanner();
+
+	/** request
+	 * Queues a solve, replacing a queued request that has not started
+	 *
+	 * @param req problem to solve, swapped out of the caller
+	 */
+	void request(request_t &req);
+
+	/** poll
+	 * Collects a finished solve without waiting
+	 *
+	 * @param traj receives the trajectory
+	 * @param tag tag of the request it solved
+	 * @param ok whether the solve succeeded
+	 * @return false if no solve finished since the last poll
+	 */
+	bool poll(MinSnapTrajectory &traj, int &tag, bool &ok);
+
+	/** busy
+	 * @return true while a request is queued or being solved
+	 */
+	bool busy();
+
+private:
+	std::thread worker_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	bool running_ = true;
+
+	// Guarded by mutex_
+	request_t pending_;
+	bool hasPending_ = false, solving_ = false;
+	MinSnapTrajectory done_;
+	bool hasDone_ = false, doneOk_ = false;
+	int doneTag_ = 0;
+
+	void workerLoop();
+};
+} // namespace bsc_common
+
+#endif
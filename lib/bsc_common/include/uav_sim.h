@@ -0,0 +1,235 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a software in the loop simulator of the UAV and the boat.
+ * The UAV has the 12 states the LQR assumes: ENU position and velocity, roll, pitch and
+ * yaw, and their rates. It takes DJI generic setpoints, so the flag picks angle, velocity,
+ * position or rate for the horizontal axes, velocity, height or thrust for the vertical,
+ * and angle or rate for yaw, in the ground or body frame. The DJI attitude loop is a
+ * second order response to the commanded roll and pitch. Thrust makes the commanded
+ * vertical acceleration, and tilt turns it into horizontal acceleration. Drag acts on
+ * the velocity relative to the wind.
+ *
+ * The boat weaves about its heading at a constant speed and heaves. The landing tag sits
+ * on its deck, and the gimbal camera sees it inside a cone and a range, with detections
+ * dropped more often and noisier with range. The UAV starts on the deck, rides it while
+ * landed, and crashes if it reaches the water.
+ *
+ * Steps are a fixed size and noise comes from a seeded generator, so a run is repeatable.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_UAV_SIM_
+#define BSC_COMMON_UAV_SIM_
+#include <eigen3/Eigen/Dense>
+#include <cstdint>
+#include <random>
+
+namespace bsc_common
+{
+class UavSim
+{
+public:
+	// Flag bits of the DJI generic setpoint, the same values as DJISDK in dji_sdk.h
+	enum flag_t : uint8_t
+	{
+		HORIZONTAL_ANGLE = 0x00,
+		HORIZONTAL_VELOCITY = 0x40,
+		HORIZONTAL_POSITION = 0x80,
+		HORIZONTAL_ANGULAR_RATE = 0xC0,
+		HORIZONTAL_MASK = 0xC0,
+		VERTICAL_VELOCITY = 0x00,
+		VERTICAL_POSITION = 0x10,
+		VERTICAL_THRUST = 0x20,
+		VERTICAL_MASK = 0x30,
+		YAW_ANGLE = 0x00,
+		YAW_RATE = 0x08,
+		HORIZONTAL_GROUND = 0x00,
+		HORIZONTAL_BODY = 0x02
+	};
+
+	struct params_t
+	{
+		double dt = 0.0025; // s per step
+
+		// UAV
+		double attitudeFrequency = 10.0; // rad/s natural frequency of the roll and pitch response
+		double attitudeDamping = 0.8;
+		double yawTau = 0.15;			 // s, yaw rate response
+		double verticalTau = 0.3;	 // s, vertical velocity response
+		double velocityTau = 0.6;	 // s, horizontal velocity response
+		double positionGain = 1.0; // 1/s, position offset to velocity
+		double heightGain = 1.0;	 // 1/s, height error to climb rate
+		double yawGain = 2.0;			 // 1/s, yaw error to yaw rate
+		double maxTilt = 0.611;		 // rad
+		double maxVertical = 3.0;	 // m/s
+		double maxVelocity = 5.0;	 // m/s
+		double maxYawRate = 2.6;	 // rad/s
+		double maxAccel = 5.0;		 // m/s^2 vertical
+		double hoverThrust = 40;	 // % thrust that holds the UAV up
+		double drag = 0.3;				 // 1/s
+		Eigen::Vector3d wind = Eigen::Vector3d::Zero();
+		double commandTimeout = 0.5;	 // s without a command before braking to a hover
+		double takeoffHeight = 1.2;		 // m climbed by the takeoff task
+		double landingSpeed = 0.5;		 // m/s descent of the landing task
+		double touchdownSpeed = 1.5;	 // m/s relative vertical speed the deck survives
+
+		// Boat
+		double boatSpeed = 0.0;				// m/s
+		double boatHeading = 0.0;			// rad ENU, mean heading
+		double weaveAmplitude = 0.0;	// rad
+		double weavePeriod = 30.0;		// s
+		double heaveAmplitude = 0.0;	// m
+		double heavePeriod = 4.0;			// s
+		double deckHeight = 0.5;			// m above the water
+		double padRadius = 0.6;				// m, the UAV lands inside it
+		Eigen::Vector3d padOffset = Eigen::Vector3d::Zero(); // pad in the boat FLU frame
+		Eigen::Vector3d tagOffset = Eigen::Vector3d::Zero(); // tag from the pad in the boat FLU frame
+
+		// Camera on a gimbal that tracks the tag up to cameraCone from straight down
+		double cameraCone = 1.4;			// rad
+		double minRange = 0.3;				// m
+		double maxRange = 10.0;				// m
+		double detectNear = 0.98;			// probability of a detection at minRange
+		double detectFar = 0.5;				// at maxRange
+		double rangeNoise = 0.01;			// m of position noise per m of range
+	};
+
+	struct tag_t
+	{
+		bool seen;
+		Eigen::Vector3d position;				// tag from the UAV in the UAV FLU frame
+		Eigen::Quaterniond orientation; // tag in the UAV FLU frame
+	};
+
+	/** Constructor
+	 * @param seed seed of the tag detection noise
+	 */
+	UavSim(unsigned seed = 1);
+	UavSim(const params_t &params, unsigned seed = 1);
+
+	/** reset
+	 * Puts the boat at the origin and the UAV on the pad, disarmed, at time 0
+	 */
+	void reset();
+
+	/** command
+	 * Sets the DJI setpoint held until the next command
+	 *
+	 * @param flag DJI flag bits, see flag_t
+	 */
+	void command(double x, double y, double z, double w, uint8_t flag);
+
+	/** takeoff, land, arm
+	 * DJI tasks. Setpoints are ignored while a takeoff or landing runs.
+	 *
+	 * @return false if the UAV is in the wrong state for the task
+	 */
+	bool takeoff();
+	bool land();
+	bool arm(bool on);
+
+	void step();
+	void step(int n);
+
+	double time() const;
+
+	/** uav
+	 * @return position, velocity, roll pitch yaw and their rates, in the LQR order
+	 */
+	Eigen::Matrix<double, 12, 1> uav() const;
+
+	Eigen::Vector3d boatPosition() const;
+	Eigen::Vector3d boatVelocity() const;
+	double boatHeading() const;
+
+	/** padPosition
+	 * @return ENU position of the landing pad
+	 */
+	Eigen::Vector3d padPosition() const;
+
+	/** tagPosition
+	 * @return ENU position of the tag
+	 */
+	Eigen::Vector3d tagPosition() const;
+
+	/** tag
+	 * Takes a camera frame, so it draws from the noise
+	 */
+	tag_t tag();
+
+	bool armed() const;
+	bool landed() const; // on the pad
+	bool crashed() const;
+
+	/** touchdown
+	 * @return relative vertical speed of the last landing on the pad
+	 */
+	double touchdown() const;
+
+private:
+	enum task_t
+	{
+		NO_TASK,
+		TAKEOFF,
+		LANDING
+	};
+
+	void stepBoat();
+	void stepUav();
+
+	/** attitudeFor
+	 * Roll and pitch that make a horizontal ENU acceleration at the current yaw
+	 */
+	Eigen::Vector2d attitudeFor(const Eigen::Vector2d &accel) const;
+
+	params_t p_;
+	std::mt19937 rng_;
+	double t_ = 0;
+
+	// UAV
+	Eigen::Vector3d pos_, vel_, rpy_, rates_;
+	Eigen::Vector2d tiltCmd_; // roll and pitch the attitude loop tracks
+	Eigen::Vector3d target_;	// position setpoint
+	double cmd_[4];
+	uint8_t flag_;
+	double lastCommand_;
+	task_t task_;
+	double taskHeight_;
+	bool armed_, landed_, crashed_;
+	double touchdown_;
+	Eigen::Vector3d padLocal_; // UAV on the pad, in the boat frame
+	double padYaw_;						 // UAV yaw less the boat heading while landed
+
+	// Boat
+	Eigen::Vector3d boatPos_, boatVel_;
+	double boatYaw_;
+
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+} // namespace bsc_common
+
+#endif
@@ -0,0 +1,239 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a prioritized message link over UDP between two hosts.
+ * Commands are retransmitted until the peer acknowledges them, one at a time, so they
+ * arrive once and in order. Telemetry is best effort: it is sent only after any pending
+ * command and within the bandwidth budget, and the receiver drops anything older than
+ * the last message on its channel. Telemetry sequence gaps give the loss rate. Every
+ * datagram echoes the last stamp it heard from the peer and how long ago, so the round
+ * trip time is measured without synchronized clocks.
+ *
+ * Datagrams from any address but the peer's are dropped. With a shared key each datagram
+ * also carries a SipHash-2-4 tag of its header and payload, and ones that fail it are dropped.
+ * Each open picks a random session that the peer must echo, so a keyed datagram captured
+ * before a restart, or earlier in the session, is not accepted again. A datagram that
+ * does not echo the session is answered with a hello carrying it.
+ *
+ * Datagram: header_t then the payload, in host byte order on both ends.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_UDP_LINK_
+#define BSC_COMMON_UDP_LINK_
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bsc_common
+{
+class UdpLink
+{
+public:
+	enum priority_t
+	{
+		COMMAND = 0,
+		TELEMETRY = 1
+	};
+
+	static const size_t MAX_PAYLOAD = 60000;
+
+	struct stats_t
+	{
+		uint64_t sent, received;					 // datagrams, including acknowledgements
+		uint64_t sentBytes, receivedBytes; // including headers
+		uint64_t telemetry;								 // telemetry messages delivered
+		uint64_t lost;										 // telemetry sequence gaps
+		uint64_t late;										 // telemetry older than its channel, not delivered
+		uint64_t commands;								 // commands delivered
+		uint64_t retransmits, failed;			 // command resends, commands given up on
+		uint64_t dropped;									 // telemetry pushed out of a full queue
+		uint64_t rejected;								 // datagrams from another address or failing the key
+		double rtt, rttVar;								 // smoothed round trip and its deviation in seconds, 0 before a sample
+
+		double lossRate() const; // lost / (lost + telemetry)
+	};
+
+	/** handler_t
+	 * Called from poll for each delivered message
+	 */
+	typedef std::function<void(uint8_t channel, priority_t priority, const uint8_t *data, size_t size)> handler_t;
+
+	/** Constructor
+	 * @param telemetryQueue telemetry messages waiting to be sent before the oldest is dropped
+	 */
+	UdpLink(size_t telemetryQueue = 32);
+	~UdpLink();
+
+	/** open
+	 * @param port local port to bind, 0 for any
+	 * @param peerHost address of the other end
+	 * @param peerPort port of the other end
+	 *
+	 * @return false if the socket could not be bound or the peer resolved
+	 */
+	bool open(uint16_t port, const std::string &peerHost, uint16_t peerPort);
+	void close();
+	bool isOpen() const;
+
+	/** send
+	 * Queues a message, safe to call from any thread
+	 *
+	 * @param channel application channel, sequenced separately
+	 * @param priority COMMAND to deliver reliably ahead of telemetry, TELEMETRY for best effort
+	 *
+	 * @return false if the link is closed or the payload is too large
+	 */
+	bool send(uint8_t channel, priority_t priority, const uint8_t *data, size_t size);
+
+	/** poll
+	 * Receives waiting datagrams, calling handler for each new message, then sends what
+	 * is due: the command at the head of the queue, then telemetry. Call from one thread.
+	 *
+	 * @param timeout seconds to wait for a datagram or a send when nothing is waiting
+	 */
+	void poll(const handler_t &handler, double timeout = 0);
+
+	/** setBandwidth
+	 * Limits telemetry to a token bucket. Commands are always sent and use up the budget.
+	 *
+	 * @param bytesPerSecond 0 for no limit
+	 * @param burst bytes that can be sent at once
+	 */
+	void setBandwidth(double bytesPerSecond, double burst = 4096);
+
+	/** setRetries
+	 * @param maxRetries resends of a command before it is given up on
+	 * @param minTimeout seconds before the first resend, it grows with the round trip time and doubles per resend
+	 */
+	void setRetries(int maxRetries, double minTimeout = 0.05);
+
+	/** setKey
+	 * Signs outgoing datagrams and drops incoming ones not signed with the same key. Set the
+	 * same key on both ends. Any string works, it is hashed to the 128 bit SipHash key.
+	 *
+	 * @param key shared secret, empty to neither sign nor check
+	 */
+	void setKey(const std::string &key);
+
+	/** simulateLoss
+	 * Drops outgoing datagrams at random, for testing
+	 */
+	void simulateLoss(double probability, unsigned seed = 1);
+
+	stats_t stats() const;
+	size_t pendingCommands() const;
+
+private:
+	enum kind_t
+	{
+		KIND_COMMAND = 0,
+		KIND_TELEMETRY = 1,
+		KIND_ACK = 2,
+		KIND_HELLO = 3 // tells the peer the session, no payload
+	};
+
+	// 36 bytes
+	struct header_t
+	{
+		uint8_t magic;
+		uint8_t kind;
+		uint8_t channel;
+		uint8_t hasEcho;
+		uint32_t seq;
+		uint32_t stamp; // sender clock in us, wraps
+		uint32_t echo;	// last stamp heard from the peer
+		uint32_t hold;	// us between hearing echo and sending this
+		uint32_t session;			// random per open of the sender
+		uint32_t peerSession; // last session heard from the peer
+		uint32_t tag[2]; // SipHash of the header before it and the payload, 0 without a key
+	};
+
+	struct message_t
+	{
+		uint8_t channel;
+		uint32_t seq;
+		std::vector<uint8_t> data;
+	};
+
+	uint32_t nowUs() const;
+	void transmit(uint8_t kind, uint8_t channel, uint32_t seq, const uint8_t *data, size_t size);
+	void receive(const uint8_t *data, size_t size, std::vector<std::pair<header_t, std::vector<uint8_t>>> &delivered);
+	double retransmitTimeout() const;
+	uint64_t sign(const uint8_t *data, size_t size) const;
+	bool fromPeer(const void *address, size_t size) const;
+
+	int fd_ = -1, wake_ = -1;
+	std::vector<uint8_t> peer_; // sockaddr of the peer
+	std::vector<uint8_t> buffer_;
+	std::chrono::steady_clock::time_point epoch_;
+
+	mutable std::mutex mutex_;
+	std::deque<message_t> commands_, telemetry_;
+	size_t telemetryQueue_;
+	uint32_t commandSeq_;
+	uint32_t telemetrySeq_[256];
+
+	// Command in flight
+	bool inFlight_ = false;
+	int retries_ = 0, maxRetries_ = 10;
+	double minTimeout_ = 0.05;
+	std::chrono::steady_clock::time_point resendAt_;
+
+	// Receiver
+	bool heardCommand_ = false;
+	uint32_t lastCommand_ = 0;
+	bool heardTelemetry_[256];
+	uint32_t lastTelemetry_[256];
+	bool heardPeer_ = false;
+	uint32_t peerStamp_ = 0, peerHeardAt_ = 0;
+
+	// Sessions, the sequences are tracked for streamSession_
+	uint32_t session_ = 0, peerSession_ = 0, streamSession_ = 0;
+	bool hello_ = false;
+
+	// Bandwidth
+	double bandwidth_ = 0, burst_ = 4096, tokens_ = 4096;
+	std::chrono::steady_clock::time_point refilled_;
+
+	// Shared key
+	bool keyed_ = false;
+	uint64_t key_[2] = {0, 0};
+
+	// Simulated loss
+	double loss_ = 0;
+	std::mt19937 rng_;
+
+	stats_t stats_;
+};
+} // namespace bsc_common
+
+#endif
@@ -39,6 +39,9 @@ SOFTWARE.
 #include "geometry_msgs/Vector3.h"
 #include "std_msgs/Empty.h"
 
+#include "angles.h"
+#include "attitude.h"
+
 namespace bsc_common
 {
 class util
@@ -107,6 +110,8 @@ public:
 	 * @param start beginning angle
 	 * @param end final angle
 	 * @param rad=true using radians if true (default)
+	 *
+	 * @return stop-start in [-pi, pi) or [-180, 180)
 	 */
 	static double ang_dist(double start, double stop, bool rad = true);
 
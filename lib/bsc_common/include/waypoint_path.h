@@ -0,0 +1,108 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This class provides a polyline of waypoint legs with a spatial index.
+ * Legs are hashed into a uniform horizontal grid once per build, so the nearest leg
+ * to a point is found by searching outwards from its cell. Arc lengths are stored
+ * per leg so lookahead points are found by walking forward from a leg hint.
+ * 
+ * Author: Brennan Cain
+ */
+#ifndef BSC_COMMON_WAYPOINT_PATH_
+#define BSC_COMMON_WAYPOINT_PATH_
+#include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/StdVector>
+#include <vector>
+
+namespace bsc_common
+{
+class WaypointPath
+{
+public:
+	/* A straight leg of the path
+	 * dir is the unit direction, s0 the arc length at start
+	 */
+	struct leg_t
+	{
+		Eigen::Vector3d start, end, dir;
+		double length, s0;
+	};
+
+	/** build
+	 * Builds the legs between consecutive points and the grid. Memory is only
+	 * reallocated when the path grows past its previous size.
+	 *
+	 * @param points points of the path, the first one is where the path starts
+	 * @param cellSize grid cell size in meters, 0 picks the mean leg length
+	 */
+	void build(const std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d>> &points, double cellSize = 0);
+
+	void clear();
+
+	int size() const;
+	double length() const;
+	const leg_t &leg(int i) const;
+
+	/** nearestLeg
+	 * Finds the leg closest to p horizontally, ignoring legs before firstLeg
+	 *
+	 * @return index of the leg, -1 if there is none
+	 */
+	int nearestLeg(const Eigen::Vector3d &p, int firstLeg = 0) const;
+
+	/** project
+	 * @return arc length of the point of leg i closest to p
+	 */
+	double project(const Eigen::Vector3d &p, int i) const;
+
+	/** pointAt
+	 * Point at arc length s, walking forward from the leg hint
+	 *
+	 * @param s arc length, clamped to the path
+	 * @param leg hint, set to the leg containing the point
+	 */
+	Eigen::Vector3d pointAt(double s, int &leg) const;
+
+private:
+	std::vector<leg_t, Eigen::aligned_allocator<leg_t>> legs_;
+	int count_ = 0;
+
+	// Grid hashed into buckets, legs of bucket b are bucketLegs_[bucketStart_[b]:bucketStart_[b+1]]
+	double cellSize_ = 1;
+	Eigen::Vector2i minCell_, maxCell_;
+	std::vector<int> bucketStart_, bucketLegs_;
+	unsigned int bucketMask_ = 0;
+
+	unsigned int bucket(int cx, int cy) const;
+	int cell(double v) const;
+	double horizontalDistance(const Eigen::Vector3d &p, int i) const;
+
+	// Calls f(cx, cy) once for every cell a leg crosses and the cells around them
+	template <class F>
+	void forEachCell(const leg_t &l, F f) const;
+};
+} // namespace bsc_common
+
+#endif
@@ -0,0 +1,393 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the landing behaviors
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/landing_behaviors.h"
+#include "include/angles.h"
+#include "include/async_log.h"
+#include <cmath>
+
+namespace bsc_common
+{
+namespace
+{
+inline Eigen::Matrix2d rotation(double theta)
+{
+	Eigen::Matrix2d r;
+	r << cos(theta), -sin(theta), sin(theta), cos(theta);
+	return r;
+}
+
+inline double clip(double x, double low, double high)
+{
+	return x > high ? high : (x < low ? low : x);
+}
+
+LandingPredictor::envelope_t envelopeOf(const LandingBehaviors::params_t &p)
+{
+	LandingPredictor::envelope_t e;
+	e.xTop = p.landXTopThresh;
+	e.yTop = p.landYTopThresh;
+	e.xBottom = p.landXBottomThresh;
+	e.yBottom = p.landYBottomThresh;
+	e.bottom = p.landBottom;
+	e.top = p.landTop;
+	e.angle = p.landAngleThresh;
+	e.vel = p.landVelMag;
+	return e;
+}
+} // namespace
+
+LandingBehaviors::LandingBehaviors(const params_t &params, const Eigen::Matrix<double, 4, 12> &generalK,
+																	 const Eigen::Matrix<double, 4, 12> &landK)
+		: p_(params), generalLqr_(generalK), landLqr_(landK),
+			predictor_(landK, params.landPlant, 0.02, params.landPredictHorizon)
+{
+	predictor_.setEnvelope(envelopeOf(p_));
+	predictor_.setUncertainty(p_.landSigmaPos, p_.landSigmaVel);
+
+	state_t s;
+	s.droneP.setZero();
+	s.droneV.setZero();
+	s.droneRpy.setZero();
+	s.droneRates.setZero();
+	s.boatP.setZero();
+	s.boatV.setZero();
+	s.heading = 0;
+	state_ = s;
+	updateState(0, s);
+}
+
+void LandingBehaviors::setHooks(const hooks_t &hooks)
+{
+	hooks_ = hooks;
+}
+
+LandingBehaviors::params_t &LandingBehaviors::params()
+{
+	return p_;
+}
+
+double LandingBehaviors::lastSpotted() const
+{
+	return lastSpotted_;
+}
+
+const LandingBehaviors::state_t &LandingBehaviors::state() const
+{
+	return state_;
+}
+
+const LandingBehaviors::derived_t &LandingBehaviors::derived() const
+{
+	return derived_;
+}
+
+bool LandingBehaviors::propellorsRunning() const
+{
+	return propellorsRunning_;
+}
+
+int LandingBehaviors::aborts() const
+{
+	return aborts_;
+}
+
+LQR &LandingBehaviors::generalLqr()
+{
+	return generalLqr_;
+}
+
+LQR &LandingBehaviors::landLqr()
+{
+	return landLqr_;
+}
+
+void LandingBehaviors::updateState(double t, const state_t &state)
+{
+	state_ = state;
+
+	derived_t &d = derived_;
+	d.droneToWorld = rotation(state.droneRpy(2));
+	d.worldToDrone = d.droneToWorld.transpose();
+	d.boatToWorld = rotation(state.heading);
+	d.worldToBoat = d.boatToWorld.transpose();
+
+	d.boatOffsetWorld = state.droneP.head<2>() - state.boatP.head<2>();
+	d.boatOffsetBoat = d.worldToBoat * d.boatOffsetWorld;
+	d.boatOffsetZ = state.droneP(2) - state.boatP(2);
+	d.droneVelDrone = d.worldToDrone * state.droneV.head<2>();
+	d.boatVelDrone = d.worldToDrone * state.boatV.head<2>();
+	d.relVelSqr = (state.droneV.head<2>() - state.boatV.head<2>()).squaredNorm();
+
+	heave_.update(t, state.boatP(2));
+
+	Eigen::Matrix<double, 12, 1> lqrState;
+	lqrState << 0, 0, 0,
+			d.droneVelDrone(0), d.droneVelDrone(1), state.droneV(2),
+			state.droneRpy(0), state.droneRpy(1), 0,
+			state.droneRates;
+	generalLqr_.updateState(lqrState);
+	landLqr_.updateState(lqrState);
+}
+
+void LandingBehaviors::tagSeen(double t)
+{
+	lastSpotted_ = t;
+}
+
+void LandingBehaviors::send(const Eigen::Vector4d &u, flag_t flag)
+{
+	if (not hooks_.command)
+		return;
+	command_t cmd;
+	cmd.u = u;
+	cmd.flag = flag;
+	hooks_.command(cmd);
+}
+
+LandingBehaviors::mode_t LandingBehaviors::takeoff(bool &changed)
+{
+	if (propellorsRunning_)
+		return TAKEOFF;
+
+	if (hooks_.takeoff and hooks_.takeoff())
+	{
+		ASYNC_INFO("Propellors running, switching to follow");
+		propellorsRunning_ = true;
+		changed = true;
+		return FOLLOW;
+	}
+	ASYNC_WARN("Failure to Start props");
+	return TAKEOFF;
+}
+
+LandingBehaviors::mode_t LandingBehaviors::follow(double t, bool &changed)
+{
+	if (t - lastSpotted_ > p_.followTagLossThresh)
+	{
+		ASYNC_WARN("Follow lost tag for more than %1.1f seconds, hovering", p_.followTagLossThresh);
+		changed = true;
+		return HOVER;
+	}
+
+	// Get the setpoint in the drone FLU
+	Eigen::Vector4d goal_d = boatToDrone(p_.followGoal);
+	const Eigen::Vector2d &vBoat = derived_.boatVelDrone;
+
+	Eigen::Matrix<double, 12, 1> set;
+	set << goal_d(0), goal_d(1), goal_d(2), // Position setpoint (xyz)
+			vBoat(0), vBoat(1), 0,							// Velocity setpoint (xyz)
+			0, 0, goal_d(3),										// Angle setpoint (rpy)
+			0, 0, 0;														// Angular velocity setpoint (rpy)
+	Eigen::Vector4d cmd = generalLqr_.getCommand(set);
+	if (hooks_.control)
+		hooks_.control(generalLqr_);
+	send(cmd, LQR_FLAG);
+	return FOLLOW;
+}
+
+LandingBehaviors::mode_t LandingBehaviors::land(double t, bool &changed)
+{
+	if (changed)
+	{
+		changed = false;
+		waitStart_ = -1;
+		lastChecks_ = -1;
+		return LAND;
+	}
+
+	// Get the setpoint in the drone FLU
+	Eigen::Vector4d goal_d = boatToDrone(p_.landGoal);
+	const Eigen::Vector2d &vBoat = derived_.boatVelDrone;
+
+	// Landing lost the tag for too long, dangerous
+	if (t - lastSpotted_ > p_.landTagLossThresh)
+	{
+		++aborts_;
+		changed = true;
+		return follow(t, changed);
+	}
+
+	// The quiet wait only counts time spent in the envelope without a break
+	check_t c;
+	c.quietIn = heave_.quietIn(p_.landQuietTime, p_.landQuietSpeed, p_.landQuietWait);
+	c.waitElapsed = -1;
+	if (not inLandThreshold(c))
+		waitStart_ = -1;
+	bool open = c.in and landWindowOpen(t, c);
+	if (hooks_.landCheck)
+		hooks_.landCheck(c);
+
+	if (open)
+	{
+		ASYNC_WARN("CALLING LAND SERVICE");
+		ASYNC_WARN("Drone offset: %1.2f,%1.2f,%1.2f", goal_d(0), goal_d(1), goal_d(2));
+		return hooks_.land and hooks_.land() ? RIDE : LAND;
+	}
+
+	double vMult = clip(1 - fabs(goal_d(0)) / fabs(p_.followGoal(0) - p_.landGoal(0)), 0, 1);
+
+	// Hold at the top of the envelope unless descending now reaches it as the rest of it closes
+	LandingPredictor::prediction_t pred;
+	if (not predictLanding(goal_d, vMult, pred) or pred.confidence < p_.landMinConfidence or
+			pred.t - pred.heightTime > p_.landPaceSlack)
+		goal_d(2) += p_.landTop;
+
+	Eigen::Matrix<double, 12, 1> set;
+	set << goal_d(0), goal_d(1), goal_d(2), // Position setpoint (xyz)
+			vBoat(0) * vMult, 0, 0,							// Velocity setpoint (xyz)
+			0, 0, goal_d(3),										// Angle setpoint (rpy)
+			0, 0, 0;														// Angular velocity setpoint (rpy)
+	Eigen::Vector4d cmd = landLqr_.getCommand(set);
+	if (hooks_.control)
+		hooks_.control(landLqr_);
+	send(cmd, LQR_FLAG);
+	return LAND;
+}
+
+LandingBehaviors::mode_t LandingBehaviors::ride()
+{
+	if (propellorsRunning_)
+	{
+		propellorsRunning_ = not(hooks_.land and hooks_.land());
+		if (propellorsRunning_)
+			ASYNC_WARN("Failed to deactivate arms");
+		else
+			ASYNC_WARN("Arms deactivated");
+	}
+	return RIDE;
+}
+
+void LandingBehaviors::hover()
+{
+	// Hover is space
+	send(Eigen::Vector4d::Zero(), WORLD_RATE);
+}
+
+Eigen::Vector4d LandingBehaviors::boatToDrone(const Eigen::Vector4d &goal) const
+{
+	// Vertical setpoint and angular distance between headings
+	double vDiff = goal(2) + state_.boatP(2) - state_.droneP(2);
+	double wDiff = angles::wrap(goal(3) + state_.heading - state_.droneRpy(2));
+
+	// World frame vector from the drone to the setpoint, then into the drone frame
+	Eigen::Vector2d goalWorld = derived_.boatToWorld * goal.head<2>() - derived_.boatOffsetWorld;
+	Eigen::Vector4d out;
+	out << derived_.worldToDrone * goalWorld, vDiff, wDiff;
+	return out;
+}
+
+bool LandingBehaviors::inLandThreshold(check_t &c)
+{
+	c.x = derived_.boatOffsetBoat(0) - p_.landGoal(0);
+	c.y = derived_.boatOffsetBoat(1) - p_.landGoal(1);
+	c.z = derived_.boatOffsetZ - p_.landGoal(2);
+	c.w = angles::wrap(state_.droneRpy(2) - state_.heading - p_.landGoal(3));
+	c.vel = sqrt(derived_.relVelSqr);
+
+	double xb = p_.landXBottomThresh, xt = p_.landXTopThresh;
+	double yb = p_.landYBottomThresh, yt = p_.landYTopThresh;
+	double zb = p_.landBottom, zt = p_.landTop; // bottom and top of the trapezoid
+
+	c.xLow = (c.z - zb) * (xb - xt) / (zt - zb) - xb;
+	c.xHigh = (c.z - zb) * (xt - xb) / (zt - zb) + xb;
+	c.yLow = (c.z - zb) * (yb - yt) / (zt - zb) - yb;
+	c.yHigh = (c.z - zb) * (yt - yb) / (zt - zb) + yb;
+
+	c.inX = c.xLow < c.x and c.x < c.xHigh;
+	c.inY = c.yLow < c.y and c.y < c.yHigh;
+	c.inZ = zb < c.z and c.z < zt;
+	c.inW = fabs(c.w) < p_.landAngleThresh;
+	c.inVel = derived_.relVelSqr < p_.landVelMag * p_.landVelMag;
+	c.in = c.inX and c.inY and c.inZ and c.inW and c.inVel;
+
+	// Text only when a check flips
+	int checks = c.inX | c.inY << 1 | c.inZ << 2 | c.inW << 3 | c.inVel << 4;
+	if (checks != lastChecks_)
+	{
+		if (c.in)
+			ASYNC_WARN("Land threshold met");
+		else
+			ASYNC_WARN("Land threshold failing:%s%s%s%s%s", c.inX ? "" : " x", c.inY ? "" : " y", c.inZ ? "" : " z",
+								 c.inW ? "" : " w", c.inVel ? "" : " vel");
+		lastChecks_ = checks;
+	}
+	return c.in;
+}
+
+bool LandingBehaviors::landWindowOpen(double t, check_t &c)
+{
+	double next = c.quietIn;
+	bool started = waitStart_ < 0;
+	if (started)
+		waitStart_ = t;
+	double waited = c.waitElapsed = t - waitStart_;
+
+	// Text only when the wait starts and ends
+	bool open = true;
+	if (next == 0)
+	{
+		if (not started)
+			ASYNC_WARN("Quiet heave after %1.1fs, landing", waited);
+	}
+	else if (waited > p_.landQuietWait)
+		ASYNC_WARN("No quiet heave for %1.1fs, landing anyway", waited);
+	else
+	{
+		if (started and next > 0)
+			ASYNC_WARN("Waiting up to %1.1fs for quiet heave, %1.1fs predicted", p_.landQuietWait, next);
+		else if (started)
+			ASYNC_WARN("Waiting up to %1.1fs for quiet heave, none predicted", p_.landQuietWait);
+		open = false;
+	}
+
+	// A failed land call starts a new wait
+	if (open)
+		waitStart_ = -1;
+	return open;
+}
+
+bool LandingBehaviors::predictLanding(const Eigen::Vector4d &goal_d, double vMult,
+																			LandingPredictor::prediction_t &p) const
+{
+	const Eigen::Vector2d &vBoat = derived_.boatVelDrone;
+	Eigen::Vector2d vRel = derived_.droneVelDrone - vBoat;
+
+	LandingPredictor::state_t x0;
+	x0 << -goal_d(0), -goal_d(1), -goal_d(2),
+			vRel(0), vRel(1), state_.droneV(2) - state_.boatV(2),
+			state_.droneRpy(0), state_.droneRpy(1), -goal_d(3),
+			state_.droneRates;
+
+	// Same velocity setpoint as land, relative to the boat
+	Eigen::Vector3d velOffset(vBoat(0) * vMult - vBoat(0), -vBoat(1), 0);
+	return predictor_.predict(x0, velOffset, p_.landGoal(3), p);
+}
+} // namespace bsc_common
@@ -0,0 +1,112 @@
+#include "include/async_log.h"
+#include "include/landing_behaviors.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+using namespace bsc_common;
+
+static int check(const char *name, bool ok)
+{
+	printf("%-48s %s\n", name, ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+// Drone riding the heave at the land goal, or a meter above it
+static LandingBehaviors::state_t stateAt(const LandingBehaviors::params_t &p, double t, bool inside)
+{
+	LandingBehaviors::state_t s;
+	double heading = 1;
+	s.boatP << 5, 3, 0.3 * sin(2 * M_PI * t / 6);
+	s.boatV << 0, 0, 0.3 * 2 * M_PI / 6 * cos(2 * M_PI * t / 6);
+	s.heading = heading;
+	s.droneP = s.boatP;
+	s.droneP.head<2>() += Eigen::Rotation2Dd(heading) * p.landGoal.head<2>();
+	s.droneP(2) += p.landGoal(2) + (inside ? 0 : 1);
+	s.droneV = s.boatV;
+	s.droneRpy << 0, 0, heading + p.landGoal(3);
+	s.droneRates.setZero();
+	return s;
+}
+
+int main()
+{
+	int failures = 0;
+
+	// Count the quiet heave messages
+	std::mutex logMutex;
+	int waitLogs = 0, giveUpLogs = 0;
+	AsyncLog::instance().start([&](AsyncLog::level_t, const char *text) {
+		std::lock_guard<std::mutex> lock(logMutex);
+		waitLogs += strncmp(text, "Waiting", 7) == 0;
+		giveUpLogs += strncmp(text, "No quiet heave", 14) == 0;
+	});
+
+	LandingBehaviors::params_t p;
+	Eigen::Matrix<double, 4, 12> K = Eigen::Matrix<double, 4, 12>::Zero();
+	LandingBehaviors b(p, K, K);
+
+	int lands = 0, checks = 0, inside = 0;
+	LandingBehaviors::check_t last;
+	LandingBehaviors::hooks_t hooks;
+	hooks.land = [&]() { return ++lands, true; };
+	hooks.landCheck = [&](const LandingBehaviors::check_t &c) {
+		++checks, inside += c.in;
+		last = c;
+	};
+	b.setHooks(hooks);
+
+	// Fill the heave window with a swell that is never quiet, 50 Hz state and 25 Hz behaviors
+	double t = 0;
+	auto fly = [&](double until, bool in, LandingBehaviors::mode_t &mode, bool &changed) {
+		for (; t < until and mode == LandingBehaviors::LAND; t += 0.02)
+		{
+			b.updateState(t, stateAt(p, t, in));
+			b.tagSeen(t);
+			if (std::lround(t / 0.02) % 2 == 0)
+				mode = b.land(t, changed);
+		}
+	};
+	for (; t < 120; t += 0.02)
+		b.updateState(t, stateAt(p, t, true));
+
+	LandingBehaviors::mode_t mode = LandingBehaviors::LAND;
+	bool changed = true;
+	fly(135, true, mode, changed);
+	failures += check("waits in the envelope for quiet heave", lands == 0 and inside > 0 and inside == checks);
+
+	// Leaving the envelope restarts the wait
+	fly(136, false, mode, changed);
+	failures += check("no wait outside the envelope", last.waitElapsed == -1 and last.quietIn == -1);
+	double reentered = t;
+	fly(reentered + p.landQuietWait - 1, true, mode, changed);
+	failures += check("a break in the envelope restarts the wait", lands == 0 and mode == LandingBehaviors::LAND);
+	failures += check("checks carry the time waited", std::abs(last.waitElapsed - (p.landQuietWait - 1)) < 0.1);
+
+	fly(reentered + p.landQuietWait + 1, true, mode, changed);
+	failures += check("lands after quietWait of continuous envelope", lands == 1 and mode == LandingBehaviors::RIDE);
+
+	AsyncLog::instance().stop();
+	failures += check("each wait is logged once", waitLogs == 2 and giveUpLogs == 1);
+
+	// A quiet sea lands at once
+	LandingBehaviors calm(p, K, K);
+	calm.setHooks(hooks);
+	lands = 0;
+	LandingBehaviors::state_t s = stateAt(p, 0, true);
+	s.boatP(2) = 0;
+	s.boatV.setZero();
+	s.droneP(2) = p.landGoal(2);
+	s.droneV.setZero();
+	for (t = 0; t < 120; t += 0.02)
+		calm.updateState(t, s);
+	calm.tagSeen(t);
+	changed = true;
+	mode = calm.land(t, changed);
+	mode = calm.land(t + 0.04, changed);
+	failures += check("quiet heave lands without waiting", lands == 1 and mode == LandingBehaviors::RIDE);
+
+	printf(failures ? "FAILED (%d)\n" : "PASSED\n", failures);
+	return failures != 0;
+}
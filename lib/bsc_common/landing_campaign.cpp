@@ -0,0 +1,277 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the LandingCampaign class
+ */
+
+#include "include/landing_campaign.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace bsc_common
+{
+namespace
+{
+inline double clip(double x, double limit)
+{
+	return std::max(-limit, std::min(limit, x));
+}
+
+inline double draw(std::mt19937 &rng, const LandingCampaign::range_t &r)
+{
+	return std::uniform_real_distribution<double>(r.min, r.max)(rng);
+}
+
+LandingCampaign::stats_t statsOf(std::vector<double> v)
+{
+	LandingCampaign::stats_t s;
+	if (v.empty())
+		return s;
+	std::sort(v.begin(), v.end());
+	auto at = [&v](double q) { return v[std::min(v.size() - 1, (size_t)(q * v.size()))]; };
+	for (double x : v)
+		s.mean += x / v.size();
+	s.p5 = at(0.05);
+	s.p50 = at(0.5);
+	s.p95 = at(0.95);
+	s.max = v.back();
+	return s;
+}
+} // namespace
+
+LandingCampaign::config_t::config_t()
+{
+	// cfg/generalK.txt, which behaviors_M.yaml uses for both
+	generalK.setZero();
+	generalK(0, 1) = -0.886, generalK(0, 4) = -0.673, generalK(0, 6) = 1.092, generalK(0, 9) = 0.125;
+	generalK(1, 0) = 0.888, generalK(1, 3) = 0.676, generalK(1, 7) = 1.101, generalK(1, 10) = 0.129;
+	generalK(2, 2) = 0.604, generalK(2, 5) = 0.361;
+	generalK(3, 8) = 0.523, generalK(3, 11) = 0.332;
+	landK = generalK;
+}
+
+LandingCampaign::LandingCampaign(const config_t &config) : c_(config)
+{
+}
+
+LandingCampaign::result_t LandingCampaign::runOne(int index) const
+{
+	std::seed_seq seq{c_.seed, (unsigned)index};
+	std::mt19937 rng(seq);
+	std::uniform_real_distribution<double> uniform(0, 1);
+	std::normal_distribution<double> normal(0, 1);
+
+	result_t r;
+	r.run = index;
+	r.outcome = TIMEOUT;
+	r.time = r.error = r.touchdownSpeed = 0;
+
+	// Conditions
+	UavSim::params_t sp = c_.sim;
+	r.wind = draw(rng, c_.windSpeed);
+	double windDir = 2 * M_PI * uniform(rng);
+	sp.wind << r.wind * cos(windDir), r.wind * sin(windDir), 0;
+	sp.boatSpeed = r.boatSpeed = draw(rng, c_.boatSpeed);
+	sp.boatHeading = M_PI * (2 * uniform(rng) - 1);
+	sp.weaveAmplitude = r.weave = draw(rng, c_.weaveAmplitude);
+	sp.weavePeriod = draw(rng, c_.weavePeriod);
+	sp.heaveAmplitude = r.heave = draw(rng, c_.heaveAmplitude);
+	sp.heavePeriod = draw(rng, c_.heavePeriod);
+	sp.rangeNoise = draw(rng, c_.rangeNoise);
+	r.dropoutRate = draw(rng, c_.dropoutRate);
+	double dropoutLength = draw(rng, c_.dropoutLength);
+	r.positionNoise = draw(rng, c_.positionNoise);
+	double velocityNoise = draw(rng, c_.velocityNoise);
+
+	// The pad is under the land goal, which is set from the tag
+	sp.tagOffset << -c_.mission.landGoal(0), -c_.mission.landGoal(1), 0;
+
+	UavSim sim(sp, rng());
+	LandingMission mission(c_.mission, c_.generalK, c_.landK);
+	mission.setServices([&sim]() { return sim.takeoff(); }, [&sim]() { return sim.land(); });
+	mission.setMode(LandingMission::TAKEOFF);
+
+	const int stateEvery = std::max(1, (int)std::lround(1 / (c_.stateRate * sp.dt)));
+	const int tagEvery = std::max(1, (int)std::lround(1 / (c_.tagRate * sp.dt)));
+	const int behaviorEvery = std::max(1, (int)std::lround(1 / (c_.behaviorRate * sp.dt)));
+	const double tagPeriod = tagEvery * sp.dt;
+
+	double followStart = -1, landStart = -1, dropoutEnd = -1;
+	bool flown = false;
+	for (long i = 0; sim.time() < c_.timeout; ++i)
+	{
+		double t = sim.time();
+
+		// Colocalization: the boat position is the tag's, the UAV's carries the noise
+		if (i % stateEvery == 0)
+		{
+			Eigen::Matrix<double, 12, 1> x = sim.uav();
+			LandingMission::state_t s;
+			s.droneP = x.segment<3>(0);
+			s.droneV = x.segment<3>(3);
+			for (int j = 0; j < 3; ++j)
+			{
+				s.droneP(j) += r.positionNoise * normal(rng);
+				s.droneV(j) += velocityNoise * normal(rng);
+			}
+			s.droneRpy = x.segment<3>(6);
+			s.droneRates = x.segment<3>(9);
+			s.boatP = sim.tagPosition();
+			s.boatV = sim.boatVelocity();
+			s.heading = sim.boatHeading();
+			mission.updateState(t, s);
+		}
+
+		// Camera, with dropouts that hide the tag for a while
+		if (i % tagEvery == 0)
+		{
+			if (t >= dropoutEnd and uniform(rng) < r.dropoutRate * tagPeriod)
+				dropoutEnd = t + std::exponential_distribution<double>(1 / dropoutLength)(rng);
+			if (sim.tag().seen and t >= dropoutEnd)
+				mission.tagSeen(t);
+		}
+
+		if (i % behaviorEvery == 0)
+		{
+			LandingMission::mode_t mode = mission.mode();
+			if (mode == LandingMission::FOLLOW)
+			{
+				if (followStart < 0)
+					followStart = t;
+				else if (t - followStart >= c_.followTime)
+				{
+					mission.setMode(LandingMission::LAND);
+					if (landStart < 0)
+						landStart = t;
+				}
+			}
+			else
+				followStart = -1;
+
+			LandingMission::command_t cmd;
+			if (mission.step(t, cmd))
+			{
+				// dji_pilot::buildFlag and adaptiveClipping
+				if (cmd.flag == LandingMission::LQR_FLAG)
+					sim.command(clip(cmd.u(0), c_.hAngleCmdMax), clip(cmd.u(1), c_.hAngleCmdMax),
+											clip(cmd.u(2), c_.vVelocityMaxBody), clip(cmd.u(3), c_.yAngleRateMax),
+											UavSim::HORIZONTAL_ANGLE | UavSim::VERTICAL_VELOCITY | UavSim::YAW_RATE |
+													UavSim::HORIZONTAL_BODY);
+				else if (cmd.flag == LandingMission::WORLD_RATE)
+					sim.command(clip(cmd.u(0), c_.hVelocityMax), clip(cmd.u(1), c_.hVelocityMax),
+											clip(cmd.u(2), c_.vVelocityMaxGround), clip(cmd.u(3), c_.yAngleRateMax),
+											UavSim::HORIZONTAL_VELOCITY | UavSim::VERTICAL_VELOCITY | UavSim::YAW_RATE);
+				else
+					sim.command(cmd.u(0), cmd.u(1), cmd.u(2), cmd.u(3),
+											UavSim::HORIZONTAL_POSITION | UavSim::VERTICAL_POSITION | UavSim::YAW_ANGLE);
+			}
+			if (mission.mode() == LandingMission::HOVER)
+			{
+				r.outcome = LOST;
+				break;
+			}
+		}
+
+		sim.step();
+		flown = flown or not sim.landed();
+		if (sim.crashed())
+		{
+			r.outcome = CRASHED;
+			break;
+		}
+		if (flown and sim.landed() and mission.mode() == LandingMission::RIDE)
+		{
+			r.outcome = LANDED;
+			break;
+		}
+	}
+
+	r.aborts = mission.aborts();
+	if (r.outcome == LANDED or r.outcome == CRASHED)
+	{
+		r.time = landStart < 0 ? 0 : sim.time() - landStart;
+		r.error = (sim.uav().head<2>() - sim.padPosition().head<2>()).norm();
+		r.touchdownSpeed = sim.touchdown();
+	}
+	return r;
+}
+
+std::vector<LandingCampaign::result_t> LandingCampaign::run(int runs, int threads) const
+{
+	std::vector<result_t> results(std::max(0, runs));
+	std::atomic<int> next(0);
+	auto worker = [&]() {
+		for (int i = next++; i < runs; i = next++)
+			results[i] = runOne(i);
+	};
+
+	std::vector<std::thread> pool;
+	for (int t = 1; t < std::min(threads, runs); ++t)
+		pool.push_back(std::thread(worker));
+	worker();
+	for (std::thread &t : pool)
+		t.join();
+	return results;
+}
+
+LandingCampaign::summary_t LandingCampaign::summarize(const std::vector<result_t> &results)
+{
+	summary_t s;
+	std::vector<double> time, error, speed;
+	for (const result_t &r : results)
+	{
+		++s.runs;
+		++s.outcomes[r.outcome];
+		if (r.outcome == LANDED)
+		{
+			time.push_back(r.time);
+			error.push_back(r.error);
+			speed.push_back(r.touchdownSpeed);
+		}
+	}
+	if (s.runs)
+	{
+		double n = s.runs, p = s.outcomes[LANDED] / n, z = 1.96;
+		double center = (p + z * z / (2 * n)) / (1 + z * z / n);
+		double half = z / (1 + z * z / n) * sqrt(p * (1 - p) / n + z * z / (4 * n * n));
+		s.successRate = p;
+		s.successLow = std::max(0.0, center - half);
+		s.successHigh = std::min(1.0, center + half);
+	}
+	s.time = statsOf(time);
+	s.error = statsOf(error);
+	s.touchdownSpeed = statsOf(speed);
+	return s;
+}
+
+const char *LandingCampaign::outcomeName(outcome_t outcome)
+{
+	static const char *names[] = {"landed", "crashed", "lost", "timeout"};
+	return outcome < OUTCOMES ? names[outcome] : "unknown";
+}
+} // namespace bsc_common
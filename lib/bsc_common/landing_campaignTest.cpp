@@ -0,0 +1,162 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/landing_campaign.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+using namespace bsc_common;
+
+static LandingCampaign::config_t calm()
+{
+	LandingCampaign::config_t c;
+	c.windSpeed = c.boatSpeed = c.weaveAmplitude = c.heaveAmplitude = c.dropoutRate = {0, 0};
+	c.positionNoise = c.velocityNoise = {0, 0};
+	return c;
+}
+
+int main()
+{
+	int failures = 0;
+
+	// Mode changes follow behaviors
+	{
+		LandingCampaign::config_t c;
+		LandingMission mission(c.mission, c.generalK, c.landK);
+		int takeoffs = 0, lands = 0;
+		mission.setServices([&]() { return ++takeoffs > 1; }, [&]() { return ++lands, true; });
+		LandingMission::command_t cmd;
+		mission.setMode(LandingMission::TAKEOFF);
+		mission.step(0, cmd);
+		bool ok = mission.mode() == LandingMission::TAKEOFF;
+		mission.step(0.04, cmd);
+		ok = ok and takeoffs == 2 and mission.mode() == LandingMission::FOLLOW;
+
+		// Follow holds with the tag, hovers without it
+		mission.tagSeen(0.1);
+		ok = ok and mission.step(5, cmd) and cmd.flag == LandingMission::LQR_FLAG;
+		ok = ok and not mission.step(10.2, cmd) and mission.mode() == LandingMission::HOVER;
+		ok = ok and mission.step(10.24, cmd) and cmd.flag == LandingMission::WORLD_RATE and cmd.u.isZero();
+
+		// Land falls back to follow when the tag is lost for land_tagLossThresh
+		mission.tagSeen(7);
+		mission.setMode(LandingMission::LAND);
+		ok = ok and not mission.step(10.28, cmd);
+		ok = ok and mission.step(10.32, cmd) and mission.mode() == LandingMission::FOLLOW and mission.aborts() == 1;
+
+		// At the land goal, level and still, it calls land
+		LandingMission::state_t s;
+		s.boatP << 5, 3, 0.5;
+		s.boatV.setZero();
+		s.heading = 1;
+		s.droneP = s.boatP;
+		s.droneP.head<2>() += Eigen::Rotation2Dd(1) * c.mission.landGoal.head<2>();
+		s.droneP(2) += c.mission.landGoal(2);
+		s.droneV.setZero();
+		s.droneRpy << 0, 0, 1;
+		s.droneRates.setZero();
+		mission.updateState(10.36, s);
+		mission.tagSeen(10.36);
+		mission.setMode(LandingMission::LAND);
+		mission.step(10.36, cmd);
+		ok = ok and not mission.step(10.4, cmd) and lands == 1 and mission.mode() == LandingMission::RIDE;
+		if (not ok)
+		{
+			++failures;
+			printf("  FAIL: mission modes\n");
+		}
+	}
+
+	// Calm conditions always land on the pad
+	{
+		LandingCampaign campaign(calm());
+		std::vector<LandingCampaign::result_t> r = campaign.run(8, 2);
+		LandingCampaign::summary_t s = LandingCampaign::summarize(r);
+		if (s.outcomes[LandingCampaign::LANDED] != 8 or s.error.max > 0.1 or s.time.max > 15 or
+				s.touchdownSpeed.max > 1)
+		{
+			++failures;
+			printf("  FAIL: calm landings %i of 8, error %.2fm, %.1fs\n", s.outcomes[LandingCampaign::LANDED], s.error.max,
+						 s.time.max);
+		}
+	}
+
+	// Results depend on the seed and run, not the threads
+	{
+		LandingCampaign::config_t c;
+		LandingCampaign campaign(c);
+		std::vector<LandingCampaign::result_t> a = campaign.run(12, 1), b = campaign.run(12, 3);
+		bool same = true, varied = false;
+		for (int i = 0; i < 12; ++i)
+		{
+			same = same and a[i].run == i and b[i].run == i and a[i].outcome == b[i].outcome and a[i].time == b[i].time and
+						 a[i].error == b[i].error and a[i].wind == b[i].wind;
+			varied = varied or a[i].wind != a[0].wind;
+		}
+		c.seed = 2;
+		varied = varied and LandingCampaign(c).runOne(0).wind != a[0].wind;
+		if (not same or not varied)
+		{
+			++failures;
+			printf("  FAIL: deterministic runs\n");
+		}
+	}
+
+	// Wilson interval
+	{
+		std::vector<LandingCampaign::result_t> r(100);
+		for (int i = 0; i < 100; ++i)
+			r[i].outcome = i < 80 ? LandingCampaign::LANDED : LandingCampaign::CRASHED;
+		LandingCampaign::summary_t s = LandingCampaign::summarize(r);
+		if (std::fabs(s.successRate - 0.8) > 1e-9 or std::fabs(s.successLow - 0.711) > 0.001 or
+				std::fabs(s.successHigh - 0.867) > 0.001)
+		{
+			++failures;
+			printf("  FAIL: success %.3f [%.3f %.3f]\n", s.successRate, s.successLow, s.successHigh);
+		}
+	}
+
+	// Scaling across cores
+	{
+		LandingCampaign campaign((LandingCampaign::config_t()));
+		int cores = std::max(1u, std::thread::hardware_concurrency()), runs = 8 * cores;
+		auto s = std::chrono::steady_clock::now();
+		campaign.run(runs, 1);
+		auto m = std::chrono::steady_clock::now();
+		std::vector<LandingCampaign::result_t> r = campaign.run(runs, cores);
+		auto e = std::chrono::steady_clock::now();
+		double one = std::chrono::duration<double>(m - s).count(), all = std::chrono::duration<double>(e - m).count();
+		LandingCampaign::summary_t sum = LandingCampaign::summarize(r);
+		printf("%i runs: %.0f runs/s on 1 thread, %.0f runs/s on %i, %.2fx; %.0f%% landed\n", runs, runs / one,
+					 runs / all, cores, one / all, 100 * sum.successRate);
+	}
+
+	if (failures)
+		printf("%i FAILURES\n", failures);
+	else
+		printf("PASSED\n");
+	return failures;
+}
@@ -0,0 +1,93 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the landing mission
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/landing_mission.h"
+
+namespace bsc_common
+{
+LandingMission::LandingMission(const params_t &params, const Eigen::Matrix<double, 4, 12> &generalK,
+															 const Eigen::Matrix<double, 4, 12> &landK)
+		: LandingBehaviors(params, generalK, landK)
+{
+	callbacks_.command = [this](const command_t &cmd) {
+		if (cmd_)
+			*cmd_ = cmd;
+		sent_ = true;
+	};
+	setHooks(callbacks_);
+}
+
+void LandingMission::setServices(std::function<bool()> takeoff, std::function<bool()> land)
+{
+	callbacks_.takeoff = takeoff;
+	callbacks_.land = land;
+	setHooks(callbacks_);
+}
+
+void LandingMission::setMode(mode_t mode)
+{
+	changed_ = changed_ or mode != mode_;
+	mode_ = mode;
+}
+
+LandingMission::mode_t LandingMission::mode() const
+{
+	return mode_;
+}
+
+bool LandingMission::step(double t, command_t &cmd)
+{
+	cmd_ = &cmd;
+	sent_ = false;
+	switch (mode_)
+	{
+	case TAKEOFF:
+		mode_ = takeoff(changed_);
+		break;
+	case FOLLOW:
+		mode_ = follow(t, changed_);
+		break;
+	case LAND:
+		mode_ = land(t, changed_);
+		break;
+	case RIDE:
+		mode_ = ride();
+		break;
+	case HOVER:
+		hover();
+		break;
+	default:
+		mode_ = propellorsRunning() ? HOVER : RIDE;
+		break;
+	}
+	cmd_ = nullptr;
+	return sent_;
+}
+} // namespace bsc_common
@@ -0,0 +1,182 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the landing predictor
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/landing_predictor.h"
+#include "include/angles.h"
+#include <cmath>
+
+namespace bsc_common
+{
+// e^M by scaling and squaring a Taylor series
+template <class M>
+static M expm(const M &m)
+{
+	int squarings = std::max(0, (int)ceil(log2(m.cwiseAbs().rowwise().sum().maxCoeff() / 0.5)));
+	M a = m / std::pow(2.0, squarings);
+	M e = M::Identity(), term = M::Identity();
+	for (int i = 1; i <= 12; ++i)
+	{
+		term = term * a / i;
+		e += term;
+	}
+	for (int i = 0; i < squarings; ++i)
+		e = e * e;
+	return e;
+}
+
+LandingPredictor::LandingPredictor(const Eigen::Matrix<double, 4, 12> &K, const plant_t &plant, double dt,
+																	 double horizon)
+{
+	K_ = K;
+	dt_ = dt;
+	steps_ = (int)ceil(horizon / dt);
+	toleranceSteps_ = (int)round(0.5 / dt);
+	const double g = 9.81, w2 = plant.attFreq * plant.attFreq, c = 2 * plant.attDamp * plant.attFreq;
+
+	matrix_t A = matrix_t::Zero();
+	Eigen::Matrix<double, 12, 4> B = Eigen::Matrix<double, 12, 4>::Zero();
+	A.block<3, 3>(0, 3).setIdentity(); // position from velocity
+	A(3, 7) = g;											 // forward from pitch
+	A(4, 6) = -g;											 // left from roll
+	A(5, 5) = -1 / plant.zTau;
+	B(5, 2) = 1 / plant.zTau;
+	A.block<3, 3>(6, 9).setIdentity(); // angles from rates
+	A(9, 6) = A(10, 7) = -w2;
+	A(9, 9) = A(10, 10) = -c;
+	B(9, 0) = B(10, 1) = w2;
+	A(11, 11) = -1 / plant.yawTau;
+	B(11, 3) = 1 / plant.yawTau;
+
+	// u = K (setpoint - x), the only nonzero setpoint entries are the velocity offset
+	matrix_t BK = B * K_;
+	Eigen::Matrix<double, 24, 24> aug = Eigen::Matrix<double, 24, 24>::Zero();
+	aug.topLeftCorner<12, 12>() = (A - BK) * dt_;
+	aug.topRightCorner<12, 12>() = matrix_t::Identity() * dt_;
+	Eigen::Matrix<double, 24, 24> e = expm(aug);
+	phi_ = e.topLeftCorner<12, 12>();
+	gamma_ = e.topRightCorner<12, 12>() * BK.middleCols<3>(3);
+
+	buildSpread();
+}
+
+void LandingPredictor::setEnvelope(const envelope_t &envelope)
+{
+	envelope_ = envelope;
+}
+
+void LandingPredictor::setUncertainty(double pos, double vel, double tolerance)
+{
+	sigmaPos_ = pos;
+	sigmaVel_ = vel;
+	toleranceSteps_ = (int)round(tolerance / dt_);
+	buildSpread();
+}
+
+double LandingPredictor::dt() const
+{
+	return dt_;
+}
+
+int LandingPredictor::steps() const
+{
+	return steps_;
+}
+
+void LandingPredictor::buildSpread()
+{
+	spread_.resize(steps_ + 1);
+	spread_[0].setZero();
+	for (int i = 0; i < 3; ++i)
+	{
+		spread_[0](i, i) = sigmaPos_;
+		spread_[0](i + 3, i + 3) = sigmaVel_;
+	}
+	for (int k = 0; k < steps_; ++k)
+		spread_[k + 1] = phi_ * spread_[k];
+}
+
+bool LandingPredictor::inside(const state_t &x, double goalYaw) const
+{
+	const envelope_t &v = envelope_;
+	double z = x(2);
+	if (not(v.bottom < z and z < v.top))
+		return false;
+
+	double w = angles::wrap(x(8));
+	if (std::abs(w) >= v.angle or x(3) * x(3) + x(4) * x(4) >= v.vel * v.vel)
+		return false;
+
+	// Position error in the boat frame
+	double yaw = w + goalYaw, c = cos(yaw), s = sin(yaw);
+	double bx = c * x(0) - s * x(1), by = s * x(0) + c * x(1);
+
+	double xh = (z - v.bottom) * (v.xTop - v.xBottom) / (v.top - v.bottom) + v.xBottom;
+	double yh = (z - v.bottom) * (v.yTop - v.yBottom) / (v.top - v.bottom) + v.yBottom;
+	return std::abs(bx) < xh and std::abs(by) < yh;
+}
+
+bool LandingPredictor::predict(const state_t &x0, const Eigen::Vector3d &velOffset, double goalYaw,
+															 prediction_t &p) const
+{
+	Eigen::Matrix<double, 12, 1> f = gamma_ * velOffset;
+	state_t x = x0;
+	int first = -1, height = -1, in = 0;
+	bool entered[12] = {false};
+	for (int k = 0; k <= steps_; ++k)
+	{
+		if (height < 0 and envelope_.bottom < x(2) and x(2) < envelope_.top)
+			height = k;
+		if (first < 0 and inside(x, goalYaw))
+			first = k;
+
+		// Count the sigma points that enter within the tolerance after the nominal state does
+		if (first >= 0)
+		{
+			for (int j = 0; j < 12; ++j)
+			{
+				if (not entered[j] and inside(j < 6 ? state_t(x + spread_[k].col(j)) : state_t(x - spread_[k].col(j - 6)), goalYaw))
+				{
+					entered[j] = true;
+					++in;
+				}
+			}
+			if (in == 12 or k - first >= toleranceSteps_)
+				break;
+		}
+		x = phi_ * x + f;
+	}
+	if (first < 0)
+		return false;
+	p.t = first * dt_;
+	p.heightTime = height * dt_;
+	p.confidence = in / 12.0;
+	return true;
+}
+} // namespace bsc_common
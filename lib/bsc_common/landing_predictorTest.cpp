@@ -0,0 +1,181 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/landing_predictor.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using namespace bsc_common;
+typedef LandingPredictor::state_t state_t;
+
+// cfg/landK.txt
+static Eigen::Matrix<double, 4, 12> landK()
+{
+	Eigen::Matrix<double, 4, 12> K = Eigen::Matrix<double, 4, 12>::Zero();
+	K(0, 1) = -0.643, K(0, 4) = -0.575, K(0, 6) = 0.920, K(0, 9) = 0.102;
+	K(1, 0) = 0.644, K(1, 3) = 0.577, K(1, 7) = 0.926, K(1, 10) = 0.105;
+	K(2, 2) = 0.604, K(2, 5) = 0.361;
+	K(3, 8) = 0.440, K(3, 11) = 0.249;
+	return K;
+}
+
+// Same model integrated with RK4 at a fine step, as the reference
+static state_t derivative(const state_t &x, const Eigen::Matrix<double, 4, 12> &K, const LandingPredictor::plant_t &p,
+													const Eigen::Vector3d &velOffset)
+{
+	state_t set = state_t::Zero();
+	set.segment<3>(3) = velOffset;
+	Eigen::Vector4d u = K * (set - x);
+	double w2 = p.attFreq * p.attFreq, c = 2 * p.attDamp * p.attFreq;
+	state_t d;
+	d.head<3>() = x.segment<3>(3);
+	d(3) = 9.81 * x(7);
+	d(4) = -9.81 * x(6);
+	d(5) = (u(2) - x(5)) / p.zTau;
+	d.segment<3>(6) = x.tail<3>();
+	d(9) = w2 * (u(0) - x(6)) - c * x(9);
+	d(10) = w2 * (u(1) - x(7)) - c * x(10);
+	d(11) = (u(3) - x(11)) / p.yawTau;
+	return d;
+}
+
+int main()
+{
+	int failures = 0;
+	LandingPredictor::plant_t plant;
+	LandingPredictor predictor(landK(), plant, 0.02, 6);
+
+	// cfg/behaviors.yaml land envelope, relative to the goal
+	LandingPredictor::envelope_t envelope;
+	envelope.xTop = envelope.yTop = 0.09;
+	envelope.xBottom = envelope.yBottom = 0.15;
+	envelope.bottom = -0.15;
+	envelope.top = 0.1;
+	envelope.angle = 0.25;
+	envelope.vel = 0.15;
+	predictor.setEnvelope(envelope);
+
+	// Approaches from behind, to the side, above and rotated
+	state_t starts[4];
+	for (int i = 0; i < 4; ++i)
+		starts[i].setZero();
+	starts[0] << -0.6, 0, 0.5, 0.3, 0, 0, 0, 0, 0, 0, 0, 0;
+	starts[1] << 0.2, 0.4, 0.3, 0, -0.2, -0.1, 0.02, 0, 0.1, 0, 0, 0;
+	starts[2] << 0, 0, 0.8, 0, 0, 0, 0, 0, 0, 0, 0, 0;
+	starts[3] << -0.3, -0.3, 0.6, 0.1, 0.1, 0, -0.03, 0.03, 0.4, 0, 0, 0.1;
+	Eigen::Vector3d velOffset(0, 0, 0);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		LandingPredictor::prediction_t p;
+		bool found = predictor.predict(starts[i], velOffset, 0, p);
+
+		// First time the fine reference is inside
+		state_t x = starts[i];
+		double h = 0.001, tRef = -1;
+		for (int k = 0; k * h <= 6; ++k)
+		{
+			if (predictor.inside(x, 0))
+			{
+				tRef = k * h;
+				break;
+			}
+			state_t k1 = derivative(x, landK(), plant, velOffset);
+			state_t k2 = derivative(x + h / 2 * k1, landK(), plant, velOffset);
+			state_t k3 = derivative(x + h / 2 * k2, landK(), plant, velOffset);
+			state_t k4 = derivative(x + h * k3, landK(), plant, velOffset);
+			x += h / 6 * (k1 + 2 * k2 + 2 * k3 + k4);
+		}
+		printf("approach %i: predicted %s %1.2fs (height %1.2fs) confidence %1.2f, reference %1.3fs\n", i,
+					 found ? "in" : "never", found ? p.t : 0.0, found ? p.heightTime : 0.0, found ? p.confidence : 0.0, tRef);
+		if (found != (tRef >= 0) or (found and std::abs(p.t - tRef) > predictor.dt() + 1e-9) or p.heightTime > p.t or
+				p.confidence < 0 or p.confidence > 1)
+		{
+			printf("  FAIL\n");
+			++failures;
+		}
+	}
+
+	// Already inside, and a drift the loop can not cancel in time
+	{
+		LandingPredictor::prediction_t p;
+		if (not predictor.predict(state_t::Zero(), velOffset, 0, p) or p.t != 0 or p.confidence <= 0.5)
+		{
+			printf("  FAIL: inside now\n");
+			++failures;
+		}
+		if (predictor.predict(starts[0], Eigen::Vector3d(2, 0, 0), 0, p))
+		{
+			printf("  FAIL: velocity offset\n");
+			++failures;
+		}
+	}
+
+	// Confidence drops with the uncertainty on a short approach
+	{
+		state_t close;
+		close << -0.12, 0.05, 0.15, 0.1, 0, -0.2, 0, 0, 0, 0, 0, 0;
+		LandingPredictor::prediction_t p;
+		double c1 = 0, c2 = 0;
+		predictor.setUncertainty(0.01, 0.01);
+		if (predictor.predict(close, velOffset, 0, p))
+			c1 = p.confidence;
+		predictor.setUncertainty(0.2, 0.2);
+		if (predictor.predict(close, velOffset, 0, p))
+			c2 = p.confidence;
+		printf("confidence %1.2f with 1cm, %1.2f with 20cm\n", c1, c2);
+		if (c2 >= c1)
+		{
+			printf("  FAIL: confidence\n");
+			++failures;
+		}
+	}
+
+	// Benchmark against the 25Hz control tick, worst case is a rollout that never enters
+	{
+		const int n = 20000;
+		LandingPredictor::prediction_t p;
+		double sum = 0;
+		auto t0 = std::chrono::steady_clock::now();
+		for (int k = 0; k < n; ++k)
+		{
+			state_t x = starts[0];
+			x(0) -= 0.001 * (k % 100);
+			if (predictor.predict(x, Eigen::Vector3d(2, 0, 0), 0, p))
+				sum += p.t;
+		}
+		auto t1 = std::chrono::steady_clock::now();
+		double us = std::chrono::duration<double, std::micro>(t1 - t0).count() / n;
+		printf("full %i step rollout %1.2fus, %1.3f%% of a 40ms tick (%g)\n", predictor.steps(), us, us / 400, sum);
+		if (us > 400)
+		{
+			printf("  FAIL: over 1%% of the tick\n");
+			++failures;
+		}
+	}
+
+	printf(failures ? "%i FAILURES\n" : "PASSED\n", failures);
+	return failures ? 1 : 0;
+}
@@ -107,4 +107,24 @@ Eigen::Matrix<double, 4, 1> LQR::getCommand(Eigen::Matrix<double, 12, 1> set)
 	u = K * (xs- xh);
 	return u;
 }
+
+const Eigen::Matrix<double, 4, 12> &LQR::getK() const
+{
+	return K;
+}
+
+const Eigen::Matrix<double, 12, 1> &LQR::getState() const
+{
+	return xh;
+}
+
+const Eigen::Matrix<double, 12, 1> &LQR::getSetpoint() const
+{
+	return xs;
+}
+
+const Eigen::Matrix<double, 4, 1> &LQR::getOutput() const
+{
+	return u;
+}
 } // namespace bsc_common
@@ -0,0 +1,463 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the minimum snap trajectory
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/min_snap.h"
+#include <algorithm>
+#include <cmath>
+
+namespace bsc_common
+{
+const Eigen::Matrix<double, 8, 8> &MinSnapTrajectory::endpointsToCoeffs()
+{
+	static const Eigen::Matrix<double, 8, 8> Ainv = [] {
+		// Rows are derivatives 0-3 of tau^j at tau = 0 and tau = 1
+		Eigen::Matrix<double, 8, 8> A = Eigen::Matrix<double, 8, 8>::Zero();
+		for (int k = 0; k < 4; ++k)
+		{
+			double f = 1;
+			for (int m = 2; m <= k; ++m)
+				f *= m;
+			A(k, k) = f;
+			for (int j = k; j < 8; ++j)
+			{
+				double d = 1;
+				for (int m = 0; m < k; ++m)
+					d *= j - m;
+				A(4 + k, j) = d;
+			}
+		}
+		return Eigen::Matrix<double, 8, 8>(A.inverse());
+	}();
+	return Ainv;
+}
+
+Eigen::Matrix<double, 8, 8> MinSnapTrajectory::segmentHessian(double T)
+{
+	static const Eigen::Matrix<double, 8, 8> H0 = [] {
+		// Integral of the squared 4th derivative over tau in [0, 1]
+		Eigen::Matrix<double, 8, 8> Q = Eigen::Matrix<double, 8, 8>::Zero();
+		for (int i = 4; i < 8; ++i)
+			for (int j = 4; j < 8; ++j)
+			{
+				double fi = i * (i - 1) * (i - 2) * (i - 3), fj = j * (j - 1) * (j - 2) * (j - 3);
+				Q(i, j) = fi * fj / (i + j - 7);
+			}
+		const Eigen::Matrix<double, 8, 8> &Ainv = endpointsToCoeffs();
+		return Eigen::Matrix<double, 8, 8>(Ainv.transpose() * Q * Ainv);
+	}();
+
+	// Normalized derivative k is T^k times the real one, and the cost integral scales by T^-7
+	Eigen::Matrix<double, 8, 1> s;
+	s << 1, T, T * T, T * T * T, 1, T, T * T, T * T * T;
+	return s.asDiagonal() * H0 * s.asDiagonal() / std::pow(T, 7);
+}
+
+double MinSnapTrajectory::trapezoidTime(double s, double d, double v0, double v1, double maxVel, double maxAcc)
+{
+	// Accelerate from v0 to the peak, cruise, then decelerate to v1
+	double vp = std::min(maxVel, std::sqrt(std::max(0.0, maxAcc * d + 0.5 * (v0 * v0 + v1 * v1))));
+	double dAcc = std::max(0.0, (vp * vp - v0 * v0) / (2 * maxAcc));
+	double dDec = std::max(0.0, (vp * vp - v1 * v1) / (2 * maxAcc));
+	double cruise = std::max(0.0, d - dAcc - dDec);
+	double tAcc = (vp - v0) / maxAcc;
+
+	if (s <= dAcc)
+		return (std::sqrt(v0 * v0 + 2 * maxAcc * s) - v0) / maxAcc;
+	if (s <= dAcc + cruise)
+		return tAcc + (s - dAcc) / vp;
+	double r = s - dAcc - cruise;
+	return tAcc + cruise / vp + (vp - std::sqrt(std::max(0.0, vp * vp - 2 * maxAcc * r))) / maxAcc;
+}
+
+bool MinSnapTrajectory::solve(const points_t &points, const std::vector<double> &radius,
+															const std::vector<double> &hold, double maxVel, double maxAcc,
+															const Eigen::Vector3d &startVel)
+{
+	segments_.clear();
+	hint_ = 0;
+	if (points.size() < 2 or not(maxVel > 0) or not(maxAcc > 0))
+		return false;
+
+	// Repeated waypoints are merged, a leg of zero length has no sensible duration
+	points_t wp;
+	std::vector<double> wpRadius, wpHold;
+	std::vector<int> wpLast, wpOf(points.size());
+	for (int i = 0; i < (int)points.size(); ++i)
+	{
+		double r = i < (int)radius.size() ? radius[i] : 0;
+		double h = i < (int)hold.size() ? std::max(0.0, hold[i]) : 0;
+		if (wp.empty() or (points[i] - wp.back()).norm() > 1e-6)
+		{
+			wp.push_back(points[i]);
+			wpRadius.push_back(r);
+			wpHold.push_back(h);
+			wpLast.push_back(i);
+		}
+		else
+		{
+			wpRadius.back() = std::min(wpRadius.back(), r);
+			wpHold.back() += h;
+			wpLast.back() = i;
+		}
+		wpOf[i] = wp.size() - 1;
+	}
+	int W = wp.size();
+	startVel_ = startVel;
+
+	/* Smoothing a trapezoidal profile's acceleration steps overshoots them, so profiles are
+	 * planned with 60% of the acceleration limit, which leaves the velocity limit to bind.
+	 */
+	double planAcc = 0.6 * maxAcc;
+
+	/* Speed through each waypoint from the turn it makes, limited so every leg can reach it.
+	 * Stops, the start, and the end are taken at rest or the start velocity.
+	 */
+	std::vector<double> corner(W, 0);
+	corner[0] = std::min(startVel.norm(), maxVel);
+	for (int k = 1; k < W - 1; ++k)
+		if (wpHold[k] <= 0)
+		{
+			double c = (wp[k] - wp[k - 1]).normalized().dot((wp[k + 1] - wp[k]).normalized());
+			corner[k] = maxVel * std::max(0.0, c);
+		}
+	for (int k = 0; k < W - 1; ++k)
+		corner[k + 1] = std::min(corner[k + 1], std::sqrt(corner[k] * corner[k] + 2 * planAcc * (wp[k + 1] - wp[k]).norm()));
+	for (int k = W - 2; k >= 0; --k)
+		corner[k] = std::min(corner[k], std::sqrt(corner[k + 1] * corner[k + 1] + 2 * planAcc * (wp[k + 1] - wp[k]).norm()));
+
+	/* A single polynomial cannot cruise, so legs are split into pieces about as long as it takes
+	 * to reach full speed. Each piece starts with its time along the leg's trapezoidal profile.
+	 */
+	double piece = maxVel * maxVel / maxAcc;
+	points_.clear();
+	radius_.clear();
+	hold_.clear();
+	lastInput_.clear();
+	fixedPos_.clear();
+	stop_.clear();
+	T_.clear();
+	knotOf_.resize(points.size());
+	std::vector<int> knotOfWp(W);
+	for (int k = 0; k < W; ++k)
+	{
+		knotOfWp[k] = points_.size();
+		points_.push_back(wp[k]);
+		radius_.push_back(wpRadius[k]);
+		hold_.push_back(wpHold[k]);
+		lastInput_.push_back(wpLast[k]);
+		bool end = k == 0 or k == W - 1;
+		stop_.push_back(end or wpHold[k] > 0);
+		fixedPos_.push_back(stop_.back() or wpRadius[k] <= 0);
+		if (end)
+			fixedPos_.back() = true;
+		if (k == W - 1)
+			break;
+
+		double d = (wp[k + 1] - wp[k]).norm();
+		int n = std::max(1, (int)std::ceil(d / piece));
+		double last = 0;
+		for (int j = 1; j <= n; ++j)
+		{
+			double t = trapezoidTime(d * j / n, d, corner[k], corner[k + 1], maxVel, planAcc);
+			T_.push_back(std::max(t - last, 1e-3));
+			last = t;
+			if (j < n)
+			{
+				points_.push_back(wp[k] + (wp[k + 1] - wp[k]) * ((double)j / n));
+				radius_.push_back(0);
+				hold_.push_back(0);
+				lastInput_.push_back(wpLast[k + 1]);
+				stop_.push_back(false);
+				fixedPos_.push_back(true);
+			}
+		}
+	}
+	for (int i = 0; i < (int)points.size(); ++i)
+		knotOf_[i] = knotOfWp[wpOf[i]];
+	knots_ = points_;
+
+	if (W < 2)
+	{
+		x_.assign(1, knot_t::Zero());
+		x_[0].row(0) = points_[0].transpose();
+		return true;
+	}
+
+	// Pin knots that leave their radius until none do, pinned knots stay pinned
+	for (int iter = 0; iter < maxIterations_; ++iter)
+	{
+		solveKnots();
+		if (not fixRadius())
+			break;
+	}
+	buildSegments();
+
+	/* Scaling every leg by the same factor scales velocity by 1/r and acceleration by 1/r^2
+	 * without changing the path. A nonzero start velocity does not scale, so check twice.
+	 */
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		double r = worstRatio(maxVel, maxAcc);
+		if (pass > 0 and r <= 1.001)
+			break;
+		for (double &T : T_)
+			T *= r;
+		solveKnots();
+		buildSegments();
+	}
+	return true;
+}
+
+void MinSnapTrajectory::solveKnots()
+{
+	int K = points_.size();
+	D_.assign(K, block_t::Zero());
+	U_.assign(K - 1, block_t::Zero());
+	rhs_.assign(K, knot_t::Zero());
+	x_.resize(K);
+
+	for (int i = 0; i < K - 1; ++i)
+	{
+		Eigen::Matrix<double, 8, 8> H = segmentHessian(T_[i]);
+		D_[i] += H.topLeftCorner<4, 4>();
+		D_[i + 1] += H.bottomRightCorner<4, 4>();
+		U_[i] = H.topRightCorner<4, 4>();
+	}
+
+	// Knot values that are fixed, stops have zero velocity, acceleration, and jerk
+	auto fixed = [&](int i, int k, Eigen::RowVector3d &v) -> bool {
+		if (k == 0)
+		{
+			v = knots_[i].transpose();
+			return fixedPos_[i];
+		}
+		v = (i == 0 and k == 1) ? Eigen::RowVector3d(startVel_.transpose()) : Eigen::RowVector3d::Zero();
+		return stop_[i];
+	};
+
+	// Move fixed values to the right hand side, then replace their rows with identity
+	Eigen::RowVector3d v;
+	for (int i = 0; i < K; ++i)
+		for (int k = 0; k < 4; ++k)
+			if (fixed(i, k, v))
+			{
+				rhs_[i] -= D_[i].col(k) * v;
+				if (i > 0)
+					rhs_[i - 1] -= U_[i - 1].col(k) * v;
+				if (i < K - 1)
+					rhs_[i + 1] -= U_[i].row(k).transpose() * v;
+			}
+	for (int i = 0; i < K; ++i)
+		for (int k = 0; k < 4; ++k)
+			if (fixed(i, k, v))
+			{
+				D_[i].row(k).setZero();
+				D_[i].col(k).setZero();
+				D_[i](k, k) = 1;
+				if (i > 0)
+					U_[i - 1].col(k).setZero();
+				if (i < K - 1)
+					U_[i].row(k).setZero();
+				rhs_[i].row(k) = v;
+			}
+
+	// Block Thomas algorithm, D_ is replaced by the inverse of each pivot block
+	D_[0] = D_[0].inverse().eval();
+	for (int i = 1; i < K; ++i)
+	{
+		block_t L = U_[i - 1].transpose() * D_[i - 1];
+		D_[i] = (D_[i] - L * U_[i - 1]).inverse();
+		rhs_[i] -= L * rhs_[i - 1];
+	}
+	x_[K - 1] = D_[K - 1] * rhs_[K - 1];
+	for (int i = K - 2; i >= 0; --i)
+		x_[i] = D_[i] * (rhs_[i] - U_[i] * x_[i + 1]);
+}
+
+bool MinSnapTrajectory::fixRadius()
+{
+	bool changed = false;
+	for (int i = 1; i < (int)points_.size() - 1; ++i)
+	{
+		if (fixedPos_[i])
+			continue;
+		Eigen::Vector3d dev = x_[i].row(0).transpose() - points_[i];
+		double d = dev.norm();
+		if (d > radius_[i])
+		{
+			// Pin to the closest point of the sphere and solve again
+			knots_[i] = points_[i] + dev * (radius_[i] / d);
+			fixedPos_[i] = true;
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+double MinSnapTrajectory::worstRatio(double maxVel, double maxAcc) const
+{
+	double vel, acc;
+	peaks(vel, acc);
+	return std::max(vel / maxVel, std::sqrt(acc / maxAcc));
+}
+
+void MinSnapTrajectory::buildSegments()
+{
+	int K = points_.size();
+	segments_.clear();
+	const Eigen::Matrix<double, 8, 8> &Ainv = endpointsToCoeffs();
+	double t = 0;
+
+	auto addHold = [&](int i) {
+		segment_t seg;
+		seg.c.setZero();
+		seg.c.row(0) = x_[i].row(0);
+		seg.t0 = t;
+		seg.T = hold_[i];
+		seg.knot = lastInput_[i];
+		seg.hold = true;
+		segments_.push_back(seg);
+		t += hold_[i];
+	};
+
+	for (int i = 0; i < K - 1; ++i)
+	{
+		if (i > 0 and hold_[i] > 0)
+			addHold(i);
+
+		double T = T_[i];
+		Eigen::Matrix<double, 8, 3> d;
+		double s = 1;
+		for (int k = 0; k < 4; ++k, s *= T)
+		{
+			d.row(k) = x_[i].row(k) * s;
+			d.row(4 + k) = x_[i + 1].row(k) * s;
+		}
+		segment_t seg;
+		seg.c = Ainv * d;
+		seg.t0 = t;
+		seg.T = T;
+		seg.knot = lastInput_[i + 1];
+		seg.hold = false;
+		segments_.push_back(seg);
+		t += T;
+	}
+	if (hold_[K - 1] > 0)
+		addHold(K - 1);
+
+	for (int i = 0; i < K; ++i)
+		knots_[i] = x_[i].row(0).transpose();
+	hint_ = 0;
+}
+
+void MinSnapTrajectory::evaluate(const segment_t &seg, double tau, sample_t &s) const
+{
+	// Horner's rule for the polynomial and its first two derivatives
+	Eigen::RowVector3d p = seg.c.row(7), v = Eigen::RowVector3d::Zero(), a = Eigen::RowVector3d::Zero();
+	for (int k = 6; k >= 0; --k)
+	{
+		a = a * tau + 2 * v;
+		v = v * tau + p;
+		p = p * tau + seg.c.row(k);
+	}
+	s.p = p.transpose();
+	s.v = v.transpose() / seg.T;
+	s.a = a.transpose() / (seg.T * seg.T);
+	s.knot = seg.knot;
+}
+
+void MinSnapTrajectory::segmentPeaks(const segment_t &seg, double &vel, double &acc) const
+{
+	vel = acc = 0;
+	sample_t s;
+	const int n = 64;
+	for (int j = 0; j <= n; ++j)
+	{
+		evaluate(seg, (double)j / n, s);
+		vel = std::max(vel, s.v.norm());
+		acc = std::max(acc, s.a.norm());
+	}
+}
+
+void MinSnapTrajectory::sample(double t, sample_t &s) const
+{
+	if (segments_.empty())
+	{
+		s.p = points_.empty() ? Eigen::Vector3d::Zero() : points_.back();
+		s.v.setZero();
+		s.a.setZero();
+		s.knot = knotOf_.size() - 1;
+		return;
+	}
+
+	t = std::min(std::max(t, 0.0), duration());
+	int last = segments_.size() - 1;
+	hint_ = std::min(std::max(hint_, 0), last);
+	while (hint_ < last and t >= segments_[hint_].t0 + segments_[hint_].T)
+		++hint_;
+	while (hint_ > 0 and t < segments_[hint_].t0)
+		--hint_;
+
+	const segment_t &seg = segments_[hint_];
+	evaluate(seg, seg.T > 0 ? (t - seg.t0) / seg.T : 1, s);
+}
+
+double MinSnapTrajectory::duration() const
+{
+	return segments_.empty() ? 0 : segments_.back().t0 + segments_.back().T;
+}
+
+const Eigen::Vector3d &MinSnapTrajectory::knot(int i) const
+{
+	return knots_[knotOf_[i]];
+}
+
+int MinSnapTrajectory::knots() const
+{
+	return knotOf_.size();
+}
+
+void MinSnapTrajectory::peaks(double &vel, double &acc) const
+{
+	vel = acc = 0;
+	for (const segment_t &seg : segments_)
+	{
+		double v, a;
+		segmentPeaks(seg, v, a);
+		vel = std::max(vel, v);
+		acc = std::max(acc, a);
+	}
+}
+
+void MinSnapTrajectory::setMaxIterations(int n)
+{
+	maxIterations_ = n;
+}
+} // namespace bsc_common
@@ -0,0 +1,145 @@
+#include "include/min_snap.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace bsc_common;
+
+// Duration of the same trajectory stopping at every waypoint
+static double stopAndGo(const MinSnapTrajectory::points_t &pts, double vMax, double aMax)
+{
+	MinSnapTrajectory stops;
+	std::vector<double> hold(pts.size(), 1e-9);
+	stops.solve(pts, std::vector<double>(pts.size(), 0), hold, vMax, aMax);
+	return stops.duration();
+}
+
+static int check(const char *name, bool ok)
+{
+	printf("%-44s %s\n", name, ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+int main()
+{
+	int failures = 0;
+	const double vMax = 3, aMax = 2;
+
+	// Survey zig-zag at 10m altitude with a stop in the middle
+	MinSnapTrajectory::points_t pts;
+	pts.push_back(Eigen::Vector3d(0, 0, 0));
+	for (int i = 0; i < 10; ++i)
+		pts.push_back(Eigen::Vector3d(20 * (i % 2), 8 * (i / 2), 10));
+	int n = pts.size();
+	std::vector<double> radius(n, 0), hold(n, 0);
+	hold[5] = 3;
+
+	MinSnapTrajectory traj;
+	traj.solve(pts, radius, hold, vMax, aMax);
+
+	// Waypoints are passed exactly, and the start, end, and hold are at rest
+	double knotErr = 0, restVel = 0;
+	MinSnapTrajectory::sample_t s, prev, fd;
+	for (int i = 0; i < n; ++i)
+		knotErr = std::max(knotErr, (traj.knot(i) - pts[i]).norm());
+	traj.sample(0, s);
+	restVel = std::max(restVel, s.v.norm());
+	traj.sample(traj.duration(), s);
+	restVel = std::max(restVel, s.v.norm() + (s.p - pts.back()).norm());
+
+	// Dense sampling for limits, continuity, and derivative consistency
+	double dt = 1e-3, vPeak = 0, aPeak = 0, jump = 0, fdErr = 0, holdTime = 0;
+	traj.sample(0, prev);
+	for (double t = dt; t <= traj.duration(); t += dt)
+	{
+		traj.sample(t, s);
+		vPeak = std::max(vPeak, s.v.norm());
+		aPeak = std::max(aPeak, s.a.norm());
+		jump = std::max(jump, (s.p - prev.p).norm() - vMax * dt * 1.01);
+		fdErr = std::max(fdErr, ((s.p - prev.p) / dt - 0.5 * (s.v + prev.v)).norm());
+		fdErr = std::max(fdErr, ((s.v - prev.v) / dt - 0.5 * (s.a + prev.a)).norm());
+		if ((s.p - pts[5]).norm() < 1e-9 and s.v.norm() < 1e-9)
+			holdTime += dt;
+		prev = s;
+	}
+	printf("duration %.1fs (stopping at each %.1fs + 3s hold), peak %.2fm/s %.2fm/s^2\n", traj.duration(),
+				 stopAndGo(pts, vMax, aMax), vPeak, aPeak);
+	failures += check("passes through waypoints", knotErr < 1e-6);
+	failures += check("starts and ends at rest", restVel < 1e-6);
+	failures += check("velocity and acceleration limits", vPeak <= vMax * 1.01 and aPeak <= aMax * 1.01);
+	failures += check("continuous position", jump <= 0);
+	failures += check("sampled derivatives match", fdErr < 1e-2);
+	failures += check("holds at the loiter waypoint", std::abs(holdTime - 3) < 0.01);
+
+	// Corner cutting inside the waypoint radius
+	std::vector<double> loose(n, 2);
+	MinSnapTrajectory cut;
+	cut.solve(pts, loose, std::vector<double>(n, 0), vMax, aMax);
+	double radiusErr = 0;
+	for (int i = 0; i < n; ++i)
+		radiusErr = std::max(radiusErr, (cut.knot(i) - pts[i]).norm() - (i == 0 or i == n - 1 ? 0 : 2));
+	double vCut, aCut;
+	cut.peaks(vCut, aCut);
+	printf("radius 2m: duration %.1fs, peak %.2fm/s %.2fm/s^2\n", cut.duration(), vCut, aCut);
+	failures += check("knots within radius", radiusErr < 1e-6);
+	failures += check("radius limits hold", vCut <= vMax * 1.01 and aCut <= aMax * 1.01);
+
+	// Passing through the gentle turns of a circuit beats stopping at each of them
+	MinSnapTrajectory::points_t circuit;
+	for (int i = 0; i <= 24; ++i)
+		circuit.push_back(Eigen::Vector3d(30 * sin(2 * M_PI * i / 24), 30 - 30 * cos(2 * M_PI * i / 24), 10));
+	MinSnapTrajectory loop;
+	loop.solve(circuit, std::vector<double>(circuit.size(), 0), std::vector<double>(circuit.size(), 0), vMax, aMax);
+	double vLoop, aLoop, loopStops = stopAndGo(circuit, vMax, aMax);
+	loop.peaks(vLoop, aLoop);
+	printf("circuit: %.1fs (stopping at each %.1fs), peak %.2fm/s %.2fm/s^2\n", loop.duration(), loopStops, vLoop, aLoop);
+	failures += check("circuit within 15% of full speed", loop.duration() < 1.15 * 2 * M_PI * 30 / vMax);
+	failures += check("circuit faster than stopping", loop.duration() < 0.6 * loopStops);
+	failures += check("circuit limits hold", vLoop <= vMax * 1.01 and aLoop <= aMax * 1.01);
+
+	// Solve and sample cost on a long lawnmower survey, 400 passes of 200m
+	MinSnapTrajectory::points_t lawn(1, Eigen::Vector3d::Zero());
+	for (int i = 0; i < 400; ++i)
+	{
+		lawn.push_back(Eigen::Vector3d(200 * (i % 2), 5 * i, 20));
+		lawn.push_back(Eigen::Vector3d(200 * ((i + 1) % 2), 5 * i, 20));
+	}
+	std::vector<double> lawnRadius(lawn.size(), 2), lawnHold(lawn.size(), 0);
+	MinSnapTrajectory survey;
+	auto t0 = std::chrono::steady_clock::now();
+	survey.solve(lawn, lawnRadius, lawnHold, vMax, aMax);
+	auto t1 = std::chrono::steady_clock::now();
+	int samples = 0;
+	for (double t = 0; t < survey.duration(); t += 0.04, ++samples)
+		survey.sample(t, s);
+	auto t2 = std::chrono::steady_clock::now();
+	double vLawn, aLawn;
+	survey.peaks(vLawn, aLawn);
+	double stopping = stopAndGo(lawn, vMax, aMax);
+	printf("%d waypoints: solve %.1f ms, sample %.3f us, %.0fs (stopping at each %.0fs), peak %.2fm/s %.2fm/s^2\n",
+				 (int)lawn.size(), std::chrono::duration<double, std::milli>(t1 - t0).count(),
+				 std::chrono::duration<double, std::micro>(t2 - t1).count() / samples, survey.duration(), stopping, vLawn,
+				 aLawn);
+	failures += check("survey limits hold", vLawn <= vMax * 1.01 and aLawn <= aMax * 1.01);
+	// Every pass ends in a turn through a 5m crossover, which costs a stop
+	double lowerBound = 400 * (200 + 5) / vMax;
+	printf("survey at full speed %.0fs\n", lowerBound);
+	failures += check("survey within 20% of full speed", survey.duration() < 1.2 * lowerBound);
+
+	// Random turns and repeated points still respect the limits
+	srand(3);
+	MinSnapTrajectory::points_t walk(1, Eigen::Vector3d::Zero());
+	for (int i = 0; i < 500; ++i)
+		walk.push_back(walk.back() + Eigen::Vector3d(rand() % 41 - 20, rand() % 41 - 20, rand() % 3 - 1));
+	walk.push_back(walk.back());
+	MinSnapTrajectory random;
+	random.solve(walk, std::vector<double>(walk.size(), 1), std::vector<double>(walk.size(), 0), vMax, aMax);
+	double vWalk, aWalk;
+	random.peaks(vWalk, aWalk);
+	failures += check("random walk limits hold", std::isfinite(random.duration()) and vWalk <= vMax * 1.01 and
+																									 aWalk <= aMax * 1.01);
+
+	printf(failures ? "FAILED (%d)\n" : "PASSED\n", failures);
+	return failures != 0;
+}
@@ -0,0 +1,267 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements flattening of serialized ROS messages into numeric columns
+ * 
+ * Author: Brennan Cain
+ */
+#include "include/msg_flattener.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace bsc_common
+{
+namespace
+{
+template <typename T>
+inline double get(const uint8_t *p)
+{
+	T v;
+	memcpy(&v, p, sizeof(v));
+	return (double)v;
+}
+
+std::string trim(const std::string &s)
+{
+	size_t a = s.find_first_not_of(" \t\r"), b = s.find_last_not_of(" \t\r");
+	return a == std::string::npos ? "" : s.substr(a, b - a + 1);
+}
+} // namespace
+
+MessageFlattener::MessageFlattener(int maxArray) : maxArray_(maxArray)
+{
+}
+
+bool MessageFlattener::primitive(const std::string &type, kind_t &kind)
+{
+	static const std::map<std::string, kind_t> kinds = {
+			{"bool", BOOL}, {"int8", INT8}, {"byte", INT8}, {"uint8", UINT8}, {"char", UINT8},
+			{"int16", INT16}, {"uint16", UINT16}, {"int32", INT32}, {"uint32", UINT32},
+			{"int64", INT64}, {"uint64", UINT64}, {"float32", FLOAT32}, {"float64", FLOAT64},
+			{"time", TIME}, {"duration", DURATION}, {"string", STRING}};
+	auto it = kinds.find(type);
+	if (it == kinds.end())
+		return false;
+	kind = it->second;
+	return true;
+}
+
+size_t MessageFlattener::width(kind_t kind)
+{
+	static const size_t widths[] = {1, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8, 8, 8, 0, 0};
+	return widths[kind];
+}
+
+bool MessageFlattener::parse(const std::string &type, const std::string &definition)
+{
+	types_.clear();
+	root_.clear();
+	fields_.clear();
+
+	std::string current = type;
+	std::istringstream lines(definition);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		if (line.compare(0, 4, "====") == 0)
+			continue;
+		if (line.compare(0, 5, "MSG: ") == 0)
+		{
+			current = trim(line.substr(5));
+			continue;
+		}
+		line = trim(line.substr(0, line.find('#')));
+		if (line.empty() or line.find('=') != std::string::npos) // constants hold no data
+			continue;
+
+		std::istringstream words(line);
+		field_t f;
+		if (not(words >> f.type >> f.name))
+			continue;
+		f.array = -1;
+		size_t bracket = f.type.find('[');
+		if (bracket != std::string::npos)
+		{
+			f.array = atoi(f.type.c_str() + bracket + 1);
+			f.type.erase(bracket);
+		}
+
+		// Nested types without a package are in the package of the type using them
+		kind_t kind;
+		if (f.type == "Header")
+			f.type = "std_msgs/Header";
+		else if (not primitive(f.type, kind) and f.type.find('/') == std::string::npos)
+			f.type = current.substr(0, current.find('/') + 1) + f.type;
+		types_[current].push_back(f);
+	}
+	return build(type, "", root_, 0);
+}
+
+bool MessageFlattener::build(const std::string &type, const std::string &prefix, std::vector<node_t> &nodes, int depth)
+{
+	auto it = types_.find(type);
+	if (it == types_.end() or depth > 16)
+		return false;
+
+	for (const field_t &f : it->second)
+	{
+		node_t n;
+		n.array = f.array;
+		n.column = n.sizeColumn = -1;
+		std::string name = prefix + f.name;
+		if (n.array == 0)
+		{
+			n.sizeColumn = fields_.size();
+			fields_.push_back(name + ".size");
+		}
+
+		if (not primitive(f.type, n.kind))
+		{
+			n.kind = MESSAGE;
+			if (not build(f.type, name + (n.array < 0 ? "." : "[0]."), n.children, depth + 1))
+				return false;
+		}
+		else if (n.kind != STRING)
+		{
+			int kept = n.array < 0 ? 1 : n.array == 0 ? maxArray_ : n.array <= MAX_FIXED ? n.array : 0;
+			if (kept)
+				n.column = fields_.size();
+			for (int i = 0; i < kept; ++i)
+				fields_.push_back(n.array < 0 ? name : name + "[" + std::to_string(i) + "]");
+		}
+		nodes.push_back(n);
+	}
+	return true;
+}
+
+const std::vector<std::string> &MessageFlattener::fields() const
+{
+	return fields_;
+}
+
+bool MessageFlattener::flatten(const uint8_t *data, size_t size, double *out) const
+{
+	for (size_t i = 0; i < fields_.size(); ++i)
+		out[i] = NAN;
+	const uint8_t *p = data;
+	return run(root_, p, data + size, out, true);
+}
+
+bool MessageFlattener::run(const std::vector<node_t> &nodes, const uint8_t *&p, const uint8_t *end, double *out,
+													 bool keep) const
+{
+	for (const node_t &n : nodes)
+	{
+		size_t count = n.array < 0 ? 1 : n.array;
+		if (n.array == 0)
+		{
+			if (end - p < 4)
+				return false;
+			count = (size_t)get<uint32_t>(p);
+			p += 4;
+			if (keep)
+				out[n.sizeColumn] = count;
+		}
+
+		if (n.kind == MESSAGE)
+		{
+			for (size_t i = 0; i < count; ++i)
+				if (not run(n.children, p, end, out, keep and i == 0))
+					return false;
+		}
+		else if (n.kind == STRING)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (end - p < 4 or get<uint32_t>(p) > (size_t)(end - p - 4))
+					return false;
+				p += 4 + (size_t)get<uint32_t>(p);
+			}
+		}
+		else
+		{
+			size_t w = width(n.kind);
+			if (count > (size_t)(end - p) / w)
+				return false;
+			if (keep and n.column >= 0)
+			{
+				size_t kept = std::min(count, n.array < 0 ? (size_t)1 : n.array == 0 ? (size_t)maxArray_ : count);
+				for (size_t i = 0; i < kept; ++i)
+				{
+					const uint8_t *v = p + i * w;
+					double &o = out[n.column + i];
+					switch (n.kind)
+					{
+					case BOOL:
+					case UINT8:
+						o = *v;
+						break;
+					case INT8:
+						o = (int8_t)*v;
+						break;
+					case INT16:
+						o = get<int16_t>(v);
+						break;
+					case UINT16:
+						o = get<uint16_t>(v);
+						break;
+					case INT32:
+						o = get<int32_t>(v);
+						break;
+					case UINT32:
+						o = get<uint32_t>(v);
+						break;
+					case INT64:
+						o = get<int64_t>(v);
+						break;
+					case UINT64:
+						o = get<uint64_t>(v);
+						break;
+					case FLOAT32:
+						o = get<float>(v);
+						break;
+					case FLOAT64:
+						o = get<double>(v);
+						break;
+					case TIME:
+						o = get<uint32_t>(v) + 1e-9 * get<uint32_t>(v + 4);
+						break;
+					case DURATION:
+						o = get<int32_t>(v) + 1e-9 * get<int32_t>(v + 4);
+						break;
+					default:
+						break;
+					}
+				}
+			}
+			p += count * w;
+		}
+	}
+	return true;
+}
+} // namespace bsc_common
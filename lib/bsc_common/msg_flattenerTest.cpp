@@ -0,0 +1,152 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/msg_flattener.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace bsc_common;
+
+typedef std::vector<uint8_t> bytes_t;
+
+template <typename T>
+static void put(bytes_t &b, T v)
+{
+	const uint8_t *p = (const uint8_t *)&v;
+	b.insert(b.end(), p, p + sizeof(v));
+}
+
+static void putString(bytes_t &b, const std::string &s)
+{
+	put<uint32_t>(b, s.size());
+	b.insert(b.end(), s.begin(), s.end());
+}
+
+int main()
+{
+	int failures = 0;
+
+	// Constants, fixed arrays, arrays of messages and strings, in the shape of a marker list
+	const std::string def = "uint8 GOOD=1\n"
+													"string NAME=a=b # not a field\n"
+													"uint8 status\n"
+													"string[] names\n"
+													"float64[4] covariance\n"
+													"Marker[] markers\n"
+													"duration age\n"
+													"uint8[] data\n"
+													"================================================================================\n"
+													"MSG: test_msgs/Marker\n"
+													"uint32 id\n"
+													"Point p\n"
+													"================================================================================\n"
+													"MSG: test_msgs/Point\n"
+													"float32 x\n"
+													"int16 y\n";
+	MessageFlattener flat(2);
+	if (not flat.parse("test_msgs/Markers", def))
+	{
+		printf("  FAIL: parse\n");
+		return 1;
+	}
+	const std::vector<std::string> want = {"status", "names.size", "covariance[0]", "covariance[1]", "covariance[2]",
+																				 "covariance[3]", "markers.size", "markers[0].id", "markers[0].p.x",
+																				 "markers[0].p.y", "age", "data.size", "data[0]", "data[1]"};
+	if (flat.fields() != want)
+	{
+		printf("  FAIL: fields\n");
+		for (const std::string &f : flat.fields())
+			printf("    %s\n", f.c_str());
+		++failures;
+	}
+
+	bytes_t m;
+	put<uint8_t>(m, 3);
+	put<uint32_t>(m, 2);
+	putString(m, "left");
+	putString(m, "right");
+	for (int i = 0; i < 4; ++i)
+		put<double>(m, i * 1.5);
+	put<uint32_t>(m, 3);
+	for (int i = 0; i < 3; ++i)
+	{
+		put<uint32_t>(m, 10 + i);
+		put<float>(m, 0.5f * i + 2);
+		put<int16_t>(m, -i - 7);
+	}
+	put<int32_t>(m, -2);
+	put<int32_t>(m, 500000000);
+	put<uint32_t>(m, 5);
+	for (int i = 0; i < 5; ++i)
+		put<uint8_t>(m, 200 + i);
+
+	std::vector<double> out(flat.fields().size());
+	double expected[] = {3, 2, 0, 1.5, 3, 4.5, 3, 10, 2, -7, -1.5, 5, 200, 201};
+	bool ok = flat.flatten(m.data(), m.size(), out.data());
+	for (size_t i = 0; ok and i < out.size(); ++i)
+		ok = out[i] == expected[i];
+	if (not ok)
+	{
+		printf("  FAIL: values\n");
+		++failures;
+	}
+
+	// No markers leaves their columns empty
+	bytes_t empty;
+	put<uint8_t>(empty, 1);
+	put<uint32_t>(empty, 0);
+	for (int i = 0; i < 4; ++i)
+		put<double>(empty, 0);
+	put<uint32_t>(empty, 0);
+	put<int32_t>(empty, 0);
+	put<int32_t>(empty, 0);
+	put<uint32_t>(empty, 0);
+	if (not flat.flatten(empty.data(), empty.size(), out.data()) or out[6] != 0 or not std::isnan(out[7]) or
+			not std::isnan(out[12]))
+	{
+		printf("  FAIL: empty arrays\n");
+		++failures;
+	}
+
+	// Every truncation is caught
+	int caught = 0;
+	for (size_t cut = 0; cut < m.size(); ++cut)
+		caught += not flat.flatten(m.data(), cut, out.data());
+	if (caught != (int)m.size())
+	{
+		printf("  FAIL: %i of %i truncations read\n", (int)m.size() - caught, (int)m.size());
+		++failures;
+	}
+
+	// Undefined nested types are refused
+	if (flat.parse("test_msgs/Bad", "Missing thing\n"))
+	{
+		printf("  FAIL: parsed an undefined type\n");
+		++failures;
+	}
+
+	printf(failures ? "%i FAILURES\n" : "PASSED\n", failures);
+	return failures ? 1 : 0;
+}
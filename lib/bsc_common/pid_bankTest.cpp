@@ -0,0 +1,63 @@
+#include "include/pid.h"
+#include "include/pid_bank.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+int main()
+{
+	const int n = 200000;
+	const double kp[4] = {.5, .4, 1.2, .8}, ki[4] = {.01, .02, .05, 0}, kd[4] = {.1, .1, .3, .05};
+
+	bsc_common::PID pids[4];
+	bsc_common::PIDBank<4>::axes_t bkp, bki, bkd;
+	for (int j = 0; j < 4; ++j)
+	{
+		pids[j] = bsc_common::PID(kp[j], ki[j], kd[j], 50);
+		bkp(j) = kp[j];
+		bki(j) = ki[j];
+		bkd(j) = kd[j];
+	}
+	bsc_common::PIDBank<4> bank(bkp, bki, bkd, 50);
+
+	// Equivalence with the PID class on the same error sequence
+	double worst = 0;
+	for (int i = 1; i < 5000; ++i)
+	{
+		double t = i * .04;
+		bsc_common::PIDBank<4>::axes_t err;
+		for (int j = 0; j < 4; ++j)
+		{
+			err(j) = std::sin(t * (j + 1)) + .1 * j;
+			pids[j].update(err(j), t);
+		}
+		bank.update(err, t);
+		for (int j = 0; j < 4; ++j)
+			worst = std::max(worst, std::fabs(bank.get_signal()(j) - pids[j].get_signal()));
+	}
+	std::cout << (worst < 1e-9 ? "PASS" : "FAIL") << ": max difference to PID " << worst << std::endl;
+
+	// Throughput, 4 axes per tick
+	double sink = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 1; i <= n; ++i)
+		for (int j = 0; j < 4; ++j)
+		{
+			pids[j].update(std::sin(i * 1e-3) + j, 1000 + i * .04);
+			sink += pids[j].get_signal();
+		}
+	auto t1 = std::chrono::steady_clock::now();
+	for (int i = 1; i <= n; ++i)
+	{
+		double s = std::sin(i * 1e-3);
+		double err[4] = {s, s + 1, s + 2, s + 3};
+		bank.update(err, 1000 + i * .04);
+		sink += bank.get_signal().sum();
+	}
+	auto t2 = std::chrono::steady_clock::now();
+
+	std::cout << "4x PID:      " << std::chrono::duration<double, std::nano>(t1 - t0).count() / n << " ns/tick\n";
+	std::cout << "PIDBank<4>:  " << std::chrono::duration<double, std::nano>(t2 - t1).count() / n << " ns/tick\n";
+	std::cout << sink << std::endl;
+	return worst < 1e-9 ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements a reader for ROS bag files, format 2.0
+ * 
+ * Author: Brennan Cain
+ */
+#include "include/ros_bag.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bsc_common
+{
+namespace
+{
+const char VERSION_LINE[] = "#ROSBAG V2.0\n";
+
+enum op_t : uint8_t
+{
+	OP_MESSAGE = 0x02,
+	OP_BAG_HEADER = 0x03,
+	OP_INDEX = 0x04,
+	OP_CHUNK = 0x05,
+	OP_CHUNK_INFO = 0x06,
+	OP_CONNECTION = 0x07
+};
+
+inline uint32_t u32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/** fields
+ * Calls back with each name=value field of a record header
+ *
+ * @return false if a field runs past the end
+ */
+template <typename F>
+bool fields(const uint8_t *p, const uint8_t *end, F callback)
+{
+	while (p + 4 <= end)
+	{
+		uint32_t n = u32(p);
+		p += 4;
+		if (n > (size_t)(end - p))
+			return false;
+		const uint8_t *eq = (const uint8_t *)memchr(p, '=', n);
+		if (eq)
+			callback(std::string((const char *)p, eq - p), eq + 1, (uint32_t)(p + n - eq - 1));
+		p += n;
+	}
+	return p == end;
+}
+} // namespace
+
+RosBagReader::RosBagReader()
+{
+}
+
+RosBagReader::~RosBagReader()
+{
+	close();
+}
+
+bool RosBagReader::open(const std::string &path)
+{
+	close();
+	fd_ = ::open(path.c_str(), O_RDONLY);
+	if (fd_ < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd_, &st) != 0 or st.st_size < (off_t)strlen(VERSION_LINE))
+	{
+		close();
+		return false;
+	}
+	size_ = st.st_size;
+	void *map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+	if (map == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+	data_ = (const uint8_t *)map;
+	madvise(map, size_, MADV_SEQUENTIAL);
+	if (memcmp(data_, VERSION_LINE, strlen(VERSION_LINE)))
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void RosBagReader::close()
+{
+	if (data_)
+		munmap((void *)data_, size_);
+	if (fd_ >= 0)
+		::close(fd_);
+	data_ = nullptr;
+	fd_ = -1;
+	size_ = 0;
+	connections_.clear();
+	skipped_ = 0;
+}
+
+bool RosBagReader::read(const std::function<void(const message_t &)> &callback)
+{
+	if (not data_)
+		return false;
+	return readRecords(data_ + strlen(VERSION_LINE), data_ + size_, callback);
+}
+
+bool RosBagReader::readRecords(const uint8_t *p, const uint8_t *end,
+															 const std::function<void(const message_t &)> &callback)
+{
+	while (p < end)
+	{
+		if (end - p < 8 or u32(p) > (size_t)(end - p - 8))
+			return false;
+		const uint8_t *header = p + 4, *headerEnd = header + u32(p);
+		uint32_t dataSize = u32(headerEnd);
+		const uint8_t *data = headerEnd + 4;
+		if (dataSize > (size_t)(end - data))
+			return false;
+		p = data + dataSize;
+
+		uint8_t op = 0;
+		uint32_t conn = 0;
+		int64_t stamp = 0;
+		std::string compression, topic;
+		bool ok = fields(header, headerEnd, [&](const std::string &name, const uint8_t *v, uint32_t n) {
+			if (name == "op" and n == 1)
+				op = v[0];
+			else if (name == "conn" and n == 4)
+				conn = u32(v);
+			else if (name == "time" and n == 8)
+				stamp = u32(v) * 1000000000ll + u32(v + 4);
+			else if (name == "compression")
+				compression.assign((const char *)v, n);
+			else if (name == "topic")
+				topic.assign((const char *)v, n);
+		});
+		if (not ok)
+			return false;
+
+		if (op == OP_MESSAGE)
+		{
+			message_t m;
+			m.conn = conn;
+			m.stamp = stamp;
+			m.data = data;
+			m.size = dataSize;
+			callback(m);
+		}
+		else if (op == OP_CONNECTION and not connections_.count(conn))
+		{
+			connection_t &c = connections_[conn];
+			c.topic = topic;
+			fields(data, data + dataSize, [&](const std::string &name, const uint8_t *v, uint32_t n) {
+				if (name == "type")
+					c.type.assign((const char *)v, n);
+				else if (name == "md5sum")
+					c.md5sum.assign((const char *)v, n);
+				else if (name == "message_definition")
+					c.definition.assign((const char *)v, n);
+			});
+		}
+		else if (op == OP_CHUNK)
+		{
+			if (compression == "none")
+			{
+				if (not readRecords(data, data + dataSize, callback))
+					return false;
+			}
+			else
+				++skipped_;
+		}
+		// Bag header, index and chunk info records only locate data, the walk does not need them
+	}
+	return true;
+}
+
+const std::map<uint32_t, RosBagReader::connection_t> &RosBagReader::connections() const
+{
+	return connections_;
+}
+
+int RosBagReader::skippedChunks() const
+{
+	return skipped_;
+}
+
+size_t RosBagReader::size() const
+{
+	return size_;
+}
+} // namespace bsc_common
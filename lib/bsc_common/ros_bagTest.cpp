@@ -0,0 +1,282 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/msg_flattener.h"
+#include "include/ros_bag.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+using namespace bsc_common;
+
+typedef std::vector<uint8_t> bytes_t;
+
+static const char *HEADER_DEF = "# Standard metadata for higher-level stamped data types.\n"
+																"uint32 seq\n"
+																"time stamp\n"
+																"string frame_id\n";
+
+static const std::string VECTOR_DEF = std::string("# This represents a Vector3 with reference coordinate frame and timestamp\n"
+																									"Header header\n"
+																									"Vector3 vector\n"
+																									"\n"
+																									"================================================================================\n"
+																									"MSG: std_msgs/Header\n") +
+																			HEADER_DEF +
+																			"\n"
+																			"================================================================================\n"
+																			"MSG: geometry_msgs/Vector3\n"
+																			"# This represents a vector in free space. \n"
+																			"float64 x\n"
+																			"float64 y\n"
+																			"float64 z\n";
+
+static const std::string JOY_DEF = std::string("# Reports the state of a joysticks axes and buttons.\n"
+																							 "Header header           # timestamp in the header is the time the data is received from the joystick\n"
+																							 "float32[] axes          # the axes measurements from a joystick\n"
+																							 "int32[] buttons         # the buttons measurements from a joystick \n"
+																							 "\n"
+																							 "================================================================================\n"
+																							 "MSG: std_msgs/Header\n") +
+																	 HEADER_DEF;
+
+template <typename T>
+static void put(bytes_t &b, T v)
+{
+	const uint8_t *p = (const uint8_t *)&v;
+	b.insert(b.end(), p, p + sizeof(v));
+}
+
+static void putString(bytes_t &b, const std::string &s)
+{
+	put<uint32_t>(b, s.size());
+	b.insert(b.end(), s.begin(), s.end());
+}
+
+static void field(bytes_t &b, const std::string &name, const bytes_t &value)
+{
+	put<uint32_t>(b, name.size() + 1 + value.size());
+	b.insert(b.end(), name.begin(), name.end());
+	b.push_back('=');
+	b.insert(b.end(), value.begin(), value.end());
+}
+
+static bytes_t text(const std::string &s)
+{
+	return bytes_t(s.begin(), s.end());
+}
+
+template <typename T>
+static bytes_t raw(T v)
+{
+	bytes_t b;
+	put(b, v);
+	return b;
+}
+
+static void record(bytes_t &out, const bytes_t &header, const bytes_t &data)
+{
+	put<uint32_t>(out, header.size());
+	out.insert(out.end(), header.begin(), header.end());
+	put<uint32_t>(out, data.size());
+	out.insert(out.end(), data.begin(), data.end());
+}
+
+static void connection(bytes_t &out, uint32_t conn, const std::string &topic, const std::string &type,
+											 const std::string &def)
+{
+	bytes_t h, d;
+	field(h, "op", raw<uint8_t>(0x07));
+	field(h, "conn", raw(conn));
+	field(h, "topic", text(topic));
+	field(d, "topic", text(topic));
+	field(d, "type", text(type));
+	field(d, "md5sum", text("0123456789abcdef0123456789abcdef"));
+	field(d, "message_definition", text(def));
+	record(out, h, d);
+}
+
+static void message(bytes_t &out, uint32_t conn, int64_t stamp, const bytes_t &data)
+{
+	bytes_t h;
+	field(h, "op", raw<uint8_t>(0x02));
+	field(h, "conn", raw(conn));
+	bytes_t t = raw<uint32_t>(stamp / 1000000000);
+	put<uint32_t>(t, stamp % 1000000000);
+	field(h, "time", t);
+	record(out, h, data);
+}
+
+static void chunk(bytes_t &out, const std::string &compression, const bytes_t &inner)
+{
+	bytes_t h;
+	field(h, "op", raw<uint8_t>(0x05));
+	field(h, "compression", text(compression));
+	field(h, "size", raw<uint32_t>(inner.size()));
+	record(out, h, inner);
+}
+
+static bytes_t stampedHeader(uint32_t seq, int64_t stamp)
+{
+	bytes_t b;
+	put<uint32_t>(b, seq);
+	put<uint32_t>(b, stamp / 1000000000);
+	put<uint32_t>(b, stamp % 1000000000);
+	putString(b, "drone");
+	return b;
+}
+
+int main()
+{
+	int failures = 0;
+	const char *path = "/tmp/ros_bagTest.bag";
+	const int n = 100000;
+	const int64_t t0 = 1500000000000000000ll;
+
+	// Build a bag: vectors and joysticks in an uncompressed chunk, one compressed chunk, connections again at the end
+	{
+		bytes_t bag = text("#ROSBAG V2.0\n");
+		bytes_t h;
+		field(h, "op", raw<uint8_t>(0x03));
+		field(h, "index_pos", raw<uint64_t>(0));
+		field(h, "conn_count", raw<uint32_t>(2));
+		field(h, "chunk_count", raw<uint32_t>(2));
+		record(bag, h, bytes_t(4096 - h.size() - 8, ' '));
+
+		bytes_t inner;
+		connection(inner, 0, "/jetyak_uav_vision/state", "geometry_msgs/Vector3Stamped", VECTOR_DEF);
+		connection(inner, 1, "/jetyak_uav_utils/behavior_cmd", "sensor_msgs/Joy", JOY_DEF);
+		for (int i = 0; i < n; ++i)
+		{
+			int64_t t = t0 + i * 20000000ll;
+			bytes_t m = stampedHeader(i, t - 1000);
+			if (i % 2 == 0)
+			{
+				put<double>(m, i);
+				put<double>(m, -i);
+				put<double>(m, 0.5 * i);
+				message(inner, 0, t, m);
+			}
+			else
+			{
+				int axes = i % 11; // sometimes more than maxArray
+				put<uint32_t>(m, axes);
+				for (int a = 0; a < axes; ++a)
+					put<float>(m, a + 0.25f);
+				put<uint32_t>(m, 1);
+				put<int32_t>(m, i);
+				message(inner, 1, t, m);
+			}
+		}
+		chunk(bag, "none", inner);
+		chunk(bag, "bz2", bytes_t(100, 7));
+		connection(bag, 0, "/jetyak_uav_vision/state", "geometry_msgs/Vector3Stamped", VECTOR_DEF);
+		connection(bag, 1, "/jetyak_uav_utils/behavior_cmd", "sensor_msgs/Joy", JOY_DEF);
+
+		FILE *f = fopen(path, "wb");
+		fwrite(bag.data(), 1, bag.size(), f);
+		fclose(f);
+	}
+
+	{
+		RosBagReader reader;
+		if (not reader.open(path))
+		{
+			printf("  FAIL: open\n");
+			return 1;
+		}
+
+		MessageFlattener vector, joy(8);
+		bool parsed = false;
+		std::vector<double> row(64);
+		int vectors = 0, joys = 0, bad = 0;
+		auto s = std::chrono::steady_clock::now();
+		bool ok = reader.read([&](const RosBagReader::message_t &m) {
+			if (not parsed)
+			{
+				const auto &c = reader.connections();
+				parsed = vector.parse(c.at(0).type, c.at(0).definition) and joy.parse(c.at(1).type, c.at(1).definition);
+			}
+			int i = (m.stamp - t0) / 20000000;
+			if (m.conn == 0)
+			{
+				++vectors;
+				bad += not vector.flatten(m.data, m.size, row.data()) or row[0] != i or
+							 fabs(row[1] - (m.stamp - 1000) * 1e-9) > 1e-6 or row[2] != i or row[3] != -i or row[4] != 0.5 * i;
+			}
+			else
+			{
+				++joys;
+				int axes = i % 11;
+				bool good = joy.flatten(m.data, m.size, row.data()) and row[2] == axes and row[11] == 1 and row[12] == i;
+				for (int a = 0; a < 8; ++a)
+					good &= a < axes ? row[3 + a] == a + 0.25 : std::isnan(row[3 + a]);
+				bad += not good;
+			}
+		});
+		auto e = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(e - s).count();
+		printf("read %i messages, %1.1fMB in %1.1fms (%1.0fMB/s)\n", vectors + joys, reader.size() / 1e6, ms,
+					 reader.size() / 1e3 / ms);
+
+		if (not ok or not parsed or vectors != n / 2 or joys != n / 2 or bad or reader.skippedChunks() != 1 or
+				reader.connections().size() != 2)
+		{
+			printf("  FAIL: read back %i vectors, %i joys, %i bad, %i skipped\n", vectors, joys, bad, reader.skippedChunks());
+			++failures;
+		}
+
+		const std::vector<std::string> want = {"header.seq", "header.stamp", "vector.x", "vector.y", "vector.z"};
+		if (vector.fields() != want or joy.fields().size() != 20 or joy.fields()[2] != "axes.size" or
+				joy.fields()[3] != "axes[0]" or joy.fields()[11] != "buttons.size" or joy.fields()[12] != "buttons[0]")
+		{
+			printf("  FAIL: field names\n");
+			++failures;
+		}
+	}
+
+	// Truncated files fail instead of reading past the end
+	{
+		FILE *f = fopen(path, "r+b");
+		fseek(f, 0, SEEK_END);
+		long size = ftell(f);
+		fclose(f);
+		if (truncate(path, size - 5000) != 0)
+			printf("could not truncate\n");
+		RosBagReader reader;
+		int count = 0;
+		if (not reader.open(path) or reader.read([&](const RosBagReader::message_t &) { ++count; }))
+		{
+			printf("  FAIL: truncated bag read as whole\n");
+			++failures;
+		}
+	}
+
+	remove(path);
+	printf(failures ? "%i FAILURES\n" : "PASSED\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the trajectory planner's worker
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/trajectory_planner.h"
+#include <utility>
+
+namespace bsc_common
+{
+TrajectoryPlanner::TrajectoryPlanner()
+{
+	worker_ = std::thread(&TrajectoryPlanner::workerLoop, this);
+}
+
+TrajectoryPlanner::~TrajectoryPlanner()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		running_ = false;
+	}
+	wake_.notify_one();
+	worker_.join();
+}
+
+void TrajectoryPlanner::request(request_t &req)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		std::swap(pending_, req);
+		hasPending_ = true;
+	}
+	wake_.notify_one();
+}
+
+bool TrajectoryPlanner::poll(MinSnapTrajectory &traj, int &tag, bool &ok)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (not hasDone_)
+		return false;
+	std::swap(traj, done_);
+	tag = doneTag_;
+	ok = doneOk_;
+	hasDone_ = false;
+	return true;
+}
+
+bool TrajectoryPlanner::busy()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return hasPending_ or solving_;
+}
+
+void TrajectoryPlanner::workerLoop()
+{
+	request_t req;
+	MinSnapTrajectory traj;
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true)
+	{
+		wake_.wait(lock, [this] { return hasPending_ or not running_; });
+		if (not running_)
+			return;
+		std::swap(req, pending_);
+		hasPending_ = false;
+		solving_ = true;
+
+		// The lock is only held to hand buffers over, never during a solve
+		lock.unlock();
+		bool ok = traj.solve(req.points, req.radius, req.hold, req.maxVel, req.maxAcc, req.startVel);
+		lock.lock();
+
+		std::swap(done_, traj);
+		doneTag_ = req.tag;
+		doneOk_ = ok;
+		hasDone_ = true;
+		solving_ = false;
+	}
+}
+} // namespace bsc_common
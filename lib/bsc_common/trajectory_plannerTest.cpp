@@ -0,0 +1,80 @@
+#include "include/trajectory_planner.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+using namespace bsc_common;
+
+static int check(const char *name, bool ok)
+{
+	printf("%-44s %s\n", name, ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+// Survey of n waypoints starting at the origin
+static TrajectoryPlanner::request_t survey(int n, int tag)
+{
+	TrajectoryPlanner::request_t req;
+	req.points.push_back(Eigen::Vector3d::Zero());
+	for (int i = 0; i < n; ++i)
+		req.points.push_back(Eigen::Vector3d(20 * (i % 2), 8 * (i / 2), 10));
+	req.radius.assign(n + 1, 1);
+	req.hold.assign(n + 1, 0);
+	req.maxVel = 3;
+	req.maxAcc = 2;
+	req.tag = tag;
+	return req;
+}
+
+int main()
+{
+	int failures = 0;
+	typedef std::chrono::steady_clock clock;
+
+	MinSnapTrajectory sync;
+	TrajectoryPlanner::request_t big = survey(800, 1);
+	clock::time_point t0 = clock::now();
+	sync.solve(big.points, big.radius, big.hold, big.maxVel, big.maxAcc);
+	double solveMs = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+
+	// Requests and polls return while the solve runs
+	TrajectoryPlanner planner;
+	MinSnapTrajectory traj;
+	int tag = 0;
+	bool ok = false;
+	t0 = clock::now();
+	planner.request(big);
+	bool early = planner.poll(traj, tag, ok);
+	double callMs = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+	printf("solve %.1f ms, request and poll %.3f ms\n", solveMs, callMs);
+	failures += check("request does not wait for the solve", callMs < solveMs / 4);
+	failures += check("nothing to poll while solving", not early and planner.busy());
+
+	while (not planner.poll(traj, tag, ok))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	failures += check("finished solve matches a direct solve",
+										ok and tag == 1 and std::abs(traj.duration() - sync.duration()) < 1e-9);
+	failures += check("idle after the solve", not planner.busy() and not planner.poll(traj, tag, ok));
+
+	// A queued request is replaced by a newer one
+	TrajectoryPlanner::request_t first = survey(800, 2), second = survey(800, 3), third = survey(10, 4);
+	planner.request(first);
+	planner.request(second);
+	planner.request(third);
+	while (planner.busy())
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	failures += check("queued requests are replaced", planner.poll(traj, tag, ok) and ok and tag == 4);
+	failures += check("last trajectory is the newest request", traj.knots() > 0 and traj.duration() < sync.duration());
+
+	// Failed solves are reported
+	TrajectoryPlanner::request_t bad = survey(1, 5);
+	bad.maxVel = -1;
+	planner.request(bad);
+	while (not planner.poll(traj, tag, ok))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	failures += check("invalid limits report a failure", not ok and tag == 5);
+
+	printf(failures ? "FAILED (%d)\n" : "PASSED\n", failures);
+	return failures != 0;
+}
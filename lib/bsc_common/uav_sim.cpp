@@ -0,0 +1,392 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the software in the loop simulator
+ * 
+ * Author: Brennan Cain
+ */
+#include "include/uav_sim.h"
+#include "include/angles.h"
+#include "include/attitude.h"
+#include <algorithm>
+#include <cmath>
+
+namespace bsc_common
+{
+namespace
+{
+const double G = 9.80665;
+
+inline double clip(double x, double limit)
+{
+	return std::max(-limit, std::min(limit, x));
+}
+
+inline Eigen::Vector2d rotate(double yaw, const Eigen::Vector2d &v)
+{
+	double c = cos(yaw), s = sin(yaw);
+	return Eigen::Vector2d(c * v(0) - s * v(1), s * v(0) + c * v(1));
+}
+} // namespace
+
+UavSim::UavSim(unsigned seed) : UavSim(params_t(), seed)
+{
+}
+
+UavSim::UavSim(const params_t &params, unsigned seed) : p_(params), rng_(seed)
+{
+	reset();
+}
+
+void UavSim::reset()
+{
+	t_ = 0;
+	boatPos_ << 0, 0, p_.deckHeight;
+	boatVel_.setZero();
+	boatYaw_ = p_.boatHeading;
+	stepBoat();
+
+	padLocal_.setZero();
+	padYaw_ = 0;
+	pos_ = padPosition();
+	vel_ = boatVel_;
+	rpy_ << 0, 0, boatYaw_;
+	rates_.setZero();
+	tiltCmd_.setZero();
+	target_ = pos_;
+	for (double &c : cmd_)
+		c = 0;
+	flag_ = HORIZONTAL_VELOCITY | VERTICAL_VELOCITY | YAW_RATE;
+	lastCommand_ = -1e9;
+	task_ = NO_TASK;
+	taskHeight_ = 0;
+	armed_ = false;
+	landed_ = true;
+	crashed_ = false;
+	touchdown_ = 0;
+}
+
+void UavSim::command(double x, double y, double z, double w, uint8_t flag)
+{
+	if (task_ != NO_TASK)
+		return;
+	cmd_[0] = x;
+	cmd_[1] = y;
+	cmd_[2] = z;
+	cmd_[3] = w;
+	flag_ = flag;
+	lastCommand_ = t_;
+
+	// Position setpoints are offsets from where the UAV is now
+	if ((flag & HORIZONTAL_MASK) == HORIZONTAL_POSITION)
+	{
+		Eigen::Vector2d offset(x, y);
+		if (flag & HORIZONTAL_BODY)
+			offset = rotate(rpy_(2), offset);
+		target_.head<2>() = pos_.head<2>() + offset;
+	}
+}
+
+bool UavSim::takeoff()
+{
+	if (crashed_ or not landed_)
+		return false;
+	armed_ = true;
+	task_ = TAKEOFF;
+	taskHeight_ = pos_(2) + p_.takeoffHeight;
+	return true;
+}
+
+bool UavSim::land()
+{
+	if (crashed_ or landed_ or not armed_)
+		return false;
+	task_ = LANDING;
+	return true;
+}
+
+bool UavSim::arm(bool on)
+{
+	// The motors only stop on the ground
+	if (crashed_ or (not on and not landed_))
+		return false;
+	armed_ = on;
+	return true;
+}
+
+void UavSim::step()
+{
+	t_ += p_.dt;
+	stepBoat();
+	if (not crashed_)
+		stepUav();
+}
+
+void UavSim::step(int n)
+{
+	for (int i = 0; i < n; ++i)
+		step();
+}
+
+double UavSim::time() const
+{
+	return t_;
+}
+
+Eigen::Matrix<double, 12, 1> UavSim::uav() const
+{
+	Eigen::Matrix<double, 12, 1> x;
+	x << pos_, vel_, rpy_, rates_;
+	return x;
+}
+
+Eigen::Vector3d UavSim::boatPosition() const
+{
+	return boatPos_;
+}
+
+Eigen::Vector3d UavSim::boatVelocity() const
+{
+	return boatVel_;
+}
+
+double UavSim::boatHeading() const
+{
+	return boatYaw_;
+}
+
+Eigen::Vector3d UavSim::padPosition() const
+{
+	Eigen::Vector3d pad = boatPos_;
+	pad.head<2>() += rotate(boatYaw_, p_.padOffset.head<2>());
+	pad(2) += p_.padOffset(2);
+	return pad;
+}
+
+Eigen::Vector3d UavSim::tagPosition() const
+{
+	Eigen::Vector3d tag = padPosition();
+	tag.head<2>() += rotate(boatYaw_, p_.tagOffset.head<2>());
+	tag(2) += p_.tagOffset(2);
+	return tag;
+}
+
+UavSim::tag_t UavSim::tag()
+{
+	tag_t out;
+	out.seen = false;
+	out.position.setZero();
+	out.orientation.setIdentity();
+
+	Eigen::Vector3d d = tagPosition() - pos_;
+	double range = d.norm();
+	std::uniform_real_distribution<double> uniform(0, 1);
+	if (crashed_ or range < p_.minRange or range > p_.maxRange or d(2) >= 0 or acos(-d(2) / range) > p_.cameraCone)
+		return out;
+	double detect = p_.detectNear + (p_.detectFar - p_.detectNear) * (range - p_.minRange) / (p_.maxRange - p_.minRange);
+	if (uniform(rng_) > detect)
+		return out;
+
+	std::normal_distribution<double> noise(0, p_.rangeNoise * range);
+	for (int i = 0; i < 3; ++i)
+		d(i) += noise(rng_);
+
+	Eigen::Quaterniond q = attitude::quatFromRPY(rpy_(0), rpy_(1), rpy_(2));
+	out.seen = true;
+	out.position = q.inverse() * d;
+	out.orientation = q.inverse() * attitude::quatFromRPY(0, 0, boatYaw_);
+	return out;
+}
+
+bool UavSim::armed() const
+{
+	return armed_;
+}
+
+bool UavSim::landed() const
+{
+	return landed_;
+}
+
+bool UavSim::crashed() const
+{
+	return crashed_;
+}
+
+double UavSim::touchdown() const
+{
+	return touchdown_;
+}
+
+void UavSim::stepBoat()
+{
+	double weave = 2 * M_PI / p_.weavePeriod, heave = 2 * M_PI / p_.heavePeriod;
+	boatYaw_ = p_.boatHeading + p_.weaveAmplitude * sin(weave * t_);
+	boatVel_ << p_.boatSpeed * cos(boatYaw_), p_.boatSpeed * sin(boatYaw_),
+			p_.heaveAmplitude * heave * cos(heave * t_);
+	boatPos_.head<2>() += boatVel_.head<2>() * p_.dt;
+	boatPos_(2) = p_.deckHeight + p_.heaveAmplitude * sin(heave * t_);
+}
+
+Eigen::Vector2d UavSim::attitudeFor(const Eigen::Vector2d &accel) const
+{
+	// Forward acceleration pitches the nose down (positive pitch), left rolls left (negative roll)
+	Eigen::Vector2d a = rotate(-rpy_(2), accel);
+	return Eigen::Vector2d(clip(-atan2(a(1), G), p_.maxTilt), clip(atan2(a(0), G), p_.maxTilt));
+}
+
+void UavSim::stepUav()
+{
+	const double dt = p_.dt;
+
+	// Setpoints for this step
+	Eigen::Vector2d hold = -vel_.head<2>() / p_.velocityTau + p_.drag * vel_.head<2>();
+	double climb = 0, yawRate = 0, thrust = -1;
+	if (task_ == TAKEOFF)
+	{
+		tiltCmd_ = attitudeFor(hold);
+		climb = std::min(1.0, p_.heightGain * (taskHeight_ - pos_(2)) + 0.1);
+		if (pos_(2) >= taskHeight_ - 0.05)
+		{
+			task_ = NO_TASK;
+			lastCommand_ = -1e9;
+		}
+	}
+	else if (task_ == LANDING)
+	{
+		tiltCmd_ = attitudeFor(hold);
+		climb = -p_.landingSpeed;
+	}
+	else if (t_ - lastCommand_ > p_.commandTimeout)
+		tiltCmd_ = attitudeFor(hold);
+	else
+	{
+		Eigen::Vector2d xy(cmd_[0], cmd_[1]), v;
+		switch (flag_ & HORIZONTAL_MASK)
+		{
+		case HORIZONTAL_ANGLE:
+			tiltCmd_ << clip(xy(0), p_.maxTilt), clip(xy(1), p_.maxTilt);
+			break;
+		case HORIZONTAL_ANGULAR_RATE:
+			tiltCmd_ += xy * dt;
+			tiltCmd_ << clip(tiltCmd_(0), p_.maxTilt), clip(tiltCmd_(1), p_.maxTilt);
+			break;
+		case HORIZONTAL_VELOCITY:
+		case HORIZONTAL_POSITION:
+			if ((flag_ & HORIZONTAL_MASK) == HORIZONTAL_POSITION)
+				v = p_.positionGain * (target_.head<2>() - pos_.head<2>());
+			else
+				v = flag_ & HORIZONTAL_BODY ? rotate(rpy_(2), xy) : xy;
+			if (v.norm() > p_.maxVelocity)
+				v *= p_.maxVelocity / v.norm();
+			tiltCmd_ = attitudeFor((v - vel_.head<2>()) / p_.velocityTau + p_.drag * vel_.head<2>());
+			break;
+		}
+
+		switch (flag_ & VERTICAL_MASK)
+		{
+		case VERTICAL_POSITION:
+			climb = p_.heightGain * (cmd_[2] - pos_(2));
+			break;
+		case VERTICAL_THRUST:
+			thrust = std::max(0.0, cmd_[2]);
+			break;
+		default:
+			climb = cmd_[2];
+		}
+
+		yawRate = flag_ & YAW_RATE ? cmd_[3] : p_.yawGain * angles::wrap(cmd_[3] - rpy_(2));
+	}
+	climb = clip(climb, p_.maxVertical);
+	yawRate = clip(yawRate, p_.maxYawRate);
+
+	// Sitting on the pad until the motors lift off
+	if (landed_)
+	{
+		if (not armed_ or (thrust < 0 ? climb <= 0.1 : thrust <= p_.hoverThrust))
+		{
+			Eigen::Vector3d pad = padPosition();
+			pos_ << pad.head<2>() + rotate(boatYaw_, padLocal_.head<2>()), pad(2);
+			vel_ = boatVel_;
+			rpy_ << 0, 0, angles::wrap(boatYaw_ + padYaw_);
+			rates_.setZero();
+			tiltCmd_.setZero();
+			return;
+		}
+		landed_ = false;
+	}
+
+	// Attitude loop, semi-implicit so the step is stable
+	const double wn = p_.attitudeFrequency, zeta = p_.attitudeDamping;
+	for (int i = 0; i < 2; ++i)
+	{
+		rates_(i) += (wn * wn * (tiltCmd_(i) - rpy_(i)) - 2 * zeta * wn * rates_(i)) * dt;
+		rpy_(i) += rates_(i) * dt;
+	}
+	rates_(2) += (yawRate - rates_(2)) / p_.yawTau * dt;
+	rpy_(2) = angles::wrap(rpy_(2) + rates_(2) * dt);
+
+	// Thrust along the body z axis
+	double cr = cos(rpy_(0)), sr = sin(rpy_(0)), cp = cos(rpy_(1)), sp = sin(rpy_(1)), cy = cos(rpy_(2)),
+				 sy = sin(rpy_(2));
+	double lift;
+	if (thrust >= 0)
+		lift = G * thrust / p_.hoverThrust;
+	else
+	{
+		double accel = clip((climb - vel_(2)) / p_.verticalTau + p_.drag * vel_(2), p_.maxAccel);
+		lift = (G + accel) / std::max(0.2, cr * cp);
+	}
+	lift = armed_ ? std::max(0.0, std::min(2.5 * G, lift)) : 0;
+	Eigen::Vector3d zb(cy * sp * cr + sy * sr, sy * sp * cr - cy * sr, cp * cr);
+	Eigen::Vector3d a = lift * zb - Eigen::Vector3d(0, 0, G) - p_.drag * (vel_ - p_.wind);
+	vel_ += a * dt;
+	pos_ += vel_ * dt;
+
+	// Contact with the pad or the water
+	Eigen::Vector3d pad = padPosition();
+	Eigen::Vector2d off = pos_.head<2>() - pad.head<2>();
+	double closing = vel_(2) - boatVel_(2);
+	if (pos_(2) <= pad(2) and closing <= 0 and off.norm() <= p_.padRadius and pos_(2) > pad(2) - 0.5)
+	{
+		touchdown_ = -closing;
+		if (touchdown_ > p_.touchdownSpeed)
+		{
+			crashed_ = true;
+			return;
+		}
+		landed_ = true;
+		padLocal_ << rotate(-boatYaw_, off), 0;
+		padYaw_ = angles::wrap(rpy_(2) - boatYaw_);
+		if (task_ == LANDING)
+		{
+			task_ = NO_TASK;
+			armed_ = false;
+		}
+	}
+	else if (pos_(2) <= 0)
+		crashed_ = true;
+}
+} // namespace bsc_common
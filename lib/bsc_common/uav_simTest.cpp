@@ -0,0 +1,263 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/uav_sim.h"
+#include "include/angles.h"
+#include "include/lqr.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using namespace bsc_common;
+
+/**
+ * LQR command the way behaviors makes it: state and setpoint in the UAV's heading frame,
+ * sent with the LQR flag from dji_pilot::buildFlag
+ */
+static void flyLqr(UavSim &sim, LQR &lqr, const Eigen::Vector3d &goal, double yaw,
+									 const Eigen::Vector3d &vel = Eigen::Vector3d::Zero())
+{
+	Eigen::Matrix<double, 12, 1> x = sim.uav(), state, set;
+	double c = cos(x(8)), s = sin(x(8));
+	Eigen::Vector3d d = goal - x.head<3>();
+	state << 0, 0, 0, c * x(3) + s * x(4), -s * x(3) + c * x(4), x(5), x(6), x(7), 0, x(9), x(10), x(11);
+	set << c * d(0) + s * d(1), -s * d(0) + c * d(1), d(2), c * vel(0) + s * vel(1), -s * vel(0) + c * vel(1), vel(2), 0, 0, angles::wrap(yaw - x(8)), 0, 0, 0;
+	lqr.updateState(state);
+	Eigen::Vector4d u = lqr.getCommand(set);
+	sim.command(u(0), u(1), u(2), u(3),
+							UavSim::HORIZONTAL_ANGLE | UavSim::VERTICAL_VELOCITY | UavSim::YAW_RATE | UavSim::HORIZONTAL_BODY);
+}
+
+int main()
+{
+	int failures = 0;
+
+	// cfg/generalK.txt
+	Eigen::Matrix<double, 4, 12> K = Eigen::Matrix<double, 4, 12>::Zero();
+	K(0, 1) = -0.886, K(0, 4) = -0.673, K(0, 6) = 1.092, K(0, 9) = 0.125;
+	K(1, 0) = 0.888, K(1, 3) = 0.676, K(1, 7) = 1.101, K(1, 10) = 0.129;
+	K(2, 2) = 0.604, K(2, 5) = 0.361;
+	K(3, 8) = 0.523, K(3, 11) = 0.332;
+
+	// Takeoff from the pad
+	{
+		UavSim sim;
+		double start = sim.uav()(2);
+		if (not sim.landed() or sim.armed() or not sim.takeoff())
+		{
+			++failures;
+			printf("  FAIL: start on the pad\n");
+		}
+		sim.step(2000);
+		Eigen::Matrix<double, 12, 1> x = sim.uav();
+		if (sim.landed() or std::fabs(x(2) - start - 1.2) > 0.1 or x.segment<2>(0).norm() > 0.05)
+		{
+			++failures;
+			printf("  FAIL: takeoff to %.2f at (%.2f, %.2f)\n", x(2) - start, x(0), x(1));
+		}
+	}
+
+	// The repo's LQR gains hold a hover offset of 3m, so the model matches their signs
+	{
+		UavSim sim;
+		LQR lqr(K);
+		sim.takeoff();
+		sim.step(2000);
+		Eigen::Vector3d goal(3, -2, 3);
+		for (int i = 0; i < 40 * 15; ++i)
+		{
+			flyLqr(sim, lqr, goal, 1.0);
+			sim.step(10); // 40Hz
+		}
+		Eigen::Matrix<double, 12, 1> x = sim.uav();
+		if ((x.head<3>() - goal).norm() > 0.1 or std::fabs(angles::wrap(x(8) - 1.0)) > 0.05 or
+				x.segment<3>(3).norm() > 0.05)
+		{
+			++failures;
+			printf("  FAIL: LQR reached (%.2f, %.2f, %.2f) yaw %.2f\n", x(0), x(1), x(2), x(8));
+		}
+	}
+
+	// Velocity in the ground and body frames, and position offsets
+	{
+		UavSim sim;
+		sim.takeoff();
+		sim.step(2000);
+		for (int i = 0; i < 200; ++i)
+		{
+			sim.command(1, 0.5, 0, M_PI / 2, UavSim::HORIZONTAL_VELOCITY | UavSim::VERTICAL_VELOCITY | UavSim::YAW_ANGLE);
+			sim.step(10);
+		}
+		Eigen::Matrix<double, 12, 1> x = sim.uav();
+		bool ok = std::fabs(x(3) - 1) < 0.05 and std::fabs(x(4) - 0.5) < 0.05 and std::fabs(x(8) - M_PI / 2) < 0.05;
+
+		// Yawed to north, body forward is north
+		for (int i = 0; i < 200; ++i)
+		{
+			sim.command(1, 0, 0, 0, UavSim::HORIZONTAL_VELOCITY | UavSim::VERTICAL_VELOCITY | UavSim::YAW_RATE |
+																UavSim::HORIZONTAL_BODY);
+			sim.step(10);
+		}
+		x = sim.uav();
+		ok = ok and std::fabs(x(3)) < 0.05 and std::fabs(x(4) - 1) < 0.05;
+
+		// Position setpoints are offsets from where the UAV is when they arrive
+		Eigen::Vector3d goal = x.head<3>() + Eigen::Vector3d(2, -1, 0);
+		for (int i = 0; i < 400; ++i)
+		{
+			Eigen::Vector3d d = goal - sim.uav().head<3>();
+			sim.command(d(0), d(1), 4, 0, UavSim::HORIZONTAL_POSITION | UavSim::VERTICAL_POSITION | UavSim::YAW_RATE);
+			sim.step(10);
+		}
+		x = sim.uav();
+		ok = ok and (x.head<2>() - goal.head<2>()).norm() < 0.05;
+		if (not ok or std::fabs(x(2) - 4) > 0.05)
+		{
+			++failures;
+			printf("  FAIL: velocity and position setpoints\n");
+		}
+
+		// Without commands it brakes to a hover
+		sim.step(4000);
+		if (sim.uav().segment<3>(3).norm() > 0.01)
+		{
+			++failures;
+			printf("  FAIL: hover after command timeout\n");
+		}
+	}
+
+	// Land on a moving, heaving boat with the LQR, then ride it
+	{
+		UavSim::params_t p;
+		p.boatSpeed = 1.0;
+		p.weaveAmplitude = 0.2;
+		p.heaveAmplitude = 0.1;
+		UavSim sim(p);
+		LQR lqr(K);
+		sim.takeoff();
+		sim.step(2000);
+		for (int i = 0; i < 40 * 30 and not sim.landed(); ++i)
+		{
+			Eigen::Vector3d goal = sim.padPosition();
+			goal(2) = std::max(goal(2) - 0.2, sim.uav()(2) - 0.3);
+			flyLqr(sim, lqr, goal, sim.boatHeading(), sim.boatVelocity());
+			sim.step(10);
+		}
+		bool ok = sim.landed() and not sim.crashed() and sim.touchdown() < 1;
+		sim.step(4000);
+		ok = ok and sim.landed() and (sim.uav().head<2>() - sim.padPosition().head<2>()).norm() < p.padRadius;
+		if (not ok)
+		{
+			++failures;
+			printf("  FAIL: landing on the moving boat, touchdown %.2fm/s\n", sim.touchdown());
+		}
+	}
+
+	// Tag visibility
+	{
+		UavSim sim(7);
+		sim.takeoff();
+		sim.step(2000);
+		int seen = 0;
+		double worst = 0;
+		for (int i = 0; i < 1000; ++i)
+		{
+			UavSim::tag_t tag = sim.tag();
+			if (tag.seen)
+			{
+				++seen;
+				worst = std::max(worst, (tag.position - Eigen::Vector3d(0, 0, -1.2)).norm());
+			}
+		}
+		if (seen < 900 or worst > 0.1)
+		{
+			++failures;
+			printf("  FAIL: tag overhead seen %i of 1000, error %.3f\n", seen, worst);
+		}
+
+		// Out of range
+		for (int i = 0; i < 400; ++i)
+		{
+			sim.command(3, 0, 0, 0, UavSim::HORIZONTAL_VELOCITY | UavSim::VERTICAL_VELOCITY | UavSim::YAW_RATE);
+			sim.step(10);
+		}
+		seen = 0;
+		for (int i = 0; i < 100; ++i)
+			seen += sim.tag().seen;
+		if (seen)
+		{
+			++failures;
+			printf("  FAIL: tag seen %i times from %.1fm away\n", seen, sim.uav()(0));
+		}
+	}
+
+	// Disarming in the air is refused, the water is a crash, and runs repeat exactly
+	{
+		UavSim a(3), b(3);
+		a.takeoff();
+		b.takeoff();
+		a.step(400);
+		b.step(400);
+		bool refused = not a.arm(false);
+		for (int i = 0; i < 4000; ++i)
+		{
+			double v = 2 + sin(i * 0.01);
+			a.command(v, -v, -1, v, UavSim::HORIZONTAL_VELOCITY | UavSim::VERTICAL_VELOCITY | UavSim::YAW_RATE);
+			b.command(v, -v, -1, v, UavSim::HORIZONTAL_VELOCITY | UavSim::VERTICAL_VELOCITY | UavSim::YAW_RATE);
+			a.step();
+			b.step();
+			a.tag();
+			b.tag();
+		}
+		if (not refused or not a.crashed() or a.uav() != b.uav() or a.tag().seen != b.tag().seen)
+		{
+			++failures;
+			printf("  FAIL: crash and determinism\n");
+		}
+	}
+
+	// Speed
+	{
+		UavSim sim;
+		sim.takeoff();
+		const int n = 400000;
+		auto s = std::chrono::steady_clock::now();
+		for (int i = 0; i < n; ++i)
+		{
+			if (i % 10 == 0)
+				sim.command(sin(i * 1e-4), 0, 0, 0, UavSim::HORIZONTAL_VELOCITY | UavSim::VERTICAL_VELOCITY | UavSim::YAW_RATE);
+			sim.step();
+		}
+		auto e = std::chrono::steady_clock::now();
+		double wall = std::chrono::duration<double>(e - s).count();
+		printf("%.0fs simulated in %.3fs at %.0fHz: %.0f simulated s per wall s\n", sim.time(), wall, 1 / 0.0025,
+					 sim.time() / wall);
+	}
+
+	if (failures)
+		printf("%i FAILURES\n", failures);
+	else
+		printf("PASSED\n");
+	return failures;
+}
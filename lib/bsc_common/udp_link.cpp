@@ -0,0 +1,525 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the prioritized UDP message link
+ * 
+ * Author: Brennan Cain
+ */
+#include "include/udp_link.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace bsc_common
+{
+namespace
+{
+const uint8_t MAGIC = 0x4b;
+const uint32_t MAX_RTT_US = 10000000; // echoes older than this are not round trips
+const int32_t RESYNC = 1024;					// without a key, a sequence this far behind means the peer restarted
+
+/** SipHash
+ * SipHash-2-4, fed in pieces so the tag field can be skipped without a copy
+ */
+class SipHash
+{
+public:
+	SipHash(const uint64_t key[2])
+	{
+		v0_ = key[0] ^ 0x736f6d6570736575ull;
+		v1_ = key[1] ^ 0x646f72616e646f6dull;
+		v2_ = key[0] ^ 0x6c7967656e657261ull;
+		v3_ = key[1] ^ 0x7465646279746573ull;
+	}
+
+	void update(const uint8_t *data, size_t size)
+	{
+		for (size_t i = 0; i < size; ++i)
+		{
+			word_ |= (uint64_t)data[i] << (8 * (length_ & 7));
+			if ((++length_ & 7) == 0)
+			{
+				compress(word_);
+				word_ = 0;
+			}
+		}
+	}
+
+	uint64_t final()
+	{
+		compress(word_ | (uint64_t)length_ << 56);
+		v2_ ^= 0xff;
+		for (int i = 0; i < 4; ++i)
+			round();
+		return v0_ ^ v1_ ^ v2_ ^ v3_;
+	}
+
+private:
+	static uint64_t rotate(uint64_t x, int b)
+	{
+		return (x << b) | (x >> (64 - b));
+	}
+
+	void round()
+	{
+		v0_ += v1_;
+		v1_ = rotate(v1_, 13) ^ v0_;
+		v0_ = rotate(v0_, 32);
+		v2_ += v3_;
+		v3_ = rotate(v3_, 16) ^ v2_;
+		v0_ += v3_;
+		v3_ = rotate(v3_, 21) ^ v0_;
+		v2_ += v1_;
+		v1_ = rotate(v1_, 17) ^ v2_;
+		v2_ = rotate(v2_, 32);
+	}
+
+	void compress(uint64_t m)
+	{
+		v3_ ^= m;
+		round();
+		round();
+		v0_ ^= m;
+	}
+
+	uint64_t v0_, v1_, v2_, v3_;
+	uint64_t word_ = 0;
+	size_t length_ = 0;
+};
+} // namespace
+
+double UdpLink::stats_t::lossRate() const
+{
+	return lost + telemetry ? (double)lost / (lost + telemetry) : 0;
+}
+
+UdpLink::UdpLink(size_t telemetryQueue) : telemetryQueue_(telemetryQueue), rng_(1)
+{
+	epoch_ = std::chrono::steady_clock::now();
+	commandSeq_ = std::random_device()();
+	memset(telemetrySeq_, 0, sizeof(telemetrySeq_));
+	memset(heardTelemetry_, 0, sizeof(heardTelemetry_));
+	memset(lastTelemetry_, 0, sizeof(lastTelemetry_));
+	memset(&stats_, 0, sizeof(stats_));
+}
+
+UdpLink::~UdpLink()
+{
+	close();
+}
+
+bool UdpLink::open(uint16_t port, const std::string &peerHost, uint16_t peerPort)
+{
+	close();
+	addrinfo hints, *found = nullptr;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	if (getaddrinfo(peerHost.c_str(), std::to_string(peerPort).c_str(), &hints, &found) or not found)
+		return false;
+	peer_.assign((uint8_t *)found->ai_addr, (uint8_t *)found->ai_addr + found->ai_addrlen);
+	freeaddrinfo(found);
+
+	fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+	wake_ = eventfd(0, EFD_NONBLOCK);
+	sockaddr_in local;
+	memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	local.sin_port = htons(port);
+	if (fd_ < 0 or wake_ < 0 or bind(fd_, (sockaddr *)&local, sizeof(local)))
+	{
+		close();
+		return false;
+	}
+	buffer_.resize(sizeof(header_t) + MAX_PAYLOAD);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	commands_.clear();
+	telemetry_.clear();
+	inFlight_ = false;
+	heardCommand_ = heardPeer_ = false;
+	memset(heardTelemetry_, 0, sizeof(heardTelemetry_));
+	std::random_device random;
+	do
+		session_ = random();
+	while (session_ == 0);
+	peerSession_ = streamSession_ = 0;
+	hello_ = false;
+	memset(&stats_, 0, sizeof(stats_));
+	tokens_ = burst_;
+	refilled_ = std::chrono::steady_clock::now();
+	return true;
+}
+
+void UdpLink::close()
+{
+	if (fd_ >= 0)
+		::close(fd_);
+	if (wake_ >= 0)
+		::close(wake_);
+	fd_ = wake_ = -1;
+}
+
+bool UdpLink::isOpen() const
+{
+	return fd_ >= 0;
+}
+
+bool UdpLink::send(uint8_t channel, priority_t priority, const uint8_t *data, size_t size)
+{
+	if (fd_ < 0 or size > MAX_PAYLOAD)
+		return false;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (priority == COMMAND)
+			commands_.push_back({channel, ++commandSeq_, std::vector<uint8_t>(data, data + size)});
+		else
+		{
+			if (telemetry_.size() >= telemetryQueue_)
+			{
+				telemetry_.pop_front();
+				++stats_.dropped;
+			}
+			telemetry_.push_back({channel, ++telemetrySeq_[channel], std::vector<uint8_t>(data, data + size)});
+		}
+	}
+
+	// Wake a poll waiting on the socket, a full counter means it is already awake
+	uint64_t one = 1;
+	ssize_t woke = write(wake_, &one, sizeof(one));
+	(void)woke;
+	return true;
+}
+
+void UdpLink::poll(const handler_t &handler, double timeout)
+{
+	if (fd_ < 0)
+		return;
+
+	// Sleep until a datagram, a send, a resend or enough bandwidth for the next telemetry
+	auto now = std::chrono::steady_clock::now();
+	double wait = timeout;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (not commands_.empty())
+			wait = inFlight_ ? std::min(wait, std::chrono::duration<double>(resendAt_ - now).count()) : 0;
+		if (not telemetry_.empty())
+		{
+			double need = sizeof(header_t) + telemetry_.front().data.size() - tokens_;
+			wait = std::min(wait, bandwidth_ > 0 ? need / bandwidth_ : 0);
+		}
+	}
+	if (wait > 0)
+	{
+		pollfd fds[2] = {{fd_, POLLIN, 0}, {wake_, POLLIN, 0}};
+		::poll(fds, 2, (int)std::ceil(wait * 1000));
+		uint64_t count;
+		ssize_t woke = read(wake_, &count, sizeof(count));
+		(void)woke;
+	}
+
+	// Receive
+	std::vector<std::pair<header_t, std::vector<uint8_t>>> delivered;
+	for (;;)
+	{
+		sockaddr_storage from;
+		socklen_t fromSize = sizeof(from);
+		ssize_t n = recvfrom(fd_, buffer_.data(), buffer_.size(), MSG_DONTWAIT, (sockaddr *)&from, &fromSize);
+		if (n < 0)
+			break;
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (not fromPeer(&from, fromSize))
+		{
+			++stats_.rejected;
+			continue;
+		}
+		receive(buffer_.data(), n, delivered);
+	}
+	for (const auto &d : delivered)
+		handler(d.first.channel, d.first.kind == KIND_COMMAND ? COMMAND : TELEMETRY, d.second.data(), d.second.size());
+
+	// Send, a hello and then commands first
+	std::lock_guard<std::mutex> lock(mutex_);
+	now = std::chrono::steady_clock::now();
+	if (hello_)
+	{
+		transmit(KIND_HELLO, 0, 0, nullptr, 0);
+		hello_ = false;
+	}
+	if (bandwidth_ > 0)
+	{
+		tokens_ = std::min(burst_, tokens_ + bandwidth_ * std::chrono::duration<double>(now - refilled_).count());
+		refilled_ = now;
+	}
+	if (inFlight_ and now >= resendAt_ and retries_ >= maxRetries_)
+	{
+		commands_.pop_front();
+		inFlight_ = false;
+		++stats_.failed;
+	}
+	if (not commands_.empty() and (not inFlight_ or now >= resendAt_))
+	{
+		const message_t &m = commands_.front();
+		if (inFlight_)
+		{
+			++retries_;
+			++stats_.retransmits;
+		}
+		else
+			retries_ = 0;
+		transmit(KIND_COMMAND, m.channel, m.seq, m.data.data(), m.data.size());
+		inFlight_ = true;
+		resendAt_ = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+													std::chrono::duration<double>(retransmitTimeout() * (1 << std::min(retries_, 6))));
+	}
+	while (not telemetry_.empty())
+	{
+		const message_t &m = telemetry_.front();
+		if (bandwidth_ > 0 and tokens_ < sizeof(header_t) + m.data.size())
+			break;
+		transmit(KIND_TELEMETRY, m.channel, m.seq, m.data.data(), m.data.size());
+		telemetry_.pop_front();
+	}
+}
+
+void UdpLink::setBandwidth(double bytesPerSecond, double burst)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	bandwidth_ = bytesPerSecond;
+	burst_ = burst;
+	tokens_ = burst;
+	refilled_ = std::chrono::steady_clock::now();
+}
+
+void UdpLink::setRetries(int maxRetries, double minTimeout)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	maxRetries_ = maxRetries;
+	minTimeout_ = minTimeout;
+}
+
+void UdpLink::setKey(const std::string &key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	keyed_ = not key.empty();
+	for (uint64_t i = 0; i < 2; ++i)
+	{
+		uint64_t salt[2] = {i, 0};
+		SipHash h(salt);
+		h.update((const uint8_t *)key.data(), key.size());
+		key_[i] = h.final();
+	}
+}
+
+void UdpLink::simulateLoss(double probability, unsigned seed)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	loss_ = probability;
+	rng_.seed(seed);
+}
+
+UdpLink::stats_t UdpLink::stats() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stats_;
+}
+
+size_t UdpLink::pendingCommands() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return commands_.size();
+}
+
+uint32_t UdpLink::nowUs() const
+{
+	return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch_)
+			.count();
+}
+
+void UdpLink::transmit(uint8_t kind, uint8_t channel, uint32_t seq, const uint8_t *data, size_t size)
+{
+	header_t h;
+	h.magic = MAGIC;
+	h.kind = kind;
+	h.channel = channel;
+	h.hasEcho = heardPeer_;
+	h.seq = seq;
+	h.stamp = nowUs();
+	h.echo = peerStamp_;
+	h.hold = h.stamp - peerHeardAt_;
+	h.session = session_;
+	h.peerSession = peerSession_;
+	h.tag[0] = h.tag[1] = 0;
+
+	size_t n = sizeof(h) + size;
+	std::vector<uint8_t> out(n);
+	memcpy(out.data(), &h, sizeof(h));
+	if (size)
+		memcpy(out.data() + sizeof(h), data, size);
+	if (keyed_)
+	{
+		uint64_t tag = sign(out.data(), n);
+		memcpy(out.data() + offsetof(header_t, tag), &tag, sizeof(tag));
+	}
+
+	++stats_.sent;
+	stats_.sentBytes += n;
+	tokens_ -= n;
+	if (loss_ > 0 and std::uniform_real_distribution<double>(0, 1)(rng_) < loss_)
+		return;
+	sendto(fd_, out.data(), n, 0, (const sockaddr *)peer_.data(), peer_.size());
+}
+
+void UdpLink::receive(const uint8_t *data, size_t size, std::vector<std::pair<header_t, std::vector<uint8_t>>> &delivered)
+{
+	header_t h;
+	if (size < sizeof(h))
+		return;
+	memcpy(&h, data, sizeof(h));
+	if (h.magic != MAGIC or h.kind > KIND_HELLO)
+		return;
+	uint64_t tag;
+	memcpy(&tag, h.tag, sizeof(tag));
+	if (keyed_ and tag != sign(data, size))
+	{
+		++stats_.rejected;
+		return;
+	}
+
+	// Resend the command in flight at once when the peer's session changes
+	if (h.session != peerSession_ and inFlight_)
+		resendAt_ = std::chrono::steady_clock::now();
+	peerSession_ = h.session;
+	if (keyed_ and h.kind != KIND_HELLO)
+	{
+		// Only a datagram echoing this session can be fresh, tell the peer the session
+		if (h.peerSession != session_)
+		{
+			++stats_.rejected;
+			hello_ = true;
+			return;
+		}
+
+		// A fresh datagram from a new session is a restarted peer
+		if (h.session != streamSession_)
+		{
+			streamSession_ = h.session;
+			heardCommand_ = false;
+			memset(heardTelemetry_, 0, sizeof(heardTelemetry_));
+		}
+	}
+	++stats_.received;
+	stats_.receivedBytes += size;
+
+	uint32_t now = nowUs();
+	heardPeer_ = true;
+	peerStamp_ = h.stamp;
+	peerHeardAt_ = now;
+	uint32_t rtt = now - h.echo - h.hold;
+	if (h.hasEcho and rtt < MAX_RTT_US)
+	{
+		// Smoothed as in RFC 6298
+		double sample = rtt * 1e-6;
+		if (stats_.rtt == 0)
+		{
+			stats_.rtt = sample;
+			stats_.rttVar = sample / 2;
+		}
+		else
+		{
+			stats_.rttVar = 0.75 * stats_.rttVar + 0.25 * std::fabs(stats_.rtt - sample);
+			stats_.rtt = 0.875 * stats_.rtt + 0.125 * sample;
+		}
+	}
+
+	const uint8_t *payload = data + sizeof(h);
+	size_t length = size - sizeof(h);
+	if (h.kind == KIND_HELLO)
+		return;
+	if (h.kind == KIND_ACK)
+	{
+		if (inFlight_ and not commands_.empty() and commands_.front().seq == h.seq)
+		{
+			commands_.pop_front();
+			inFlight_ = false;
+		}
+	}
+	else if (h.kind == KIND_COMMAND)
+	{
+		// Acknowledge every copy, deliver the first
+		transmit(KIND_ACK, h.channel, h.seq, nullptr, 0);
+		int32_t ahead = (int32_t)(h.seq - lastCommand_);
+		if (heardCommand_ and ahead <= 0 and (keyed_ or ahead > -RESYNC))
+			return;
+		heardCommand_ = true;
+		lastCommand_ = h.seq;
+		++stats_.commands;
+		delivered.emplace_back(h, std::vector<uint8_t>(payload, payload + length));
+	}
+	else
+	{
+		int32_t ahead = (int32_t)(h.seq - lastTelemetry_[h.channel]);
+		if (heardTelemetry_[h.channel] and ahead <= 0 and (keyed_ or ahead > -RESYNC))
+		{
+			++stats_.late;
+			return;
+		}
+		if (heardTelemetry_[h.channel] and ahead > 0)
+			stats_.lost += ahead - 1;
+		heardTelemetry_[h.channel] = true;
+		lastTelemetry_[h.channel] = h.seq;
+		++stats_.telemetry;
+		delivered.emplace_back(h, std::vector<uint8_t>(payload, payload + length));
+	}
+}
+
+uint64_t UdpLink::sign(const uint8_t *data, size_t size) const
+{
+	SipHash h(key_);
+	h.update(data, offsetof(header_t, tag));
+	h.update(data + sizeof(header_t), size - sizeof(header_t));
+	return h.final();
+}
+
+bool UdpLink::fromPeer(const void *address, size_t size) const
+{
+	const sockaddr_in *from = (const sockaddr_in *)address, *peer = (const sockaddr_in *)peer_.data();
+	return size >= sizeof(sockaddr_in) and from->sin_family == AF_INET and
+				 from->sin_addr.s_addr == peer->sin_addr.s_addr and from->sin_port == peer->sin_port;
+}
+
+double UdpLink::retransmitTimeout() const
+{
+	return std::max(minTimeout_, stats_.rtt > 0 ? stats_.rtt + 4 * stats_.rttVar : 4 * minTimeout_);
+}
+} // namespace bsc_common
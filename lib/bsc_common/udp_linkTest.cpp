@@ -0,0 +1,412 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "include/udp_link.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace bsc_common;
+
+struct received_t
+{
+	std::vector<uint32_t> commands, telemetry;
+	std::vector<bool> order; // true for a command, in delivery order
+};
+
+static UdpLink::handler_t collect(received_t &r)
+{
+	return [&r](uint8_t, UdpLink::priority_t priority, const uint8_t *data, size_t size) {
+		uint32_t i = 0;
+		if (size >= 4)
+			memcpy(&i, data, 4);
+		(priority == UdpLink::COMMAND ? r.commands : r.telemetry).push_back(i);
+		r.order.push_back(priority == UdpLink::COMMAND);
+	};
+}
+
+static void pump(UdpLink &a, received_t &ra, UdpLink &b, received_t &rb, double seconds)
+{
+	auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+	while (std::chrono::steady_clock::now() < end)
+	{
+		a.poll(collect(ra), 0.001);
+		b.poll(collect(rb), 0.001);
+	}
+}
+
+// Forwards datagrams between two links on loopback and keeps the ones the first sends
+struct relay_t
+{
+	int fd;
+	uint16_t portA, portB;
+	std::vector<std::vector<uint8_t>> captured;
+
+	relay_t(uint16_t port, uint16_t portA, uint16_t portB) : portA(portA), portB(portB)
+	{
+		fd = socket(AF_INET, SOCK_DGRAM, 0);
+		sockaddr_in local = address(port);
+		bind(fd, (sockaddr *)&local, sizeof(local));
+	}
+
+	~relay_t()
+	{
+		close(fd);
+	}
+
+	static sockaddr_in address(uint16_t port)
+	{
+		sockaddr_in a;
+		memset(&a, 0, sizeof(a));
+		a.sin_family = AF_INET;
+		a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		a.sin_port = htons(port);
+		return a;
+	}
+
+	void step()
+	{
+		uint8_t buffer[2048];
+		sockaddr_in from;
+		socklen_t size = sizeof(from);
+		ssize_t n;
+		while ((n = recvfrom(fd, buffer, sizeof(buffer), MSG_DONTWAIT, (sockaddr *)&from, &size)) >= 0)
+		{
+			bool fromA = ntohs(from.sin_port) == portA;
+			if (fromA)
+				captured.push_back(std::vector<uint8_t>(buffer, buffer + n));
+			sockaddr_in to = address(fromA ? portB : portA);
+			sendto(fd, buffer, n, 0, (sockaddr *)&to, sizeof(to));
+			size = sizeof(from);
+		}
+	}
+
+	void replay(const std::vector<uint8_t> &datagram)
+	{
+		sockaddr_in to = address(portB);
+		sendto(fd, datagram.data(), datagram.size(), 0, (sockaddr *)&to, sizeof(to));
+	}
+};
+
+static void relayPump(UdpLink &a, received_t &ra, relay_t &relay, UdpLink &b, received_t &rb, double seconds)
+{
+	auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+	while (std::chrono::steady_clock::now() < end)
+	{
+		a.poll(collect(ra));
+		relay.step();
+		b.poll(collect(rb));
+		relay.step();
+	}
+}
+
+static bool inOrder(const std::vector<uint32_t> &v, uint32_t n)
+{
+	if (v.size() != n)
+		return false;
+	for (uint32_t i = 0; i < n; ++i)
+		if (v[i] != i)
+			return false;
+	return true;
+}
+
+int main()
+{
+	int failures = 0;
+	uint8_t payload[200] = {0};
+
+	// Clean link
+	{
+		UdpLink a, b;
+		received_t ra, rb;
+		if (not a.open(47110, "127.0.0.1", 47111) or not b.open(47111, "localhost", 47110))
+		{
+			printf("  FAIL: open\n");
+			return 1;
+		}
+		for (uint32_t i = 0; i < 20; ++i)
+		{
+			memcpy(payload, &i, 4);
+			a.send(1, UdpLink::COMMAND, payload, 4);
+			a.send(0, UdpLink::TELEMETRY, payload, 100);
+		}
+		pump(a, ra, b, rb, 0.5);
+		UdpLink::stats_t s = b.stats();
+		if (not inOrder(rb.commands, 20) or not inOrder(rb.telemetry, 20) or s.lost or a.stats().retransmits)
+		{
+			++failures;
+			printf("  FAIL: clean link, %zu commands %zu telemetry\n", rb.commands.size(), rb.telemetry.size());
+		}
+		if (a.stats().rtt <= 0 or a.stats().rtt > 0.05)
+		{
+			++failures;
+			printf("  FAIL: round trip %f\n", a.stats().rtt);
+		}
+		if (a.send(0, UdpLink::TELEMETRY, payload, UdpLink::MAX_PAYLOAD + 1))
+		{
+			++failures;
+			printf("  FAIL: oversized payload queued\n");
+		}
+	}
+
+	// 20% loss each way: commands still arrive once and in order, telemetry loss is measured
+	{
+		UdpLink a, b;
+		received_t ra, rb;
+		a.open(47112, "127.0.0.1", 47113);
+		b.open(47113, "127.0.0.1", 47112);
+		a.simulateLoss(0.2, 3);
+		b.simulateLoss(0.2, 4);
+		a.setRetries(20, 0.005);
+		const uint32_t n = 2000, commands = 50;
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			memcpy(payload, &i, 4);
+			a.send(0, UdpLink::TELEMETRY, payload, 40);
+			if (i % (n / commands) == 0)
+			{
+				uint32_t c = i / (n / commands);
+				memcpy(payload, &c, 4);
+				a.send(1, UdpLink::COMMAND, payload, 4);
+			}
+			a.poll(collect(ra));
+			b.poll(collect(rb));
+		}
+		pump(a, ra, b, rb, 1);
+		UdpLink::stats_t sa = a.stats(), sb = b.stats();
+		bool increasing = true;
+		for (size_t i = 1; i < rb.telemetry.size(); ++i)
+			increasing = increasing and rb.telemetry[i] > rb.telemetry[i - 1];
+		if (not inOrder(rb.commands, commands) or sa.failed or not increasing)
+		{
+			++failures;
+			printf("  FAIL: lossy link, %zu of %u commands, %zu pending\n", rb.commands.size(), commands, a.pendingCommands());
+		}
+		if (std::fabs(sb.lossRate() - 0.2) > 0.04 or sb.telemetry + sb.lost + 1 < n * 0.99)
+		{
+			++failures;
+			printf("  FAIL: loss rate %.3f\n", sb.lossRate());
+		}
+		printf("20%% loss: %llu telemetry, %llu lost (%.1f%%), %llu resends for %u commands, rtt %.0fus +- %.0fus\n",
+					 (unsigned long long)sb.telemetry, (unsigned long long)sb.lost, 100 * sb.lossRate(),
+					 (unsigned long long)sa.retransmits, commands, sa.rtt * 1e6, sa.rttVar * 1e6);
+	}
+
+	// A command queued behind a telemetry backlog goes out first
+	{
+		UdpLink a(100), b;
+		received_t ra, rb;
+		a.open(47114, "127.0.0.1", 47115);
+		b.open(47115, "127.0.0.1", 47114);
+		a.setBandwidth(20000, 1000);
+		for (uint32_t i = 0; i < 100; ++i)
+		{
+			memcpy(payload, &i, 4);
+			a.send(0, UdpLink::TELEMETRY, payload, 180);
+		}
+		a.poll(collect(ra));
+		uint32_t c = 0;
+		memcpy(payload, &c, 4);
+		a.send(1, UdpLink::COMMAND, payload, 4);
+		pump(a, ra, b, rb, 0.3);
+		size_t at = 0;
+		while (at < rb.order.size() and not rb.order[at])
+			++at;
+		if (rb.commands.size() != 1 or at > 10 or rb.telemetry.size() >= 100)
+		{
+			++failures;
+			printf("  FAIL: command behind %zu telemetry, %zu telemetry sent\n", at, rb.telemetry.size());
+		}
+	}
+
+	// A command to nobody is given up on
+	{
+		UdpLink a;
+		received_t ra;
+		a.open(47116, "127.0.0.1", 47117);
+		a.setRetries(3, 0.01);
+		a.send(1, UdpLink::COMMAND, payload, 4);
+		auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(1000);
+		while (std::chrono::steady_clock::now() < end)
+			a.poll(collect(ra), 0.01);
+		UdpLink::stats_t s = a.stats();
+		if (s.failed != 1 or s.retransmits != 3 or a.pendingCommands())
+		{
+			++failures;
+			printf("  FAIL: unanswered command, %llu failed %llu resends\n", (unsigned long long)s.failed,
+						 (unsigned long long)s.retransmits);
+		}
+	}
+
+	// Datagrams from a third host are dropped
+	{
+		UdpLink a, b, c;
+		received_t ra, rb, rc;
+		a.open(47120, "127.0.0.1", 47121);
+		b.open(47121, "127.0.0.1", 47120);
+		c.open(47122, "127.0.0.1", 47121);
+		uint32_t i = 7;
+		memcpy(payload, &i, 4);
+		c.send(1, UdpLink::COMMAND, payload, 4);
+		c.send(0, UdpLink::TELEMETRY, payload, 4);
+		pump(c, rc, b, rb, 0.1);
+		if (rb.commands.size() or rb.telemetry.size() or b.stats().rejected != 2 or b.stats().received)
+		{
+			++failures;
+			printf("  FAIL: stranger delivered %zu commands %zu telemetry, %llu rejected\n", rb.commands.size(),
+						 rb.telemetry.size(), (unsigned long long)b.stats().rejected);
+		}
+	}
+	// Only datagrams signed with the shared key are delivered
+	{
+		UdpLink a, b;
+		received_t ra, rb;
+		a.open(47123, "127.0.0.1", 47124);
+		b.open(47124, "127.0.0.1", 47123);
+		a.setKey("wrong key");
+		b.setKey("shared key");
+		uint32_t i = 0;
+		memcpy(payload, &i, 4);
+		a.send(0, UdpLink::TELEMETRY, payload, 100);
+		pump(a, ra, b, rb, 0.05);
+		bool wrong = rb.telemetry.size() or b.stats().rejected != 1;
+
+		a.setKey("");
+		a.send(0, UdpLink::TELEMETRY, payload, 100);
+		pump(a, ra, b, rb, 0.05);
+		bool unsigned_ = rb.telemetry.size() or b.stats().rejected != 2;
+
+		// Telemetry is only accepted once the commands have carried the sessions across
+		a.setKey("shared key");
+		for (i = 0; i < 10; ++i)
+		{
+			memcpy(payload, &i, 4);
+			a.send(1, UdpLink::COMMAND, payload, 4);
+		}
+		pump(a, ra, b, rb, 0.2);
+		for (i = 0; i < 10; ++i)
+		{
+			memcpy(payload, &i, 4);
+			a.send(0, UdpLink::TELEMETRY, payload, 100);
+		}
+		pump(a, ra, b, rb, 0.1);
+		bool shared = inOrder(rb.commands, 10) and inOrder(rb.telemetry, 10);
+		if (wrong or unsigned_ or not shared)
+		{
+			++failures;
+			printf("  FAIL: keyed link, wrong key %s, no key %s, %zu commands %zu telemetry with the key\n",
+						 wrong ? "delivered" : "dropped", unsigned_ ? "delivered" : "dropped", rb.commands.size(),
+						 rb.telemetry.size());
+		}
+	}
+	// Keyed commands captured on the wire are not accepted again
+	{
+		UdpLink a, b;
+		received_t ra, rb;
+		relay_t relay(47127, 47125, 47126);
+		a.open(47125, "127.0.0.1", 47127);
+		b.open(47126, "127.0.0.1", 47127);
+		a.setKey("shared key");
+		b.setKey("shared key");
+		uint32_t i = 0;
+		memcpy(payload, &i, 4);
+		a.send(1, UdpLink::COMMAND, payload, 4);
+		relayPump(a, ra, relay, b, rb, 0.1);
+
+		// The second byte of a datagram is its kind, 0 for a command
+		std::vector<uint8_t> first;
+		for (const auto &d : relay.captured)
+			if (d.size() > 1 and d[1] == 0)
+				first = d;
+		relay.replay(first);
+		relayPump(a, ra, relay, b, rb, 0.05);
+		bool sameSession = rb.commands.size() == 1;
+
+		b.close();
+		b.open(47126, "127.0.0.1", 47127);
+		relay.replay(first);
+		relayPump(a, ra, relay, b, rb, 0.05);
+		bool restarted = rb.commands.size() == 1;
+
+		// A restarted peer still gets new commands, and none is far enough behind to resync
+		const uint32_t n = 1100;
+		for (i = 1; i <= n; ++i)
+		{
+			memcpy(payload, &i, 4);
+			a.send(1, UdpLink::COMMAND, payload, 4);
+		}
+		auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while (a.pendingCommands() and std::chrono::steady_clock::now() < end)
+			relayPump(a, ra, relay, b, rb, 0.001);
+		size_t delivered = rb.commands.size();
+		relay.replay(first);
+		relayPump(a, ra, relay, b, rb, 0.05);
+		bool farBehind = rb.commands.size() == delivered;
+
+		if (not sameSession or not restarted or not farBehind or delivered != n + 1)
+		{
+			++failures;
+			printf("  FAIL: replayed command delivered in the session %s, after a restart %s, %u behind %s, %zu of %u "
+						 "delivered\n",
+						 sameSession ? "no" : "yes", restarted ? "no" : "yes", n, farBehind ? "no" : "yes", delivered, n + 1);
+		}
+		printf("replay: %llu rejected\n", (unsigned long long)b.stats().rejected);
+	}
+	// Throughput over loopback
+	{
+		UdpLink a(1024), b;
+		received_t ra, rb;
+		a.open(47118, "127.0.0.1", 47119);
+		b.open(47119, "127.0.0.1", 47118);
+		const uint32_t n = 50000;
+		auto s = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			memcpy(payload, &i, 4);
+			a.send(0, UdpLink::TELEMETRY, payload, 150);
+			if (i % 16 == 15)
+			{
+				a.poll(collect(ra));
+				b.poll(collect(rb));
+			}
+		}
+		a.poll(collect(ra));
+		b.poll(collect(rb), 0.01);
+		auto e = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(e - s).count();
+		printf("loopback: %zu of %u 150 byte messages in %.0fms (%.0fk/s)\n", rb.telemetry.size(), n, ms,
+					 rb.telemetry.size() / ms);
+	}
+
+	if (failures)
+		printf("%i FAILURES\n", failures);
+	else
+		printf("PASSED\n");
+	return failures;
+}
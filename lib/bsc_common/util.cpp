@@ -30,40 +30,15 @@ SOFTWARE.
 #include "include/util.h"
 void bsc_common::util::rpy_from_quat(const geometry_msgs::Quaternion &orientation, geometry_msgs::Vector3 *state)
 {
-	// Get message as quaternion, then get roll, pitch, yaw
-	tf::Quaternion q(orientation.x, orientation.y, orientation.z, orientation.w);
-	tf::Matrix3x3 m(q);
-	double t_r, t_p, t_y;
-	m.getRPY(t_r, t_p, t_y);
-	state->x = t_r;
-	state->y = t_p;
-	state->z = t_y;
-	if (state->x > C_PI)
-	{
-		state->x = state->x - 2 * C_PI;
-	}
-	if (state->y > C_PI)
-	{
-		state->y = state->y - 2 * C_PI;
-	}
-	if (state->z > C_PI)
-	{
-		state->z = state->z - 2 * C_PI;
-	}
+	Eigen::Vector3d rpy = attitude::rpyFromQuat(orientation.x, orientation.y, orientation.z, orientation.w);
+	state->x = rpy(0);
+	state->y = rpy(1);
+	state->z = rpy(2);
 }
 
 double bsc_common::util::yaw_from_quat(const geometry_msgs::Quaternion &orientation)
 {
-	geometry_msgs::Vector3 *state = new geometry_msgs::Vector3();
-
-	bsc_common::util::rpy_from_quat(orientation, state);
-
-	double yaw = state->z;
-	if (yaw > bsc_common::util::C_PI)
-	{
-		yaw = yaw - 2 * bsc_common::util::C_PI;
-	}
-	return yaw;
+	return attitude::yawFromQuat(orientation.x, orientation.y, orientation.z, orientation.w);
 }
 
 template <typename T>
@@ -100,23 +75,7 @@ void bsc_common::util::inverse_pose(const geometry_msgs::Pose &in, geometry_msgs
 }
 double bsc_common::util::ang_dist(double start, double stop, bool rad)
 {
-	double pi = rad ? C_PI : 180;
-
-	while (start < -pi)
-		start += 2 * pi;
-	while (stop < -pi)
-		stop += 2 * pi;
-	while (start >= pi)
-		start -= 2 * pi;
-	while (stop >= pi)
-		stop -= 2 * pi;
-
-	int d1 = stop - start;
-	if (d1 >= pi)
-		d1 = d1 - 2 * pi;
-	if (d1 < -pi)
-		d1 = d1 + 2 * pi;
-	return d1;
+	return rad ? angles::diff(start, stop) : angles::diffDeg(start, stop);
 }
 
 double bsc_common::util::latlondist(double lat1, double lon1, double lat2, double lon2)
@@ -0,0 +1,245 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the waypoint path and its grid
+ * 
+ * Author: Brennan Cain
+ */
+
+#include "include/waypoint_path.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace bsc_common
+{
+void WaypointPath::clear()
+{
+	count_ = 0;
+	std::fill(bucketStart_.begin(), bucketStart_.end(), 0);
+}
+
+int WaypointPath::size() const
+{
+	return count_;
+}
+
+double WaypointPath::length() const
+{
+	return count_ == 0 ? 0 : legs_[count_ - 1].s0 + legs_[count_ - 1].length;
+}
+
+const WaypointPath::leg_t &WaypointPath::leg(int i) const
+{
+	return legs_[i];
+}
+
+unsigned int WaypointPath::bucket(int cx, int cy) const
+{
+	return ((unsigned int)cx * 73856093u ^ (unsigned int)cy * 19349663u) & bucketMask_;
+}
+
+int WaypointPath::cell(double v) const
+{
+	return (int)std::floor(v / cellSize_);
+}
+
+template <class F>
+void WaypointPath::forEachCell(const leg_t &l, F f) const
+{
+	// Grid traversal (Amanatides and Woo) so long diagonal legs only touch the
+	// cells they cross. The one cell pad absorbs rounding at cell borders.
+	int cx = cell(l.start(0)), cy = cell(l.start(1));
+	int ex = cell(l.end(0)), ey = cell(l.end(1));
+	int sx = ex > cx ? 1 : -1, sy = ey > cy ? 1 : -1;
+	int nx = std::abs(ex - cx), ny = std::abs(ey - cy);
+
+	double dx = l.end(0) - l.start(0), dy = l.end(1) - l.start(1);
+	double inf = std::numeric_limits<double>::infinity();
+	double stepX = dx != 0 ? cellSize_ / std::abs(dx) : inf;
+	double stepY = dy != 0 ? cellSize_ / std::abs(dy) : inf;
+	double nextX = dx != 0 ? ((sx > 0 ? cx + 1 : cx) * cellSize_ - l.start(0)) / dx : inf;
+	double nextY = dy != 0 ? ((sy > 0 ? cy + 1 : cy) * cellSize_ - l.start(1)) / dy : inf;
+
+	for (int x = cx - 1; x <= cx + 1; ++x)
+		for (int y = cy - 1; y <= cy + 1; ++y)
+			f(x, y);
+
+	// The traversal is monotonic, so each step only uncovers the far row or column
+	while (nx > 0 or ny > 0)
+	{
+		if (ny == 0 or (nx > 0 and nextX < nextY))
+		{
+			cx += sx;
+			nextX += stepX;
+			--nx;
+			for (int y = cy - 1; y <= cy + 1; ++y)
+				f(cx + sx, y);
+		}
+		else
+		{
+			cy += sy;
+			nextY += stepY;
+			--ny;
+			for (int x = cx - 1; x <= cx + 1; ++x)
+				f(x, cy + sy);
+		}
+	}
+}
+
+void WaypointPath::build(const std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d>> &points,
+												 double cellSize)
+{
+	count_ = std::max(0, (int)points.size() - 1);
+	if (legs_.size() < (size_t)count_)
+		legs_.resize(count_);
+
+	double s = 0;
+	for (int i = 0; i < count_; ++i)
+	{
+		leg_t &l = legs_[i];
+		l.start = points[i];
+		l.end = points[i + 1];
+		l.length = (l.end - l.start).norm();
+		l.dir = l.length > 0 ? Eigen::Vector3d((l.end - l.start) / l.length) : Eigen::Vector3d::Zero();
+		l.s0 = s;
+		s += l.length;
+	}
+
+	// Cells about one leg long keep both the cells per leg and the legs per cell small
+	cellSize_ = cellSize > 0 ? cellSize : std::max(1.0, count_ > 0 ? s / count_ : 1.0);
+
+	// Count the cells each leg touches to size the table
+	size_t entries = 0;
+	minCell_.setConstant(std::numeric_limits<int>::max());
+	maxCell_.setConstant(std::numeric_limits<int>::min());
+	for (int i = 0; i < count_; ++i)
+		forEachCell(legs_[i], [&](int cx, int cy) {
+			++entries;
+			minCell_ = minCell_.cwiseMin(Eigen::Vector2i(cx, cy));
+			maxCell_ = maxCell_.cwiseMax(Eigen::Vector2i(cx, cy));
+		});
+
+	unsigned int buckets = 1;
+	while (buckets < 2 * entries)
+		buckets <<= 1;
+	bucketMask_ = buckets - 1;
+	bucketStart_.assign(buckets + 1, 0);
+	bucketLegs_.resize(entries);
+
+	// Counting sort of the legs into their buckets
+	for (int i = 0; i < count_; ++i)
+		forEachCell(legs_[i], [&](int cx, int cy) { ++bucketStart_[bucket(cx, cy) + 1]; });
+	for (unsigned int b = 0; b < buckets; ++b)
+		bucketStart_[b + 1] += bucketStart_[b];
+	std::vector<int> fill(bucketStart_.begin(), bucketStart_.end() - 1);
+	for (int i = 0; i < count_; ++i)
+		forEachCell(legs_[i], [&](int cx, int cy) { bucketLegs_[fill[bucket(cx, cy)]++] = i; });
+}
+
+double WaypointPath::horizontalDistance(const Eigen::Vector3d &p, int i) const
+{
+	const leg_t &l = legs_[i];
+	Eigen::Vector2d d = l.end.head<2>() - l.start.head<2>();
+	Eigen::Vector2d r = p.head<2>() - l.start.head<2>();
+	double len2 = d.squaredNorm();
+	double t = len2 > 0 ? std::min(1.0, std::max(0.0, r.dot(d) / len2)) : 0;
+	return (r - t * d).norm();
+}
+
+int WaypointPath::nearestLeg(const Eigen::Vector3d &p, int firstLeg) const
+{
+	if (firstLeg >= count_)
+		return -1;
+
+	int best = -1;
+	double bestDist = std::numeric_limits<double>::infinity();
+	int cx = cell(p(0)), cy = cell(p(1));
+	auto visit = [&](int x, int y) {
+		unsigned int b = bucket(x, y);
+		for (int k = bucketStart_[b]; k < bucketStart_[b + 1]; ++k)
+		{
+			int i = bucketLegs_[k];
+			if (i < firstLeg)
+				continue;
+			double d = horizontalDistance(p, i);
+			if (d < bestDist or (d == bestDist and i < best))
+			{
+				bestDist = d;
+				best = i;
+			}
+		}
+	};
+
+	// Only rings that reach the grid's bounds have legs, and only where they cross them
+	int gapX = std::max(0, std::max(minCell_(0) - cx, cx - maxCell_(0)));
+	int gapY = std::max(0, std::max(minCell_(1) - cy, cy - maxCell_(1)));
+	int minRing = std::max(gapX, gapY);
+	int maxRing = std::max(std::max(std::abs(cx - minCell_(0)), std::abs(cx - maxCell_(0))),
+												 std::max(std::abs(cy - minCell_(1)), std::abs(cy - maxCell_(1))));
+
+	for (int ring = minRing; ring <= maxRing; ++ring)
+	{
+		// Legs are padded by a cell, so anything not seen yet is at least ring cells away
+		if (best >= 0 and bestDist <= ring * cellSize_)
+			break;
+
+		// Rows above and below, then the columns between them
+		int x0 = std::max(cx - ring, minCell_(0)), x1 = std::min(cx + ring, maxCell_(0));
+		int y0 = std::max(cy - ring + 1, minCell_(1)), y1 = std::min(cy + ring - 1, maxCell_(1));
+		for (int y : {cy - ring, cy + ring})
+		{
+			if (y >= minCell_(1) and y <= maxCell_(1))
+				for (int x = x0; x <= x1; ++x)
+					visit(x, y);
+			if (ring == 0)
+				break;
+		}
+		for (int x : {cx - ring, cx + ring})
+			if (ring > 0 and x >= minCell_(0) and x <= maxCell_(0))
+				for (int y = y0; y <= y1; ++y)
+					visit(x, y);
+	}
+	return best;
+}
+
+double WaypointPath::project(const Eigen::Vector3d &p, int i) const
+{
+	const leg_t &l = legs_[i];
+	return l.s0 + std::min(l.length, std::max(0.0, (p - l.start).dot(l.dir)));
+}
+
+Eigen::Vector3d WaypointPath::pointAt(double s, int &leg) const
+{
+	leg = std::min(std::max(leg, 0), count_ - 1);
+	s = std::min(std::max(s, 0.0), length());
+	while (leg < count_ - 1 and s > legs_[leg].s0 + legs_[leg].length)
+		++leg;
+	while (leg > 0 and s < legs_[leg].s0)
+		--leg;
+	const leg_t &l = legs_[leg];
+	return l.start + (s - l.s0) * l.dir;
+}
+} // namespace bsc_common
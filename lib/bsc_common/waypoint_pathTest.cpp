@@ -0,0 +1,146 @@
+#include "include/waypoint_path.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+using namespace bsc_common;
+typedef std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d>> points_t;
+
+static double segDist(const Eigen::Vector3d &p, const WaypointPath::leg_t &l)
+{
+	Eigen::Vector2d d = l.end.head<2>() - l.start.head<2>(), r = p.head<2>() - l.start.head<2>();
+	double t = d.squaredNorm() > 0 ? std::min(1.0, std::max(0.0, r.dot(d) / d.squaredNorm())) : 0;
+	return (r - t * d).norm();
+}
+
+int main()
+{
+	srand(7);
+	int failures = 0;
+
+	// Survey pattern: 2000 waypoints in a random walk
+	points_t pts(1, Eigen::Vector3d::Zero());
+	for (int i = 0; i < 2000; ++i)
+	{
+		double a = 2 * M_PI * rand() / RAND_MAX;
+		pts.push_back(pts.back() + Eigen::Vector3d(20 * cos(a), 20 * sin(a), 0.1 * (rand() % 21 - 10)));
+	}
+	WaypointPath path;
+	path.build(pts);
+
+	// Grid queries must match a brute force search
+	const int queries = 20000;
+	points_t q(queries);
+	for (int i = 0; i < queries; ++i)
+		q[i] = pts[rand() % pts.size()] + Eigen::Vector3d(rand() % 200 - 100, rand() % 200 - 100, 0);
+
+	std::vector<int> grid(queries), brute(queries);
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < queries; ++i)
+		grid[i] = path.nearestLeg(q[i], i % 100);
+	auto t1 = std::chrono::steady_clock::now();
+	for (int i = 0; i < queries; ++i)
+	{
+		double best = std::numeric_limits<double>::infinity();
+		for (int l = i % 100; l < path.size(); ++l)
+		{
+			double d = segDist(q[i], path.leg(l));
+			if (d < best)
+			{
+				best = d;
+				brute[i] = l;
+			}
+		}
+	}
+	auto t2 = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < queries; ++i)
+		if (std::abs(segDist(q[i], path.leg(grid[i])) - segDist(q[i], path.leg(brute[i]))) > 1e-9)
+			++failures;
+	printf("nearestLeg: %d mismatches, grid %.2f us, brute %.2f us per query\n", failures,
+				 std::chrono::duration<double, std::micro>(t1 - t0).count() / queries,
+				 std::chrono::duration<double, std::micro>(t2 - t1).count() / queries);
+
+	// Arc length walk
+	int leg = 0;
+	for (double s = 0; s < path.length(); s += 7.3)
+	{
+		Eigen::Vector3d p = path.pointAt(s, leg);
+		if (std::abs(path.project(p, leg) - s) > 1e-6)
+		{
+			printf("pointAt/project mismatch at s=%f\n", s);
+			++failures;
+		}
+	}
+	Eigen::Vector3d end = path.pointAt(path.length() + 10, leg);
+	if ((end - pts.back()).norm() > 1e-9 or leg != path.size() - 1)
+	{
+		printf("pointAt does not clamp to the end\n");
+		++failures;
+	}
+
+	// A tight survey followed by a long diagonal transit home
+	points_t transit(1, Eigen::Vector3d::Zero());
+	for (int i = 0; i < 2000; ++i)
+		transit.push_back(Eigen::Vector3d((i / 40) * 2.0, (i / 40) % 2 ? 80 - (i % 40) * 2.0 : (i % 40) * 2.0, 5));
+	transit.push_back(Eigen::Vector3d(-30000, -40000, 5));
+	WaypointPath diagonal;
+	auto t3 = std::chrono::steady_clock::now();
+	diagonal.build(transit);
+	auto t4 = std::chrono::steady_clock::now();
+	int diagonalMismatches = 0;
+	for (int i = 0; i < 2000; ++i)
+	{
+		double f = (double)rand() / RAND_MAX;
+		Eigen::Vector3d p = f * transit.back() + (1 - f) * transit[transit.size() - 2] +
+												Eigen::Vector3d(rand() % 400 - 200, rand() % 400 - 200, 0);
+		if (i % 2)
+			p = transit[rand() % transit.size()] + Eigen::Vector3d(rand() % 20 - 10, rand() % 20 - 10, 0);
+		double best = std::numeric_limits<double>::infinity();
+		for (int l = 0; l < diagonal.size(); ++l)
+			best = std::min(best, segDist(p, diagonal.leg(l)));
+		if (std::abs(segDist(p, diagonal.leg(diagonal.nearestLeg(p))) - best) > 1e-9)
+			++diagonalMismatches;
+	}
+	failures += diagonalMismatches;
+	printf("diagonal transit: %d mismatches, build %.2f ms\n", diagonalMismatches,
+				 std::chrono::duration<double, std::milli>(t4 - t3).count());
+
+	// Queries far off a path of short legs skip the empty rings
+	points_t fine(1, Eigen::Vector3d::Zero());
+	for (int i = 0; i < 1000; ++i)
+		fine.push_back(fine.back() + Eigen::Vector3d(i / 40 % 2 ? -1 : 1, i % 40 ? 0 : 1, 0));
+	WaypointPath walk;
+	walk.build(fine);
+	int farMismatches = 0;
+	double farMs = 0;
+	for (int i = 0; i < 100; ++i)
+	{
+		double a = 2 * M_PI * i / 100, r = i % 2 ? 1000 : 3000;
+		Eigen::Vector3d p(r * cos(a), r * sin(a), 0);
+		double best = std::numeric_limits<double>::infinity();
+		for (int l = 0; l < walk.size(); ++l)
+			best = std::min(best, segDist(p, walk.leg(l)));
+		auto t5 = std::chrono::steady_clock::now();
+		int nearest = walk.nearestLeg(p);
+		farMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t5).count() / 100;
+		if (std::abs(segDist(p, walk.leg(nearest)) - best) > 1e-9)
+			++farMismatches;
+	}
+	failures += farMismatches + (farMs > 5);
+	printf("far queries: %d mismatches, %.3f ms per query\n", farMismatches, farMs);
+
+	// Degenerate paths
+	WaypointPath single;
+	single.build(points_t(1, Eigen::Vector3d::Zero()));
+	if (single.nearestLeg(Eigen::Vector3d::Zero()) != -1)
+		++failures;
+	single.build(points_t(2, Eigen::Vector3d::Ones()));
+	if (single.nearestLeg(Eigen::Vector3d(50, 50, 0)) != 0)
+		++failures;
+
+	printf(failures ? "FAILED (%d)\n" : "PASSED\n", failures);
+	return failures != 0;
+}
@@ -36,58 +36,12 @@ float clip(float x, float low, float high) {
 
 void Behaviors::takeoffBehavior()
 {
-	if (!propellorsRunning)
-	{
-		std_srvs::Trigger srv;
-		takeoffSrv_.call(srv);
-		if (srv.response.success)
-		{
-			ROS_INFO("Propellors running, switching to follow");
-			propellorsRunning = true;
-			currentMode_ = JETYAK_UAV_UTILS::FOLLOW;
-			behaviorChanged_ = true;
-		}
-		else
-		{
-			ROS_WARN("Failure to Start props");
-		}
-	}
+	currentMode_ = (JETYAK_UAV_UTILS::Mode)landing_->takeoff(behaviorChanged_);
 }
 
 void Behaviors::followBehavior()
 {
-	if (ros::Time::now().toSec() - lastSpotted <= follow_.tagLossThresh) // TODO: Add tag loss threshold for follow_
-	{
-		// Get the setpoint in the drone FLU
-		Eigen::Vector4d goal_b;
-		goal_b << follow_.goal_pose.x, follow_.goal_pose.y, follow_.goal_pose.z, follow_.goal_pose.w; // Goal in boat FLU
-		Eigen::Vector4d goal_d = boat_to_drone(goal_b);																								// Goal in drone FLU
-
-		// Get boat velocity in drone frame
-		Eigen::Vector2d vBoat(state.boat_pdot.x, state.boat_pdot.y);				// Boat velocity in world frame
-		vBoat = bsc_common::util::rotation_matrix(state.drone_q.z) * vBoat; // Boat velocity in drone frame
-
-		Eigen::Matrix<double, 12, 1> set;
-		set << goal_d(0), goal_d(1), goal_d(2), // Position setpoint (xyz)
-				vBoat(0, 0), vBoat(1, 0), 0,				// Velocity setpoint (xyz)
-				0, 0, goal_d(3),										// Angle setpoint (rpy)
-				0, 0, 0;														// Angular velocity setpoint (rpy)
-		Eigen::Vector4d cmdM = lqr_->getCommand(set);
-
-		sensor_msgs::Joy cmd;
-		cmd.axes.push_back(cmdM(0));
-		cmd.axes.push_back(cmdM(1));
-		cmd.axes.push_back(cmdM(2));
-		cmd.axes.push_back(cmdM(3));
-		cmd.axes.push_back(JETYAK_UAV_UTILS::LQR);
-		cmdPub_.publish(cmd);
-	}
-	else
-	{
-		ROS_WARN("Follow lost tag for more than 5 seconds, hovering");
-		currentMode_ = JETYAK_UAV_UTILS::HOVER;
-		behaviorChanged_ = true;
-	}
+	currentMode_ = (JETYAK_UAV_UTILS::Mode)landing_->follow(ros::Time::now().toSec(), behaviorChanged_);
 }
 
 void Behaviors::leaveBehavior()
@@ -101,24 +55,23 @@ void Behaviors::returnBehavior()
 {
 	Eigen::Vector4d goal_boatFLU;
 	goal_boatFLU << return_.goal.x, return_.goal.y, return_.goal.z, return_.goal.w;
-	Eigen::Vector4d offset = boat_to_drone(goal_boatFLU); // Vector pointing from the UAV to the follow setpoint
+	Eigen::Vector4d offset = landing_->boatToDrone(goal_boatFLU); // Vector pointing from the UAV to the follow setpoint
 
-	if (ros::Time::now().toSec() - lastSpotted <= return_.tagTime and state.drone_p.z <= return_.finalHeight + return_.heightThresh)
+	if (ros::Time::now().toSec() - landing_->lastSpotted() <= return_.tagTime and state.drone_p.z <= return_.finalHeight + return_.heightThresh)
 	{
+		if (return_.stage != return_.SETTLE)
+			ASYNC_WARN("Settling: %1.2fm over", -offset(2));
 		return_.stage = return_.SETTLE;
 		if ((pow(offset(0), 2) + pow(offset(1), 2)) < return_.settleRadiusSquared)
 		{
-			ROS_WARN("Settled, now following");
+			ASYNC_WARN("Settled, now following");
 			currentMode_ = JETYAK_UAV_UTILS::FOLLOW;
 			behaviorChanged_ = true;
 		}
 		else
 		{
-			ROS_WARN("Settling: %1.2fm over", -offset(2));
-
 			// Get boat velocity in drone frame
-			Eigen::Vector2d vBoat(state.boat_pdot.x, state.boat_pdot.y);				 // Boat velocity in world frame
-			vBoat = bsc_common::util::rotation_matrix(-state.drone_q.z) * vBoat; // Boat velocity in drone frame
+			const Eigen::Vector2d &vBoat = landing_->derived().boatVelDrone;
 
 			Eigen::Matrix<double, 12, 1> set;
 			set << offset(0), offset(1), offset(2), // Position setpoint (xyz)
@@ -126,7 +79,8 @@ void Behaviors::returnBehavior()
 					0, 0, offset(3),										// Angle setpoint (rpy)
 					0, 0, 0;														// Angular velocity setpoint (rpy)
 
-			Eigen::Vector4d cmdM = lqr_->getCommand(set);
+			Eigen::Vector4d cmdM = landing_->generalLqr().getCommand(set);
+			recordControl(landing_->generalLqr());
 			sensor_msgs::Joy cmd;
 			cmd.axes.push_back(cmdM(0));
 			cmd.axes.push_back(cmdM(1));
@@ -136,35 +90,30 @@ void Behaviors::returnBehavior()
 			cmdPub_.publish(cmd);
 		}
 	}
-	else if (return_.stage == return_.SETTLE and ros::Time::now().toSec() - lastSpotted > return_.tagLossThresh)
+	else if (return_.stage == return_.SETTLE and ros::Time::now().toSec() - landing_->lastSpotted() > return_.tagLossThresh)
 	{	
-		ROS_WARN("Tag lost for %1.2f seconds, going back up", ros::Time::now().toSec() - state.header.stamp.toSec());
+		ASYNC_WARN("Tag lost for %1.2f seconds, going back up", ros::Time::now().toSec() - state.header.stamp.toSec());
 		return_.stage = return_.UP;
 	}
 
 	else if (behaviorChanged_)
 	{
-		ROS_WARN("Behavior is now return");
+		ASYNC_WARN("Behavior is now return");
 		behaviorChanged_ = false;
 		return_.stage = return_.UP;
-		ROS_WARN("Going Up");
+		ASYNC_WARN("Going Up to %1.2f from %1.2f", return_.gotoHeight, state.drone_p.z);
 	}
 
 	else if (return_.stage == return_.UP)
 	{
 		if (state.drone_p.z >= return_.gotoHeight - return_.heightThresh)
 		{
-			ROS_WARN("Changed OVER");
+			ASYNC_WARN("Changed OVER");
 			return_.stage = return_.OVER;
 		}
 		else
 		{
 			double u_c = return_.gotoHeight - state.drone_p.z;
-			ROS_WARN("Goal: %1.2f, Current %1.2f", return_.gotoHeight, state.drone_p.z);
-
-			// Get boat velocity in drone frame
-			Eigen::Vector2d vBoat(state.boat_pdot.x, state.boat_pdot.y);				 // Boat velocity in world frame
-			vBoat = bsc_common::util::rotation_matrix(-state.drone_q.z) * vBoat; // Boat velocity in drone frame
 
 			Eigen::Matrix<double, 12, 1> set;
 			set << 0, 0, u_c,		 // Position setpoint (xyz)
@@ -172,7 +121,8 @@ void Behaviors::returnBehavior()
 					0, 0, offset(3), // Angle setpoint (rpy)
 					0, 0, 0;				 // Angular velocity setpoint (rpy)
 
-			Eigen::Vector4d cmdM = lqr_->getCommand(set);
+			Eigen::Vector4d cmdM = landing_->generalLqr().getCommand(set);
+			recordControl(landing_->generalLqr());
 			sensor_msgs::Joy cmd;
 			cmd.axes.push_back(clip(cmdM(0),-.1,.1));
 			cmd.axes.push_back(clip(cmdM(1),-.1,.1));
@@ -186,24 +136,32 @@ void Behaviors::returnBehavior()
 	{
 		if ((pow(offset(0), 2) + pow(offset(1), 2)) < return_.downRadius)
 		{
-			ROS_WARN("Changed DOWN");
+			ASYNC_WARN("Changed DOWN");
 			return_.stage = return_.DOWN;
 		}
 		else
 		{
 			double u_c = return_.gotoHeight - state.drone_p.z;
 
+			// Aim at where the settle point will be once the drone can reach it
+			Eigen::Vector2d aim = offset.head<2>();
+			Eigen::Vector2d drone(state.drone_p.x, state.drone_p.y), goal(return_.goal.x, return_.goal.y), point;
+			double dt;
+			if (boatPredictor_.ready() and
+					boatPredictor_.intercept(drone, goal, return_.maxVel, return_.predictHorizon, point, dt))
+				aim = landing_->derived().worldToDrone * (point - drone);
+
 			// Get boat velocity in drone frame
-			Eigen::Vector2d vBoat(state.boat_pdot.x, state.boat_pdot.y);				 // Boat velocity in world frame
-			vBoat = bsc_common::util::rotation_matrix(-state.drone_q.z) * vBoat; // Boat velocity in drone frame
+			const Eigen::Vector2d &vBoat = landing_->derived().boatVelDrone;
 
 			Eigen::Matrix<double, 12, 1> set;
-			set << offset(0), offset(1), u_c, // Position setpoint (xyz)
+			set << aim(0), aim(1), u_c,				// Position setpoint (xyz)
 					vBoat(0), vBoat(1), 0,				// Velocity setpoint (xyz)
 					0, 0, offset(3),							// Angle setpoint (rpy)
 					0, 0, 0;											// Angular velocity setpoint (rpy)
 
-			Eigen::Vector4d cmdM = lqr_->getCommand(set);
+			Eigen::Vector4d cmdM = landing_->generalLqr().getCommand(set);
+			recordControl(landing_->generalLqr());
 			sensor_msgs::Joy cmd;
 			cmd.axes.push_back(cmdM(0));
 			cmd.axes.push_back(cmdM(1));
@@ -218,8 +176,7 @@ void Behaviors::returnBehavior()
 		double u_c = return_.finalHeight - state.drone_p.z;
 
 		// Get boat velocity in drone frame
-		Eigen::Vector2d vBoat(state.boat_pdot.x, state.boat_pdot.y);				 // Boat velocity in world frame
-		vBoat = bsc_common::util::rotation_matrix(-state.drone_q.z) * vBoat; // Boat velocity in drone frame
+		const Eigen::Vector2d &vBoat = landing_->derived().boatVelDrone;
 
 		Eigen::Matrix<double, 12, 1> set;
 		set << offset(0), offset(1), u_c, // Position setpoint (xyz)
@@ -227,7 +184,8 @@ void Behaviors::returnBehavior()
 				0, 0, offset(3),							// Angle setpoint (rpy)
 				0, 0, 0;											// Angular velocity setpoint (rpy)
 
-		Eigen::Vector4d cmdM = lqr_->getCommand(set);
+		Eigen::Vector4d cmdM = landing_->generalLqr().getCommand(set);
+		recordControl(landing_->generalLqr());
 		sensor_msgs::Joy cmd;
 			cmd.axes.push_back(clip(cmdM(0),-.1,.1));
 			cmd.axes.push_back(clip(cmdM(1),-.1,.1));
@@ -238,95 +196,256 @@ void Behaviors::returnBehavior()
 	}
 	else
 	{
-		ROS_ERROR("BAD CONDITIONALS, DEFAULTING TO HOVER");
+		ASYNC_ERROR("BAD CONDITIONALS, DEFAULTING TO HOVER");
 		currentMode_ = JETYAK_UAV_UTILS::HOVER;
 	}
 };
 
 void Behaviors::landBehavior()
 {
+	currentMode_ = (JETYAK_UAV_UTILS::Mode)landing_->land(ros::Time::now().toSec(), behaviorChanged_);
+}
+
+void Behaviors::rideBehavior()
+{
+	currentMode_ = (JETYAK_UAV_UTILS::Mode)landing_->ride();
+}
+
+void Behaviors::hoverBehavior()
+{
+	landing_->hover();
+}
+
+void Behaviors::waypointBehavior()
+{
+	Eigen::Vector3d pos(state.drone_p.x, state.drone_p.y, state.drone_p.z);
+
+	adoptTrajectory();
+	bool trajectory = waypoint_.planned and not waypoint_.streaming;
+
 	if (behaviorChanged_)
 	{
 		behaviorChanged_ = false;
-	}
-	else
-	{ // DO the loop
-		// Get the setpoint in the drone FLU
-		Eigen::Vector4d goal_b;
-		goal_b << land_.goal_pose.x, land_.goal_pose.y, land_.goal_pose.z, land_.goal_pose.w; // Goal in boat FLU
-		Eigen::Vector4d goal_d = boat_to_drone(goal_b);																				// Goal in drone FLU
-
-		Eigen::Vector2d vBoat(state.boat_pdot.x, state.boat_pdot.y);				 // Boat velocity in world frame
-		vBoat = bsc_common::util::rotation_matrix(-state.drone_q.z) * vBoat; // Boat velocity in drone frame
 
-		if (ros::Time::now().toSec() - lastSpotted <= land_.tagLossThresh)
+		// A trajectory from before the drone moved is replanned, the legs are flown meanwhile
+		bool stale = trajectory and
+								 (waypoint_.trajTime > 0 or (waypoint_.trajectory.knot(0) - pos).norm() > waypoint_.lookahead);
+		if (trajectory and not stale)
+			ASYNC_WARN("Waypoints: flying a %1.1fs trajectory from waypoint %i", waypoint_.trajectory.duration(),
+								 waypoint_.leg + 1);
+		else
 		{
-
-			if (inLandThreshold())
+			// Resume on the closest remaining leg rather than flying back to a passed waypoint
+			int nearest = waypoint_.path.nearestLeg(pos, waypoint_.leg);
+			if (nearest > waypoint_.leg)
 			{
-				ROS_WARN("CALLING LAND SERVICE");
-				ROS_WARN("Drone offset: %1.2f,%1.2f,%1.2f",goal_d(0), goal_d(1), goal_d(2));
-				std_srvs::Trigger srv;
-				landSrv_.call(srv);
-				if (srv.response.success)
-				{
-					currentMode_ = JETYAK_UAV_UTILS::RIDE;
-				}
+				waypoint_.leg = nearest;
+				waypoint_.enteredTime = -1;
 			}
-			else
+			ASYNC_WARN("Waypoints: resuming on leg %i of %i", waypoint_.leg, waypoint_.path.size());
+			if (stale)
 			{
-				double vMult = clip(1-fabs(goal_d(0))/fabs(follow_.goal_pose.x-land_.goal_pose.x),0,1);
-				Eigen::Matrix<double, 12, 1> set;
-				set << goal_d(0), goal_d(1), goal_d(2), // Position setpoint (xyz)
-						vBoat(0) * vMult, 0, 0,				// Velocity setpoint (xyz)
-						0, 0, goal_d(3),										// Angle setpoint (rpy)
-						0, 0, 0;														// Angular velocity setpoint (rpy)
-
-				Eigen::Vector4d cmdM = land_.lqr->getCommand(set);
-				sensor_msgs::Joy cmd;
-				cmd.axes.push_back(cmdM(0));
-				cmd.axes.push_back(cmdM(1));
-				cmd.axes.push_back(cmdM(2));
-				cmd.axes.push_back(cmdM(3));
-				cmd.axes.push_back(JETYAK_UAV_UTILS::LQR);
-				cmdPub_.publish(cmd);
+				trajectory = false;
+				planTrajectory(waypoint_.leg + 1);
 			}
 		}
-		else //landing lost the tag for too long, dangerous
+	}
+
+	if (trajectory)
+	{
+		followTrajectory();
+		return;
+	}
+
+	if (waypoint_.leg >= waypoint_.path.size())
+	{
+		ASYNC_WARN("Waypoints complete, hovering");
+		currentMode_ = JETYAK_UAV_UTILS::HOVER;
+		behaviorChanged_ = true;
+		hoverBehavior();
+		return;
+	}
+
+	const bsc_common::WaypointPath::leg_t &leg = waypoint_.path.leg(waypoint_.leg);
+	int target = waypoint_.leg + 1;
+
+	// Loiter inside the radius of the target, then move on to the next leg
+	if ((leg.end - pos).norm() <= waypoint_.radius[target])
+	{
+		double now = ros::Time::now().toSec();
+		if (waypoint_.enteredTime < 0)
+			waypoint_.enteredTime = now;
+		else if (now - waypoint_.enteredTime >= waypoint_.loiterTime[target])
 		{
-			currentMode_ = JETYAK_UAV_UTILS::FOLLOW;
-			behaviorChanged_ = true;
-			followBehavior();
+			ASYNC_WARN("Reached waypoint %i", target);
+			if (waypoint_.streaming)
+				pullCoverageLeg();
+			else
+				++waypoint_.leg;
+			waypoint_.enteredTime = -1;
+			return;
 		}
 	}
+	else
+		waypoint_.enteredTime = -1;
+
+	// Carrot is the lookahead point on this leg, or the waypoint itself while loitering
+	Eigen::Vector3d carrot;
+	Eigen::Vector2d vel(0, 0);
+	if (waypoint_.enteredTime < 0)
+	{
+		double s = std::min(waypoint_.path.project(pos, waypoint_.leg) + waypoint_.lookahead, leg.s0 + leg.length);
+		waypoint_.lookaheadLeg = waypoint_.leg;
+		carrot = waypoint_.path.pointAt(s, waypoint_.lookaheadLeg);
+		vel = waypoint_.speed * leg.dir.head<2>();
+	}
+	else
+		carrot = leg.end;
+
+	Eigen::Vector2d offset = landing_->derived().worldToDrone * (carrot - pos).head<2>();
+	vel = landing_->derived().worldToDrone * vel;
+	double wDiff = bsc_common::angles::wrap(waypoint_.heading[target] - state.drone_q.z);
+
+	Eigen::Matrix<double, 12, 1> set;
+	set << offset(0), offset(1), carrot(2) - pos(2), // Position setpoint (xyz)
+			vel(0), vel(1), 0,													 // Velocity setpoint (xyz)
+			0, 0, wDiff,																 // Angle setpoint (rpy)
+			0, 0, 0;																		 // Angular velocity setpoint (rpy)
+	Eigen::Vector4d cmdM = landing_->generalLqr().getCommand(set);
+	recordControl(landing_->generalLqr());
+
+	// Limit the horizontal command without changing its direction
+	double mag = cmdM.head<2>().norm();
+	if (mag > waypoint_.maxCmd)
+		cmdM.head<2>() *= waypoint_.maxCmd / mag;
+
+	waypoint_.cmd.axes[0] = cmdM(0);
+	waypoint_.cmd.axes[1] = cmdM(1);
+	waypoint_.cmd.axes[2] = cmdM(2);
+	waypoint_.cmd.axes[3] = cmdM(3);
+	cmdPub_.publish(waypoint_.cmd);
 }
 
-void Behaviors::rideBehavior()
+bool Behaviors::planTrajectory(int from)
+{
+	// Drop the current trajectory and any solve still running for an older request
+	waypoint_.planned = waypoint_.planning = false;
+	int last = (int)waypoint_.points.size() - 1;
+	if (from > last)
+		return false;
+
+	bsc_common::TrajectoryPlanner::request_t req;
+	req.points.reserve(last - from + 2);
+	req.points.push_back(Eigen::Vector3d(state.drone_p.x, state.drone_p.y, state.drone_p.z));
+	req.points.insert(req.points.end(), waypoint_.points.begin() + from, waypoint_.points.end());
+
+	// Index 0 of the per waypoint values becomes the drone's position
+	req.radius.assign(waypoint_.radius.begin() + from - 1, waypoint_.radius.end());
+	req.hold.assign(waypoint_.loiterTime.begin() + from - 1, waypoint_.loiterTime.end());
+	req.radius[0] = req.hold[0] = 0;
+
+	req.maxVel = waypoint_.maxVel;
+	req.maxAcc = waypoint_.maxAcc;
+	req.startVel = Eigen::Vector3d(state.drone_pdot.x, state.drone_pdot.y, state.drone_pdot.z);
+	req.tag = ++waypoint_.planTag;
+	waypoint_.planFrom = from;
+	waypoint_.planning = true;
+	waypoint_.planner.request(req);
+	return true;
+}
+
+void Behaviors::adoptTrajectory()
 {
-	if (propellorsRunning)
+	int tag;
+	bool ok;
+	if (not waypoint_.planning or not waypoint_.planner.poll(waypoint_.trajectory, tag, ok) or
+			tag != waypoint_.planTag)
+		return;
+	waypoint_.planning = false;
+
+	if (not ok)
 	{
-		std_srvs::Trigger srv;
-		landSrv_.call(srv);
-		propellorsRunning = srv.response.success;
-		if (srv.response.success)
-		{
-			ROS_WARN("Arms deactivated");
-		}
-		else
-		{
-			ROS_WARN("Failed to deactivate arms");
-		}
+		ASYNC_WARN("Waypoints: no trajectory from waypoint %i, following legs", waypoint_.planFrom);
+		return;
+	}
+
+	// The legs flown during the solve may have passed its first waypoint
+	if (waypoint_.leg + 1 > waypoint_.planFrom)
+	{
+		planTrajectory(waypoint_.leg + 1);
+		return;
 	}
+
+	waypoint_.planned = true;
+	waypoint_.trajOffset = waypoint_.planFrom - 1;
+	waypoint_.trajTime = 0;
+	waypoint_.lastTick = -1;
+	ASYNC_WARN("Waypoints: flying a %1.1fs trajectory from waypoint %i", waypoint_.trajectory.duration(),
+						 waypoint_.planFrom);
 }
 
-void Behaviors::hoverBehavior()
+void Behaviors::followTrajectory()
+{
+	Eigen::Vector3d pos(state.drone_p.x, state.drone_p.y, state.drone_p.z);
+	double now = ros::Time::now().toSec();
+	bsc_common::MinSnapTrajectory::sample_t &ref = waypoint_.ref;
+
+	// Hold the reference while the drone is more than the lookahead behind it
+	if (waypoint_.lastTick >= 0 and (ref.p - pos).norm() <= waypoint_.lookahead)
+		waypoint_.trajTime += now - waypoint_.lastTick;
+	waypoint_.lastTick = now;
+	waypoint_.trajectory.sample(waypoint_.trajTime, ref);
+
+	int last = (int)waypoint_.points.size() - 1;
+	int target = std::min(ref.knot + waypoint_.trajOffset, last);
+	if (target > waypoint_.leg + 1)
+	{
+		ASYNC_WARN("Passed waypoint %i", target - 1);
+		waypoint_.leg = target - 1;
+	}
+
+	if (waypoint_.trajTime >= waypoint_.trajectory.duration() and
+			(waypoint_.points[last] - pos).norm() <= waypoint_.radius[last])
+	{
+		ASYNC_WARN("Waypoints complete, hovering");
+		waypoint_.leg = last;
+		currentMode_ = JETYAK_UAV_UTILS::HOVER;
+		behaviorChanged_ = true;
+		hoverBehavior();
+		return;
+	}
+
+	Eigen::Vector2d offset = landing_->derived().worldToDrone * (ref.p - pos).head<2>();
+	Eigen::Vector2d vel = landing_->derived().worldToDrone * ref.v.head<2>();
+	double wDiff = bsc_common::angles::wrap(waypoint_.heading[target] - state.drone_q.z);
+
+	Eigen::Matrix<double, 12, 1> set;
+	set << offset(0), offset(1), ref.p(2) - pos(2), // Position setpoint (xyz)
+			vel(0), vel(1), ref.v(2),										// Velocity setpoint (xyz)
+			0, 0, wDiff,																// Angle setpoint (rpy)
+			0, 0, 0;																		// Angular velocity setpoint (rpy)
+	Eigen::Vector4d cmdM = landing_->generalLqr().getCommand(set);
+	recordControl(landing_->generalLqr());
+
+	double mag = cmdM.head<2>().norm();
+	if (mag > waypoint_.maxCmd)
+		cmdM.head<2>() *= waypoint_.maxCmd / mag;
+
+	waypoint_.cmd.axes[0] = cmdM(0);
+	waypoint_.cmd.axes[1] = cmdM(1);
+	waypoint_.cmd.axes[2] = cmdM(2);
+	waypoint_.cmd.axes[3] = cmdM(3);
+	cmdPub_.publish(waypoint_.cmd);
+}
+
+void Behaviors::pullCoverageLeg()
 {
-	// Hover is space
-	sensor_msgs::Joy cmd;
-	cmd.axes.push_back(0);
-	cmd.axes.push_back(0);
-	cmd.axes.push_back(0);
-	cmd.axes.push_back(0);
-	cmd.axes.push_back(JETYAK_UAV_UTILS::WORLD_RATE);
-	cmdPub_.publish(cmd);
+	// Drop every point up to the reached target, which is past the first leg after a resume
+	int reached = std::min(waypoint_.leg + 1, (int)waypoint_.window.size() - 1);
+	waypoint_.window.erase(waypoint_.window.begin(), waypoint_.window.begin() + reached);
+	Eigen::Vector2d p;
+	for (int i = 0; i < reached and waypoint_.coverage.next(p); ++i)
+		waypoint_.window.push_back(Eigen::Vector3d(p(0), p(1), waypoint_.surveyZ));
+	waypoint_.path.build(waypoint_.window);
+	waypoint_.leg = 0;
 }
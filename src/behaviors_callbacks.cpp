@@ -41,26 +41,27 @@ void Behaviors::stateCallback(const jetyak_uav_utils::ObservedState::ConstPtr &m
 	this->state.heading = msg->heading;
 	this->state.origin = msg->origin;
 
-	Eigen::Vector2d vel(state.drone_pdot.x,state.drone_pdot.y);
-	vel = bsc_common::util::rotation_matrix(-state.drone_q.z) * vel;
-	Eigen::Matrix<double,12,1> lqrState;
+	boatPredictor_.update(msg->header.stamp.toSec(), Eigen::Vector2d(msg->boat_p.x, msg->boat_p.y),
+												Eigen::Vector2d(msg->boat_pdot.x, msg->boat_pdot.y), msg->heading);
 
-	lqrState << 0,0,0,
-		vel(0),vel(1),state.drone_pdot.z,
-		state.drone_q.x,state.drone_q.y,0,
-		state.drone_qdot.x,state.drone_qdot.y,state.drone_qdot.z;
-
-	lqr_->updateState(lqrState);
-	land_.lqr->updateState(lqrState);
+	bsc_common::LandingBehaviors::state_t s;
+	s.droneP << msg->drone_p.x, msg->drone_p.y, msg->drone_p.z;
+	s.droneV << msg->drone_pdot.x, msg->drone_pdot.y, msg->drone_pdot.z;
+	s.droneRpy << msg->drone_q.x, msg->drone_q.y, msg->drone_q.z;
+	s.droneRates << msg->drone_qdot.x, msg->drone_qdot.y, msg->drone_qdot.z;
+	s.boatP << msg->boat_p.x, msg->boat_p.y, msg->boat_p.z;
+	s.boatV << msg->boat_pdot.x, msg->boat_pdot.y, msg->boat_pdot.z;
+	s.heading = msg->heading;
+	landing_->updateState(msg->header.stamp.toSec(), s);
 }
 
 void Behaviors::tagCallback(const geometry_msgs::PoseStamped::ConstPtr &msg)
 {
-	if (msg->header.stamp.toSec() - lastSpotted > resetFilterTimeThresh)
+	if (msg->header.stamp.toSec() - landing_->lastSpotted() > resetFilterTimeThresh)
 	{
-		ROS_WARN("Tag lost for %1.2fs", msg->header.stamp.toSec() - lastSpotted);
+		ASYNC_WARN("Tag lost for %1.2fs", msg->header.stamp.toSec() - landing_->lastSpotted());
 	}
-	lastSpotted = msg->header.stamp.toSec();
+	landing_->tagSeen(msg->header.stamp.toSec());
 }
 
 void Behaviors::extCmdCallback(const sensor_msgs::Joy::ConstPtr &msg)
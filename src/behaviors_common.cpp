@@ -42,7 +42,7 @@ void Behaviors::downloadParams(std::string ns_param)
 	 */
 	auto getP = [](std::string ns, std::string name, double &param) {
 		if (!ros::param::get(ns + name, param))
-			ROS_WARN("FAILED: %s", name.c_str());
+			ASYNC_WARN("FAILED: %s", name.c_str());
 	};
 
 	std::string ns = ns_param;
@@ -51,34 +51,49 @@ void Behaviors::downloadParams(std::string ns_param)
 	 * MISC PARAMETERS *
 	 ******************/
 	if (!ros::param::get(ns + "integral_size", integral_size))
-		ROS_WARN("FAILED: %s", "integral_size");
+		ASYNC_WARN("FAILED: %s", "integral_size");
 
 	if (!ros::param::get(ns + "generalK", generalK))
-		ROS_WARN("FAILED: %s", "generalK");
+		ASYNC_WARN("FAILED: %s", "generalK");
 	if (!ros::param::get(ns + "landK", landK))
-		ROS_WARN("FAILED: %s", "landK");
+		ASYNC_WARN("FAILED: %s", "landK");
 
 	getP(ns, "reset_kalman_threshold", resetFilterTimeThresh);
 
+	// Optional, the recorder stays closed without a path
+	ros::param::get(ns + "recorder_path", log_.path);
+	ros::param::get(ns + "recorder_maxRecords", log_.maxRecords);
+
 	/**********************
 	 * LANDING PARAMETERS *
 	 *********************/
-	getP(ns, "land_x", land_.goal_pose.x);
-	getP(ns, "land_y", land_.goal_pose.y);
-	getP(ns, "land_z", land_.goal_pose.z);
-	getP(ns, "land_w", land_.goal_pose.w);
-
-	double velMag;
-	getP(ns, "land_velMag", velMag);
-	land_.velThreshSqr = velMag * velMag;
-	getP(ns, "land_xTopThresh", land_.xTopThresh);
-	getP(ns, "land_yTopThresh", land_.yTopThresh);
-	getP(ns, "land_xBottomThresh", land_.xBottomThresh);
-	getP(ns, "land_yBottomThresh", land_.yBottomThresh);
-	getP(ns, "land_bottom",land_.bottom);
-	getP(ns, "land_top", land_.top);
-	getP(ns, "land_angleThresh", land_.angleThresh);
-	getP(ns, "land_tagLossThresh", land_.tagLossThresh);
+	bsc_common::LandingBehaviors::params_t &lp = landingParams_;
+	getP(ns, "land_x", lp.landGoal(0));
+	getP(ns, "land_y", lp.landGoal(1));
+	getP(ns, "land_z", lp.landGoal(2));
+	getP(ns, "land_w", lp.landGoal(3));
+	getP(ns, "land_velMag", lp.landVelMag);
+	getP(ns, "land_xTopThresh", lp.landXTopThresh);
+	getP(ns, "land_yTopThresh", lp.landYTopThresh);
+	getP(ns, "land_xBottomThresh", lp.landXBottomThresh);
+	getP(ns, "land_yBottomThresh", lp.landYBottomThresh);
+	getP(ns, "land_bottom", lp.landBottom);
+	getP(ns, "land_top", lp.landTop);
+	getP(ns, "land_angleThresh", lp.landAngleThresh);
+	getP(ns, "land_tagLossThresh", lp.landTagLossThresh);
+	getP(ns, "land_quietSpeed", lp.landQuietSpeed);
+	getP(ns, "land_quietTime", lp.landQuietTime);
+	getP(ns, "land_quietWait", lp.landQuietWait);
+	getP(ns, "land_predictHorizon", lp.landPredictHorizon);
+	getP(ns, "land_sigmaPos", lp.landSigmaPos);
+	getP(ns, "land_sigmaVel", lp.landSigmaVel);
+	getP(ns, "land_minConfidence", lp.landMinConfidence);
+	getP(ns, "land_paceSlack", lp.landPaceSlack);
+	getP(ns, "land_attFreq", lp.landPlant.attFreq);
+	getP(ns, "land_attDamp", lp.landPlant.attDamp);
+	getP(ns, "land_zTau", lp.landPlant.zTau);
+	getP(ns, "land_yawTau", lp.landPlant.yawTau);
+	getP(ns, "land_diagnosticsRate", land_.diagnosticsRate);
 
 	/**********************
 	 * TAKEOFF PARAMETERS *
@@ -89,11 +104,11 @@ void Behaviors::downloadParams(std::string ns_param)
 	/*********************
 	 * FOLLOW PARAMETERS *
 	 ********************/
-	getP(ns, "follow_x", follow_.goal_pose.x);
-	getP(ns, "follow_y", follow_.goal_pose.y);
-	getP(ns, "follow_z", follow_.goal_pose.z);
-	getP(ns, "follow_w", follow_.goal_pose.w);
-	getP(ns, "follow_tagLossThresh", follow_.tagLossThresh);
+	getP(ns, "follow_x", lp.followGoal(0));
+	getP(ns, "follow_y", lp.followGoal(1));
+	getP(ns, "follow_z", lp.followGoal(2));
+	getP(ns, "follow_w", lp.followGoal(3));
+	getP(ns, "follow_tagLossThresh", lp.followTagLossThresh);
 
 	/*********************
 	 * RETURN PARAMETERS *
@@ -112,6 +127,20 @@ void Behaviors::downloadParams(std::string ns_param)
 	getP(ns, "return_settle_y", return_.goal.y);
 	getP(ns, "return_settle_z", return_.goal.z);
 	getP(ns, "return_settle_w", return_.goal.w);
+	getP(ns, "return_maxVel", return_.maxVel);
+	getP(ns, "return_predictHorizon", return_.predictHorizon);
+	double predictWindow = 50;
+	getP(ns, "return_predictWindow", predictWindow);
+	boatPredictor_.setWindow((int)predictWindow);
+
+	/***********************
+	 * WAYPOINT PARAMETERS *
+	 **********************/
+	getP(ns, "waypoint_lookahead", waypoint_.lookahead);
+	getP(ns, "waypoint_speed", waypoint_.speed);
+	getP(ns, "waypoint_maxCmd", waypoint_.maxCmd);
+	getP(ns, "waypoint_maxVel", waypoint_.maxVel);
+	getP(ns, "waypoint_maxAcc", waypoint_.maxAcc);
 }
 
 void Behaviors::assignPublishers()
@@ -119,6 +148,7 @@ void Behaviors::assignPublishers()
 	cmdPub_ = nh.advertise<sensor_msgs::Joy>("behavior_cmd", 1);
 	modePub_ = nh.advertise<std_msgs::UInt8>("behavior_mode", 1);
 	gimbalCmdPub_ = nh.advertise<geometry_msgs::Vector3>("/jetyak_uav_vision/gimbal_cmd", 1);
+	landDiagnosticsPub_ = nh.advertise<jetyak_uav_utils::LandingDiagnostics>("land_diagnostics", 1);
 }
 
 void Behaviors::assignServiceClients()
@@ -137,6 +167,8 @@ void Behaviors::assignServiceServers()
 	getModeService_ = nh.advertiseService("getMode", &Behaviors::getModeCallback, this);
 	setFollowPosition_ = nh.advertiseService("setFollowPosition", &Behaviors::setFollowPositionCallback, this);
 	setLandPosition_ = nh.advertiseService("setLandPosition", &Behaviors::setLandPositionCallback, this);
+	setWaypoints_ = nh.advertiseService("setWaypoints", &Behaviors::setWaypointsCallback, this);
+	setCoverage_ = nh.advertiseService("setCoverage", &Behaviors::setCoverageCallback, this);
 }
 
 void Behaviors::assignSubscribers()
@@ -146,40 +178,12 @@ void Behaviors::assignSubscribers()
 	extCmdSub_ = nh.subscribe("extCommand", 1, &Behaviors::extCmdCallback, this);
 }
 
-Eigen::Vector4d Behaviors::boat_to_drone(Eigen::Vector4d pos)
-{
-	// Vertical setpoint
-	double vDiff = pos(2) + state.boat_p.z - state.drone_p.z; // Distance from UAV to point (- if below UAV)
-	double wDiff = pos(3) + state.heading - state.drone_q.z;	// Angular distance between headings (- if CW of UAV)
-
-	// Ensure angular dist [-pi, pi)
-	if (wDiff >= M_PI)
-		wDiff -= 2 * M_PI;
-	else if (wDiff < -M_PI)
-		wDiff += 2 * M_PI;
-
-	// Get setpoint in world frame
-	Eigen::Vector2d goal_boat_body(pos(0), pos(1));																											 // Setpoint relative to boat frame
-	Eigen::Vector2d goal_boat_world = bsc_common::util::rotation_matrix(state.heading) * goal_boat_body; // Relative to boat in world frame
-	Eigen::Vector2d boat_world(state.boat_p.x, state.boat_p.y);																					 // Boat position in world
-	Eigen::Vector2d goal_world = boat_world + goal_boat_world;																					 // Setpoint in world frame
-
-	// Transform to drone frame
-	Eigen::Vector2d drone_world(state.drone_p.x, state.drone_p.y);																						// Drone position in world
-	Eigen::Vector2d goal_drone_world = goal_world - drone_world;																							// World frame vector from drone to setpoint
-	Eigen::Vector2d goal_drone_body = bsc_common::util::rotation_matrix(-state.drone_q.z) * goal_drone_world; // Transform into the drone frame
-
-	Eigen::Vector4d dronePos;
-	dronePos << goal_drone_body(0), goal_drone_body(1), vDiff, wDiff;
-
-	return dronePos;
-}
-
 Eigen::Vector2d Behaviors::gimbal_angle_cmd()
 {
-	double dx = state.boat_p.x - state.drone_p.x;
-	double dy = state.boat_p.y - state.drone_p.y;
-	double dz = state.boat_p.z - state.drone_p.z;
+	const bsc_common::LandingBehaviors::derived_t &derived = landing_->derived();
+	double dx = -derived.boatOffsetWorld(0);
+	double dy = -derived.boatOffsetWorld(1);
+	double dz = -derived.boatOffsetZ;
 
 	double dxy = sqrt(dx * dx + dy * dy);
 
@@ -198,55 +202,57 @@ Eigen::Vector2d Behaviors::gimbal_angle_cmd()
 
 	return gimbalAngle;
 }
-bool Behaviors::inLandThreshold()
+void Behaviors::publishCommand(const bsc_common::LandingBehaviors::command_t &cmd)
 {
+	sensor_msgs::Joy msg;
+	msg.axes.push_back(cmd.u(0));
+	msg.axes.push_back(cmd.u(1));
+	msg.axes.push_back(cmd.u(2));
+	msg.axes.push_back(cmd.u(3));
+	msg.axes.push_back(cmd.flag);
+	cmdPub_.publish(msg);
+}
 
-	double x = state.drone_p.x-state.boat_p.x;
-	double y = state.drone_p.y-state.boat_p.y;
-	
-	Eigen::Vector2d world_off(x,y);	
-	Eigen::Vector2d boat_off = bsc_common::util::rotation_matrix(-state.heading) * world_off;
-
-	x=boat_off(0)-land_.goal_pose.x;
-	y=boat_off(1)-land_.goal_pose.y;
-
-	double z = state.drone_p.z-state.boat_p.z-land_.goal_pose.z;
-
-	double w = state.drone_q.z-state.heading-land_.goal_pose.w;
-
-	if (w >= M_PI)
-		w -= 2 * M_PI;
-	else if (w < -M_PI)
-		w += 2 * M_PI;
-
-	double xb = land_.xBottomThresh;
-	double xt = land_.xTopThresh;
-
-	double yb = land_.yBottomThresh;
-	double yt = land_.yTopThresh;
-
-	double zb = land_.bottom; // bottom of trapezoid for finding x,y boundaries
-	double zt = land_.top;
-
-	double xl = (z - zb) * (xb - xt) / (zt - zb) - xb;
-	double xh = (z - zb) * (xt - xb) / (zt - zb) + xb;
-
-	double yl = (z - zb) * (yb - yt) / (zt - zb) - yb;
-	double yh = (z - zb) * (yt - yb) / (zt - zb) + yb;
-
-	bool inX = xl < x and x < xh;
-	bool inY = yl < y and y < yh;
-	bool inZ = zb < z and z < zt;
-	bool inW = fabs(w) < land_.angleThresh;
+void Behaviors::landCheck(const bsc_common::LandingBehaviors::check_t &c)
+{
+	recorder_.record(log_.landThreshold, {c.x, c.y, c.z, c.w, c.vel, c.xHigh, c.yHigh, (double)c.in});
+
+	double now = ros::Time::now().toSec();
+	if (land_.diagnosticsRate > 0 and now - land_.lastDiagnostics >= 1 / land_.diagnosticsRate)
+	{
+		const bsc_common::LandingBehaviors::params_t &p = landing_->params();
+		jetyak_uav_utils::LandingDiagnostics &d = land_.diagnostics;
+		d.header.stamp = ros::Time::now();
+		d.x = c.x;
+		d.y = c.y;
+		d.z = c.z;
+		d.w = c.w;
+		d.vel = c.vel;
+		d.x_low = c.xLow;
+		d.x_high = c.xHigh;
+		d.y_low = c.yLow;
+		d.y_high = c.yHigh;
+		d.z_low = p.landBottom;
+		d.z_high = p.landTop;
+		d.w_limit = p.landAngleThresh;
+		d.vel_limit = p.landVelMag;
+		d.in_x = c.inX;
+		d.in_y = c.inY;
+		d.in_z = c.inZ;
+		d.in_w = c.inW;
+		d.in_vel = c.inVel;
+		d.in_threshold = c.in;
+		d.quiet_in = c.quietIn;
+		d.wait_elapsed = c.waitElapsed;
+		landDiagnosticsPub_.publish(d);
+		land_.lastDiagnostics = now;
+	}
+}
 
-	double velSqr = pow(state.drone_pdot.x-state.boat_pdot.x, 2) + pow(state.drone_pdot.y-state.boat_pdot.y, 2);
-	bool inVel = velSqr < land_.velThreshSqr;
-	// ROS_WARN("%1.8f,%1.8f",(pow(state.drone_pdot.x, 2) + pow(state.drone_pdot.y, 2)),land_.velThreshSqr);
-	ROS_WARN("%s,%s,%s,%s,%s",inX?" true":"false",inY?" true":"false",inZ?" true":"false",inW?" true":"false",inVel?" true":"false");
-	ROS_WARN("X %1.2f<%1.2f<%1.2f",xl,x,xh);
-	ROS_WARN("Y %1.2f<%1.2f<%1.2f",yl,y,yh);
-	ROS_WARN("Z %1.2f<%1.2f<%1.2f",zb,z,zt);
-	ROS_WARN("W %1.2f<%1.2f<%1.2f",-land_.angleThresh,w,land_.angleThresh);
-	ROS_WARN("V %1.2f<%1.2f",sqrt(velSqr),sqrt(land_.velThreshSqr));
-	return inX and inY and inZ and inW and inVel;
+void Behaviors::recordControl(const bsc_common::LQR &lqr)
+{
+	const Eigen::Matrix<double, 4, 1> &u = lqr.getOutput();
+	recorder_.record(log_.state, lqr.getState().data(), 12);
+	recorder_.record(log_.setpoint, lqr.getSetpoint().data(), 12);
+	recorder_.record(log_.command, {u(0), u(1), u(2), u(3), (double)(&lqr == &landing_->landLqr())});
 }
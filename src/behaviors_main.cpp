@@ -49,12 +49,44 @@ Behaviors::Behaviors(ros::NodeHandle &nh_param)
 	leave_.input.axes.push_back(0);
 	leave_.input.axes.push_back(JETYAK_UAV_UTILS::WORLD_RATE);
 
-	lqr_ = new bsc_common::LQR(generalK);
-	land_.lqr = new bsc_common::LQR(landK);
+	waypoint_.cmd.axes.resize(5, 0);
+	waypoint_.cmd.axes[4] = JETYAK_UAV_UTILS::LQR;
+	waypoint_.window.reserve(3);
+
+	landing_ = new bsc_common::LandingBehaviors(landingParams_, bsc_common::LQR(generalK).getK(),
+																							bsc_common::LQR(landK).getK());
+	bsc_common::LandingBehaviors::hooks_t hooks;
+	hooks.takeoff = [this]() {
+		std_srvs::Trigger srv;
+		takeoffSrv_.call(srv);
+		return (bool)srv.response.success;
+	};
+	hooks.land = [this]() {
+		std_srvs::Trigger srv;
+		landSrv_.call(srv);
+		return (bool)srv.response.success;
+	};
+	hooks.command = [this](const bsc_common::LandingBehaviors::command_t &cmd) { publishCommand(cmd); };
+	hooks.control = [this](const bsc_common::LQR &lqr) { recordControl(lqr); };
+	hooks.landCheck = [this](const bsc_common::LandingBehaviors::check_t &c) { landCheck(c); };
+	landing_->setHooks(hooks);
+
+	log_.state = recorder_.addType("lqr_state", "x,y,z,xdot,ydot,zdot,r,p,w,rdot,pdot,wdot");
+	log_.setpoint = recorder_.addType("lqr_setpoint", "x,y,z,xdot,ydot,zdot,r,p,w,rdot,pdot,wdot");
+	log_.command = recorder_.addType("lqr_command", "r,p,z,w,land");
+	log_.mode = recorder_.addType("mode", "mode,return_stage,changed");
+	log_.landThreshold = recorder_.addType("land_threshold", "x,y,z,w,vel,xh,yh,in");
+	if (!log_.path.empty() and !recorder_.open(log_.path, log_.maxRecords))
+		ASYNC_WARN("Flight recorder could not open %s", log_.path.c_str());
 }
 
 Behaviors::~Behaviors()
 {
+	if (recorder_.isOpen())
+		ASYNC_INFO("Flight recorder wrote %lu records, dropped %lu", (unsigned long)recorder_.written(),
+						 (unsigned long)recorder_.dropped());
+	recorder_.close();
+	delete landing_;
 }
 
 void Behaviors::doBehaviorAction()
@@ -97,21 +129,28 @@ void Behaviors::doBehaviorAction()
 		hoverBehavior();
 		break;
 	}
+	case JETYAK_UAV_UTILS::WAYPOINT:
+	{
+		waypointBehavior();
+		break;
+	}
 	default:
 	{
-		if (propellorsRunning)
+		if (landing_->propellorsRunning())
 		{
-			ROS_ERROR("Mode out of bounds: %i. Now hovering.", (char)currentMode_);
+			ASYNC_ERROR("Mode out of bounds: %i. Now hovering.", (char)currentMode_);
 			this->currentMode_ = JETYAK_UAV_UTILS::HOVER;
 		}
 		else
 		{
-			ROS_ERROR("Mode out of bounds: %i. Now riding.", (char)currentMode_);
+			ASYNC_ERROR("Mode out of bounds: %i. Now riding.", (char)currentMode_);
 			this->currentMode_ = JETYAK_UAV_UTILS::RIDE;
 		}
 		break;
 	}
 		}
+	recorder_.record(log_.mode, {(double)currentMode_, (double)return_.stage, (double)behaviorChanged_});
+
 	Eigen::Vector2d cmds = gimbal_angle_cmd();
 	geometry_msgs::Vector3 msg;
 	msg.x = 0;
@@ -128,6 +167,7 @@ int main(int argc, char **argv)
 {
 	ros::init(argc, argv, "behaviors");
 	ros::NodeHandle nh;
+	JETYAK_UAV_UTILS::startAsyncLog();
 	Behaviors behaviors_o(nh);
 	ros::Rate rate(25);
 
@@ -44,22 +44,22 @@ bool Behaviors::setModeCallback(jetyak_uav_utils::SetString::Request &req, jetya
 
 				enableGimbalSrv_.call(enable);
 				if(not enable.response.success) {
-					ROS_WARN("Failed to %s tracking",enable.request.data?"enable":"disable");
+					ASYNC_WARN("Failed to %s tracking",enable.request.data?"enable":"disable");
 					res.success = false;
 					return false;
 				} else {
-					ROS_WARN("%s tracking",enable.request.data?"Enabled":"Disabled");
+					ASYNC_WARN("%s tracking",enable.request.data?"Enabled":"Disabled");
 					trackEnabled = shouldTrack;
 				}
 			}
 			currentMode_ = (JETYAK_UAV_UTILS::Mode)i;
 			behaviorChanged_ = true;
 			res.success = true;
-			ROS_WARN("Mode changed to %s", req.data.c_str());
+			ASYNC_WARN("Mode changed to %s", req.data.c_str());
 			return true;
 		}
 	}
-	ROS_WARN("Invalid mode: %s", req.data.c_str());
+	ASYNC_WARN("Invalid mode: %s", req.data.c_str());
 	return false;
 }
 
@@ -72,10 +72,7 @@ bool Behaviors::getModeCallback(jetyak_uav_utils::GetString::Request &req, jetya
 bool Behaviors::setFollowPositionCallback(jetyak_uav_utils::FourAxes::Request &req,
 																					jetyak_uav_utils::FourAxes::Response &res)
 {
-	follow_.goal_pose.x = req.x[0];
-	follow_.goal_pose.y = req.y[0];
-	follow_.goal_pose.z = req.z[0];
-	follow_.goal_pose.w = req.w[0];
+	landing_->params().followGoal << req.x[0], req.y[0], req.z[0], req.w[0];
 
 	res.success = true;
 	return true;
@@ -84,11 +81,106 @@ bool Behaviors::setFollowPositionCallback(jetyak_uav_utils::FourAxes::Request &r
 bool Behaviors::setLandPositionCallback(jetyak_uav_utils::FourAxes::Request &req,
 																				jetyak_uav_utils::FourAxes::Response &res)
 {
-	land_.goal_pose.x = req.x[0];
-	land_.goal_pose.y = req.y[0];
-	land_.goal_pose.z = req.z[0];
-	land_.goal_pose.w = req.w[0];
+	landing_->params().landGoal << req.x[0], req.y[0], req.z[0], req.w[0];
 
 	res.success = true;
 	return true;
 }
+
+bool Behaviors::setWaypointsCallback(jetyak_uav_utils::SetWaypoints::Request &req,
+																		 jetyak_uav_utils::SetWaypoints::Response &res)
+{
+	if (state.origin.x == 0 and state.origin.y == 0)
+	{
+		ASYNC_WARN("No ENU origin yet, rejecting waypoints");
+		res.success = false;
+		return true;
+	}
+
+	bsc_common::GPS_ENU enu;
+	enu.setENUOrigin(state.origin.x, state.origin.y, state.origin.z);
+
+	const std::vector<jetyak_uav_utils::Waypoint> &wps = req.waypoints.waypoints;
+	std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d>> points;
+	points.reserve(wps.size() + 1);
+	points.push_back(Eigen::Vector3d(state.drone_p.x, state.drone_p.y, state.drone_p.z));
+
+	waypoint_.radius.assign(1, 0);
+	waypoint_.loiterTime.assign(1, 0);
+	waypoint_.heading.assign(1, state.drone_q.z);
+	for (const jetyak_uav_utils::Waypoint &wp : wps)
+	{
+		points.push_back(enu.geo2enu(wp.lat, wp.lon, wp.alt));
+		waypoint_.radius.push_back(wp.radius > 0 ? wp.radius : 1.0); // a zero radius could never be entered
+		waypoint_.loiterTime.push_back(wp.loiter_time);
+		waypoint_.heading.push_back(wp.heading);
+	}
+
+	waypoint_.path.build(points);
+	waypoint_.points = points;
+	waypoint_.streaming = false;
+	waypoint_.leg = 0;
+	waypoint_.lookaheadLeg = 0;
+	waypoint_.enteredTime = -1;
+	bool planning = planTrajectory(1);
+	if (currentMode_ == JETYAK_UAV_UTILS::WAYPOINT)
+		behaviorChanged_ = true;
+
+	ASYNC_WARN("Received %i waypoints, %1.1fm path, %s", (int)wps.size(), waypoint_.path.length(),
+						 planning ? "planning a trajectory" : "following legs");
+	res.success = true;
+	return true;
+}
+
+bool Behaviors::setCoverageCallback(jetyak_uav_utils::SetCoverage::Request &req,
+																		jetyak_uav_utils::SetCoverage::Response &res)
+{
+	const std::vector<jetyak_uav_utils::Waypoint> &corners = req.polygon.waypoints;
+	if ((state.origin.x == 0 and state.origin.y == 0) or corners.size() < 3)
+	{
+		ASYNC_WARN("No ENU origin yet or fewer than 3 corners, rejecting coverage");
+		res.success = false;
+		return true;
+	}
+
+	bsc_common::GPS_ENU enu;
+	enu.setENUOrigin(state.origin.x, state.origin.y, state.origin.z);
+
+	bsc_common::CoveragePath::polygon_t polygon;
+	for (const jetyak_uav_utils::Waypoint &c : corners)
+		polygon.push_back(enu.geo2enu(c.lat, c.lon, c.alt).head<2>());
+
+	if (not waypoint_.coverage.setup(polygon, (bsc_common::CoveragePath::Pattern)req.pattern, req.spacing, req.angle))
+	{
+		ASYNC_WARN("Invalid coverage polygon or spacing");
+		res.success = false;
+		return true;
+	}
+
+	// Every survey point shares the first corner's settings
+	const jetyak_uav_utils::Waypoint &first = corners[0];
+	waypoint_.surveyZ = enu.geo2enu(first.lat, first.lon, first.alt)(2);
+	waypoint_.radius.assign(3, first.radius > 0 ? first.radius : 1.0);
+	waypoint_.loiterTime.assign(3, first.loiter_time);
+	waypoint_.heading.assign(3, first.heading);
+
+	// Seed the window with the drone's position and the first two survey points
+	waypoint_.window.clear();
+	waypoint_.window.push_back(Eigen::Vector3d(state.drone_p.x, state.drone_p.y, state.drone_p.z));
+	Eigen::Vector2d p;
+	for (int i = 0; i < 2 and waypoint_.coverage.next(p); ++i)
+		waypoint_.window.push_back(Eigen::Vector3d(p(0), p(1), waypoint_.surveyZ));
+	waypoint_.path.build(waypoint_.window);
+
+	waypoint_.streaming = true;
+	waypoint_.planning = false;
+	waypoint_.leg = 0;
+	waypoint_.lookaheadLeg = 0;
+	waypoint_.enteredTime = -1;
+	if (currentMode_ == JETYAK_UAV_UTILS::WAYPOINT)
+		behaviorChanged_ = true;
+
+	ASYNC_WARN("Coverage survey of %i corners started", (int)corners.size());
+	res.success = true;
+	return true;
+}
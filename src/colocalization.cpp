@@ -0,0 +1,340 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the colocalization node
+ */
+
+#include "jetyak_uav_utils/colocalization.h"
+
+#include <algorithm>
+
+colocalization::colocalization(ros::NodeHandle &nh)
+{
+	// Subscribe to topics
+	dGPSSub = nh.subscribe("/dji_sdk/gps_position", 1, &colocalization::dGPSCallback, this);
+	dAttiSub = nh.subscribe("/dji_sdk/attitude", 1, &colocalization::dAttiCallback, this);
+	dImuSub = nh.subscribe("/dji_sdk/imu", 1, &colocalization::dImuCallback, this);
+	dVelSub = nh.subscribe("/dji_sdk/velocity", 1, &colocalization::dVelCallback, this);
+	jGPSSub = nh.subscribe("/jetyak2/global_position/global", 1, &colocalization::jGPSCallback, this);
+	jCompassSub = nh.subscribe("/jetyak2/global_position/compass_hdg", 1, &colocalization::jCompassCallback, this);
+	tagSub = nh.subscribe("/jetyak_uav_vision/tag_pose", 1, &colocalization::tagCallback, this);
+
+	// Set up publisher
+	statePub = nh.advertise<jetyak_uav_utils::ObservedState>("/jetyak_uav_vision/state", 1);
+
+	// Set up service
+	resetFilterService = nh.advertiseService("/jetyak_uav_vision/resetFilter", &colocalization::resetFilterCallback, this);
+
+	if (!ros::param::get("~rate", rate))
+	{
+		rate = 50;
+		ROS_WARN("rate not available, defaulting to %1.1f", rate);
+	}
+
+	// The DJI IMU runs at 400Hz
+	if (!ros::param::get("~imu_decimation", imuDecimation))
+	{
+		imuDecimation = 2;
+		ROS_WARN("imu_decimation not available, defaulting to %i", imuDecimation);
+	}
+
+	if (!ros::param::get("~use_srf", useSrf))
+		useSrf = false;
+	if (useSrf)
+		ROS_INFO("Using the float32 square root filter");
+
+	// Samples kept for replay, the filter is predicted forward when it falls further behind
+	if (!ros::param::get("~imu_buffer", imuBuffer))
+	{
+		imuBuffer = 200;
+		ROS_WARN("imu_buffer not available, defaulting to %i", imuBuffer);
+	}
+
+	originSet = false;
+	attiSet = false;
+	ratesSet = false;
+	headingSet = false;
+	droneRates.setZero();
+	propagated.valid = false;
+	imuCount = 0;
+	lastImuTime = 0;
+	imuStats.latencySum = 0;
+	imuStats.latencyMax = 0;
+	imuStats.costMax = 0;
+	imuStats.samples = 0;
+	imuStats.lastReport = ros::WallTime::now();
+}
+
+double colocalization::getRate()
+{
+	return rate;
+}
+
+void colocalization::predictAndPublish()
+{
+	if (!filterInitialized() or !attiSet or !ratesSet or !headingSet)
+		return;
+
+	// The filter stays at its newest measurement unless that is older than every kept sample
+	if (!imuSamples.empty() and imuSamples.front().t > filterTime())
+		useSrf ? srf.predictTo(imuSamples.front().t) : ekf.predictTo(imuSamples.front().t);
+	while (!imuSamples.empty() and imuSamples.front().t <= filterTime())
+		imuSamples.pop_front();
+
+	// Restart the propagation from the filter and replay the samples since
+	bsc_common::ColocalizationEKF::state_t X = filterState();
+	propagated.t = filterTime();
+	propagated.droneP = X.segment<3>(bsc_common::ColocalizationEKF::DRONE_P);
+	propagated.droneV = X.segment<3>(bsc_common::ColocalizationEKF::DRONE_V);
+	propagated.boatP = X.segment<3>(bsc_common::ColocalizationEKF::BOAT_P);
+	propagated.boatV = X.segment<2>(bsc_common::ColocalizationEKF::BOAT_V);
+	propagated.valid = true;
+	for (const imu_t &sample : imuSamples)
+		propagate(sample.t, sample.a);
+
+	// Publish at the filter rate if the IMU went quiet
+	if (ros::Time::now().toSec() - lastImuTime > 2 / rate)
+		publishState(ros::Time(propagated.t), propagated.droneP, propagated.droneV, propagated.boatP);
+}
+
+bool colocalization::filterInitialized() const
+{
+	return useSrf ? srf.isInitialized() : ekf.isInitialized();
+}
+
+double colocalization::filterTime() const
+{
+	return useSrf ? srf.getTime() : ekf.getTime();
+}
+
+bsc_common::ColocalizationEKF::state_t colocalization::filterState() const
+{
+	if (useSrf)
+		return srf.getState().cast<double>();
+	return ekf.getState();
+}
+
+void colocalization::propagate(double t, const Eigen::Vector3d &a)
+{
+	double dt = t - propagated.t;
+	propagated.droneP += dt * propagated.droneV + .5 * dt * dt * a;
+	propagated.droneV += dt * a;
+	propagated.boatP.head<2>() += dt * propagated.boatV;
+	propagated.t = t;
+}
+
+void colocalization::publishState(const ros::Time &stamp, const Eigen::Vector3d &droneP, const Eigen::Vector3d &droneV,
+																	const Eigen::Vector3d &boatP)
+{
+	bsc_common::ColocalizationEKF::state_t X = filterState();
+	Eigen::Vector3d rpy = bsc_common::attitude::rpyFromQuat(droneAtti);
+
+	jetyak_uav_utils::ObservedState stateMsg;
+	stateMsg.header.stamp = stamp;
+	stateMsg.header.frame_id = "local_ENU";
+
+	stateMsg.drone_p.x = droneP(0);
+	stateMsg.drone_p.y = droneP(1);
+	stateMsg.drone_p.z = droneP(2);
+
+	stateMsg.drone_pdot.x = droneV(0);
+	stateMsg.drone_pdot.y = droneV(1);
+	stateMsg.drone_pdot.z = droneV(2);
+
+	stateMsg.drone_q.x = rpy(0);
+	stateMsg.drone_q.y = rpy(1);
+	stateMsg.drone_q.z = rpy(2);
+
+	stateMsg.drone_qdot.x = droneRates(0);
+	stateMsg.drone_qdot.y = droneRates(1);
+	stateMsg.drone_qdot.z = droneRates(2);
+
+	stateMsg.boat_p.x = boatP(0) - X(11);
+	stateMsg.boat_p.y = boatP(1) - X(12);
+	stateMsg.boat_p.z = boatP(2) - X(13);
+
+	stateMsg.boat_pdot.x = X(9);
+	stateMsg.boat_pdot.y = X(10);
+	stateMsg.boat_pdot.z = 0;
+
+	stateMsg.heading = bsc_common::angles::wrap(boatHeading - X(14));
+
+	stateMsg.gps_offset.x = X(11);
+	stateMsg.gps_offset.y = X(12);
+	stateMsg.gps_offset.z = X(13);
+
+	stateMsg.heading_offset = X(14);
+
+	stateMsg.origin.x = origin(0);
+	stateMsg.origin.y = origin(1);
+	stateMsg.origin.z = origin(2);
+
+	statePub.publish(stateMsg);
+}
+
+// Callbacks
+void colocalization::dGPSCallback(const sensor_msgs::NavSatFix::ConstPtr &msg)
+{
+	if (originSet)
+	{
+		Eigen::Vector3d z = enu.geo2enu(msg->latitude, msg->longitude, msg->altitude);
+		useSrf ? srf.processDroneGPS(z, msg->header.stamp.toSec()) : ekf.processDroneGPS(z, msg->header.stamp.toSec());
+	}
+	else
+	{
+		enu.setENUOrigin(msg->latitude, msg->longitude, msg->altitude);
+		origin << msg->latitude, msg->longitude, msg->altitude;
+		originSet = true;
+	}
+}
+
+void colocalization::dAttiCallback(const geometry_msgs::QuaternionStamped::ConstPtr &msg)
+{
+	droneAtti = Eigen::Quaterniond(msg->quaternion.w, msg->quaternion.x, msg->quaternion.y, msg->quaternion.z);
+	attiSet = true;
+}
+
+void colocalization::dVelCallback(const geometry_msgs::Vector3Stamped::ConstPtr &msg)
+{
+	Eigen::Vector3d z(msg->vector.x, msg->vector.y, msg->vector.z);
+	useSrf ? srf.processDroneVel(z, msg->header.stamp.toSec()) : ekf.processDroneVel(z, msg->header.stamp.toSec());
+}
+
+void colocalization::jGPSCallback(const sensor_msgs::NavSatFix::ConstPtr &msg)
+{
+	if (originSet)
+	{
+		Eigen::Vector3d z = enu.geo2enu(msg->latitude, msg->longitude, msg->altitude);
+		useSrf ? srf.processBoatGPS(z, msg->header.stamp.toSec()) : ekf.processBoatGPS(z, msg->header.stamp.toSec());
+	}
+}
+
+void colocalization::jCompassCallback(const std_msgs::Float64::ConstPtr &msg)
+{
+	// Compass heading is clockwise from north
+	boatHeading = bsc_common::angles::wrapDeg(90 - msg->data) * bsc_common::angles::PI / 180;
+	headingSet = true;
+}
+
+void colocalization::tagCallback(const geometry_msgs::PoseStamped::ConstPtr &msg)
+{
+	if (attiSet and headingSet)
+	{
+		Eigen::Vector3d tagPos(msg->pose.position.x, msg->pose.position.y, msg->pose.position.z);
+		Eigen::Vector3d posW = droneAtti * tagPos;
+
+		double yawT = bsc_common::attitude::yawFromQuat(msg->pose.orientation.x, msg->pose.orientation.y,
+																										 msg->pose.orientation.z, msg->pose.orientation.w);
+		double yawD = bsc_common::attitude::yawFromQuat(droneAtti.x(), droneAtti.y(), droneAtti.z(), droneAtti.w());
+
+		Eigen::Vector4d z;
+		z << posW, bsc_common::angles::wrap(boatHeading - yawT - yawD);
+		useSrf ? srf.processTag(z, msg->header.stamp.toSec()) : ekf.processTag(z, msg->header.stamp.toSec());
+	}
+}
+
+void colocalization::dImuCallback(const sensor_msgs::Imu::ConstPtr &msg)
+{
+	ros::WallTime start = ros::WallTime::now();
+
+	droneRates << msg->angular_velocity.x, msg->angular_velocity.y, msg->angular_velocity.z;
+	ratesSet = true;
+
+	double t = msg->header.stamp.toSec();
+	lastImuTime = t;
+	if (!attiSet or (!imuSamples.empty() and t <= imuSamples.back().t))
+		return;
+
+	// Specific force in FLU rotated to ENU, minus gravity
+	Eigen::Quaterniond q(msg->orientation.w, msg->orientation.x, msg->orientation.y, msg->orientation.z);
+	Eigen::Vector3d f(msg->linear_acceleration.x, msg->linear_acceleration.y, msg->linear_acceleration.z);
+	imu_t sample = {t, q * f - Eigen::Vector3d(0, 0, 9.80665)};
+	imuSamples.push_back(sample);
+	if ((int)imuSamples.size() > imuBuffer)
+		imuSamples.pop_front();
+
+	if (!propagated.valid or t <= propagated.t)
+		return;
+	propagate(t, sample.a);
+
+	if (++imuCount < imuDecimation)
+		return;
+	imuCount = 0;
+
+	publishState(msg->header.stamp, propagated.droneP, propagated.droneV, propagated.boatP);
+
+	// Track the latency from the IMU stamp and the cost of the sample
+	double latency = (ros::Time::now() - msg->header.stamp).toSec();
+	double cost = (ros::WallTime::now() - start).toSec();
+	imuStats.latencySum += latency;
+	imuStats.latencyMax = std::max(imuStats.latencyMax, latency);
+	imuStats.costMax = std::max(imuStats.costMax, cost);
+	++imuStats.samples;
+
+	if ((ros::WallTime::now() - imuStats.lastReport).toSec() > 10)
+	{
+		ROS_INFO("IMU propagation: %i states, latency mean %1.2fms max %1.2fms, max cost %1.3fms", imuStats.samples,
+						 1e3 * imuStats.latencySum / imuStats.samples, 1e3 * imuStats.latencyMax, 1e3 * imuStats.costMax);
+		imuStats.latencySum = 0;
+		imuStats.latencyMax = 0;
+		imuStats.costMax = 0;
+		imuStats.samples = 0;
+		imuStats.lastReport = ros::WallTime::now();
+	}
+}
+
+bool colocalization::resetFilterCallback(std_srvs::Trigger::Request &req, std_srvs::Trigger::Response &res)
+{
+	ekf.reset();
+	srf.reset();
+	propagated.valid = false;
+	imuSamples.clear();
+
+	res.success = true;
+	res.message = "Filter reset";
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////  Main  ////////////////////////////
+////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv)
+{
+	ros::init(argc, argv, "colocalization");
+	ros::NodeHandle nh;
+
+	colocalization filter(nh);
+	ros::Rate rate(filter.getRate());
+
+	while (ros::ok())
+	{
+		ros::spinOnce();
+		filter.predictAndPublish();
+		rate.sleep();
+	}
+
+	return 0;
+}
@@ -40,7 +40,7 @@ dji_pilot::dji_pilot(ros::NodeHandle &nh)
 	// Load autopilot parameters
 	loadPilotParameters();
 	if (isM100)
-		ROS_INFO("Platform set to M100");
+		ASYNC_INFO("Platform set to M100");
 
 	// Set up subscriptions
 	extCmdSub = nh.subscribe("behavior_cmd", 10, &dji_pilot::extCallback, this);
@@ -90,6 +90,11 @@ dji_pilot::dji_pilot(ros::NodeHandle &nh)
 	rcCommand.axes.push_back(commandFlag);
 
 	alarm = new bsc_common::Flasher(250000);
+
+	commandRecord = recorder.addType("command", "rc,r,p,z,w,flag");
+	panicRecord = recorder.addType("panic", "panic,rc_age");
+	if (!recorderPath.empty() && !recorder.open(recorderPath, recorderMaxRecords))
+		ASYNC_WARN("Flight recorder could not open %s", recorderPath.c_str());
 }
 
 dji_pilot::~dji_pilot()
@@ -98,10 +103,11 @@ dji_pilot::~dji_pilot()
 	{
 		// Try to release control
 		if (requestControl(0))
-			ROS_INFO("Control released back to RC");
+			ASYNC_INFO("Control released back to RC");
 	}
 	alarm->stopFlash();
 	delete alarm;
+	recorder.close();
 }
 
 void dji_pilot::loadPilotParameters()
@@ -131,6 +137,10 @@ void dji_pilot::loadPilotParameters()
 	// Yaw thresholds
 	nh_private.param("yAngleRateMax", yAngleRateMax, 5.0 * C_PI / 6.0);
 	nh_private.param("yAngleMax", yAngleMax, C_PI);
+
+	// Flight recorder
+	nh_private.param("recorder_path", recorderPath, std::string(""));
+	nh_private.param("recorder_maxRecords", recorderMaxRecords, 2000000);
 }
 
 // Callbacks //
@@ -156,7 +166,7 @@ void dji_pilot::extCallback(const sensor_msgs::Joy::ConstPtr &msg)
 		extCommand = adaptiveClipping(*output);
 	}
 	else
-		ROS_WARN("Command received has not the expected format");
+		ASYNC_WARN("Command received has not the expected format");
 }
 
 void dji_pilot::rcCallback(const sensor_msgs::Joy::ConstPtr &msg)
@@ -164,7 +174,7 @@ void dji_pilot::rcCallback(const sensor_msgs::Joy::ConstPtr &msg)
 	if (!rcReceived)
 	{
 		rcReceived = true;
-		ROS_WARN("RC msg received");
+		ASYNC_WARN("RC msg received");
 	}
 
 	// Update last RC msg time
@@ -270,15 +280,15 @@ bool dji_pilot::requestControl(int requestFlag)
 
 	if (!ctrlAuthority.response.result)
 	{
-		ROS_ERROR("Could not switch control");
+		ASYNC_ERROR("Could not switch control");
 		return false;
 	}
 	else
 	{
 		if (requestFlag)
-			ROS_INFO("Control of vehicle is obtained");
+			ASYNC_INFO("Control of vehicle is obtained");
 		else
-			ROS_INFO("Released vehicle control");
+			ASYNC_INFO("Released vehicle control");
 	}
 
 	return true;
@@ -395,6 +405,8 @@ void dji_pilot::publishCommand()
 
 		// Publish command
 		controlPub.publish(djiCommand);
+		recorder.record(commandRecord, {(double)bypassPilot, djiCommand.axes[0], djiCommand.axes[1], djiCommand.axes[2],
+																		djiCommand.axes[3], djiCommand.axes[4]});
 
 		// Reset bypass flag
 		bypassPilot = false;
@@ -412,7 +424,7 @@ bool dji_pilot::checkRCconnection()
 		}
 
 		// TO DO: Sound alarm
-		ROS_WARN("SDK lost connection to RC: PANIC!!!");
+		ASYNC_WARN("SDK lost connection to RC: PANIC!!!");
 		return false;
 	}
 	else if (!rcReceived)
@@ -421,6 +433,7 @@ bool dji_pilot::checkRCconnection()
 	{
 		// PANIC mode ON
 		panicMode = true;
+		recorder.record(panicRecord, {1, ros::Time::now().toSec() - lastRCmsg.toSec()});
 
 		// Release control
 		if (autopilotOn) {
@@ -429,7 +442,7 @@ bool dji_pilot::checkRCconnection()
 		}
 
 		alarm->startFlash();
-		ROS_WARN("SDK lost connection to RC: PANIC!!!");
+		ASYNC_WARN("SDK lost connection to RC: PANIC!!!");
 
 		return false;
 	}
@@ -445,6 +458,7 @@ int main(int argc, char **argv)
 {
 	ros::init(argc, argv, "dji_pilot_node");
 	ros::NodeHandle nh;
+	JETYAK_UAV_UTILS::startAsyncLog();
 
 	dji_pilot joydji_pilot(nh);
 
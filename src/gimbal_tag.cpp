@@ -58,12 +58,10 @@ gimbal_tag::gimbal_tag(ros::NodeHandle &nh)
 
 void gimbal_tag::changeTagAxes()
 {
-	tf::Matrix3x3 rTag(qTag);
-	double tR, tP, tY;
-	rTag.getRPY(tR, tP, tY);
+	Eigen::Vector3d rpy = bsc_common::attitude::rpyFromQuat(qTag.x(), qTag.y(), qTag.z(), qTag.w());
+	Eigen::Quaterniond q = bsc_common::attitude::quatFromRPY(-rpy(2), -rpy(0), rpy(1));
 
-	qTag = tf::createQuaternionFromRPY(-tY, -tR, tP);
-	qTag.normalize();
+	qTag = tf::Quaternion(q.x(), q.y(), q.z(), q.w());
 }
 
 void gimbal_tag::publishTagPose()
@@ -81,11 +79,8 @@ void gimbal_tag::publishTagPose()
 		tf::Quaternion positonTagBody = qOffset * posTag * qOffset.inverse();
 		geometry_msgs::PoseStamped tagPoseBody;
 
-		// Get time
-		ros::Time time = ros::Time::now();
-
-		// Update header
-		tagPoseBody.header.stamp = time;
+		// Update header, stamped with the image so the filter can account for the latency
+		tagPoseBody.header.stamp = tagStamp;
 		tagPoseBody.header.frame_id = "body_FLU";
 
 		tagPoseBody.pose.position.x = positonTagBody[0];
@@ -119,6 +114,10 @@ void gimbal_tag::tagCallback(const ar_track_alvar_msgs::AlvarMarkers &msg)
 		posTag[2] = msg.markers[0].pose.pose.position.z;
 		posTag[3] = 0;
 
+		tagStamp = msg.markers[0].header.stamp;
+		if (tagStamp.isZero())
+			tagStamp = ros::Time::now();
+
 		// Go from Camera frame to Gimbal frame
 		qTag = qFix * qTag;
 
@@ -134,15 +133,10 @@ void gimbal_tag::tagCallback(const ar_track_alvar_msgs::AlvarMarkers &msg)
 void gimbal_tag::gimbalCallback(const geometry_msgs::Vector3Stamped &msg)
 {
 	// The gimbal's frame is NED while the drone's frame is ENU
-	double rotZ = 90 - msg.vector.z;
-
-	if (rotZ >= 180)
-		rotZ -= 360;
-	else if (rotZ < -180)
-		rotZ += 360;
+	double rotZ = bsc_common::angles::wrapDeg(90 - msg.vector.z);
 
-	qGimbal = tf::createQuaternionFromRPY(DEG2RAD(msg.vector.x), DEG2RAD(-msg.vector.y), DEG2RAD(rotZ));
-	qGimbal.normalize();
+	Eigen::Quaterniond q = bsc_common::attitude::quatFromRPY(DEG2RAD(msg.vector.x), DEG2RAD(-msg.vector.y), DEG2RAD(rotZ));
+	qGimbal = tf::Quaternion(q.x(), q.y(), q.z(), q.w());
 }
 
 void gimbal_tag::attitudeCallback(const geometry_msgs::QuaternionStamped &msg)
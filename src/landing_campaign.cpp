@@ -0,0 +1,275 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the landing_campaign tool. It flies Monte Carlo landings with
+ * the behaviors parameters and reports how often and how well they land.
+ *
+ * landing_campaign [-n runs] [-j threads] [-s seed] [-c campaign.yaml] [-o results.csv]
+ *                  <behaviors.yaml> [dji_pilot.yaml]
+ *   The LQR gain files are those named by generalK and landK, or the file of the same
+ *   name beside behaviors.yaml. dji_pilot.yaml gives the command limits. Each run's
+ *   conditions and outcome are written to results.csv.
+ * 
+ * Author: Brennan Cain
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../lib/bsc_common/include/landing_campaign.h"
+
+namespace
+{
+typedef std::map<std::string, std::string> yaml_t;
+
+/** readYaml
+ * Reads the flat key: value files in cfg, comments and quotes removed
+ */
+bool readYaml(const std::string &path, yaml_t &out)
+{
+	std::ifstream file(path.c_str());
+	if (not file)
+		return false;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		line = line.substr(0, line.find('#'));
+		size_t colon = line.find(':');
+		if (colon == std::string::npos)
+			continue;
+		auto trim = [](std::string s) {
+			size_t a = s.find_first_not_of(" \t\r\""), b = s.find_last_not_of(" \t\r\"");
+			return a == std::string::npos ? std::string() : s.substr(a, b - a + 1);
+		};
+		std::string key = trim(line.substr(0, colon));
+		if (not key.empty())
+			out[key] = trim(line.substr(colon + 1));
+	}
+	return true;
+}
+
+void get(const yaml_t &yaml, const std::string &key, double &value)
+{
+	auto it = yaml.find(key);
+	char *end;
+	if (it != yaml.end())
+	{
+		double v = strtod(it->second.c_str(), &end);
+		if (end != it->second.c_str() and *end == 0)
+			value = v;
+		else
+			fprintf(stderr, "%s is not a number: %s\n", key.c_str(), it->second.c_str());
+	}
+}
+
+// [min, max]
+void get(const yaml_t &yaml, const std::string &key, bsc_common::LandingCampaign::range_t &range)
+{
+	auto it = yaml.find(key);
+	if (it != yaml.end() and sscanf(it->second.c_str(), " [ %lf , %lf ]", &range.min, &range.max) != 2)
+		fprintf(stderr, "%s is not [min, max]: %s\n", key.c_str(), it->second.c_str());
+}
+
+/** loadK
+ * Reads an LQR gain file, falling back to the file of the same name in dir
+ */
+bool loadK(const yaml_t &yaml, const std::string &key, const std::string &dir, Eigen::Matrix<double, 4, 12> &K)
+{
+	auto it = yaml.find(key);
+	if (it == yaml.end())
+		return true;
+	std::string path = it->second;
+	if (not std::ifstream(path.c_str()))
+		path = dir + "/" + path.substr(path.find_last_of('/') + 1);
+	if (not std::ifstream(path.c_str()))
+	{
+		fprintf(stderr, "cannot open %s for %s\n", it->second.c_str(), key.c_str());
+		return false;
+	}
+
+	// column row value, from 1
+	std::ifstream file(path.c_str());
+	int col, row;
+	double value;
+	K.setZero();
+	while (file >> col >> row >> value)
+		if (col >= 1 and col <= 12 and row >= 1 and row <= 4)
+			K(row - 1, col - 1) = value;
+	return true;
+}
+
+void loadMission(const yaml_t &y, bsc_common::LandingMission::params_t &p)
+{
+	get(y, "follow_x", p.followGoal(0));
+	get(y, "follow_y", p.followGoal(1));
+	get(y, "follow_z", p.followGoal(2));
+	get(y, "follow_w", p.followGoal(3));
+	get(y, "follow_tagLossThresh", p.followTagLossThresh);
+
+	get(y, "land_x", p.landGoal(0));
+	get(y, "land_y", p.landGoal(1));
+	get(y, "land_z", p.landGoal(2));
+	get(y, "land_w", p.landGoal(3));
+	get(y, "land_velMag", p.landVelMag);
+	get(y, "land_xTopThresh", p.landXTopThresh);
+	get(y, "land_yTopThresh", p.landYTopThresh);
+	get(y, "land_xBottomThresh", p.landXBottomThresh);
+	get(y, "land_yBottomThresh", p.landYBottomThresh);
+	get(y, "land_bottom", p.landBottom);
+	get(y, "land_top", p.landTop);
+	get(y, "land_angleThresh", p.landAngleThresh);
+	get(y, "land_tagLossThresh", p.landTagLossThresh);
+	get(y, "land_quietSpeed", p.landQuietSpeed);
+	get(y, "land_quietTime", p.landQuietTime);
+	get(y, "land_quietWait", p.landQuietWait);
+	get(y, "land_predictHorizon", p.landPredictHorizon);
+	get(y, "land_sigmaPos", p.landSigmaPos);
+	get(y, "land_sigmaVel", p.landSigmaVel);
+	get(y, "land_minConfidence", p.landMinConfidence);
+	get(y, "land_paceSlack", p.landPaceSlack);
+	get(y, "land_attFreq", p.landPlant.attFreq);
+	get(y, "land_attDamp", p.landPlant.attDamp);
+	get(y, "land_zTau", p.landPlant.zTau);
+	get(y, "land_yawTau", p.landPlant.yawTau);
+}
+
+void loadCampaign(const yaml_t &y, bsc_common::LandingCampaign::config_t &c)
+{
+	get(y, "behavior_rate", c.behaviorRate);
+	get(y, "state_rate", c.stateRate);
+	get(y, "tag_rate", c.tagRate);
+	get(y, "follow_time", c.followTime);
+	get(y, "timeout", c.timeout);
+	get(y, "wind_speed", c.windSpeed);
+	get(y, "boat_speed", c.boatSpeed);
+	get(y, "weave_amplitude", c.weaveAmplitude);
+	get(y, "weave_period", c.weavePeriod);
+	get(y, "heave_amplitude", c.heaveAmplitude);
+	get(y, "heave_period", c.heavePeriod);
+	get(y, "dropout_rate", c.dropoutRate);
+	get(y, "dropout_length", c.dropoutLength);
+	get(y, "position_noise", c.positionNoise);
+	get(y, "velocity_noise", c.velocityNoise);
+	get(y, "range_noise", c.rangeNoise);
+	get(y, "deck_height", c.sim.deckHeight);
+	get(y, "pad_radius", c.sim.padRadius);
+	get(y, "camera_cone", c.sim.cameraCone);
+	get(y, "max_range", c.sim.maxRange);
+	get(y, "detect_near", c.sim.detectNear);
+	get(y, "detect_far", c.sim.detectFar);
+}
+
+void printStats(const char *name, const bsc_common::LandingCampaign::stats_t &s)
+{
+	printf("%-22s mean %6.2f  p5 %6.2f  p50 %6.2f  p95 %6.2f  max %6.2f\n", name, s.mean, s.p5, s.p50, s.p95, s.max);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	int runs = 1000, threads = std::max(1u, std::thread::hardware_concurrency());
+	unsigned seed = 1;
+	std::string campaignPath, outPath;
+	std::vector<std::string> args;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (not strcmp(argv[i], "-n") and i + 1 < argc)
+			runs = std::max(1, atoi(argv[++i]));
+		else if (not strcmp(argv[i], "-j") and i + 1 < argc)
+			threads = std::max(1, atoi(argv[++i]));
+		else if (not strcmp(argv[i], "-s") and i + 1 < argc)
+			seed = strtoul(argv[++i], nullptr, 10);
+		else if (not strcmp(argv[i], "-c") and i + 1 < argc)
+			campaignPath = argv[++i];
+		else if (not strcmp(argv[i], "-o") and i + 1 < argc)
+			outPath = argv[++i];
+		else
+			args.push_back(argv[i]);
+	}
+
+	yaml_t behaviors, pilot, campaign;
+	if (args.empty() or args.size() > 2 or not readYaml(args[0], behaviors) or
+			(args.size() == 2 and not readYaml(args[1], pilot)) or
+			(not campaignPath.empty() and not readYaml(campaignPath, campaign)))
+	{
+		fprintf(stderr, "usage: landing_campaign [-n runs] [-j threads] [-s seed] [-c campaign.yaml] [-o results.csv] "
+										"<behaviors.yaml> [dji_pilot.yaml]\n");
+		return 1;
+	}
+
+	bsc_common::LandingCampaign::config_t config;
+	std::string dir = args[0].find('/') == std::string::npos ? "." : args[0].substr(0, args[0].find_last_of('/'));
+	loadMission(behaviors, config.mission);
+	if (not loadK(behaviors, "generalK", dir, config.generalK) or not loadK(behaviors, "landK", dir, config.landK))
+		return 1;
+	get(pilot, "hAngleCmdMax", config.hAngleCmdMax);
+	get(pilot, "hVelocityMaxGround", config.hVelocityMax);
+	get(pilot, "vVelocityMaxBody", config.vVelocityMaxBody);
+	get(pilot, "vVelocityMaxGround", config.vVelocityMaxGround);
+	get(pilot, "yAngleRateMax", config.yAngleRateMax);
+	loadCampaign(campaign, config);
+	config.seed = seed;
+
+	bsc_common::LandingCampaign lc(config);
+	auto start = std::chrono::steady_clock::now();
+	std::vector<bsc_common::LandingCampaign::result_t> results = lc.run(runs, threads);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (not outPath.empty())
+	{
+		FILE *out = fopen(outPath.c_str(), "w");
+		if (not out)
+		{
+			fprintf(stderr, "cannot write %s\n", outPath.c_str());
+			return 1;
+		}
+		fprintf(out, "run,outcome,time,error,touchdown_speed,aborts,wind,boat_speed,weave,heave,dropout_rate,position_noise\n");
+		for (const bsc_common::LandingCampaign::result_t &r : results)
+			fprintf(out, "%i,%s,%.3f,%.4f,%.3f,%i,%.3f,%.3f,%.4f,%.4f,%.4f,%.4f\n", r.run,
+							bsc_common::LandingCampaign::outcomeName(r.outcome), r.time, r.error, r.touchdownSpeed, r.aborts, r.wind,
+							r.boatSpeed, r.weave, r.heave, r.dropoutRate, r.positionNoise);
+		fclose(out);
+	}
+
+	bsc_common::LandingCampaign::summary_t s = bsc_common::LandingCampaign::summarize(results);
+	printf("%i runs in %1.2fs on %i threads (%1.0f runs/s)\n", s.runs, seconds, threads, s.runs / seconds);
+	printf("success %5.1f%%, 95%% interval %5.1f%% to %5.1f%%\n", 100 * s.successRate, 100 * s.successLow,
+				 100 * s.successHigh);
+	for (int o = 0; o < bsc_common::LandingCampaign::OUTCOMES; ++o)
+		printf("  %-8s %i\n", bsc_common::LandingCampaign::outcomeName((bsc_common::LandingCampaign::outcome_t)o),
+					 s.outcomes[o]);
+	printStats("time to land (s)", s.time);
+	printStats("touchdown error (m)", s.error);
+	printStats("touchdown speed (m/s)", s.touchdownSpeed);
+	return 0;
+}
@@ -0,0 +1,419 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the UDP link bridge node
+ */
+
+#include "jetyak_uav_utils/link_bridge.h"
+
+#include <boost/make_shared.hpp>
+#include <cstring>
+
+namespace
+{
+/** QueuedCall
+ * Runs a function from a callback queue
+ */
+class QueuedCall : public ros::CallbackInterface
+{
+public:
+	QueuedCall(const std::function<void()> &run) : run(run)
+	{
+	}
+
+	CallResult call()
+	{
+		run();
+		return Success;
+	}
+
+private:
+	std::function<void()> run;
+};
+
+/** serialize
+ * ROS serializes msg after prefix
+ */
+template <class M>
+std::vector<uint8_t> serialize(const M &msg, const uint8_t *prefix, size_t prefixSize)
+{
+	uint32_t size = ros::serialization::serializationLength(msg);
+	std::vector<uint8_t> out(prefixSize + size);
+	if (prefixSize)
+		memcpy(out.data(), prefix, prefixSize);
+	ros::serialization::OStream stream(out.data() + prefixSize, size);
+	ros::serialization::serialize(stream, msg);
+	return out;
+}
+
+template <class M>
+bool deserialize(const uint8_t *data, size_t size, M &msg)
+{
+	try
+	{
+		ros::serialization::IStream stream(const_cast<uint8_t *>(data), size);
+		ros::serialization::deserialize(stream, msg);
+	}
+	catch (ros::serialization::StreamOverrunException &e)
+	{
+		return false;
+	}
+	return true;
+}
+
+inline void put(double *&row, const geometry_msgs::Vector3 &v)
+{
+	*row++ = v.x;
+	*row++ = v.y;
+	*row++ = v.z;
+}
+
+inline void get(const double *&row, geometry_msgs::Vector3 &v)
+{
+	v.x = *row++;
+	v.y = *row++;
+	v.z = *row++;
+}
+} // namespace
+
+link_bridge::link_bridge(ros::NodeHandle &nh)
+		: callSpinner(1, &callQueue), stateEncoder(STATE_COLUMNS), stateDecoder(STATE_COLUMNS), mode(0), modeSet(false),
+			modeChanged(false), nextCall(0)
+{
+	ros::NodeHandle nh_private("~");
+	std::string side, peerHost, key;
+	int port, peerPort, maxRetries;
+	double bandwidth, minTimeout, simulatedLoss;
+	nh_private.param("side", side, std::string("uav"));
+	nh_private.param("port", port, 14600);
+	nh_private.param("peer_host", peerHost, std::string("127.0.0.1"));
+	nh_private.param("peer_port", peerPort, 14600);
+	nh_private.param("state_period", statePeriod, 0.1);
+	nh_private.param("state_maxRows", stateMaxRows, 25);
+	nh_private.param("mode_period", modePeriod, 1.0);
+	nh_private.param("bandwidth", bandwidth, 0.0);
+	nh_private.param("max_retries", maxRetries, 10);
+	nh_private.param("min_timeout", minTimeout, 0.05);
+	nh_private.param("service_timeout", serviceTimeout, 2.0);
+	nh_private.param("stats_period", statsPeriod, 1.0);
+	nh_private.param("simulated_loss", simulatedLoss, 0.0);
+	nh_private.param("key", key, std::string(""));
+	isUav = side != "boat";
+
+	if (!link.open(port, peerHost, peerPort))
+		ROS_ERROR("Could not open the link on port %i to %s:%i", port, peerHost.c_str(), peerPort);
+	link.setBandwidth(bandwidth);
+	link.setRetries(maxRetries, minTimeout);
+	link.setKey(key);
+	if (key.empty())
+		ROS_WARN("No link key, datagrams are not signed");
+	if (simulatedLoss > 0)
+	{
+		ROS_WARN("Simulating %.0f%% loss on the link", 100 * simulatedLoss);
+		link.simulateLoss(simulatedLoss);
+	}
+
+	if (isUav)
+	{
+		callSpinner.start();
+		stateSub = nh.subscribe("/jetyak_uav_vision/state", 10, &link_bridge::stateCallback, this);
+		modeSub = nh.subscribe("/jetyak_uav_utils/behavior_mode", 10, &link_bridge::modeCallback, this);
+	}
+	else
+	{
+		statePub = nh.advertise<jetyak_uav_utils::ObservedState>("/jetyak_uav_vision/state", 1);
+		modePub = nh.advertise<std_msgs::UInt8>("/jetyak_uav_utils/behavior_mode", 1);
+	}
+	statsPub = nh.advertise<jetyak_uav_utils::LinkStats>("link_stats", 1);
+
+	addService<jetyak_uav_utils::SetString>(nh, "setMode");
+	addService<jetyak_uav_utils::GetString>(nh, "getMode");
+	addService<jetyak_uav_utils::FourAxes>(nh, "setFollowPosition");
+	addService<jetyak_uav_utils::FourAxes>(nh, "setLandPosition");
+	addService<jetyak_uav_utils::SetWaypoints>(nh, "setWaypoints");
+	addService<jetyak_uav_utils::SetCoverage>(nh, "setCoverage");
+
+	lastFlush = lastMode = lastStats = ros::WallTime::now();
+}
+
+link_bridge::~link_bridge()
+{
+	callSpinner.stop();
+	link.close();
+}
+
+bool link_bridge::isOpen() const
+{
+	return link.isOpen();
+}
+
+template <class S>
+void link_bridge::addService(ros::NodeHandle &nh, const std::string &name)
+{
+	std::string service = "/jetyak_uav_utils/" + name;
+	if (isUav)
+	{
+		callers.push_back([service](const uint8_t *data, size_t size, std::vector<uint8_t> &response) {
+			S srv;
+			if (!deserialize(data, size, srv.request) || !ros::service::call(service, srv))
+				return false;
+			response = serialize(srv.response, nullptr, 0);
+			return true;
+		});
+	}
+	else
+	{
+		uint8_t index = servers.size();
+		boost::function<bool(typename S::Request &, typename S::Response &)> callback =
+				[this, index](typename S::Request &req, typename S::Response &res) { return forwardCall<S>(index, req, res); };
+		servers.push_back(nh.advertiseService(service, callback));
+	}
+}
+
+template <class S>
+bool link_bridge::forwardCall(uint8_t index, typename S::Request &req, typename S::Response &res)
+{
+	uint8_t prefix[5];
+	uint32_t id;
+	{
+		std::lock_guard<std::mutex> lock(callMutex);
+		id = nextCall++;
+		replies[id] = std::make_pair(false, std::vector<uint8_t>());
+	}
+	memcpy(prefix, &id, 4);
+	prefix[4] = index;
+	std::vector<uint8_t> request = serialize(req, prefix, sizeof(prefix));
+	if (!link.send(REQUEST, bsc_common::UdpLink::COMMAND, request.data(), request.size()))
+	{
+		ROS_WARN("Request too large for the link");
+		std::lock_guard<std::mutex> lock(callMutex);
+		replies.erase(id);
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(callMutex);
+	bool answered = callDone.wait_for(lock, std::chrono::duration<double>(serviceTimeout),
+																		[this, id]() { return replies[id].first; });
+	std::vector<uint8_t> response = replies[id].second;
+	replies.erase(id);
+	lock.unlock();
+
+	if (!answered)
+	{
+		ROS_WARN("No response over the link after %1.1fs", serviceTimeout);
+		return false;
+	}
+
+	// [success][response]
+	return response.size() >= 1 && response[0] && deserialize(response.data() + 1, response.size() - 1, res);
+}
+
+void link_bridge::poll(double timeout)
+{
+	link.poll([this](uint8_t channel, bsc_common::UdpLink::priority_t priority, const uint8_t *data,
+									 size_t size) { received(channel, priority, data, size); },
+						timeout);
+
+	ros::WallTime now = ros::WallTime::now();
+	if (isUav)
+	{
+		if ((now - lastFlush).toSec() >= statePeriod)
+		{
+			flushState();
+			lastFlush = now;
+		}
+
+		std::lock_guard<std::mutex> lock(stateMutex);
+		if (modeSet && (modeChanged || (now - lastMode).toSec() >= modePeriod))
+		{
+			link.send(MODE, bsc_common::UdpLink::TELEMETRY, &mode, 1);
+			modeChanged = false;
+			lastMode = now;
+		}
+	}
+
+	if ((now - lastStats).toSec() >= statsPeriod)
+	{
+		publishStats();
+		lastStats = now;
+	}
+}
+
+void link_bridge::received(uint8_t channel, bsc_common::UdpLink::priority_t priority, const uint8_t *data,
+													 size_t size)
+{
+	if (channel == STATE && !isUav && size >= 2)
+	{
+		// [uint16 rows][Gorilla rows]
+		uint16_t rows;
+		memcpy(&rows, data, 2);
+		stateDecoder.reset(data + 2, size - 2, rows);
+		int64_t t;
+		double row[STATE_COLUMNS];
+		while (stateDecoder.next(t, row))
+		{
+			jetyak_uav_utils::ObservedState msg;
+			msg.header.stamp.fromNSec(t);
+			const double *r = row;
+			get(r, msg.drone_p);
+			get(r, msg.drone_pdot);
+			get(r, msg.drone_q);
+			get(r, msg.drone_qdot);
+			get(r, msg.boat_p);
+			get(r, msg.boat_pdot);
+			msg.heading = *r++;
+			get(r, msg.gps_offset);
+			msg.heading_offset = *r++;
+			get(r, msg.origin);
+			statePub.publish(msg);
+		}
+	}
+	else if (channel == MODE && !isUav && size == 1)
+	{
+		std_msgs::UInt8 msg;
+		msg.data = data[0];
+		modePub.publish(msg);
+	}
+	else if (channel == REQUEST && isUav && size >= 5)
+	{
+		std::vector<uint8_t> request(data, data + size);
+		callQueue.addCallback(boost::make_shared<QueuedCall>([this, request]() { call(request); }));
+	}
+	else if (channel == RESPONSE && !isUav && size >= 5)
+	{
+		uint32_t id;
+		memcpy(&id, data, 4);
+		std::lock_guard<std::mutex> lock(callMutex);
+		auto waiting = replies.find(id);
+		if (waiting != replies.end())
+		{
+			waiting->second = std::make_pair(true, std::vector<uint8_t>(data + 4, data + size));
+			callDone.notify_all();
+		}
+	}
+}
+
+void link_bridge::call(const std::vector<uint8_t> &request)
+{
+	// [id][service][request] -> [id][success][response]
+	uint8_t prefix[5];
+	memcpy(prefix, request.data(), 4);
+	std::vector<uint8_t> response;
+	uint8_t index = request[4];
+	prefix[4] = index < callers.size() && callers[index](request.data() + 5, request.size() - 5, response);
+	std::vector<uint8_t> reply(prefix, prefix + 5);
+	reply.insert(reply.end(), response.begin(), response.end());
+	link.send(RESPONSE, bsc_common::UdpLink::COMMAND, reply.data(), reply.size());
+}
+
+void link_bridge::flushState()
+{
+	std::vector<uint8_t> payload;
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		if (!stateEncoder.rows())
+			return;
+		uint16_t rows = stateEncoder.rows();
+		payload.resize(2);
+		memcpy(payload.data(), &rows, 2);
+		payload.insert(payload.end(), stateEncoder.data(), stateEncoder.data() + stateEncoder.size());
+		stateEncoder.reset();
+	}
+	link.send(STATE, bsc_common::UdpLink::TELEMETRY, payload.data(), payload.size());
+}
+
+void link_bridge::publishStats()
+{
+	bsc_common::UdpLink::stats_t s = link.stats();
+	jetyak_uav_utils::LinkStats msg;
+	msg.header.stamp = ros::Time::now();
+	msg.sent = s.sent;
+	msg.received = s.received;
+	msg.sent_bytes = s.sentBytes;
+	msg.received_bytes = s.receivedBytes;
+	msg.rejected = s.rejected;
+	msg.telemetry = s.telemetry;
+	msg.lost = s.lost;
+	msg.late = s.late;
+	msg.dropped = s.dropped;
+	msg.loss_rate = s.lossRate();
+	msg.commands = s.commands;
+	msg.retransmits = s.retransmits;
+	msg.failed = s.failed;
+	msg.pending_commands = link.pendingCommands();
+	msg.rtt = s.rtt;
+	msg.rtt_var = s.rttVar;
+	statsPub.publish(msg);
+}
+
+void link_bridge::stateCallback(const jetyak_uav_utils::ObservedState::ConstPtr &msg)
+{
+	double row[STATE_COLUMNS], *r = row;
+	put(r, msg->drone_p);
+	put(r, msg->drone_pdot);
+	put(r, msg->drone_q);
+	put(r, msg->drone_qdot);
+	put(r, msg->boat_p);
+	put(r, msg->boat_pdot);
+	*r++ = msg->heading;
+	put(r, msg->gps_offset);
+	*r++ = msg->heading_offset;
+	put(r, msg->origin);
+
+	bool full;
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stateEncoder.append(msg->header.stamp.toNSec(), row);
+		full = (int)stateEncoder.rows() >= stateMaxRows;
+	}
+	if (full)
+		flushState();
+}
+
+void link_bridge::modeCallback(const std_msgs::UInt8::ConstPtr &msg)
+{
+	std::lock_guard<std::mutex> lock(stateMutex);
+	modeChanged = modeChanged || !modeSet || msg->data != mode;
+	modeSet = true;
+	mode = msg->data;
+}
+
+int main(int argc, char **argv)
+{
+	ros::init(argc, argv, "link_bridge");
+	ros::NodeHandle nh;
+
+	link_bridge bridge(nh);
+	if (!bridge.isOpen())
+		return 1;
+
+	// Callbacks run beside the link, forwarded service calls block until the UAV answers
+	ros::AsyncSpinner spinner(2);
+	spinner.start();
+	while (ros::ok())
+		bridge.poll(0.005);
+
+	return 0;
+}
@@ -0,0 +1,396 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the log_export tool. It converts flight logs into column tables
+ * for analysis and reads them back.
+ *
+ * log_export export [-j threads] [-a maxArray] <out_dir> <file>...
+ *   Each bag (.bag) becomes <out_dir>/<name>/<topic>/, one table per topic, and each
+ *   flight recorder file (.bin) becomes <out_dir>/<name>/<type>/. Files are converted
+ *   in parallel. Inputs with the same name get <name>_<input index> instead.
+ * log_export info <table_dir>
+ * log_export query <table_dir> [-t start end] [-f field,field,...]
+ *   Prints the rows in the time range (s since the epoch) as CSV.
+ * 
+ * Author: Brennan Cain
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "../lib/bsc_common/include/column_store.h"
+#include "../lib/bsc_common/include/flight_recorder.h"
+#include "../lib/bsc_common/include/msg_flattener.h"
+#include "../lib/bsc_common/include/ros_bag.h"
+
+namespace
+{
+struct result_t
+{
+	size_t bytes = 0, rows = 0, stored = 0;
+	int tables = 0;
+	double seconds = 0;
+	std::string error;
+};
+
+std::string baseName(const std::string &path)
+{
+	std::string name = path.substr(path.find_last_of('/') + 1);
+	return name.substr(0, name.find_last_of('.'));
+}
+
+std::string tableName(const std::string &topic)
+{
+	std::string name = topic.substr(topic.find_first_not_of('/') == std::string::npos ? 0 : topic.find_first_not_of('/'));
+	std::replace(name.begin(), name.end(), '/', '_');
+	return name.empty() ? "root" : name;
+}
+
+bool endsWith(const std::string &s, const std::string &end)
+{
+	return s.size() >= end.size() and s.compare(s.size() - end.size(), end.size(), end) == 0;
+}
+
+// One output table, fed by every connection on its topic
+struct table_t
+{
+	bsc_common::MessageFlattener flattener;
+	bsc_common::ColumnWriter writer;
+	std::string type;
+	std::vector<double> row;
+	bool ok = false;
+	table_t(int maxArray) : flattener(maxArray) {}
+};
+
+void exportBag(const std::string &path, const std::string &out, int maxArray, result_t &r)
+{
+	bsc_common::RosBagReader bag;
+	if (not bag.open(path))
+	{
+		r.error = "not a version 2.0 bag";
+		return;
+	}
+	r.bytes = bag.size();
+
+	std::map<std::string, std::unique_ptr<table_t>> tables;
+	std::vector<table_t *> byConn;
+	size_t skipped = 0;
+	bool ok = bag.read([&](const bsc_common::RosBagReader::message_t &m) {
+		if (m.conn >= byConn.size() or not byConn[m.conn])
+		{
+			byConn.resize(std::max<size_t>(byConn.size(), m.conn + 1), nullptr);
+			const bsc_common::RosBagReader::connection_t &c = bag.connections().at(m.conn);
+			std::unique_ptr<table_t> &t = tables[c.topic];
+			if (not t)
+			{
+				t.reset(new table_t(maxArray));
+				t->type = c.type;
+				t->ok = t->flattener.parse(c.type, c.definition) and
+								t->writer.open(out + "/" + tableName(c.topic), t->flattener.fields());
+				t->row.resize(t->flattener.fields().size());
+				if (not t->ok)
+					fprintf(stderr, "%s: cannot export %s (%s)\n", path.c_str(), c.topic.c_str(), c.type.c_str());
+			}
+			byConn[m.conn] = t.get();
+		}
+
+		table_t *t = byConn[m.conn];
+		if (t->ok and t->type == bag.connections().at(m.conn).type and t->flattener.flatten(m.data, m.size, t->row.data()))
+		{
+			t->writer.append(m.stamp, t->row.data());
+			++r.rows;
+		}
+		else
+			++skipped;
+	});
+
+	for (auto &t : tables)
+		if (t.second->ok)
+		{
+			r.stored += t.second->writer.bytes();
+			++r.tables;
+			if (not t.second->writer.close())
+				r.error = "write failed for " + t.first;
+		}
+	if (not ok)
+		r.error = "bag ends early, exported what was readable";
+	if (skipped or bag.skippedChunks())
+		fprintf(stderr, "%s: skipped %lu messages and %i compressed chunks\n", path.c_str(), (unsigned long)skipped,
+						bag.skippedChunks());
+}
+
+void exportRecorder(const std::string &path, const std::string &out, result_t &r)
+{
+	typedef bsc_common::FlightRecorder recorder_t;
+	FILE *f = fopen(path.c_str(), "rb");
+	recorder_t::header_t header;
+	if (not f or fread(&header, sizeof(header), 1, f) != 1 or strncmp(header.magic, "JYFLTREC", 8) or
+			header.recordSize != sizeof(recorder_t::record_t))
+	{
+		if (f)
+			fclose(f);
+		r.error = "not a flight recorder file";
+		return;
+	}
+
+	// Schema lines are "<id> <name> <field>,<field>,..."
+	std::vector<std::unique_ptr<bsc_common::ColumnWriter>> writers(recorder_t::MAX_TYPES);
+	std::vector<size_t> widths(recorder_t::MAX_TYPES, 0);
+	std::istringstream schema(std::string(header.schema, strnlen(header.schema, sizeof(header.schema))));
+	std::string line;
+	while (std::getline(schema, line))
+	{
+		std::istringstream words(line);
+		int id;
+		std::string name, list, field;
+		if (not(words >> id >> name >> list) or id < 0 or id >= recorder_t::MAX_TYPES)
+			continue;
+		std::vector<std::string> fields;
+		std::istringstream names(list);
+		while (std::getline(names, field, ','))
+			fields.push_back(field);
+		writers[id].reset(new bsc_common::ColumnWriter());
+		if (not writers[id]->open(out + "/" + name, fields))
+		{
+			r.error = "cannot create " + out + "/" + name;
+			writers[id].reset();
+		}
+		widths[id] = fields.size();
+		++r.tables;
+	}
+
+	std::vector<recorder_t::record_t> records(4096);
+	double row[recorder_t::MAX_FIELDS];
+	size_t left = header.records, n;
+	while (left and (n = fread(records.data(), sizeof(recorder_t::record_t), std::min(left, records.size()), f)) > 0)
+	{
+		left -= n;
+		for (size_t i = 0; i < n; ++i)
+		{
+			const recorder_t::record_t &rec = records[i];
+			if (rec.type >= recorder_t::MAX_TYPES or not writers[rec.type])
+				continue;
+			for (size_t c = 0; c < widths[rec.type]; ++c)
+				row[c] = c < rec.count ? rec.values[c] : NAN;
+			writers[rec.type]->append(rec.stamp, row);
+			++r.rows;
+		}
+	}
+	r.bytes = sizeof(header) + (header.records - left) * sizeof(recorder_t::record_t);
+	fclose(f);
+
+	for (auto &w : writers)
+		if (w)
+		{
+			r.stored += w->bytes();
+			if (not w->close())
+				r.error = "write failed";
+		}
+	if (left)
+		r.error = "file ends early, exported what was readable";
+}
+
+int exportFiles(int argc, char **argv)
+{
+	int threads = std::max(1u, std::thread::hardware_concurrency()), maxArray = 8;
+	std::vector<std::string> args;
+	for (int i = 2; i < argc; ++i)
+	{
+		if (not strcmp(argv[i], "-j") and i + 1 < argc)
+			threads = std::max(1, atoi(argv[++i]));
+		else if (not strcmp(argv[i], "-a") and i + 1 < argc)
+			maxArray = std::max(0, atoi(argv[++i]));
+		else
+			args.push_back(argv[i]);
+	}
+	if (args.size() < 2)
+	{
+		fprintf(stderr, "usage: log_export export [-j threads] [-a maxArray] <out_dir> <file>...\n");
+		return 1;
+	}
+
+	const std::string out = args[0];
+	std::vector<std::string> files(args.begin() + 1, args.end());
+	mkdir(out.c_str(), 0755);
+
+	// One directory per input, so no two workers write the same tables. The first input
+	// with a name keeps it, later ones get a name no input has.
+	std::vector<std::string> dirs(files.size());
+	std::set<std::string> taken;
+	for (const std::string &file : files)
+		taken.insert(baseName(file));
+	std::set<std::string> used;
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		std::string name = baseName(files[i]);
+		if (not used.insert(name).second)
+		{
+			std::string renamed = name + "_" + std::to_string(i);
+			for (int k = 1; taken.count(renamed); ++k)
+				renamed = name + "_" + std::to_string(i) + "_" + std::to_string(k);
+			printf("%s: %s/%s is taken, writing to %s/%s\n", files[i].c_str(), out.c_str(), name.c_str(), out.c_str(),
+						 renamed.c_str());
+			taken.insert(renamed);
+			name = renamed;
+		}
+		dirs[i] = out + "/" + name;
+	}
+
+	std::vector<result_t> results(files.size());
+	std::atomic<size_t> next(0);
+	std::mutex print;
+	auto worker = [&]() {
+		for (size_t i; (i = next++) < files.size();)
+		{
+			const std::string &dir = dirs[i];
+			mkdir(dir.c_str(), 0755);
+			auto s = std::chrono::steady_clock::now();
+			if (endsWith(files[i], ".bin"))
+				exportRecorder(files[i], dir, results[i]);
+			else
+				exportBag(files[i], dir, maxArray, results[i]);
+			results[i].seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - s).count();
+
+			const result_t &r = results[i];
+			std::lock_guard<std::mutex> lock(print);
+			printf("%s: %lu rows in %i tables, %1.1fMB to %1.1fMB in %1.2fs (%1.0fMB/s)%s%s\n", files[i].c_str(),
+						 (unsigned long)r.rows, r.tables, r.bytes / 1e6, r.stored / 1e6, r.seconds, r.bytes / 1e6 / r.seconds,
+						 r.error.empty() ? "" : ", ", r.error.c_str());
+		}
+	};
+
+	auto s = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (int t = 0; t < std::min<int>(threads, files.size()); ++t)
+		pool.push_back(std::thread(worker));
+	for (std::thread &t : pool)
+		t.join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - s).count();
+
+	size_t bytes = 0, rows = 0;
+	int failed = 0;
+	for (const result_t &r : results)
+	{
+		bytes += r.bytes;
+		rows += r.rows;
+		failed += not r.error.empty();
+	}
+	printf("%lu files, %lu rows, %1.1fMB in %1.2fs on %i threads (%1.0fMB/s)\n", (unsigned long)files.size(),
+				 (unsigned long)rows, bytes / 1e6, seconds, (int)pool.size(), bytes / 1e6 / seconds);
+	return failed ? 1 : 0;
+}
+
+int info(int argc, char **argv)
+{
+	bsc_common::ColumnReader reader;
+	if (argc < 3 or not reader.open(argv[2]))
+	{
+		fprintf(stderr, "usage: log_export info <table_dir>\n");
+		return 1;
+	}
+	printf("%lu rows from %1.3f to %1.3f\n", (unsigned long)reader.rows(), reader.start() * 1e-9, reader.end() * 1e-9);
+	for (const std::string &f : reader.fields())
+		printf("  %s\n", f.c_str());
+	return 0;
+}
+
+int query(int argc, char **argv)
+{
+	bsc_common::ColumnReader reader;
+	int64_t t0 = INT64_MIN, t1 = INT64_MAX;
+	std::vector<std::string> fields;
+	for (int i = 3; i < argc; ++i)
+	{
+		if (not strcmp(argv[i], "-t") and i + 2 < argc)
+		{
+			t0 = (int64_t)(atof(argv[i + 1]) * 1e9);
+			t1 = (int64_t)(atof(argv[i + 2]) * 1e9);
+			i += 2;
+		}
+		else if (not strcmp(argv[i], "-f") and i + 1 < argc)
+		{
+			std::istringstream list(argv[++i]);
+			std::string f;
+			while (std::getline(list, f, ','))
+				fields.push_back(f);
+		}
+	}
+	if (argc < 3 or not reader.open(argv[2]))
+	{
+		fprintf(stderr, "usage: log_export query <table_dir> [-t start end] [-f field,field,...]\n");
+		return 1;
+	}
+
+	std::vector<int64_t> t;
+	std::vector<std::vector<double>> columns;
+	if (not reader.read(t0, t1, fields, t, columns))
+	{
+		fprintf(stderr, "unknown field or damaged table\n");
+		return 1;
+	}
+
+	const std::vector<std::string> &names = fields.empty() ? reader.fields() : fields;
+	printf("t");
+	for (const std::string &n : names)
+		printf(",%s", n.c_str());
+	printf("\n");
+	for (size_t r = 0; r < t.size(); ++r)
+	{
+		printf("%ld.%09ld", (long)(t[r] / 1000000000), (long)(t[r] % 1000000000));
+		for (const std::vector<double> &c : columns)
+			printf(",%.17g", c[r]);
+		printf("\n");
+	}
+	return 0;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	std::string command = argc > 1 ? argv[1] : "";
+	if (command == "export")
+		return exportFiles(argc, argv);
+	if (command == "info")
+		return info(argc, argv);
+	if (command == "query")
+		return query(argc, argv);
+	fprintf(stderr, "usage: log_export export|info|query ...\n");
+	return 1;
+}
@@ -0,0 +1,284 @@
+/**
+MIT License
+
+Copyright (c) 2018 Brennan Cain and Michail Kalaitzakis (Unmanned Systems and Robotics Lab, University of South Carolina, USA)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * This file implements the software in the loop simulator node
+ */
+
+#include "jetyak_uav_utils/sil_sim.h"
+
+#include <algorithm>
+
+namespace
+{
+bsc_common::UavSim::params_t loadParams()
+{
+	ros::NodeHandle nh_private("~");
+	bsc_common::UavSim::params_t p;
+	double windX, windY;
+	nh_private.param("dt", p.dt, p.dt);
+	nh_private.param("boat_speed", p.boatSpeed, p.boatSpeed);
+	nh_private.param("boat_heading", p.boatHeading, p.boatHeading);
+	nh_private.param("weave_amplitude", p.weaveAmplitude, p.weaveAmplitude);
+	nh_private.param("weave_period", p.weavePeriod, p.weavePeriod);
+	nh_private.param("heave_amplitude", p.heaveAmplitude, p.heaveAmplitude);
+	nh_private.param("heave_period", p.heavePeriod, p.heavePeriod);
+	nh_private.param("deck_height", p.deckHeight, p.deckHeight);
+	nh_private.param("pad_radius", p.padRadius, p.padRadius);
+	nh_private.param("wind_x", windX, 0.0);
+	nh_private.param("wind_y", windY, 0.0);
+	nh_private.param("camera_cone", p.cameraCone, p.cameraCone);
+	nh_private.param("max_range", p.maxRange, p.maxRange);
+	nh_private.param("detect_near", p.detectNear, p.detectNear);
+	nh_private.param("detect_far", p.detectFar, p.detectFar);
+	nh_private.param("range_noise", p.rangeNoise, p.rangeNoise);
+	p.wind << windX, windY, 0;
+	return p;
+}
+
+int loadSeed()
+{
+	ros::NodeHandle nh_private("~");
+	int seed;
+	nh_private.param("seed", seed, 1);
+	return seed;
+}
+
+inline void set(geometry_msgs::Vector3 &v, double x, double y, double z)
+{
+	v.x = x;
+	v.y = y;
+	v.z = z;
+}
+} // namespace
+
+sil_sim::sil_sim(ros::NodeHandle &nh)
+		: sim(loadParams(), loadSeed()), clockOffset(0), lastState(-1e9), lastTag(-1e9), lastRc(-1e9), authority(false),
+			crashReported(false)
+{
+	ros::NodeHandle nh_private("~");
+	double stateRate, tagRate, rcRate;
+	nh_private.param("state_rate", stateRate, 50.0);
+	nh_private.param("tag_rate", tagRate, 15.0);
+	nh_private.param("rc_rate", rcRate, 50.0);
+	nh_private.param("real_time_factor", realTimeFactor, 1.0);
+	nh_private.param("report_period", reportPeriod, 5.0);
+	nh_private.param("origin_lat", origin(0), 0.0);
+	nh_private.param("origin_lon", origin(1), 0.0);
+	nh_private.param("origin_alt", origin(2), 0.0);
+	statePeriod = 1 / stateRate;
+	tagPeriod = 1 / tagRate;
+	rcPeriod = 1 / rcRate;
+
+	setpointSub = nh.subscribe("/dji_sdk/flight_control_setpoint_generic", 10, &sil_sim::setpointCallback, this);
+
+	statePub = nh.advertise<jetyak_uav_utils::ObservedState>("/jetyak_uav_vision/state", 1);
+	tagPub = nh.advertise<geometry_msgs::PoseStamped>("/jetyak_uav_vision/tag_pose", 1);
+	rcPub = nh.advertise<sensor_msgs::Joy>("/dji_sdk/rc", 1);
+	clockPub = nh.advertise<rosgraph_msgs::Clock>("/clock", 1);
+
+	authorityServ = nh.advertiseService("/dji_sdk/sdk_control_authority", &sil_sim::authorityCallback, this);
+	taskServ = nh.advertiseService("/dji_sdk/drone_task_control", &sil_sim::taskCallback, this);
+	armServ = nh.advertiseService("/dji_sdk/drone_arm_control", &sil_sim::armCallback, this);
+	resetServ = nh_private.advertiseService("reset", &sil_sim::resetCallback, this);
+	gimbalServ = nh.advertiseService("/jetyak_uav_vision/setGimbalTracking", &sil_sim::visionBoolCallback, this);
+	facedownServ = nh.advertiseService("/jetyak_uav_vision/facedown", &sil_sim::visionTriggerCallback, this);
+	resetFilterServ = nh.advertiseService("/jetyak_uav_vision/reset_filter", &sil_sim::visionTriggerCallback, this);
+}
+
+void sil_sim::spin()
+{
+	ros::WallTime start = ros::WallTime::now(), lastReport = start;
+	double startSim = now(), reportSim = startSim;
+	while (ros::ok())
+	{
+		ros::spinOnce();
+		sim.step();
+
+		ros::Time stamp(now());
+		rosgraph_msgs::Clock clock;
+		clock.clock = stamp;
+		clockPub.publish(clock);
+
+		if (now() - lastState >= statePeriod)
+			publishState(stamp);
+		if (now() - lastTag >= tagPeriod)
+			publishTag(stamp);
+		if (now() - lastRc >= rcPeriod)
+			publishRc(stamp);
+
+		if (sim.crashed() and !crashReported)
+		{
+			ROS_ERROR("Crashed at %1.2fs, call ~reset to start again", now());
+			crashReported = true;
+		}
+
+		// Hold simulated time to real_time_factor times the wall clock
+		ros::WallTime wall = ros::WallTime::now();
+		if (realTimeFactor > 0)
+		{
+			double ahead = (now() - startSim) / realTimeFactor - (wall - start).toSec();
+			if (ahead > 0)
+				ros::WallDuration(ahead).sleep();
+			else if (ahead < -1)
+			{
+				// Fell behind, so catch up from here rather than running fast
+				start = wall;
+				startSim = now();
+			}
+		}
+		if ((wall - lastReport).toSec() >= reportPeriod)
+		{
+			ROS_INFO("%1.1f simulated s per wall s", (now() - reportSim) / (wall - lastReport).toSec());
+			lastReport = wall;
+			reportSim = now();
+		}
+	}
+}
+
+double sil_sim::now() const
+{
+	return clockOffset + sim.time();
+}
+
+void sil_sim::publishState(const ros::Time &stamp)
+{
+	lastState = now();
+	Eigen::Matrix<double, 12, 1> x = sim.uav();
+	Eigen::Vector3d boatP = sim.boatPosition(), boatV = sim.boatVelocity();
+
+	// Colocalization's estimate, exact and with no GPS offset
+	jetyak_uav_utils::ObservedState msg;
+	msg.header.stamp = stamp;
+	msg.header.frame_id = "world_ENU";
+	set(msg.drone_p, x(0), x(1), x(2));
+	set(msg.drone_pdot, x(3), x(4), x(5));
+	set(msg.drone_q, x(6), x(7), x(8));
+	set(msg.drone_qdot, x(9), x(10), x(11));
+	set(msg.boat_p, boatP(0), boatP(1), boatP(2));
+	set(msg.boat_pdot, boatV(0), boatV(1), boatV(2));
+	msg.heading = sim.boatHeading();
+	set(msg.gps_offset, 0, 0, 0);
+	msg.heading_offset = 0;
+	set(msg.origin, origin(0), origin(1), origin(2));
+	statePub.publish(msg);
+}
+
+void sil_sim::publishTag(const ros::Time &stamp)
+{
+	lastTag = now();
+	bsc_common::UavSim::tag_t tag = sim.tag();
+	if (!tag.seen)
+		return;
+
+	geometry_msgs::PoseStamped msg;
+	msg.header.stamp = stamp;
+	msg.header.frame_id = "body_FLU";
+	msg.pose.position.x = tag.position(0);
+	msg.pose.position.y = tag.position(1);
+	msg.pose.position.z = tag.position(2);
+	msg.pose.orientation.x = tag.orientation.x();
+	msg.pose.orientation.y = tag.orientation.y();
+	msg.pose.orientation.z = tag.orientation.z();
+	msg.pose.orientation.w = tag.orientation.w();
+	tagPub.publish(msg);
+}
+
+void sil_sim::publishRc(const ros::Time &stamp)
+{
+	lastRc = now();
+
+	// M100 in P mode with the autopilot switch on and the sticks centered
+	sensor_msgs::Joy msg;
+	msg.header.stamp = stamp;
+	msg.axes = {0, 0, 0, 0, 8000, -10000};
+	rcPub.publish(msg);
+}
+
+void sil_sim::setpointCallback(const sensor_msgs::Joy::ConstPtr &msg)
+{
+	if (authority && msg->axes.size() >= 5)
+		sim.command(msg->axes[0], msg->axes[1], msg->axes[2], msg->axes[3], (uint8_t)msg->axes[4]);
+}
+
+bool sil_sim::authorityCallback(dji_sdk::SDKControlAuthority::Request &req,
+																dji_sdk::SDKControlAuthority::Response &res)
+{
+	authority = req.control_enable;
+	res.result = true;
+	return true;
+}
+
+bool sil_sim::taskCallback(dji_sdk::DroneTaskControl::Request &req, dji_sdk::DroneTaskControl::Response &res)
+{
+	if (req.task == 4)
+		res.result = sim.takeoff();
+	else if (req.task == 6)
+		res.result = sim.land();
+	else
+	{
+		ROS_WARN("Task %i is not simulated", (int)req.task);
+		res.result = false;
+	}
+	return true;
+}
+
+bool sil_sim::armCallback(dji_sdk::DroneArmControl::Request &req, dji_sdk::DroneArmControl::Response &res)
+{
+	res.result = sim.arm(req.arm);
+	return true;
+}
+
+bool sil_sim::resetCallback(std_srvs::Trigger::Request &req, std_srvs::Trigger::Response &res)
+{
+	// The clock carries on from where the last run ended
+	clockOffset += sim.time();
+	sim.reset();
+	crashReported = false;
+	res.success = true;
+	return true;
+}
+
+bool sil_sim::visionTriggerCallback(std_srvs::Trigger::Request &req, std_srvs::Trigger::Response &res)
+{
+	res.success = true;
+	return true;
+}
+
+bool sil_sim::visionBoolCallback(std_srvs::SetBool::Request &req, std_srvs::SetBool::Response &res)
+{
+	res.success = true;
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	ros::init(argc, argv, "sil_sim");
+	ros::NodeHandle nh;
+
+	sil_sim sim(nh);
+	sim.spin();
+
+	return 0;
+}